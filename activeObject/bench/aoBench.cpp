@@ -0,0 +1,403 @@
+// Cost of the event framework on the POSIX port (host, not the device):
+//
+//   latency     post -> dispatch, one event in flight (ping-pong), for an
+//               actor with its own task and an executor-hosted one
+//   throughput  events/s per actor with 1..8 actors busy at once
+//   fan-out     EventBus::publish() to 1..32 subscribers: cost of the call
+//               with plain handlers, and until the last of N actors has
+//               handled the event
+//   timers      jitter of a periodic 10 ms timer, lateness of 5 ms one-shots
+//   hosting     task-per-actor vs executor for 8 and 32 actors: stack
+//               reserved on the device and post -> dispatch latency with
+//               the events spread over all actors
+//   allocation  EventPool vs malloc/free per size class, a burst beyond the
+//               pool, and the pool's fallback counters for the whole run
+//
+// The numbers are relative: the shim runs FreeRTOS tasks as pthreads, so a
+// context switch is a futex wake, not a PendSV. Use them to compare builds
+// of the framework, not to predict the ESP32.
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include "activeObject.h"
+#include "eventBus.h"
+#include "eventPool.h"
+#include "esp_timer.h"
+
+namespace
+{
+
+constexpr size_t STACK_SIZE = 4096;         // per actor task and per worker
+constexpr size_t WORKERS = 2;
+constexpr size_t LATENCY_EVENTS = 20000;
+constexpr size_t THROUGHPUT_EVENTS = 100000;
+// Events in flight per actor: 8 actors x 8 fit the small class
+// (EVENT_POOL_SMALL_BLOCKS), so the heap stays out
+constexpr size_t WINDOW = 8;
+constexpr size_t FANOUT_EVENTS = 2000;
+constexpr size_t MAX_SUBSCRIBERS = 32;
+constexpr uint32_t TIMER_PERIOD_MS = 10;
+constexpr size_t TIMER_PERIODS = 200;
+constexpr uint32_t ONE_SHOT_MS = 5;
+constexpr size_t ONE_SHOTS = 100;
+constexpr size_t ALLOC_ROUNDS = 20000;
+// Blocks held at once per round: freed LIFO like short-lived events
+constexpr size_t ALLOC_BURST = 16;
+
+// Counts handled events; the bench thread waits for a count
+class Counter {
+public:
+    void Add()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _count++;
+        _changed.notify_all();
+    }
+
+    void WaitFor(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [&] { return _count >= count; });
+    }
+
+    size_t Get()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _count;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    size_t _count = 0;
+};
+
+class Sink : public ActiveObject {
+public:
+    Sink(const char* name) : ActiveObject(name, TaskConfig{ STACK_SIZE, 1, tskNO_AFFINITY }, 64) { setup(); }
+    Sink(const char* name, Executor& executor) : ActiveObject(name, executor, 64) { setup(); }
+
+    Counter handled;
+    std::vector<uint32_t> latencies;
+    bool recordLatency = false;
+
+private:
+    void setup()
+    {
+        on<DummyEvent>([this](const DummyEvent& e) {
+            if (recordLatency) {
+                latencies.push_back(static_cast<uint32_t>(esp_timer_get_time()) - e.getCreatedUs());
+            }
+            handled.Add();
+        });
+    }
+};
+
+uint32_t percentile(std::vector<uint32_t>& values, double p)
+{
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t i = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[i];
+}
+
+void printPercentiles(const char* name, std::vector<uint32_t>& values)
+{
+    printf("%-16s %8u %8u %8u %8u\n", name, (unsigned)percentile(values, 0.50), (unsigned)percentile(values, 0.90),
+           (unsigned)percentile(values, 0.99), (unsigned)percentile(values, 1.0));
+}
+
+void latency(const char* name, Sink& sink)
+{
+    sink.latencies.reserve(LATENCY_EVENTS);
+    sink.recordLatency = true;
+    size_t base = sink.handled.Get();
+    for (size_t i = 1; i <= LATENCY_EVENTS; ++i) {
+        sink.Post(new DummyEvent("Bench"));
+        sink.handled.WaitFor(base + i);
+    }
+    sink.recordLatency = false;
+    printPercentiles(name, sink.latencies);
+    sink.latencies.clear();
+}
+
+// One event in flight, posted round robin over the first count sinks
+std::vector<uint32_t> latencySpread(std::vector<Sink*>& sinks, size_t count)
+{
+    std::vector<size_t> base;
+    for (size_t i = 0; i < count; ++i) {
+        base.push_back(sinks[i]->handled.Get());
+        sinks[i]->recordLatency = true;
+    }
+    for (size_t n = 0; n < LATENCY_EVENTS; ++n) {
+        size_t i = n % count;
+        sinks[i]->Post(new DummyEvent("Bench"));
+        sinks[i]->handled.WaitFor(++base[i]);
+    }
+    std::vector<uint32_t> all;
+    for (size_t i = 0; i < count; ++i) {
+        sinks[i]->recordLatency = false;
+        all.insert(all.end(), sinks[i]->latencies.begin(), sinks[i]->latencies.end());
+        sinks[i]->latencies.clear();
+    }
+    return all;
+}
+
+void hostingRow(const char* name, size_t actors, size_t tasks, std::vector<Sink*>& sinks)
+{
+    std::vector<uint32_t> latencies = latencySpread(sinks, actors);
+    printf("%-10s %6zu %6zu %10zu %8u %8u %8u\n", name, actors, tasks, tasks * STACK_SIZE / 1024,
+           (unsigned)percentile(latencies, 0.50), (unsigned)percentile(latencies, 0.99),
+           (unsigned)percentile(latencies, 1.0));
+}
+
+// All sinks busy at once, WINDOW events in flight each; events/s per actor
+double throughput(std::vector<Sink*>& sinks)
+{
+    std::vector<size_t> base;
+    for (Sink* sink : sinks) {
+        base.push_back(sink->handled.Get());
+    }
+    size_t perSink = THROUGHPUT_EVENTS / sinks.size();
+    int64_t start = esp_timer_get_time();
+    for (size_t posted = 0; posted < perSink; ++posted) {
+        for (size_t s = 0; s < sinks.size(); ++s) {
+            if (posted >= WINDOW) {
+                sinks[s]->handled.WaitFor(base[s] + posted - WINDOW + 1);
+            }
+            sinks[s]->Post(new DummyEvent("Bench"));
+        }
+    }
+    for (size_t s = 0; s < sinks.size(); ++s) {
+        sinks[s]->handled.WaitFor(base[s] + perSink);
+    }
+    double seconds = (esp_timer_get_time() - start) / 1e6;
+    return perSink / seconds;
+}
+
+void throughputTable(const char* name, std::vector<Sink*>& pool)
+{
+    printf("%-16s", name);
+    for (size_t count = 1; count <= pool.size(); count *= 2) {
+        std::vector<Sink*> sinks(pool.begin(), pool.begin() + count);
+        printf(" %10.0f", throughput(sinks));
+    }
+    printf("\n");
+}
+
+// ns per publish() with plain handlers
+double fanOutHandlers(size_t subscribers)
+{
+    size_t calls = 0;
+    std::vector<EventBus::SubscriptionId> ids;
+    for (size_t i = 0; i < subscribers; ++i) {
+        ids.push_back(EventBus::get().subscribe<DummyEvent>([&calls](const DummyEvent&) { calls++; }));
+    }
+    const size_t events = FANOUT_EVENTS * 10;
+    int64_t start = esp_timer_get_time();
+    for (size_t i = 0; i < events; ++i) {
+        EventBus::get().publish(new DummyEvent("Bench"));
+    }
+    double ns = (esp_timer_get_time() - start) * 1000.0 / events;
+    for (EventBus::SubscriptionId id : ids) {
+        EventBus::get().unsubscribe(id);
+    }
+    return calls == events * subscribers ? ns : -1.0;
+}
+
+// us from publish() until the last subscribed actor has handled the event
+double fanOutActors(std::vector<Sink*>& sinks, size_t subscribers)
+{
+    std::vector<EventBus::SubscriptionId> ids;
+    for (size_t i = 0; i < subscribers; ++i) {
+        Sink* sink = sinks[i];
+        ids.push_back(EventBus::get().subscribe(Event::Type::Dummy,
+                                                EventBus::HandlerFunc([sink](const Event* e) {
+                                                    sink->TryPost(e->Retain());
+                                                })));
+    }
+    std::vector<size_t> base;
+    for (size_t i = 0; i < subscribers; ++i) {
+        base.push_back(sinks[i]->handled.Get());
+    }
+    int64_t start = esp_timer_get_time();
+    for (size_t n = 1; n <= FANOUT_EVENTS; ++n) {
+        EventBus::get().publish(new DummyEvent("Bench"));
+        for (size_t i = 0; i < subscribers; ++i) {
+            sinks[i]->handled.WaitFor(base[i] + n);
+        }
+    }
+    double us = static_cast<double>(esp_timer_get_time() - start) / FANOUT_EVENTS;
+    for (EventBus::SubscriptionId id : ids) {
+        EventBus::get().unsubscribe(id);
+    }
+    return us;
+}
+
+void timerJitter()
+{
+    std::mutex mutex;
+    std::condition_variable fired;
+    std::vector<int64_t> stamps;
+
+    Timer periodic("BenchPeriodic", true, [&](const Event*) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stamps.push_back(esp_timer_get_time());
+        fired.notify_all();
+    });
+    periodic.Start(TIMER_PERIOD_MS, new DummyEvent("Bench"));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        fired.wait(lock, [&] { return stamps.size() > TIMER_PERIODS; });
+    }
+    periodic.Stop();
+
+    std::vector<uint32_t> jitter;
+    for (size_t i = 1; i < stamps.size(); ++i) {
+        int64_t deviation = stamps[i] - stamps[i - 1] - TIMER_PERIOD_MS * 1000;
+        jitter.push_back(static_cast<uint32_t>(deviation < 0 ? -deviation : deviation));
+    }
+    printPercentiles("periodic 10 ms", jitter);
+
+    std::vector<uint32_t> lateness;
+    Timer oneShot("BenchOneShot", false, [&](const Event*) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stamps.push_back(esp_timer_get_time());
+        fired.notify_all();
+    });
+    for (size_t i = 0; i < ONE_SHOTS; ++i) {
+        std::unique_lock<std::mutex> lock(mutex);
+        stamps.clear();
+        int64_t due = esp_timer_get_time() + ONE_SHOT_MS * 1000;
+        oneShot.Start(ONE_SHOT_MS, new DummyEvent("Bench"));
+        fired.wait(lock, [&] { return !stamps.empty(); });
+        int64_t late = stamps[0] - due;
+        lateness.push_back(static_cast<uint32_t>(late < 0 ? 0 : late));
+    }
+    printPercentiles("one-shot 5 ms", lateness);
+}
+
+// Keeps the compiler from pairing up and dropping malloc/free
+void* volatile g_keep;
+
+// ns per allocate + free, ALLOC_BURST blocks held at once
+template <typename Alloc, typename Free>
+double allocCost(size_t size, Alloc alloc, Free release)
+{
+    void* blocks[ALLOC_BURST];
+    int64_t start = esp_timer_get_time();
+    for (size_t round = 0; round < ALLOC_ROUNDS; ++round) {
+        for (size_t i = 0; i < ALLOC_BURST; ++i) {
+            blocks[i] = alloc(size);
+            g_keep = blocks[i];
+        }
+        for (size_t i = ALLOC_BURST; i-- > 0;) {
+            release(blocks[i]);
+        }
+    }
+    return (esp_timer_get_time() - start) * 1000.0 / (ALLOC_ROUNDS * ALLOC_BURST);
+}
+
+void allocation()
+{
+    const EventPool::SizeClass classes[] = { EventPool::SizeClass::Small, EventPool::SizeClass::Large };
+    const char* names[] = { "small", "large" };
+    for (size_t c = 0; c < 2; ++c) {
+        size_t size = EventPool::GetStats(classes[c]).blockSize;
+        double pool = allocCost(size, EventPool::Allocate, EventPool::Free);
+        double heap = allocCost(size, std::malloc, std::free);
+        printf("%-8s %8zu %12.1f %12.1f\n", names[c], size, pool, heap);
+    }
+
+    // Twice the small class held at once: the second half goes to the heap
+    EventPool::Stats before = EventPool::GetStats(EventPool::SizeClass::Small);
+    size_t size = before.blockSize;
+    std::vector<void*> held(2 * before.blocks);
+    int64_t start = esp_timer_get_time();
+    for (void*& block : held) {
+        block = EventPool::Allocate(size);
+    }
+    for (void* block : held) {
+        EventPool::Free(block);
+    }
+    double ns = (esp_timer_get_time() - start) * 1000.0 / held.size();
+    EventPool::Stats after = EventPool::GetStats(EventPool::SizeClass::Small);
+    printf("burst of %zu small blocks: %.1f ns per pair, %u exhausted (to the heap)\n", held.size(), ns,
+           (unsigned)(after.exhausted - before.exhausted));
+}
+
+void poolCounters()
+{
+    const EventPool::SizeClass classes[] = { EventPool::SizeClass::Small, EventPool::SizeClass::Large };
+    const char* names[] = { "small", "large" };
+    printf("%-8s %8s %10s %10s %10s\n", "class", "blocks", "allocs", "peak", "exhausted");
+    for (size_t c = 0; c < 2; ++c) {
+        EventPool::Stats s = EventPool::GetStats(classes[c]);
+        printf("%-8s %8u %10u %10u %10u\n", names[c], (unsigned)s.blocks, (unsigned)s.allocs, (unsigned)s.highWater,
+               (unsigned)s.exhausted);
+    }
+    printf("oversize events (heap): %u\n", (unsigned)EventPool::GetOversizeCount());
+}
+
+} // namespace
+
+int main()
+{
+    // Actors live until the process ends, like on the device
+    Executor* executor = new Executor("BenchExecutor", STACK_SIZE, 1, WORKERS);
+    std::vector<Sink*> tasks;
+    std::vector<Sink*> hosted;
+    for (size_t i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        tasks.push_back(new Sink("TaskSink"));
+        tasks.back()->Start();
+    }
+    for (size_t i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        hosted.push_back(new Sink("HostedSink", *executor));
+        hosted.back()->Start();
+    }
+
+    printf("post -> dispatch latency, us (%zu events, one in flight)\n", LATENCY_EVENTS);
+    printf("%-16s %8s %8s %8s %8s\n", "actor", "p50", "p90", "p99", "max");
+    latency("own task", *tasks[0]);
+    latency("executor", *hosted[0]);
+
+    printf("\nevents/s per actor (%zu events, %zu in flight per actor)\n", THROUGHPUT_EVENTS, WINDOW);
+    printf("%-16s %10s %10s %10s %10s\n", "actors", "1", "2", "4", "8");
+    std::vector<Sink*> tasksEight(tasks.begin(), tasks.begin() + 8);
+    throughputTable("own task", tasksEight);
+    std::vector<Sink*> hostedEight(hosted.begin(), hosted.begin() + 8);
+    throughputTable("executor (2 w)", hostedEight);
+
+    printf("\ntask per actor vs executor (%zu B stacks, %zu workers; TCBs and mailboxes not counted)\n",
+           STACK_SIZE, WORKERS);
+    printf("%-10s %6s %6s %10s %8s %8s %8s\n", "hosting", "actors", "tasks", "stack KiB", "p50 us", "p99 us",
+           "max us");
+    for (size_t actors : { size_t(8), MAX_SUBSCRIBERS }) {
+        hostingRow("own task", actors, actors, tasks);
+        hostingRow("executor", actors, WORKERS, hosted);
+    }
+
+    printf("\nEventBus fan-out (%zu events)\n", FANOUT_EVENTS);
+    printf("%-12s %16s %22s\n", "subscribers", "handlers ns/pub", "executor actors us/pub");
+    for (size_t subscribers = 1; subscribers <= MAX_SUBSCRIBERS; subscribers *= 2) {
+        printf("%-12zu %16.0f %22.1f\n", subscribers, fanOutHandlers(subscribers), fanOutActors(hosted, subscribers));
+    }
+
+    printf("\ntimer deviation, us (%zu periods, %zu one-shots)\n", TIMER_PERIODS, ONE_SHOTS);
+    printf("%-16s %8s %8s %8s %8s\n", "timer", "p50", "p90", "p99", "max");
+    timerJitter();
+
+    printf("\nevent allocation, ns per allocate + free (%zu held at once)\n", ALLOC_BURST);
+    printf("%-8s %8s %12s %12s\n", "class", "bytes", "EventPool", "malloc");
+    allocation();
+
+    printf("\nEventPool over the whole run\n");
+    poolCounters();
+    return 0;
+}
@@ -1,6 +1,7 @@
 #ifndef ACTIVE_OBJECT_H
 #define ACTIVE_OBJECT_H
 
+#include <atomic>
 #include <functional>
 #include <vector>
 #include <memory>
@@ -8,34 +9,107 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 #include "timer.h"
 #include "events.h"
+#include "mailbox.h"
+#include "dispatchTable.h"
+#include "actorStats.h"
+#include "executor.h"
 
 class ActiveObject {
     public:
+        // Placement of an actor's dedicated task
+        struct TaskConfig {
+            size_t stackSize = 4096;
+            UBaseType_t priority = 1;
+            BaseType_t core = 1;        // tskNO_AFFINITY lets the scheduler pick
+        };
+
+        // Dedicated task per actor (heavy actors, e.g. WiFi)
+        ActiveObject(const std::string& name, const TaskConfig& config, size_t queueSize);
+        // Same, with the default priority 1 on core 1
         ActiveObject(const std::string& name, size_t stackSize, size_t queueSize);
+        // Run-to-completion actor multiplexed on an executor's workers;
+        // pinned to one worker, or run by any (idle workers steal it)
+        ActiveObject(const std::string& name, Executor& executor, size_t queueSize,
+                     int worker = Executor::ANY_WORKER);
         virtual ~ActiveObject();
     
         bool Start();
-        BaseType_t Post(Event* e);
-        BaseType_t PostISR(Event* e);
-        virtual void Dispatcher(Event* e) = 0;
+        // Takes over one reference of e; use e->Retain() to post a shared event
+        BaseType_t Post(const Event* e);
+        // Never blocks: drops e (and counts a blocked post) if the mailbox is full
+        BaseType_t TryPost(const Event* e);
+        // Post count events with a single wakeup; returns the number posted
+        size_t PostBatch(const Event* const* events, size_t count);
+        // Same without blocking: events that find the mailbox full are
+        // dropped (and counted as blocked posts) like with TryPost
+        size_t TryPostBatch(const Event* const* events, size_t count);
+        // Only for events that exist before the interrupt (e.g. a static event
+        // posted with Retain()); interrupt sources should use an IsrChannel.
+        // Returns the send result; on pdFAIL the caller keeps its reference.
+        BaseType_t PostISR(const Event* e, BaseType_t* higherPriorityTaskWoken);
+
+        // Fallback for event types without an on<EventT>() handler
+        virtual void Dispatcher(const Event* e) { (void)e; }
     
-        bool PeekQueue(Event** e);
-        QueueHandle_t& getQueue();
+        inline Mailbox& getMailbox() { return _mailbox; }
         inline Timer* getTimer() { return &_timer; }
+        inline const std::string& getName() const { return _name; }
+
+        // Queue wait / dispatch time histograms, high-water mark, blocked posts
+        inline const ActorStats& GetStats() const { return _stats; }
+        void DumpStats() const;
+        static void DumpAllStats();
     
     protected:
+        // Register a typed handler, called as handler(const EventT&).
+        // Do this in the constructor, before anything is posted.
+        template <typename EventT, typename F>
+        void on(F&& handler) { _handlers.on<EventT>(std::forward<F>(handler)); }
+
+        // Collapse pending EventTs in the mailbox (see Mailbox::Coalesce).
+        // Also a constructor-time setting.
+        template <typename EventT>
+        void coalesce(Mailbox::Coalesce policy, Mailbox::MergeFunc merge = nullptr) {
+            _mailbox.SetCoalescing(EventT::TYPE, policy, merge);
+        }
+
+        // Events handled per wakeup (dedicated task, default: all pending)
+        // or per executor turn (default: Executor::EVENTS_PER_TURN)
+        void SetBatchSize(size_t events) { _batchSize = events > 0 ? events : 1; }
+
         std::string _name;
         Timer _timer;
     
     private:
+        friend class Executor;
+
         static void taskDispatcher(void* data);
         void eventLoop();
+        void registerActor();
+        BaseType_t enqueue(const Event* e);
+        void wake();
+        void wakeFromISR(BaseType_t* higherPriorityTaskWoken);
+        size_t drain(size_t maxEvents);
+        void runTurn();
+
+        // Events popped from the mailbox per lock round trip
+        static constexpr size_t DRAIN_CHUNK = 8;
     
+        DispatchTable _handlers;
+        Mailbox _mailbox;
+        ActorStats _stats;
         TaskHandle_t _taskHandle;
-        QueueHandle_t _queue;
+        Executor* _executor;
+        int _worker;
+        size_t _batchSize;
+        std::atomic<bool> _scheduled;
+
+        // Registry of all live actors for DumpAllStats()
+        ActiveObject* _nextActor;
+        static ActiveObject* s_firstActor;
+        static portMUX_TYPE s_registryLock;
     };
 
 #endif // End: Active Object
\ No newline at end of file
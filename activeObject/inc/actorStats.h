@@ -0,0 +1,81 @@
+#ifndef ACTOR_STATS_H
+#define ACTOR_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "events.h"
+
+// Per-actor latency/queue profiling, set to 0 to compile it out
+#ifndef ENABLE_ACTOR_PROFILING
+#define ENABLE_ACTOR_PROFILING 1
+#endif
+
+/**
+ * @brief   Log2 latency histogram in microseconds.
+ *
+ * Bucket i counts samples below 2^(i + 4) us (16 us .. 16 ms), the last
+ * bucket everything above. Written by one task, read by any, so relaxed
+ * atomics are enough and recording never blocks.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 12;
+
+    void Record(uint32_t us);
+
+    uint32_t Count() const { return _count.load(std::memory_order_relaxed); }
+    uint32_t Max() const { return _max.load(std::memory_order_relaxed); }
+    uint32_t Bucket(size_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+
+    // Upper bound (us) of the bucket holding the given percentile, UINT32_MAX if open-ended
+    uint32_t Percentile(uint32_t percent) const;
+
+    static uint32_t BucketLimit(size_t i);
+
+private:
+    std::array<std::atomic<uint32_t>, BUCKETS> _buckets {};
+    std::atomic<uint32_t> _count {0};
+    std::atomic<uint32_t> _max {0};
+};
+
+/**
+ * @brief   Profiling data of one ActiveObject.
+ *
+ * Queue wait (post to dispatch) and Dispatcher execution time per event
+ * type, plus the number of posts that had to block on a full mailbox.
+ * Per-type histograms are allocated on the first dispatch of that type, so
+ * an actor only pays for the events it actually handles.
+ */
+class ActorStats {
+public:
+    struct TypeStats {
+        LatencyHistogram wait;
+        LatencyHistogram exec;
+    };
+
+    ActorStats() = default;
+    ~ActorStats();
+
+    // Called by the actor's own task only
+    void RecordDispatch(Event::Type type, uint32_t waitUs, uint32_t execUs);
+    void RecordBlockedPost() { _blockedPosts.fetch_add(1, std::memory_order_relaxed); }
+
+    // nullptr until an event of that type has been dispatched
+    const TypeStats* Get(Event::Type type) const;
+    uint32_t BlockedPosts() const { return _blockedPosts.load(std::memory_order_relaxed); }
+
+    void Dump(const char* name, size_t highWater, size_t capacity, uint32_t coalesced) const;
+
+private:
+    std::array<std::atomic<TypeStats*>, static_cast<size_t>(Event::Type::Count)> _types {};
+    std::atomic<uint32_t> _blockedPosts {0};
+
+    // Disallow copy and assignment
+    ActorStats(const ActorStats&) = delete;
+    ActorStats& operator=(const ActorStats&) = delete;
+};
+
+#endif // ACTOR_STATS_H
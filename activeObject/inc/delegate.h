@@ -0,0 +1,103 @@
+#ifndef DELEGATE_H
+#define DELEGATE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 4 * sizeof(void*)>
+class Delegate;
+
+/**
+ * @brief   Copyable callable with small-buffer storage only.
+ *
+ * Drop-in for std::function where the callable (typically a lambda with a
+ * few captured pointers) is stored inline. Callables that do not fit are
+ * rejected at compile time instead of silently going to the heap.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class Delegate<R(Args...), Capacity> {
+public:
+    Delegate() = default;
+
+    template <typename F,
+              typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+    Delegate(F&& f) {
+        using Callable = typename std::decay<F>::type;
+        static_assert(sizeof(Callable) <= Capacity, "Callable too large for Delegate storage");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable over-aligned for Delegate storage");
+        new (&_storage) Callable(std::forward<F>(f));
+        _invoke = &invokeImpl<Callable>;
+        _manage = &manageImpl<Callable>;
+    }
+
+    Delegate(const Delegate& other) {
+        copyFrom(other);
+    }
+
+    Delegate& operator=(const Delegate& other) {
+        if (this != &other) {
+            reset();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ~Delegate() {
+        reset();
+    }
+
+    R operator()(Args... args) const {
+        return _invoke(&_storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const {
+        return _invoke != nullptr;
+    }
+
+private:
+    enum class Op { Copy, Destroy };
+
+    using Storage = typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type;
+    using Invoker = R (*)(const Storage*, Args&&...);
+    using Manager = void (*)(Op, Storage*, const Storage*);
+
+    template <typename Callable>
+    static R invokeImpl(const Storage* storage, Args&&... args) {
+        Callable& f = *const_cast<Callable*>(reinterpret_cast<const Callable*>(storage));
+        return f(std::forward<Args>(args)...);
+    }
+
+    template <typename Callable>
+    static void manageImpl(Op op, Storage* dst, const Storage* src) {
+        if (op == Op::Copy) {
+            new (dst) Callable(*reinterpret_cast<const Callable*>(src));
+        } else {
+            reinterpret_cast<Callable*>(dst)->~Callable();
+        }
+    }
+
+    void copyFrom(const Delegate& other) {
+        if (other._manage != nullptr) {
+            other._manage(Op::Copy, &_storage, &other._storage);
+        }
+        _invoke = other._invoke;
+        _manage = other._manage;
+    }
+
+    void reset() {
+        if (_manage != nullptr) {
+            _manage(Op::Destroy, &_storage, nullptr);
+        }
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+    Storage _storage;
+    Invoker _invoke = nullptr;
+    Manager _manage = nullptr;
+};
+
+#endif // DELEGATE_H
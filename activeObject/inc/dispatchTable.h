@@ -0,0 +1,45 @@
+#ifndef DISPATCH_TABLE_H
+#define DISPATCH_TABLE_H
+
+#include <array>
+#include <utility>
+
+#include "delegate.h"
+#include "events.h"
+
+/**
+ * @brief   Jump table from Event::Type to a typed handler.
+ *
+ * on<EventT>(handler) stores a thunk in the slot of EventT::TYPE that
+ * downcasts and calls handler(const EventT&). Dispatch is one array index
+ * and one indirect call; the downcast is always correct because the slot
+ * is selected by the same compile-time type ID the event was built with.
+ */
+class DispatchTable {
+public:
+    using Thunk = Delegate<void(const Event*)>;
+
+    template <typename EventT, typename F>
+    void on(F&& handler) {
+        _slots[static_cast<size_t>(EventT::TYPE)] =
+            Thunk([handler](const Event* e) { handler(*static_cast<const EventT*>(e)); });
+    }
+
+    template <typename EventT>
+    void off() {
+        _slots[static_cast<size_t>(EventT::TYPE)] = Thunk();
+    }
+
+    // Returns false when no handler is registered for the event's type
+    bool dispatch(const Event* e) const {
+        const Thunk& thunk = _slots[static_cast<size_t>(e->getType())];
+        if (!thunk) return false;
+        thunk(e);
+        return true;
+    }
+
+private:
+    std::array<Thunk, static_cast<size_t>(Event::Type::Count)> _slots;
+};
+
+#endif // DISPATCH_TABLE_H
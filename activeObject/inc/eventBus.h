@@ -1,24 +1,68 @@
 #ifndef EVENTBUS_H
 #define EVENTBUS_H
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
-#include <functional>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "delegate.h"
 #include "events.h"
 
+/**
+ * @brief   Process-wide publish/subscribe hub.
+ *
+ * Subscribers live in a dense table indexed by Event::Type. Each slot points
+ * to an immutable snapshot of its handler list; subscribe/unsubscribe build
+ * a new snapshot under a mutex and swap the pointer (copy-on-write), so
+ * publish() never locks and costs one array lookup per event. Snapshots
+ * that may still be walked by a publisher are retired and freed by a later
+ * writer once no publish() is in flight.
+ */
 class EventBus {
 public:
-    using HandlerFunc = std::function<void(Event*)>;
+    // Handlers borrow the shared, immutable event for the duration of the
+    // call; Retain() it to keep it or to post it to an ActiveObject.
+    using HandlerFunc = Delegate<void(const Event*)>;
+    using SubscriptionId = uint32_t;
 
     static EventBus& get();
-    void subscribe(Event::Type type, HandlerFunc handler);
-    void publish(Event* e);
+
+    // Safe at runtime from any task, also from inside a handler
+    SubscriptionId subscribe(Event::Type type, HandlerFunc handler);
+
+    // Typed variant, called as handler(const EventT&)
+    template <typename EventT, typename F>
+    SubscriptionId subscribe(F&& handler) {
+        return subscribe(EventT::TYPE, HandlerFunc([handler](const Event* e) {
+            handler(*static_cast<const EventT*>(e));
+        }));
+    }
+
+    bool unsubscribe(SubscriptionId id);
+
+    // Takes over one reference of e, every subscriber sees the same instance
+    void publish(const Event* e);
 
 private:
-    EventBus() = default;
+    EventBus();
+
+    struct Subscriber {
+        SubscriptionId id;
+        HandlerFunc handler;
+    };
+    using HandlerList = std::vector<Subscriber>;
+
+    void replace(size_t slot, const HandlerList* list);
+    void reclaim();
 
-    using HandlerList = std::vector<HandlerFunc>;
-    std::map<Event::Type, HandlerList> _handlers;
+    std::array<std::atomic<const HandlerList*>, static_cast<size_t>(Event::Type::Count)> _handlers;
+    std::atomic<uint32_t> _publishers;
+    std::vector<const HandlerList*> _retired;
+    SubscriptionId _nextId;
+    SemaphoreHandle_t _writeLock;
 };
 
-#endif // EVENTBUS_H
\ No newline at end of file
+#endif // EVENTBUS_H
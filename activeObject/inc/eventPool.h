@@ -0,0 +1,52 @@
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Number of blocks per size class, override from the build if needed
+#ifndef EVENT_POOL_SMALL_BLOCKS
+#define EVENT_POOL_SMALL_BLOCKS 64
+#endif
+
+#ifndef EVENT_POOL_LARGE_BLOCKS
+#define EVENT_POOL_LARGE_BLOCKS 16
+#endif
+
+/**
+ * @brief   Fixed-size block allocator backing Event::operator new/delete.
+ *
+ * Two statically allocated slabs (size classes) whose block sizes are
+ * derived at compile time from the events in events.h. Allocation and
+ * release pop/push an intrusive free list inside a spinlock, so both are
+ * O(1) and can be used from an ISR. When a class is exhausted, or an event
+ * is larger than the large class, the request falls back to the heap and
+ * is counted - the heap fallback is not ISR-safe.
+ */
+class EventPool {
+public:
+    enum class SizeClass {
+        Small = 0,
+        Large = 1,
+        Count
+    };
+
+    struct Stats {
+        size_t blockSize;
+        uint32_t blocks;
+        uint32_t allocs;
+        uint32_t frees;
+        uint32_t inUse;
+        uint32_t highWater;
+        uint32_t exhausted;     // requests that found the class empty
+    };
+
+    static void* Allocate(size_t size);
+    static void Free(void* p);
+
+    static Stats GetStats(SizeClass sizeClass);
+    static uint32_t GetOversizeCount();     // events too large for any class
+    static void DumpStats();
+};
+
+#endif // EVENT_POOL_H
@@ -2,28 +2,31 @@
 #ifndef EVENTS_H
 #define EVENTS_H
 
-#include <functional>
-#include <map>
-#include <vector>
 #include <cstdint>
+#include <cstddef>
 #include <atomic>
 #include <string>
 
+#include "eventPool.h"
+
 enum class LedMode {
     ON,
     OFF,
     TOGGLE,
     BLINK_SLOW,
-    BLINK_FAST
+    BLINK_FAST,
+    BREATHE
 };
 
 class Event {
 public:
-    enum class Type {
+    enum class Type : uint8_t {
         OnStart,
         Measurement,
+        AdcFrame,
         ScreenRefresh,
         ButtonClicked, 
+        ButtonEdge,
         SystemReset, 
         WiFiConnected,
         WiFiDisconnected,
@@ -36,158 +39,240 @@ public:
         WiFiDisconnectedByRequest, 
         LedControl, 
         LedStop, 
-        TimerTick 
+        LedPattern,
+        TimerTick,
+        Dummy,
+        Count           // number of types, keep last
     };
 
-    enum class Priority {
+    enum class Priority : uint8_t {
         High = 0,
         Normal = 1,
         Low = 2
     };
 
     virtual ~Event() {}
-    virtual Type getType() const = 0;
-    virtual Priority getPriority() const { return Priority::Normal; }
+
+    // Type and priority are fixed per class at compile time (see TypedEvent)
+    // and stored in the instance, so the dispatch path needs no virtual call.
+    Type getType() const { return _type; }
+    Priority getPriority() const { return _priority; }
+
+    // Mutable private copy, only needed when a handler wants to change an event
     virtual Event* Clone() const = 0;
 
     static const char* typeToString(Type type);
 
-    Event(const char* source);
+    Event(const Event& other);
+    Event& operator=(const Event&) = delete;
     uint32_t getId() const;
     const char* getSource() const;
+    // esp_timer time of construction, truncated to 32 bit (wraps after ~71 min)
+    uint32_t getCreatedUs() const { return _createdUs; }
+
+    // Events are immutable once posted and shared by reference count.
+    // new starts at one reference; whoever holds a pointer owns one
+    // reference and hands it on (Post, publish) or drops it with Release().
+    // The last Release() returns the event to the EventPool.
+    const Event* Retain() const;
+    void Release() const;
+    // More than one reference: someone else may be looking at this event
+    bool IsShared() const { return _refCount.load(std::memory_order_acquire) > 1; }
+
+    // All events are carved out of the EventPool, so plain new/delete
+    // never hit the general heap on the hot paths.
+    static void* operator new(size_t size);
+    static void operator delete(void* p);
 
 protected:
+    Event(Type type, Priority priority, const char* source);
+
     uint32_t _id;
+    uint32_t _createdUs;
     const char* _source;
+    mutable std::atomic<uint32_t> _refCount;
+    const Type _type;
+    const Priority _priority;
     static std::atomic<uint32_t> _eventIdCounter;
 };
 
-class OnStart : public Event {
+/**
+ * @brief   Base of every concrete event.
+ *
+ * Declares the event's ID and priority at compile time and provides
+ * Clone() through the derived copy constructor. Payload is whatever the
+ * derived class adds as members.
+ */
+template <typename Derived, Event::Type TypeId, Event::Priority Prio = Event::Priority::Normal>
+class TypedEvent : public Event {
 public:
-    OnStart(const char* source = "Unknown") : Event(source) {}
-    Type getType() const override { return Type::OnStart; }
-    Event* Clone() const override;
+    static constexpr Type TYPE = TypeId;
+    static constexpr Priority PRIORITY = Prio;
+
+    Event* Clone() const override {
+        return new Derived(static_cast<const Derived&>(*this));
+    }
+
+protected:
+    explicit TypedEvent(const char* source) : Event(TypeId, Prio, source) {}
 };
 
-class MeasurementEvent : public Event {
+// Checked downcast: nullptr unless e is an EventT
+template <typename EventT>
+inline const EventT* event_cast(const Event* e) {
+    return (e != nullptr && e->getType() == EventT::TYPE) ? static_cast<const EventT*>(e) : nullptr;
+}
+
+class OnStart : public TypedEvent<OnStart, Event::Type::OnStart> {
 public:
+    OnStart(const char* source = "Unknown") : TypedEvent(source) {}
+};
+
+class MeasurementEvent : public TypedEvent<MeasurementEvent, Event::Type::Measurement> {
+public:
+    enum class Quantity : uint8_t {
+        Unknown,
+        WaterLevel,     // % of the calibrated range
+        Flow,           // L/min
+        Volume,         // L since boot
+        Temperature,    // °C
+    };
+
     MeasurementEvent(float value, const char* source = "Unknown")
-        : Event(source), _value(value) {}
-    Type getType() const override { return Type::Measurement; }
+        : TypedEvent(source), _value(value), _sampleUs(_createdUs), _quantity(Quantity::Unknown), _channel(0) {}
+    // channel tells apart several sensors of one source (e.g. probes on a bus)
+    MeasurementEvent(Quantity quantity, float value, uint32_t sampleUs, const char* source = "Unknown",
+                     uint8_t channel = 0)
+        : TypedEvent(source), _value(value), _sampleUs(sampleUs), _quantity(quantity), _channel(channel) {}
+
     float getValue() const { return _value; }
-    Event* Clone() const override;
+    Quantity getQuantity() const { return _quantity; }
+    // esp_timer time (32 bit) the value refers to, not when it was published
+    uint32_t getSampleUs() const { return _sampleUs; }
+    uint8_t getChannel() const { return _channel; }
 
 private:
     float _value;
+    uint32_t _sampleUs;
+    Quantity _quantity;
+    uint8_t _channel;
 };
 
-class ScreenRefreshEvent : public Event {
+class ScreenRefreshEvent : public TypedEvent<ScreenRefreshEvent, Event::Type::ScreenRefresh, Event::Priority::Low> {
 public:
-    ScreenRefreshEvent(const char* source = "Unknown") : Event(source) {}
-    Type getType() const override { return Type::ScreenRefresh; }
-    Priority getPriority() const override { return Priority::Low; }
-    Event* Clone() const override;
+    ScreenRefreshEvent(const char* source = "Unknown") : TypedEvent(source) {}
 };
 
-class SystemResetEvent : public Event {
+class SystemResetEvent : public TypedEvent<SystemResetEvent, Event::Type::SystemReset> {
 public:
-    SystemResetEvent(const char* source = "Unknown") : Event(source) {}
-    Type getType() const override { return Type::SystemReset; }
-    Event* Clone() const override { return new SystemResetEvent(_source); }
+    SystemResetEvent(const char* source = "Unknown") : TypedEvent(source) {}
 };
 
-class WiFiConnectedEvent : public Event {
+class WiFiConnectedEvent : public TypedEvent<WiFiConnectedEvent, Event::Type::WiFiConnected> {
 public:
-    WiFiConnectedEvent(const char* source = "WiFi") : Event(source) {}
-    Type getType() const override { return Type::WiFiConnected; }
-    Event* Clone() const override { return new WiFiConnectedEvent(_source); }
+    WiFiConnectedEvent(const char* source = "WiFi") : TypedEvent(source) {}
 };
 
-class WiFiDisconnectedEvent : public Event {
+class WiFiDisconnectedEvent : public TypedEvent<WiFiDisconnectedEvent, Event::Type::WiFiDisconnected> {
 public:
-    WiFiDisconnectedEvent(const char* source = "WiFi") : Event(source) {}
-    Type getType() const override { return Type::WiFiDisconnected; }
-    Event* Clone() const override { return new WiFiDisconnectedEvent(_source); }
+    // reason: wifi_err_reason_t of the driver, 0 if unknown
+    WiFiDisconnectedEvent(const char* source = "WiFi", uint16_t reason = 0)
+        : TypedEvent(source), _reason(reason) {}
+
+    uint16_t getReason() const { return _reason; }
+
+private:
+    uint16_t _reason;
 };
 
-class WiFiConnectingEvent : public Event {
+class WiFiConnectingEvent : public TypedEvent<WiFiConnectingEvent, Event::Type::WiFiConnecting> {
 public:
-    WiFiConnectingEvent(const char* source = "WiFi") : Event(source) {}
-    Type getType() const override { return Type::WiFiConnecting; }
-    Event* Clone() const override { return new WiFiConnectingEvent(_source); }
+    WiFiConnectingEvent(const char* source = "WiFi") : TypedEvent(source) {}
 };
 
-class WiFiReconnectEvent : public Event {
+class WiFiReconnectEvent : public TypedEvent<WiFiReconnectEvent, Event::Type::WiFiReconnect> {
 public:
-    Type getType() const override { return Type::WiFiReconnect; }
-    Event* Clone() const override { return new WiFiReconnectEvent(*this); }
+    WiFiReconnectEvent(const char* source = "WiFi") : TypedEvent(source) {}
 };
 
-class WiFiFailedEvent : public Event {
+class WiFiFailedEvent : public TypedEvent<WiFiFailedEvent, Event::Type::WiFiFailed> {
 public:
-    WiFiFailedEvent(const char* source = "Unknown") : Event(source) {}
-    Type getType() const override { return Type::WiFiFailed; }
-    Event* Clone() const override { return new WiFiFailedEvent(*this); }
+    WiFiFailedEvent(const char* source = "Unknown") : TypedEvent(source) {}
 };
 
-class WiFiRestoredEvent : public Event {
+class WiFiRestoredEvent : public TypedEvent<WiFiRestoredEvent, Event::Type::WiFiRestored> {
 public:
-    WiFiRestoredEvent(const char* source = "Unknown") : Event(source) {}
-    Type getType() const override { return Type::WiFiRestored; }
-    Event* Clone() const override { return new WiFiRestoredEvent(*this); }
+    WiFiRestoredEvent(const char* source = "Unknown") : TypedEvent(source) {}
 };
 
-class WiFiGotIPEvent : public Event {
+class WiFiGotIPEvent : public TypedEvent<WiFiGotIPEvent, Event::Type::WiFiGotIP> {
 public:
     WiFiGotIPEvent(const std::string& ip, const char* source = "WiFi")
-        : Event(source), _ip(ip) {}
-    Type getType() const override { return Type::WiFiGotIP; }
+        : TypedEvent(source), _ip(ip) {}
     const std::string& getIP() const { return _ip; }
-    Event* Clone() const override { return new WiFiGotIPEvent(_ip, _source); }
 
 private:
     std::string _ip;
 };
 
-class WiFiDisconnectedByRequestEvent : public Event {
+class WiFiDisconnectedByRequestEvent : public TypedEvent<WiFiDisconnectedByRequestEvent, Event::Type::WiFiDisconnectedByRequest> {
 public:
-    WiFiDisconnectedByRequestEvent(const char* source = "WiFi") : Event(source) {}
-    Type getType() const override { return Type::WiFiDisconnected; }
-    Event* Clone() const override { return new WiFiDisconnectedByRequestEvent(_source); }
+    WiFiDisconnectedByRequestEvent(const char* source = "WiFi") : TypedEvent(source) {}
 };
 
-class WiFiShutdownEvent : public Event {
+class WiFiShutdownEvent : public TypedEvent<WiFiShutdownEvent, Event::Type::WiFiShutdown> {
 public:
-    WiFiShutdownEvent(const char* source = "WiFi") : Event(source) {}
-    Type getType() const override { return Type::WiFiFailed; }
-    Event* Clone() const override { return new WiFiShutdownEvent(_source); }
+    WiFiShutdownEvent(const char* source = "WiFi") : TypedEvent(source) {}
 };
 
-class LedControlEvent : public Event {
+class LedControlEvent : public TypedEvent<LedControlEvent, Event::Type::LedControl> {
 public:
     LedControlEvent(LedMode mode, const char* source = "Unknown")
-        : Event(source), _mode(mode) {}
+        : TypedEvent(source), _mode(mode) {}
 
-    Type getType() const override { return Type::LedControl; }
-    Event* Clone() const override { return new LedControlEvent(_mode, _source); }
     LedMode getMode() const { return _mode; }
 
 private:
     LedMode _mode;
 };
 
-class LedStopEvent : public Event {
+class LedStopEvent : public TypedEvent<LedStopEvent, Event::Type::LedStop> {
 public:
-    LedStopEvent(const char* source = "Unknown") : Event(source) {}
-    Type getType() const override { return Type::LedStop; }
-    Event* Clone() const override { return new LedStopEvent(_source); }
+    LedStopEvent(const char* source = "Unknown") : TypedEvent(source) {}
 };
 
-class DummyEvent : public Event {
-    public:
-        DummyEvent(const char* source = "System") : Event(source) {}
-        Type getType() const override { return Type::ScreenRefresh; } // oder eigener Dummy-Typ
-        Event* Clone() const override { return new DummyEvent(_source); }
-    };
+class DummyEvent : public TypedEvent<DummyEvent, Event::Type::Dummy> {
+public:
+    DummyEvent(const char* source = "System") : TypedEvent(source) {}
+};
+
+// Size classes of the EventPool, derived from the events above
+namespace EventPoolLayout {
+
+template <typename... Ts>
+constexpr size_t maxSizeOf() {
+    size_t size = 0;
+    ((size = sizeof(Ts) > size ? sizeof(Ts) : size), ...);
+    return size;
+}
+
+constexpr size_t roundUp(size_t size) {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+}
+
+// Plain events plus two words of payload for component events (ButtonClicked, ...)
+constexpr size_t SmallBlockSize = roundUp(maxSizeOf<
+    OnStart, MeasurementEvent, ScreenRefreshEvent, SystemResetEvent,
+    WiFiConnectedEvent, WiFiDisconnectedEvent, WiFiConnectingEvent,
+    WiFiReconnectEvent, WiFiFailedEvent, WiFiRestoredEvent,
+    WiFiDisconnectedByRequestEvent, WiFiShutdownEvent,
+    LedControlEvent, LedStopEvent, DummyEvent>() + 2 * sizeof(void*));
+
+// Events owning a std::string
+constexpr size_t LargeBlockSize = roundUp(maxSizeOf<WiFiGotIPEvent>());
+
+static_assert(SmallBlockSize <= LargeBlockSize, "Event pool size classes out of order");
+
+} // namespace EventPoolLayout
 
 #endif // EVENTS_H
@@ -0,0 +1,104 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+class ActiveObject;
+
+// Maximum number of actors that can be attached to one executor
+#ifndef EXECUTOR_MAX_ACTORS
+#define EXECUTOR_MAX_ACTORS 32
+#endif
+
+// Maximum number of worker tasks of one executor
+#ifndef EXECUTOR_MAX_WORKERS
+#define EXECUTOR_MAX_WORKERS 4
+#endif
+
+/**
+ * @brief   Worker tasks that run many lightweight ActiveObjects.
+ *
+ * Actors attached to an executor keep their own mailbox but have no task of
+ * their own. Posting to such an actor puts it on a ready queue (at most
+ * once, guarded by the actor's scheduled flag); a worker then runs it to
+ * completion for up to its batch size of events (EVENTS_PER_TURN unless
+ * the actor sets another) before moving on to the next ready actor, so one
+ * busy actor cannot starve the others.
+ *
+ * There is one worker per core (or as many as requested), each with two
+ * ready queues: actors pinned to that worker, and unpinned actors. An idle
+ * worker steals unpinned actors from the other workers. Since an actor is
+ * in at most one queue and run by at most one worker at a time, its
+ * events are still handled strictly in mailbox order.
+ * Handlers must not block for long, they share the workers' stacks.
+ */
+class Executor {
+public:
+    // Default batch size of executor-hosted actors (ActiveObject::SetBatchSize)
+    static constexpr size_t EVENTS_PER_TURN = 4;
+    static constexpr int ANY_WORKER = -1;
+
+    Executor(const char* name, size_t stackSize, UBaseType_t priority, size_t workers);
+    ~Executor();
+
+    // Default executor for small actors (buttons, LEDs, ...), one worker per core
+    static Executor& Shared();
+
+    bool IsValid() const { return _workerCount > 0; }
+    size_t WorkerCount() const { return _workerCount; }
+
+    // Queue a ready actor, on its pinned worker or the caller's core's worker
+    void Schedule(ActiveObject* actor, int worker);
+    void ScheduleFromISR(ActiveObject* actor, int worker, BaseType_t* higherPriorityTaskWoken);
+
+    // Actors that could not be queued (ready ring full); the first one is
+    // logged, later ones and those from an ISR are only counted
+    uint32_t GetOverflowCount() const { return _overflows.load(std::memory_order_relaxed); }
+
+private:
+    // Fixed ring of ready actors, protected by the worker's spinlock
+    struct ReadyRing {
+        ActiveObject* slots[EXECUTOR_MAX_ACTORS];
+        size_t head;
+        size_t count;
+    };
+
+    struct Worker {
+        Executor* owner;
+        size_t index;
+        TaskHandle_t task;
+        ReadyRing pinned;
+        ReadyRing shared;
+        portMUX_TYPE lock;
+    };
+
+    static void taskEntry(void* data);
+    void run(Worker& worker);
+
+    size_t pick(int worker) const;
+    bool push(Worker& worker, ActiveObject* actor, bool pinned);
+    uint32_t reject(ActiveObject* actor);
+    ActiveObject* popLocal(Worker& worker);
+    ActiveObject* steal(Worker& thief);
+    void wakeIdleWorker(size_t except);
+
+    static bool ringPush(ReadyRing& ring, ActiveObject* actor);
+    static ActiveObject* ringPop(ReadyRing& ring);
+
+    Worker _workers[EXECUTOR_MAX_WORKERS];
+    // Grows while the constructor starts workers that may already steal
+    std::atomic<size_t> _workerCount;
+    std::atomic<uint32_t> _idleMask;
+    std::atomic<uint32_t> _overflows;
+
+    // Disallow copy and assignment
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+};
+
+#endif // EXECUTOR_H
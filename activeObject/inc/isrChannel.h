@@ -0,0 +1,151 @@
+#ifndef ISR_CHANNEL_H
+#define ISR_CHANNEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "events.h"
+
+class ActiveObject;
+class IsrService;
+
+// Slots per channel unless given, rounded up to a power of two
+#ifndef ISR_CHANNEL_DEFAULT_SLOTS
+#define ISR_CHANNEL_DEFAULT_SLOTS 64
+#endif
+
+// Drain task: above every actor, below the WiFi/lwIP stack (17 on ESP-IDF,
+// under the lwIP tcpip task at 18 and the default event loop at 20)
+#ifndef ISR_SERVICE_PRIORITY
+#define ISR_SERVICE_PRIORITY (configMAX_PRIORITIES - 8)
+#endif
+
+#ifndef ISR_SERVICE_STACK_SIZE
+#define ISR_SERVICE_STACK_SIZE 3072
+#endif
+
+// Slots converted and posted per channel before the next channel gets a turn
+#ifndef ISR_SERVICE_BATCH
+#define ISR_SERVICE_BATCH 16
+#endif
+
+// Ticks between retries while a target mailbox is full
+#ifndef ISR_SERVICE_RETRY_TICKS
+#define ISR_SERVICE_RETRY_TICKS 1
+#endif
+
+/**
+ * @brief   Allocation-free path from one interrupt source to an actor.
+ *
+ * The ISR writes a small fixed-size slot (timestamp plus two words of
+ * payload) into a preallocated single-producer/single-consumer ring with
+ * Raise(); no event is created and no lock is taken. The IsrService drain
+ * task later turns every slot into an event with the channel's convert
+ * function and posts the events of one pass to the target actor as one
+ * batch, without blocking: only as many slots as the target's mailbox
+ * has room for are taken, the rest wait in the ring and are retried
+ * every ISR_SERVICE_RETRY_TICKS. A slow actor thus backs up its own ring
+ * (and eventually drops slots) but never stalls the other channels.
+ *
+ * One channel per interrupt source: Raise() must only be called from one
+ * ISR (or task) at a time. The drain task is only notified when the ring
+ * goes from empty to non-empty, so a burst of interrupts costs a single
+ * wakeup. A full ring drops the slot and counts it in Dropped(); size the
+ * ring for the worst-case burst between two drain passes.
+ *
+ * Channels register with the service on construction and are expected to
+ * live forever, like the actors they feed.
+ */
+class IsrChannel {
+public:
+    struct Slot {
+        uint32_t timeUs;    // esp_timer time of Raise(), truncated to 32 bit
+        uint32_t value;
+        uint32_t aux;
+    };
+
+    // Runs in the drain task; returns a new event (or nullptr to skip the slot)
+    using Convert = const Event* (*)(const Slot& slot, void* context);
+
+    IsrChannel(const char* name, ActiveObject& target, Convert convert, void* context = nullptr,
+               size_t slots = ISR_CHANNEL_DEFAULT_SLOTS);
+    ~IsrChannel();
+
+    bool IsValid() const { return _slots != nullptr; }
+
+    // ISR side. False if the ring is full (the slot is dropped and counted).
+    bool Raise(uint32_t value, uint32_t aux, BaseType_t* higherPriorityTaskWoken);
+
+    const char* GetName() const { return _name; }
+    // Slots accepted so far (wraps at 2^32)
+    uint32_t Raised() const { return _head.load(std::memory_order_relaxed); }
+    // Slots lost: ring full, or (rarely) the target's mailbox filled up by
+    // another producer between the space check and the post
+    uint32_t Dropped() const { return _dropped.load(std::memory_order_relaxed); }
+    uint32_t HighWater() const { return _highWater.load(std::memory_order_relaxed); }
+
+private:
+    friend class IsrService;
+
+    // Drain task side: convert and post up to max slots, returns slots
+    // consumed; backlog is set if slots were left for lack of mailbox space
+    size_t drain(size_t max, bool* backlog);
+
+    const char* _name;
+    ActiveObject& _target;
+    Convert _convert;
+    void* _context;
+    IsrService* _service;
+    Slot* _slots;
+    uint32_t _mask;
+    std::atomic<uint32_t> _head;        // written by the ISR only
+    std::atomic<uint32_t> _tail;        // written by the drain task only
+    std::atomic<uint32_t> _dropped;
+    std::atomic<uint32_t> _highWater;
+    IsrChannel* _next;
+
+    // Disallow copy and assignment
+    IsrChannel(const IsrChannel&) = delete;
+    IsrChannel& operator=(const IsrChannel&) = delete;
+};
+
+/**
+ * @brief   High-priority task draining all IsrChannels.
+ *
+ * Created on first use. Each pass gives every channel up to
+ * ISR_SERVICE_BATCH slots and repeats until all rings are empty or backed
+ * up, then sleeps on its task notification until an ISR raises into an
+ * empty ring, or at most ISR_SERVICE_RETRY_TICKS while a ring is backed up.
+ */
+class IsrService {
+public:
+    static IsrService& Instance();
+
+    bool IsValid() const { return _taskHandle != nullptr; }
+    void DumpStats() const;
+
+private:
+    friend class IsrChannel;
+
+    IsrService();
+
+    void add(IsrChannel* channel);
+    void remove(IsrChannel* channel);
+    void notifyFromISR(BaseType_t* higherPriorityTaskWoken);
+
+    static void taskEntry(void* data);
+    void run();
+
+    TaskHandle_t _taskHandle;
+    IsrChannel* _first;
+    mutable portMUX_TYPE _lock;
+
+    // Disallow copy and assignment
+    IsrService(const IsrService&) = delete;
+    IsrService& operator=(const IsrService&) = delete;
+};
+
+#endif // ISR_CHANNEL_H
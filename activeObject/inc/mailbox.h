@@ -0,0 +1,121 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "events.h"
+
+/**
+ * @brief   Multi-level priority mailbox of an ActiveObject.
+ *
+ * One FIFO lane per Event::Priority. A bitmap of non-empty lanes lets Pop()
+ * find the highest-priority event in O(1) without peeking at or rotating
+ * lower-priority events. The total number of queued events is bounded by
+ * the capacity; a counting semaphore makes producers block when it is
+ * reached. All lane operations run inside a spinlock and are ISR-safe.
+ *
+ * The mailbox owns one reference of every queued event and stamps each
+ * entry with its post time (events are shared, so the stamp lives in the
+ * slot, not in the event). It does not wake its consumer, the owner does
+ * that after a successful push.
+ *
+ * Event types can be coalesced: if the newest event of a lane has the
+ * same type as the pushed one, ReplaceLatest swaps it for the new event and
+ * Merge folds the new event into it. Only the newest entry of a lane is
+ * considered, so order within the lane is the same as if the pending event
+ * had been dropped and the new one appended. A coalesced push needs no
+ * free slot and never blocks.
+ */
+class Mailbox {
+public:
+    static constexpr size_t LANES = 3;
+
+    enum class Coalesce : uint8_t {
+        KeepAll,        // queue every event (default)
+        ReplaceLatest,  // a newer event supersedes a pending one
+        Merge           // fold the newer event into the pending one
+    };
+
+    // Folds incoming into pending; false queues incoming as usual. Called
+    // inside the mailbox spinlock, so keep it short and do not allocate.
+    // pending is only handed out when nobody else holds a reference to it.
+    using MergeFunc = bool (*)(Event& pending, const Event& incoming);
+
+    struct Entry {
+        const Event* event;
+        uint32_t postedUs;
+    };
+
+    explicit Mailbox(size_t capacity);
+    ~Mailbox();
+
+    bool IsValid() const;
+
+    // Set before anything is pushed; Merge requires a merge function
+    void SetCoalescing(Event::Type type, Coalesce policy, MergeFunc merge = nullptr);
+
+    // Enqueue in the lane of e->getPriority(). Blocks up to wait ticks while full.
+    BaseType_t Push(const Event* e, TickType_t wait);
+    // Never coalesces: releasing a replaced event is not ISR-safe
+    BaseType_t PushFromISR(const Event* e, BaseType_t* higherPriorityTaskWoken);
+
+    // Dequeue the oldest event of the highest non-empty lane, nullptr if empty.
+    // postedUs receives the esp_timer time (truncated to 32 bit) of the post.
+    const Event* Pop(uint32_t* postedUs = nullptr);
+    // Dequeue up to max of the oldest events of the highest non-empty lane
+    // under a single lock; returns the count and the lane. Their slots stay
+    // taken: FreeSlots() each one handled, Unpop() the ones left over.
+    size_t PopBatch(Entry* out, size_t max, size_t* lane);
+    // Put entries of a PopBatch() back in front of their lane, order kept
+    void Unpop(const Entry* entries, size_t count, size_t lane);
+    void FreeSlots(size_t count);
+    // Whether a lane above lane holds an event; lock-free, for the consumer
+    bool HasAbove(size_t lane) const {
+        return (_readyMask.load(std::memory_order_relaxed) & ((1u << lane) - 1)) != 0;
+    }
+
+    size_t Count() const;
+    size_t HighWater() const;
+    size_t Capacity() const { return _capacity; }
+    // Free slots; popped events hold theirs until FreeSlots()
+    size_t Space() const;
+    // Events absorbed by ReplaceLatest / Merge
+    uint32_t Coalesced() const;
+
+private:
+    struct Lane {
+        Entry* slots;
+        size_t head;
+        size_t count;
+    };
+
+    struct Policy {
+        Coalesce mode;
+        MergeFunc merge;
+    };
+
+    size_t laneOf(const Event* e) const;
+    bool coalesce(const Event* e, const Event** replaced);
+    bool enqueue(const Event* e);
+    bool popLocked(Entry& entry);
+
+    size_t _capacity;
+    Lane _lanes[LANES];
+    Policy _policies[static_cast<size_t>(Event::Type::Count)];
+    std::atomic<uint32_t> _readyMask;   // written under _lock
+    size_t _count;
+    size_t _highWater;
+    uint32_t _coalesced;
+    SemaphoreHandle_t _space;
+    mutable portMUX_TYPE _lock;
+
+    // Disallow copy and assignment
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+};
+
+#endif // MAILBOX_H
@@ -6,28 +6,42 @@
 #include <utility>
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/timers.h"
 #include "events.h"
+#include "timerService.h"
 
-class Timer 
+class ActiveObject;
+
+/**
+ * @brief   Named one-shot or periodic timer on the shared TimerService.
+ *
+ * Thin facade over a TimerService entry; creating one allocates nothing
+ * but the name. On expiry the timer either posts its event straight into
+ * the target actor's mailbox, or calls the callback in the timer service
+ * task. A periodic timer delivers the same event every period.
+ */
+class Timer
 {
 public:
-    Timer(const std::string& name, bool autoReload, std::function<void(Event*)> callback, int identify = 0);
+    // The callback borrows the event; Retain() it to keep or post it
+    Timer(const std::string& name, bool autoReload, std::function<void(const Event*)> callback, int identify = 0);
+    // Posts the event to target (non-blocking), no callback involved
+    Timer(const std::string& name, bool autoReload, ActiveObject& target, int identify = 0);
     virtual ~Timer();
 
-    // Start the timer with a duration (ms), optionally with an event
+    // Start the timer with a duration (ms), optionally with an event.
+    // The timer takes over one reference of the event and keeps it until
+    // Stop() or the next Start(); every expiry posts a new reference.
     void Start(TickType_t duration);
-    void Start(TickType_t duration, Event* event);
+    void Start(TickType_t duration, const Event* event);
 
-    // Stop or reset the timer
+    // Stop the timer, or re-arm it with the last duration and event (also
+    // after a one-shot fired)
     void Stop();
     void Reset();
+    bool IsActive() const;
 
-    // Get the underlying FreeRTOS timer handle
-    TimerHandle_t GetHandle() const;
-
-    // Set a new callback
-    void SetCallback(std::function<void(Event*)> callback);
+    // Set a new callback (replaces a post target); do this while stopped
+    void SetCallback(std::function<void(const Event*)> callback);
 
     // Set or get the identify value
     void SetIdentify(int identify);
@@ -40,16 +54,15 @@ public:
 private:
     std::string _timerName;
     int _identify;
-    TimerHandle_t _timerHandle;
-    Event* _event;
-    std::function<void(Event*)> _callback;
+    std::function<void(const Event*)> _callback;
     bool _autoReload;
+    TimerService::Entry _entry;
 
-    static void timerCallback(TimerHandle_t xTimer);
+    static void timerCallback(const Event* e, void* context);
 
     // Disallow copy and assignment
     Timer(const Timer&) = delete;
     Timer& operator=(const Timer&) = delete;
 };
 
-#endif // TIMER_H
\ No newline at end of file
+#endif // TIMER_H
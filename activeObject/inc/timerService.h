@@ -0,0 +1,125 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "events.h"
+
+class ActiveObject;
+
+// Service task: above the actors, below the IsrService drain task
+#ifndef TIMER_SERVICE_PRIORITY
+#define TIMER_SERVICE_PRIORITY (configMAX_PRIORITIES - 9)
+#endif
+
+#ifndef TIMER_SERVICE_STACK_SIZE
+#define TIMER_SERVICE_STACK_SIZE 4096
+#endif
+
+/**
+ * @brief   Hierarchical timing wheel driving all timers from one task.
+ *
+ * Four wheels of 64 slots, each slot of wheel n spanning 64^n ticks, cover
+ * 2^24 ticks; longer timers park in the last wheel and are re-filed when
+ * it turns. A timer is an intrusive Entry owned by its user, so start, stop
+ * and restart are O(1) list operations with no allocation, and thousands
+ * of timers cost nothing but their entries. Every tick only the current
+ * slot of wheel 0 is expired; the upper wheels cascade their next slot
+ * down when the wheel below wraps.
+ *
+ * The task sleeps until the next occupied slot (or the next cascade) and
+ * catches up tick by tick if it was delayed, so an expiry is late by at
+ * most one tick plus the task's scheduling latency, and never lost. A
+ * periodic timer keeps its phase; periods missed during a stall are
+ * skipped, not fired in a burst.
+ *
+ * An expiring entry either posts its event straight into an actor's
+ * mailbox (non-blocking; a full mailbox counts a missed expiry) or calls
+ * a plain callback in the service task. The entry owns one reference of
+ * its event until Stop() or the next Start() and posts a new reference on
+ * every expiry, so a one-shot timer can be re-armed with Restart() after
+ * it fired. A timer stopped while its expiry is being delivered may still
+ * deliver that one expiry.
+ */
+class TimerService {
+public:
+    using Callback = void (*)(const Event* e, void* context);
+
+    // One timer. Fields are owned by the service while the entry is linked.
+    struct Entry {
+        Entry** pprev = nullptr;    // link pointing at this entry
+        Entry* next = nullptr;
+        uint32_t expires = 0;
+        uint32_t interval = 0;      // ticks of the last start, for Restart()
+        uint32_t period = 0;        // 0: one-shot
+        ActiveObject* target = nullptr;
+        Callback callback = nullptr;
+        void* context = nullptr;
+        const Event* event = nullptr;
+        bool active = false;
+    };
+
+    static constexpr size_t WHEELS = 4;
+    static constexpr size_t SLOT_BITS = 6;
+    static constexpr size_t SLOTS = 1u << SLOT_BITS;
+
+    static TimerService& Instance();
+
+    bool IsValid() const { return _taskHandle != nullptr; }
+
+    // Arm an entry (re-arms if active). Takes over one reference of event
+    // (may be nullptr) and drops the entry's previous one.
+    void Start(Entry& entry, TickType_t delay, bool periodic, const Event* event);
+    // Re-arm with the interval of the last Start(), keeping the event; also
+    // after a one-shot expired
+    void Restart(Entry& entry);
+    // Disarm; the entry's event is released
+    void Stop(Entry& entry);
+    bool IsActive(const Entry& entry) const;
+
+    size_t ActiveCount() const;
+    // Expiries that found their actor's mailbox full
+    uint32_t Missed() const;
+
+private:
+    TimerService();
+
+    // One expiry, delivered outside the lock
+    struct Expiry {
+        ActiveObject* target;
+        Callback callback;
+        void* context;
+        const Event* event;
+    };
+
+    static constexpr size_t EXPIRY_BATCH = 16;
+
+    static void taskEntry(void* data);
+    void run();
+
+    bool arm(Entry& entry, TickType_t delay, bool periodic);
+    void link(Entry& entry);
+    void unlink(Entry& entry);
+    void cascade(size_t wheel);
+    size_t collect(Expiry* out, size_t max);
+    void deliver(const Expiry& expiry);
+    void advance(uint32_t tick);
+    TickType_t ticksToNextSlot() const;
+
+    Entry* _wheels[WHEELS][SLOTS];
+    uint32_t _now;          // last processed tick
+    uint32_t _wakeAt;       // tick the task sleeps until
+    size_t _active;
+    uint32_t _missed;
+    TaskHandle_t _taskHandle;
+    mutable portMUX_TYPE _lock;
+
+    // Disallow copy and assignment
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+};
+
+#endif // TIMER_SERVICE_H
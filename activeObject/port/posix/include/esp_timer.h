@@ -0,0 +1,18 @@
+// esp_timer.h - POSIX host port
+#ifndef POSIX_ESP_TIMER_H
+#define POSIX_ESP_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Microseconds since the port was started (CLOCK_MONOTONIC).
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POSIX_ESP_TIMER_H
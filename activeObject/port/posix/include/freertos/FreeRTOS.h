@@ -0,0 +1,61 @@
+// FreeRTOS.h - POSIX host port
+//
+// Minimal subset of the ESP-IDF FreeRTOS API used by the activeObject
+// component, implemented on top of pthreads. One tick is one millisecond.
+#ifndef POSIX_FREERTOS_H
+#define POSIX_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_PRIORITIES    25
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+
+#define tskNO_AFFINITY          ((BaseType_t)0x7fffffff)
+#define portNUM_PROCESSORS      2
+
+#define IRAM_ATTR
+
+// Critical sections map onto a recursive mutex. There are no real
+// interrupts on the host, so the *_ISR and *_SAFE flavours are identical.
+typedef struct {
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+void vPortMuxInitialize(portMUX_TYPE* mux);
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portMUX_INITIALIZER_UNLOCKED    { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+#define portMUX_INITIALIZE(mux)         vPortMuxInitialize(mux)
+#define portENTER_CRITICAL(mux)         vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)          vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)     vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)      vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux)    vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux)     vPortExitCritical(mux)
+
+#define portYIELD_FROM_ISR(...)         ((void)0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POSIX_FREERTOS_H
@@ -0,0 +1,33 @@
+// queue.h - POSIX host port
+#ifndef POSIX_FREERTOS_QUEUE_H
+#define POSIX_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct QueueDefinition* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueGenericSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait, BaseType_t toFront);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+#define xQueueSend(q, item, wait)           xQueueGenericSend((q), (item), (wait), pdFALSE)
+#define xQueueSendToBack(q, item, wait)     xQueueGenericSend((q), (item), (wait), pdFALSE)
+#define xQueueSendToFront(q, item, wait)    xQueueGenericSend((q), (item), (wait), pdTRUE)
+#define xQueueSendFromISR(q, item, woken) \
+    (((void)(woken)), xQueueGenericSend((q), (item), 0, pdFALSE))
+#define xQueueReceiveFromISR(q, buf, woken) \
+    (((void)(woken)), xQueueReceive((q), (buf), 0))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POSIX_FREERTOS_QUEUE_H
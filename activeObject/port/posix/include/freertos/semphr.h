@@ -0,0 +1,30 @@
+// semphr.h - POSIX host port
+//
+// As in FreeRTOS, semaphores are queues with a zero item size.
+#ifndef POSIX_FREERTOS_SEMPHR_H
+#define POSIX_FREERTOS_SEMPHR_H
+
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+
+#define xSemaphoreCreateBinary()            xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()             xSemaphoreCreateCounting(1, 1)
+#define vSemaphoreDelete(sem)               vQueueDelete(sem)
+#define xSemaphoreTake(sem, wait)           xQueueReceive((sem), NULL, (wait))
+#define xSemaphoreGive(sem)                 xQueueGenericSend((sem), NULL, 0, pdFALSE)
+#define xSemaphoreTakeFromISR(sem, woken)   (((void)(woken)), xQueueReceive((sem), NULL, 0))
+#define xSemaphoreGiveFromISR(sem, woken)   (((void)(woken)), xQueueGenericSend((sem), NULL, 0, pdFALSE))
+#define uxSemaphoreGetCount(sem)            uxQueueMessagesWaiting(sem)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POSIX_FREERTOS_SEMPHR_H
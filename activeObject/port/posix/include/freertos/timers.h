@@ -0,0 +1,28 @@
+// timers.h - POSIX host port
+#ifndef POSIX_FREERTOS_TIMERS_H
+#define POSIX_FREERTOS_TIMERS_H
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tmrTimerControl* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t autoReload,
+                           void* timerId, TimerCallbackFunction_t callback);
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t newPeriod, TickType_t ticksToWait);
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+void* pvTimerGetTimerID(TimerHandle_t timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POSIX_FREERTOS_TIMERS_H
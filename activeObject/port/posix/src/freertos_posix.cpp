@@ -0,0 +1,547 @@
+// freertos_posix.cpp - POSIX host port
+//
+// Tasks are pthreads, queues and task notifications are mutex/condition
+// variable pairs and the software timer service is a thread sleeping on a
+// timerfd. Blocking calls use the raw pthread primitives so vTaskDelete()
+// can cancel a task that is parked in any of them.
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "esp_timer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+timespec now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts;
+}
+
+int64_t nowUs() {
+    static const timespec start = now();
+    timespec ts = now();
+    return (int64_t)(ts.tv_sec - start.tv_sec) * 1000000 + (ts.tv_nsec - start.tv_nsec) / 1000;
+}
+
+timespec deadlineAfter(TickType_t ticks) {
+    timespec ts = now();
+    uint64_t ns = (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL;
+    ts.tv_sec += ns / 1000000000ULL;
+    ts.tv_nsec += ns % 1000000000ULL;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+void initCond(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void unlockMutex(void* mutex) {
+    pthread_mutex_unlock(static_cast<pthread_mutex_t*>(mutex));
+}
+
+// Wait on cond until pred() holds or the tick timeout expires.
+template <typename Pred>
+bool waitFor(pthread_cond_t* cond, pthread_mutex_t* mutex, TickType_t ticks, Pred pred) {
+    if (pred()) return true;
+    if (ticks == 0) return false;
+
+    bool ok = true;
+    pthread_cleanup_push(unlockMutex, mutex);
+    if (ticks == portMAX_DELAY) {
+        while (!pred()) pthread_cond_wait(cond, mutex);
+    } else {
+        timespec deadline = deadlineAfter(ticks);
+        while (!pred()) {
+            if (pthread_cond_timedwait(cond, mutex, &deadline) == ETIMEDOUT) {
+                ok = pred();
+                break;
+            }
+        }
+    }
+    pthread_cleanup_pop(0);
+    return ok;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Critical sections
+// ---------------------------------------------------------------------------
+
+void vPortMuxInitialize(portMUX_TYPE* mux) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mux->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    pthread_mutex_lock(&mux->mutex);
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    pthread_mutex_unlock(&mux->mutex);
+}
+
+int64_t esp_timer_get_time(void) {
+    return nowUs();
+}
+
+// ---------------------------------------------------------------------------
+// Tasks and task notifications
+// ---------------------------------------------------------------------------
+
+struct tskTaskControlBlock {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t notifyValue;
+    TaskFunction_t code;
+    void* parameters;
+    BaseType_t coreId;
+    std::string name;
+};
+
+static thread_local TaskHandle_t currentTask = nullptr;
+
+static TaskHandle_t newTaskControlBlock(const char* name) {
+    TaskHandle_t task = new tskTaskControlBlock();
+    pthread_mutex_init(&task->mutex, nullptr);
+    initCond(&task->cond);
+    task->notifyValue = 0;
+    task->code = nullptr;
+    task->parameters = nullptr;
+    task->coreId = tskNO_AFFINITY;
+    task->name = name != nullptr ? name : "";
+    return task;
+}
+
+static void* taskEntry(void* arg) {
+    TaskHandle_t task = static_cast<TaskHandle_t>(arg);
+    currentTask = task;
+    task->code(task->parameters);
+    // FreeRTOS tasks must never return; treat it like a self-delete.
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId) {
+    (void)priority;
+    TaskHandle_t task = newTaskControlBlock(name);
+    task->code = code;
+    task->parameters = parameters;
+    task->coreId = coreId;
+    if (createdTask != nullptr) *createdTask = task;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    // Host stacks need more headroom than the ESP32 (glibc, sanitizers).
+    size_t stack = stackDepth < 65536 ? 65536 : stackDepth;
+    pthread_attr_setstacksize(&attr, stack);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task->thread, &attr, taskEntry, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        if (createdTask != nullptr) *createdTask = nullptr;
+        delete task;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                       void* parameters, UBaseType_t priority, TaskHandle_t* createdTask) {
+    return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority,
+                                   createdTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == currentTask) {
+        pthread_exit(nullptr);
+    }
+    pthread_cancel(task->thread);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    timespec deadline = deadlineAfter(ticks);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(nowUs() / (1000 * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (currentTask == nullptr) {
+        // Threads not created through the port (e.g. main) get a control
+        // block on first use so they can receive notifications too.
+        currentTask = newTaskControlBlock("main");
+        currentTask->thread = pthread_self();
+    }
+    return currentTask;
+}
+
+BaseType_t xPortGetCoreID(void) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    return task->coreId == tskNO_AFFINITY ? 0 : task->coreId;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->mutex);
+    task->notifyValue++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->mutex);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken != nullptr) *higherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&task->mutex);
+    waitFor(&task->cond, &task->mutex, ticksToWait, [task] { return task->notifyValue != 0; });
+    uint32_t value = task->notifyValue;
+    if (value != 0) {
+        task->notifyValue = clearCountOnExit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->mutex);
+    return value;
+}
+
+void vPortYield(void) {
+    sched_yield();
+}
+
+// ---------------------------------------------------------------------------
+// Queues and semaphores
+// ---------------------------------------------------------------------------
+
+struct QueueDefinition {
+    pthread_mutex_t mutex;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    std::vector<uint8_t> storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0) return nullptr;
+    QueueHandle_t queue = new QueueDefinition();
+    pthread_mutex_init(&queue->mutex, nullptr);
+    initCond(&queue->notEmpty);
+    initCond(&queue->notFull);
+    queue->storage.resize((size_t)length * itemSize);
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    QueueHandle_t queue = xQueueCreate(maxCount, 0);
+    if (queue != nullptr) queue->count = initialCount;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue == nullptr) return;
+    pthread_cond_destroy(&queue->notEmpty);
+    pthread_cond_destroy(&queue->notFull);
+    pthread_mutex_destroy(&queue->mutex);
+    delete queue;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait, BaseType_t toFront) {
+    pthread_mutex_lock(&queue->mutex);
+    if (!waitFor(&queue->notFull, &queue->mutex, ticksToWait,
+                 [queue] { return queue->count < queue->length; })) {
+        pthread_mutex_unlock(&queue->mutex);
+        return pdFAIL;
+    }
+    if (queue->itemSize != 0) {
+        UBaseType_t slot;
+        if (toFront) {
+            queue->head = (queue->head + queue->length - 1) % queue->length;
+            slot = queue->head;
+        } else {
+            slot = (queue->head + queue->count) % queue->length;
+        }
+        memcpy(&queue->storage[(size_t)slot * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+    pthread_cond_signal(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->mutex);
+    return pdPASS;
+}
+
+static BaseType_t queueRead(QueueHandle_t queue, void* buffer, TickType_t ticksToWait, bool remove) {
+    pthread_mutex_lock(&queue->mutex);
+    if (!waitFor(&queue->notEmpty, &queue->mutex, ticksToWait, [queue] { return queue->count > 0; })) {
+        pthread_mutex_unlock(&queue->mutex);
+        return pdFAIL;
+    }
+    if (queue->itemSize != 0 && buffer != nullptr) {
+        memcpy(buffer, &queue->storage[(size_t)queue->head * queue->itemSize], queue->itemSize);
+    }
+    if (remove) {
+        if (queue->itemSize != 0) queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_signal(&queue->notFull);
+    } else {
+        pthread_cond_signal(&queue->notEmpty);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+    return queueRead(queue, buffer, ticksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+    return queueRead(queue, buffer, ticksToWait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    UBaseType_t spaces = queue->length - queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return spaces;
+}
+
+// ---------------------------------------------------------------------------
+// Software timers
+// ---------------------------------------------------------------------------
+
+struct tmrTimerControl {
+    std::string name;
+    TickType_t period;
+    bool autoReload;
+    bool active;
+    int64_t expiryUs;
+    void* timerId;
+    TimerCallbackFunction_t callback;
+};
+
+namespace {
+
+// Single service thread that owns every timer, like the FreeRTOS timer
+// task: it sleeps on a timerfd armed for the earliest expiry and is kicked
+// through an eventfd whenever the timer set changes.
+class TimerService {
+public:
+    static TimerService& get() {
+        static TimerService instance;
+        return instance;
+    }
+
+    void add(TimerHandle_t timer) {
+        pthread_mutex_lock(&_mutex);
+        _timers.push_back(timer);
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    void remove(TimerHandle_t timer) {
+        pthread_mutex_lock(&_mutex);
+        for (size_t i = 0; i < _timers.size(); ++i) {
+            if (_timers[i] == timer) {
+                _timers.erase(_timers.begin() + i);
+                break;
+            }
+        }
+        pthread_mutex_unlock(&_mutex);
+        delete timer;
+    }
+
+    void arm(TimerHandle_t timer, bool active) {
+        pthread_mutex_lock(&_mutex);
+        timer->active = active;
+        if (active) {
+            timer->expiryUs = nowUs() + (int64_t)timer->period * portTICK_PERIOD_MS * 1000;
+        }
+        pthread_mutex_unlock(&_mutex);
+        kick();
+    }
+
+    void setPeriod(TimerHandle_t timer, TickType_t period) {
+        pthread_mutex_lock(&_mutex);
+        timer->period = period;
+        pthread_mutex_unlock(&_mutex);
+        arm(timer, true);
+    }
+
+    bool isActive(TimerHandle_t timer) {
+        pthread_mutex_lock(&_mutex);
+        bool active = timer->active;
+        pthread_mutex_unlock(&_mutex);
+        return active;
+    }
+
+private:
+    TimerService() {
+        pthread_mutex_init(&_mutex, nullptr);
+        _timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        _wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        pthread_t thread;
+        pthread_create(&thread, nullptr, &TimerService::run, this);
+        pthread_detach(thread);
+    }
+
+    void kick() {
+        uint64_t one = 1;
+        (void)!write(_wakeFd, &one, sizeof(one));
+    }
+
+    static void* run(void* arg) {
+        static_cast<TimerService*>(arg)->loop();
+        return nullptr;
+    }
+
+    void loop() {
+        while (true) {
+            std::vector<TimerHandle_t> expired;
+            int64_t next = -1;
+
+            pthread_mutex_lock(&_mutex);
+            int64_t t = nowUs();
+            for (TimerHandle_t timer : _timers) {
+                if (!timer->active) continue;
+                if (timer->expiryUs <= t) {
+                    expired.push_back(timer);
+                    if (timer->autoReload) {
+                        timer->expiryUs += (int64_t)timer->period * portTICK_PERIOD_MS * 1000;
+                        if (timer->expiryUs <= t) timer->expiryUs = t + 1;
+                    } else {
+                        timer->active = false;
+                    }
+                }
+                if (timer->active && (next < 0 || timer->expiryUs < next)) {
+                    next = timer->expiryUs;
+                }
+            }
+            pthread_mutex_unlock(&_mutex);
+
+            for (TimerHandle_t timer : expired) {
+                timer->callback(timer);
+            }
+            if (!expired.empty()) continue;
+
+            itimerspec spec = {};
+            if (next >= 0) {
+                int64_t delta = next - nowUs();
+                if (delta < 1) delta = 1;
+                spec.it_value.tv_sec = delta / 1000000;
+                spec.it_value.tv_nsec = (delta % 1000000) * 1000;
+            }
+            timerfd_settime(_timerFd, 0, &spec, nullptr);
+
+            pollfd fds[2] = {{_timerFd, POLLIN, 0}, {_wakeFd, POLLIN, 0}};
+            poll(fds, 2, -1);
+            uint64_t drain;
+            if (fds[0].revents & POLLIN) (void)!read(_timerFd, &drain, sizeof(drain));
+            if (fds[1].revents & POLLIN) (void)!read(_wakeFd, &drain, sizeof(drain));
+        }
+    }
+
+    pthread_mutex_t _mutex;
+    std::vector<TimerHandle_t> _timers;
+    int _timerFd;
+    int _wakeFd;
+};
+
+} // namespace
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t autoReload,
+                           void* timerId, TimerCallbackFunction_t callback) {
+    if (period == 0 || callback == nullptr) return nullptr;
+    TimerHandle_t timer = new tmrTimerControl();
+    timer->name = name != nullptr ? name : "";
+    timer->period = period;
+    timer->autoReload = autoReload != pdFALSE;
+    timer->active = false;
+    timer->expiryUs = 0;
+    timer->timerId = timerId;
+    timer->callback = callback;
+    TimerService::get().add(timer);
+    return timer;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t) {
+    TimerService::get().remove(timer);
+    return pdPASS;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t) {
+    TimerService::get().arm(timer, true);
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t) {
+    TimerService::get().arm(timer, false);
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t) {
+    TimerService::get().arm(timer, true);
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t newPeriod, TickType_t) {
+    if (newPeriod == 0) return pdFAIL;
+    TimerService::get().setPeriod(timer, newPeriod);
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer) {
+    return TimerService::get().isActive(timer) ? pdTRUE : pdFALSE;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->timerId;
+}
@@ -1,30 +1,40 @@
 // activeObject.cpp
 #include "activeObject.h"
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <stdio.h>
 #include "events.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+
+ActiveObject* ActiveObject::s_firstActor = nullptr;
+portMUX_TYPE ActiveObject::s_registryLock = portMUX_INITIALIZER_UNLOCKED;
 
 ActiveObject::ActiveObject(const std::string& name, size_t stackSize, size_t queueSize)
+    : ActiveObject(name, TaskConfig{stackSize, 1, 1}, queueSize) {
+}
+
+ActiveObject::ActiveObject(const std::string& name, const TaskConfig& config, size_t queueSize)
     : _name(name),
-      _timer(name + ".timer", false, [this](Event* e) {
-          if (e != nullptr) {
-              this->Post(e);
-          }
-      }) {
-    _queue = xQueueCreate(queueSize, sizeof(Event*));
-    if (_queue == nullptr) {
-        ESP_LOGE("ActiveObject", "Failed to create queue for %s", _name.c_str());
-    }
+      _timer(name + ".timer", false, *this),
+      _mailbox(queueSize),
+      _taskHandle(nullptr),
+      _executor(nullptr),
+      _worker(Executor::ANY_WORKER),
+      _batchSize(SIZE_MAX),
+      _scheduled(false),
+      _nextActor(nullptr) {
+    registerActor();
     
     BaseType_t result = xTaskCreatePinnedToCore(
         taskDispatcher, 
         _name.c_str(), 
-        stackSize, 
+        config.stackSize, 
         this, 
-        1, 
+        config.priority, 
         &_taskHandle, 
-        1
+        config.core
     );
     
     if (result != pdPASS) {
@@ -33,60 +43,150 @@ ActiveObject::ActiveObject(const std::string& name, size_t stackSize, size_t que
     }
 }
 
+ActiveObject::ActiveObject(const std::string& name, Executor& executor, size_t queueSize, int worker)
+    : _name(name),
+      _timer(name + ".timer", false, *this),
+      _mailbox(queueSize),
+      _taskHandle(nullptr),
+      _executor(&executor),
+      _worker(worker),
+      _batchSize(Executor::EVENTS_PER_TURN),
+      _scheduled(false),
+      _nextActor(nullptr) {
+    registerActor();
+
+    if (!executor.IsValid()) {
+        ESP_LOGE("ActiveObject", "Executor for %s has no task", _name.c_str());
+        _executor = nullptr;
+    }
+}
+
+void ActiveObject::registerActor() {
+    if (!_mailbox.IsValid()) {
+        ESP_LOGE("ActiveObject", "Failed to create mailbox for %s", _name.c_str());
+    }
+
+    portENTER_CRITICAL(&s_registryLock);
+    _nextActor = s_firstActor;
+    s_firstActor = this;
+    portEXIT_CRITICAL(&s_registryLock);
+}
+
+// Executor-hosted actors must outlive their executor's ready queue, i.e.
+// they are expected to be static like every actor in this firmware.
 ActiveObject::~ActiveObject() {
     if (_taskHandle != nullptr) {
         vTaskDelete(_taskHandle);
     }
-    if (_queue != nullptr) {
-        // Free any remaining events in the queue before deleting it
-        Event* e = nullptr;
-        while (xQueueReceive(_queue, &e, 0) == pdPASS) {
-            if (e != nullptr) {
-                delete e;
-            }
+
+    portENTER_CRITICAL(&s_registryLock);
+    for (ActiveObject** link = &s_firstActor; *link != nullptr; link = &(*link)->_nextActor) {
+        if (*link == this) {
+            *link = _nextActor;
+            break;
         }
-        vQueueDelete(_queue);
     }
+    portEXIT_CRITICAL(&s_registryLock);
+    // Remaining events are freed by the mailbox
 }
 
 bool ActiveObject::Start() {
-    return _taskHandle != nullptr;
+    return _taskHandle != nullptr || _executor != nullptr;
 }
 
-BaseType_t ActiveObject::Post(Event* e) {
+BaseType_t ActiveObject::Post(const Event* e) {
     if (e == nullptr) return pdFAIL;
-    if (_queue == nullptr) return pdFAIL;
+    if (!Start()) {
+        e->Release();
+        return pdFAIL;
+    }
     
-    BaseType_t result = xQueueSend(_queue, &e, portMAX_DELAY);
-    if (result != pdPASS) {
-        // If we couldn't post the event, delete it to avoid memory leak
-        delete e;
-        ESP_LOGE("ActiveObject", "%s: Failed to post event", _name.c_str());
+    BaseType_t result = enqueue(e);
+    if (result == pdPASS) {
+        wake();
     }
     return result;
 }
 
-BaseType_t ActiveObject::PostISR(Event* e) {
+BaseType_t ActiveObject::TryPost(const Event* e) {
     if (e == nullptr) return pdFAIL;
-    if (_queue == nullptr) return pdFAIL;
-    
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    // Ignore return value since we can't handle errors in an ISR
-    (void)xQueueSendFromISR(_queue, &e, &xHigherPriorityTaskWoken);
-    
-    // Note: We can't delete the event here if posting fails, as we're in an ISR
-    // The caller must handle cleanup if this method returns pdFAIL
-    
-    return xHigherPriorityTaskWoken;
+    if (!Start()) {
+        e->Release();
+        return pdFAIL;
+    }
+    if (_mailbox.Push(e, 0) != pdPASS) {
+        _stats.RecordBlockedPost();
+        e->Release();
+        return pdFAIL;
+    }
+
+    wake();
+    return pdPASS;
 }
 
-bool ActiveObject::PeekQueue(Event** e) {
-    if (_queue == nullptr) return false;
-    return xQueuePeek(_queue, e, 0) == pdPASS;
+size_t ActiveObject::PostBatch(const Event* const* events, size_t count) {
+    size_t posted = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (events[i] == nullptr) continue;
+        if (!Start()) {
+            events[i]->Release();
+        } else if (enqueue(events[i]) == pdPASS) {
+            posted++;
+        }
+    }
+
+    if (posted > 0) {
+        wake();
+    }
+    return posted;
 }
 
-QueueHandle_t& ActiveObject::getQueue() {
-    return _queue;
+size_t ActiveObject::TryPostBatch(const Event* const* events, size_t count) {
+    size_t posted = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (events[i] == nullptr) continue;
+        if (!Start()) {
+            events[i]->Release();
+        } else if (_mailbox.Push(events[i], 0) == pdPASS) {
+            posted++;
+        } else {
+            _stats.RecordBlockedPost();
+            events[i]->Release();
+        }
+    }
+
+    if (posted > 0) {
+        wake();
+    }
+    return posted;
+}
+
+BaseType_t ActiveObject::enqueue(const Event* e) {
+    BaseType_t result = _mailbox.Push(e, 0);
+    if (result != pdPASS) {
+        // Mailbox full: count it, make sure the consumer is running (a batch
+        // has not woken it yet), then wait for space as before
+        _stats.RecordBlockedPost();
+        wake();
+        result = _mailbox.Push(e, portMAX_DELAY);
+    }
+    if (result != pdPASS) {
+        // If we couldn't post the event, drop our reference to avoid a leak
+        e->Release();
+        ESP_LOGE("ActiveObject", "%s: Failed to post event", _name.c_str());
+    }
+    return result;
+}
+
+BaseType_t ActiveObject::PostISR(const Event* e, BaseType_t* higherPriorityTaskWoken) {
+    if (e == nullptr) return pdFAIL;
+    if (!Start()) return pdFAIL;
+    
+    BaseType_t result = _mailbox.PushFromISR(e, higherPriorityTaskWoken);
+    if (result == pdPASS) {
+        wakeFromISR(higherPriorityTaskWoken);
+    }
+    return result;
 }
 
 void ActiveObject::taskDispatcher(void* data) {
@@ -99,41 +199,106 @@ void ActiveObject::taskDispatcher(void* data) {
     }
 }
 
+void ActiveObject::wake() {
+    if (_executor == nullptr) {
+        // One notification per event; the loop drains the mailbox on wakeup
+        xTaskNotifyGive(_taskHandle);
+    } else if (!_scheduled.exchange(true)) {
+        _executor->Schedule(this, _worker);
+    }
+}
+
+void ActiveObject::wakeFromISR(BaseType_t* higherPriorityTaskWoken) {
+    if (_executor == nullptr) {
+        vTaskNotifyGiveFromISR(_taskHandle, higherPriorityTaskWoken);
+    } else if (!_scheduled.exchange(true)) {
+        _executor->ScheduleFromISR(this, _worker, higherPriorityTaskWoken);
+    }
+}
+
 void ActiveObject::eventLoop() {
-    Event* e = nullptr;
     while (true) {
-        if (_queue != nullptr && uxQueueMessagesWaiting(_queue) > 0) {
-            // Process events by priority (0 = highest, 2 = lowest)
-            for (int p = 0; p <= 2; ++p) {
-                UBaseType_t count = uxQueueMessagesWaiting(_queue);
-                for (UBaseType_t i = 0; i < count; ++i) {
-                    if (xQueuePeek(_queue, &e, 0) == pdPASS && 
-                        e != nullptr && 
-                        e->getPriority() == static_cast<Event::Priority>(p)) {
-                        
-                        // Remove from queue now that we've verified it matches our criteria
-                        xQueueReceive(_queue, &e, 0);
-                        
-                        ESP_LOGI("ActiveObject", "[%s] Handling Event: %s (Priority: %d)",
-                               _name.c_str(), Event::typeToString(e->getType()), static_cast<int>(e->getPriority()));
-                        
-                        // Handle the event - no exception handling since it's typically 
-                        // disabled in ESP32 applications
-                        Dispatcher(e);
-                        
-                        // No error checking via exceptions - would need to be handled differently
-                        // in an embedded system, potentially with return codes
-                        
-                        delete e;
-                        break;
-                    }
-                }
-                // Allow other tasks to run between priority levels
-                taskYIELD();
+        // Block until something is posted - no polling, no idle wakeups
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // With a bounded batch, let equal-priority tasks run in between
+        while (drain(_batchSize) == _batchSize) {
+            taskYIELD();
+        }
+    }
+}
+
+// Called by an executor worker. The scheduled flag stays set while the
+// actor runs, so it is never queued (or run, even by a stealing worker)
+// twice at the same time; it is cleared afterwards and the actor requeued
+// if events arrived meanwhile. This keeps per-actor FIFO order.
+void ActiveObject::runTurn() {
+    drain(_batchSize);
+    _scheduled.store(false);
+    if (_mailbox.Count() > 0 && !_scheduled.exchange(true)) {
+        _executor->Schedule(this, _worker);
+    }
+}
+
+// Dispatch up to maxEvents pending events, popped in chunks so the mailbox
+// lock is taken once per chunk instead of once per event. A chunk holds
+// the oldest events of the highest non-empty lane; before each of them a
+// lock-free look at the mailbox checks for a higher lane, and if one
+// filled up meanwhile the rest of the chunk goes back in front of its
+// lane. A High event posted behind a burst of Low events is therefore
+// dispatched right after the event being handled, as with single pops.
+size_t ActiveObject::drain(size_t maxEvents) {
+    Mailbox::Entry chunk[DRAIN_CHUNK];
+    size_t handled = 0;
+    while (handled < maxEvents) {
+        size_t lane = 0;
+        size_t n = _mailbox.PopBatch(chunk, std::min(DRAIN_CHUNK, maxEvents - handled), &lane);
+        if (n == 0) break;
+
+        size_t i = 0;
+        for (; i < n; ++i) {
+            if (i > 0 && _mailbox.HasAbove(lane)) {
+                break;
             }
-        } else {
-            // No messages in queue, sleep for a short time
-            vTaskDelay(pdMS_TO_TICKS(10));
+            _mailbox.FreeSlots(1);
+
+            const Event* e = chunk[i].event;
+            ESP_LOGD("ActiveObject", "[%s] Handling Event: %s (Priority: %d)",
+                   _name.c_str(), Event::typeToString(e->getType()), static_cast<int>(e->getPriority()));
+#if ENABLE_ACTOR_PROFILING
+            uint32_t startUs = static_cast<uint32_t>(esp_timer_get_time());
+#endif
+
+            // Handle the event - no exception handling since it's typically 
+            // disabled in ESP32 applications. Typed handlers go through the
+            // jump table, everything else through the virtual Dispatcher.
+            if (!_handlers.dispatch(e)) {
+                Dispatcher(e);
+            }
+#if ENABLE_ACTOR_PROFILING
+            uint32_t endUs = static_cast<uint32_t>(esp_timer_get_time());
+            _stats.RecordDispatch(e->getType(), startUs - chunk[i].postedUs, endUs - startUs);
+#endif
+
+            e->Release();
         }
+        _mailbox.Unpop(chunk + i, n - i, lane);
+        handled += i;
     }
-}
\ No newline at end of file
+    return handled;
+}
+
+void ActiveObject::DumpStats() const {
+    _stats.Dump(_name.c_str(), _mailbox.HighWater(), _mailbox.Capacity(), _mailbox.Coalesced());
+}
+
+void ActiveObject::DumpAllStats() {
+    // Actors are created once at startup and live forever in this firmware,
+    // so walking the list outside the lock (logging may block) is safe.
+    portENTER_CRITICAL(&s_registryLock);
+    ActiveObject* actor = s_firstActor;
+    portEXIT_CRITICAL(&s_registryLock);
+
+    for (; actor != nullptr; actor = actor->_nextActor) {
+        actor->DumpStats();
+    }
+}
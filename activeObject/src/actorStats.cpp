@@ -0,0 +1,80 @@
+// actorStats.cpp
+#include "actorStats.h"
+#include "esp_log.h"
+
+static const char* TAG = "ActorStats";
+
+uint32_t LatencyHistogram::BucketLimit(size_t i) {
+    return i + 1 < BUCKETS ? (1u << (i + 4)) : UINT32_MAX;
+}
+
+void LatencyHistogram::Record(uint32_t us) {
+    size_t i = 0;
+    while (i + 1 < BUCKETS && us >= BucketLimit(i)) {
+        ++i;
+    }
+    _buckets[i].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    if (us > _max.load(std::memory_order_relaxed)) {
+        _max.store(us, std::memory_order_relaxed);
+    }
+}
+
+uint32_t LatencyHistogram::Percentile(uint32_t percent) const {
+    uint32_t total = Count();
+    if (total == 0) return 0;
+
+    uint64_t target = (static_cast<uint64_t>(total) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += Bucket(i);
+        if (seen >= target) {
+            return BucketLimit(i);
+        }
+    }
+    return BucketLimit(BUCKETS - 1);
+}
+
+ActorStats::~ActorStats() {
+    for (auto& slot : _types) {
+        delete slot.load();
+    }
+}
+
+void ActorStats::RecordDispatch(Event::Type type, uint32_t waitUs, uint32_t execUs) {
+    size_t index = static_cast<size_t>(type);
+    if (index >= _types.size()) return;
+
+    TypeStats* stats = _types[index].load(std::memory_order_acquire);
+    if (stats == nullptr) {
+        // Only the owning task writes, so a plain publish is race free
+        stats = new TypeStats();
+        _types[index].store(stats, std::memory_order_release);
+    }
+    stats->wait.Record(waitUs);
+    stats->exec.Record(execUs);
+}
+
+const ActorStats::TypeStats* ActorStats::Get(Event::Type type) const {
+    size_t index = static_cast<size_t>(type);
+    if (index >= _types.size()) return nullptr;
+    return _types[index].load(std::memory_order_acquire);
+}
+
+void ActorStats::Dump(const char* name, size_t highWater, size_t capacity, uint32_t coalesced) const {
+    ESP_LOGI(TAG, "[%s] queue high-water %u/%u, blocked posts %u, coalesced %u",
+             name, (unsigned)highWater, (unsigned)capacity, (unsigned)BlockedPosts(), (unsigned)coalesced);
+
+    for (size_t i = 0; i < _types.size(); ++i) {
+        const TypeStats* stats = _types[i].load(std::memory_order_acquire);
+        if (stats == nullptr) continue;
+
+        ESP_LOGI(TAG, "[%s]   %-26s n=%-6u wait p50<%u p99<%u max=%u us | exec p50<%u p99<%u max=%u us",
+                 name, Event::typeToString(static_cast<Event::Type>(i)),
+                 (unsigned)stats->wait.Count(),
+                 (unsigned)stats->wait.Percentile(50), (unsigned)stats->wait.Percentile(99),
+                 (unsigned)stats->wait.Max(),
+                 (unsigned)stats->exec.Percentile(50), (unsigned)stats->exec.Percentile(99),
+                 (unsigned)stats->exec.Max());
+    }
+}
@@ -2,34 +2,101 @@
 #include "eventBus.h"
 #include <cstdio>
 
-#define ENABLE_EVENT_TRACE 1
+#define ENABLE_EVENT_TRACE 0
 
 EventBus& EventBus::get() {
     static EventBus instance;
     return instance;
 }
 
-void EventBus::subscribe(Event::Type type, HandlerFunc handler) {
-    _handlers[type].push_back(handler);
+EventBus::EventBus()
+    : _publishers(0),
+      _nextId(1),
+      _writeLock(xSemaphoreCreateMutex()) {
+    for (auto& slot : _handlers) {
+        slot.store(nullptr);
+    }
+}
+
+EventBus::SubscriptionId EventBus::subscribe(Event::Type type, HandlerFunc handler) {
+    size_t slot = static_cast<size_t>(type);
+    if (slot >= _handlers.size()) return 0;
+
+    xSemaphoreTake(_writeLock, portMAX_DELAY);
+    const HandlerList* current = _handlers[slot].load();
+    HandlerList* next = current != nullptr ? new HandlerList(*current) : new HandlerList();
+    SubscriptionId id = _nextId++;
+    next->push_back(Subscriber{ id, handler });
+    replace(slot, next);
+    xSemaphoreGive(_writeLock);
+    return id;
+}
+
+bool EventBus::unsubscribe(SubscriptionId id) {
+    bool found = false;
+
+    xSemaphoreTake(_writeLock, portMAX_DELAY);
+    for (size_t slot = 0; slot < _handlers.size() && !found; ++slot) {
+        const HandlerList* current = _handlers[slot].load();
+        if (current == nullptr) continue;
+
+        for (size_t i = 0; i < current->size(); ++i) {
+            if ((*current)[i].id != id) continue;
+
+            HandlerList* next = nullptr;
+            if (current->size() > 1) {
+                next = new HandlerList(*current);
+                next->erase(next->begin() + i);
+            }
+            replace(slot, next);
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_writeLock);
+    return found;
+}
+
+// Called with _writeLock held
+void EventBus::replace(size_t slot, const HandlerList* list) {
+    const HandlerList* old = _handlers[slot].exchange(list);
+    if (old != nullptr) {
+        _retired.push_back(old);
+    }
+    reclaim();
 }
 
-void EventBus::publish(Event* e) {
+// Called with _writeLock held. A publisher registers itself before loading
+// a snapshot, so once the new pointer is visible and no publisher is in
+// flight, nobody can still be walking a retired list.
+void EventBus::reclaim() {
+    if (_publishers.load() != 0) return;
+    for (const HandlerList* list : _retired) {
+        delete list;
+    }
+    _retired.clear();
+}
+
+void EventBus::publish(const Event* e) {
 #if ENABLE_EVENT_TRACE
     printf("[Event:%05lu] Publish %s from %s\n", e->getId(), Event::typeToString(e->getType()), e->getSource());
 #endif
-    std::map<Event::Type, std::vector<HandlerFunc>>::iterator it = _handlers.find(e->getType());
-    if (it != _handlers.end()) {
-        std::vector<HandlerFunc>& handlers = it->second;
-        for (size_t i = 0; i < handlers.size(); ++i) {
-            Event* cloned = e->Clone();
+    size_t slot = static_cast<size_t>(e->getType());
+    if (slot < _handlers.size()) {
+        _publishers.fetch_add(1);
+        const HandlerList* handlers = _handlers[slot].load();
+        if (handlers != nullptr) {
+            for (size_t i = 0; i < handlers->size(); ++i) {
 #if ENABLE_EVENT_TRACE
-            printf("[Event:%05lu] Clone to handler %zu (%p)\n", cloned->getId(), i, static_cast<void*>(cloned));
+                printf("[Event:%05lu] Share with handler %zu (%p)\n", e->getId(), i, static_cast<const void*>(e));
 #endif
-            handlers[i](cloned);
+                (*handlers)[i].handler(e);
+            }
         }
+        _publishers.fetch_sub(1);
     }
 #if ENABLE_EVENT_TRACE
-    printf("[Event:%05lu] Delete original (%p)\n", e->getId(), static_cast<void*>(e));
+    printf("[Event:%05lu] Release publisher reference (%p)\n", e->getId(), static_cast<const void*>(e));
 #endif
-    delete e;
-}
\ No newline at end of file
+    e->Release();
+}
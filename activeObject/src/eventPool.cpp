@@ -0,0 +1,143 @@
+// eventPool.cpp
+#include "eventPool.h"
+#include "events.h"
+#include <cstdlib>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct Slab {
+    uint8_t* storage;
+    size_t blockSize;
+    uint32_t blocks;
+    FreeBlock* freeList;
+    EventPool::Stats stats;
+};
+
+alignas(std::max_align_t) uint8_t smallStorage[EVENT_POOL_SMALL_BLOCKS * EventPoolLayout::SmallBlockSize];
+alignas(std::max_align_t) uint8_t largeStorage[EVENT_POOL_LARGE_BLOCKS * EventPoolLayout::LargeBlockSize];
+
+Slab slabs[static_cast<size_t>(EventPool::SizeClass::Count)] = {
+    { smallStorage, EventPoolLayout::SmallBlockSize, EVENT_POOL_SMALL_BLOCKS, nullptr, {} },
+    { largeStorage, EventPoolLayout::LargeBlockSize, EVENT_POOL_LARGE_BLOCKS, nullptr, {} },
+};
+
+uint32_t oversize = 0;
+bool initialized = false;
+portMUX_TYPE poolLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Called with poolLock held. Lazy so events created by static
+// constructors are served regardless of initialization order.
+void initialize() {
+    for (Slab& slab : slabs) {
+        slab.freeList = nullptr;
+        for (uint32_t i = slab.blocks; i > 0; --i) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(slab.storage + (i - 1) * slab.blockSize);
+            block->next = slab.freeList;
+            slab.freeList = block;
+        }
+    }
+    initialized = true;
+}
+
+Slab* owningSlab(void* p) {
+    uint8_t* address = static_cast<uint8_t*>(p);
+    for (Slab& slab : slabs) {
+        if (address >= slab.storage && address < slab.storage + slab.blocks * slab.blockSize) {
+            return &slab;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+void* EventPool::Allocate(size_t size) {
+    void* block = nullptr;
+
+    portENTER_CRITICAL_SAFE(&poolLock);
+    if (!initialized) {
+        initialize();
+    }
+    for (Slab& slab : slabs) {
+        if (size > slab.blockSize) {
+            continue;
+        }
+        if (slab.freeList == nullptr) {
+            slab.stats.exhausted++;
+            continue;
+        }
+        block = slab.freeList;
+        slab.freeList = slab.freeList->next;
+        slab.stats.allocs++;
+        if (++slab.stats.inUse > slab.stats.highWater) {
+            slab.stats.highWater = slab.stats.inUse;
+        }
+        break;
+    }
+    if (block == nullptr && size > EventPoolLayout::LargeBlockSize) {
+        oversize++;
+    }
+    portEXIT_CRITICAL_SAFE(&poolLock);
+
+    if (block == nullptr) {
+        // Pool exhausted or event too large: fall back to the heap
+        // (exceptions are typically disabled on ESP32, so abort like new would)
+        block = std::malloc(size);
+        if (block == nullptr) {
+            ESP_LOGE("EventPool", "Out of memory allocating %u byte event", (unsigned)size);
+            abort();
+        }
+    }
+    return block;
+}
+
+void EventPool::Free(void* p) {
+    if (p == nullptr) return;
+
+    Slab* slab = owningSlab(p);
+    if (slab == nullptr) {
+        std::free(p);
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&poolLock);
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = slab->freeList;
+    slab->freeList = block;
+    slab->stats.frees++;
+    slab->stats.inUse--;
+    portEXIT_CRITICAL_SAFE(&poolLock);
+}
+
+EventPool::Stats EventPool::GetStats(SizeClass sizeClass) {
+    portENTER_CRITICAL_SAFE(&poolLock);
+    Stats stats = slabs[static_cast<size_t>(sizeClass)].stats;
+    portEXIT_CRITICAL_SAFE(&poolLock);
+    stats.blockSize = slabs[static_cast<size_t>(sizeClass)].blockSize;
+    stats.blocks = slabs[static_cast<size_t>(sizeClass)].blocks;
+    return stats;
+}
+
+uint32_t EventPool::GetOversizeCount() {
+    portENTER_CRITICAL_SAFE(&poolLock);
+    uint32_t count = oversize;
+    portEXIT_CRITICAL_SAFE(&poolLock);
+    return count;
+}
+
+void EventPool::DumpStats() {
+    static const char* names[] = { "small", "large" };
+    for (size_t i = 0; i < static_cast<size_t>(SizeClass::Count); ++i) {
+        Stats s = GetStats(static_cast<SizeClass>(i));
+        ESP_LOGI("EventPool", "%s: %u x %u B, in use %u (peak %u), allocs %u, frees %u, exhausted %u",
+                 names[i], (unsigned)s.blocks, (unsigned)s.blockSize, (unsigned)s.inUse,
+                 (unsigned)s.highWater, (unsigned)s.allocs, (unsigned)s.frees, (unsigned)s.exhausted);
+    }
+    ESP_LOGI("EventPool", "oversize: %u", (unsigned)GetOversizeCount());
+}
@@ -1,13 +1,20 @@
 // events.cpp
 #include "events.h"
-#include <cstdio>
-
-#define ENABLE_EVENT_TRACE 1
+#include "esp_timer.h"
 
 std::atomic<uint32_t> Event::_eventIdCounter {1};
 
-Event::Event(const char* source)
-    : _id(_eventIdCounter.fetch_add(1)), _source(source) {}
+Event::Event(Type type, Priority priority, const char* source)
+    : _id(_eventIdCounter.fetch_add(1)),
+      _createdUs(static_cast<uint32_t>(esp_timer_get_time())),
+      _source(source), _refCount(1),
+      _type(type), _priority(priority) {}
+
+Event::Event(const Event& other)
+    : _id(other._id),
+      _createdUs(static_cast<uint32_t>(esp_timer_get_time())),
+      _source(other._source), _refCount(1),
+      _type(other._type), _priority(other._priority) {}
 
 uint32_t Event::getId() const {
     return _id;
@@ -17,36 +24,58 @@ const char* Event::getSource() const {
     return _source;
 }
 
-Event* OnStart::Clone() const {
-    return new OnStart(getSource());
+const Event* Event::Retain() const {
+    _refCount.fetch_add(1, std::memory_order_relaxed);
+    return this;
+}
+
+void Event::Release() const {
+    if (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
 }
 
-Event* MeasurementEvent::Clone() const {
-    return new MeasurementEvent(_value, getSource());
+void* Event::operator new(size_t size) {
+    return EventPool::Allocate(size);
 }
 
-Event* ScreenRefreshEvent::Clone() const {
-    return new ScreenRefreshEvent(getSource());
+void Event::operator delete(void* p) {
+    EventPool::Free(p);
 }
 
+namespace {
+
+// Indexed by Event::Type
+constexpr const char* TYPE_NAMES[] = {
+    "OnStart",
+    "Measurement",
+    "AdcFrame",
+    "ScreenRefresh",
+    "ButtonClicked",
+    "ButtonEdge",
+    "SystemReset",
+    "WiFiConnected",
+    "WiFiDisconnected",
+    "WiFiConnecting",
+    "WiFiReconnect",
+    "WiFiRestored",
+    "WiFiFailed",
+    "WiFiGotIP",
+    "WiFiShutdown",
+    "WiFiDisconnectedByRequest",
+    "LedControl",
+    "LedStop",
+    "LedPattern",
+    "TimerTick",
+    "Dummy",
+};
+
+static_assert(sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]) == static_cast<size_t>(Event::Type::Count),
+              "TYPE_NAMES out of sync with Event::Type");
+
+} // namespace
+
 const char* Event::typeToString(Event::Type type) {
-    switch (type) {
-        case Type::OnStart: return "OnStart";
-        case Type::Measurement: return "Measurement";
-        case Type::ScreenRefresh: return "ScreenRefresh";
-        case Type::ButtonClicked: return "ButtonClicked";
-        case Type::SystemReset: return "SystemReset";
-        case Type::WiFiConnected: return "WiFiConnected";
-        case Type::WiFiDisconnected: return "WiFiDisconnected";
-        case Type::WiFiConnecting: return "WiFiConnecting";
-        case Type::WiFiReconnect: return "WiFiReconnect";
-        case Type::WiFiRestored: return "WiFiRestored";
-        case Type::WiFiFailed: return "WiFiFailed";
-        case Type::WiFiGotIP: return "WiFiGotIP";
-        case Type::WiFiShutdown: return "WiFiShutdown";
-        case Type::WiFiDisconnectedByRequest: return "WiFiDisconnectedByRequest";
-        case Type::LedControl: return "LedControl";
-        case Type::LedStop: return "LedStop";
-        default: return "Unknown";
-    }
+    size_t index = static_cast<size_t>(type);
+    return index < static_cast<size_t>(Type::Count) ? TYPE_NAMES[index] : "Unknown";
 }
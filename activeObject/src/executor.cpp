@@ -0,0 +1,191 @@
+// executor.cpp
+#include "executor.h"
+#include "activeObject.h"
+#include "esp_log.h"
+
+Executor::Executor(const char* name, size_t stackSize, UBaseType_t priority, size_t workers)
+    : _workerCount(0),
+      _idleMask(0),
+      _overflows(0) {
+    if (workers > EXECUTOR_MAX_WORKERS) {
+        workers = EXECUTOR_MAX_WORKERS;
+    }
+
+    for (size_t i = 0; i < EXECUTOR_MAX_WORKERS; ++i) {
+        Worker& worker = _workers[i];
+        worker.owner = this;
+        worker.index = i;
+        worker.task = nullptr;
+        worker.pinned.head = worker.pinned.count = 0;
+        worker.shared.head = worker.shared.count = 0;
+        portMUX_INITIALIZE(&worker.lock);
+    }
+
+    // One worker per core, round robin if more workers than cores
+    for (size_t i = 0; i < workers; ++i) {
+        BaseType_t result = xTaskCreatePinnedToCore(taskEntry, name, stackSize, &_workers[i], priority,
+                                                    &_workers[i].task, static_cast<BaseType_t>(i % portNUM_PROCESSORS));
+        if (result != pdPASS) {
+            ESP_LOGE("Executor", "Failed to create worker %u for %s", (unsigned)i, name);
+            _workers[i].task = nullptr;
+            break;
+        }
+        _workerCount.store(i + 1);
+    }
+}
+
+Executor::~Executor() {
+    for (size_t i = 0; i < _workerCount.load(); ++i) {
+        if (_workers[i].task != nullptr) {
+            vTaskDelete(_workers[i].task);
+        }
+    }
+}
+
+Executor& Executor::Shared() {
+    static Executor instance("Executor", 4096, 1, portNUM_PROCESSORS);
+    return instance;
+}
+
+bool Executor::ringPush(ReadyRing& ring, ActiveObject* actor) {
+    if (ring.count >= EXECUTOR_MAX_ACTORS) return false;
+    ring.slots[(ring.head + ring.count) % EXECUTOR_MAX_ACTORS] = actor;
+    ring.count++;
+    return true;
+}
+
+ActiveObject* Executor::ringPop(ReadyRing& ring) {
+    if (ring.count == 0) return nullptr;
+    ActiveObject* actor = ring.slots[ring.head];
+    ring.head = (ring.head + 1) % EXECUTOR_MAX_ACTORS;
+    ring.count--;
+    return actor;
+}
+
+// Worker for a new ready actor: its pinned worker, else the caller's core
+size_t Executor::pick(int worker) const {
+    size_t count = _workerCount.load();
+    if (worker >= 0) {
+        return static_cast<size_t>(worker) % count;
+    }
+    return static_cast<size_t>(xPortGetCoreID()) % count;
+}
+
+bool Executor::push(Worker& worker, ActiveObject* actor, bool pinned) {
+    portENTER_CRITICAL_SAFE(&worker.lock);
+    bool ok = ringPush(pinned ? worker.pinned : worker.shared, actor);
+    portEXIT_CRITICAL_SAFE(&worker.lock);
+    return ok;
+}
+
+// The actor could not be queued. An actor is queued at most once, so the
+// ring only overflows with more than EXECUTOR_MAX_ACTORS actors attached
+// (or with no worker at all). Clearing the scheduled flag lets the next
+// post try again; until then the actor's events wait in its mailbox.
+// Also called from ISRs: no logging here.
+uint32_t Executor::reject(ActiveObject* actor) {
+    actor->_scheduled.store(false);
+    return _overflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Executor::Schedule(ActiveObject* actor, int worker) {
+    if (_workerCount == 0) {
+        reject(actor);
+        return;
+    }
+
+    Worker& target = _workers[pick(worker)];
+    bool pinned = worker >= 0;
+    if (!push(target, actor, pinned)) {
+        if (reject(actor) == 0) {
+            ESP_LOGE("Executor", "Ready queue overflow, %s not scheduled", actor->getName().c_str());
+        }
+        return;
+    }
+
+    xTaskNotifyGive(target.task);
+    // If the target is busy, let an idle worker steal the unpinned actor
+    if (!pinned && (_idleMask.load() & (1u << target.index)) == 0) {
+        wakeIdleWorker(target.index);
+    }
+}
+
+void Executor::ScheduleFromISR(ActiveObject* actor, int worker, BaseType_t* higherPriorityTaskWoken) {
+    if (_workerCount == 0) {
+        reject(actor);
+        return;
+    }
+
+    Worker& target = _workers[pick(worker)];
+    if (!push(target, actor, worker >= 0)) {
+        reject(actor);
+        return;
+    }
+
+    vTaskNotifyGiveFromISR(target.task, higherPriorityTaskWoken);
+}
+
+void Executor::wakeIdleWorker(size_t except) {
+    uint32_t idle = _idleMask.load() & ~(1u << except);
+    if (idle != 0) {
+        xTaskNotifyGive(_workers[__builtin_ctz(idle)].task);
+    }
+}
+
+ActiveObject* Executor::popLocal(Worker& worker) {
+    portENTER_CRITICAL_SAFE(&worker.lock);
+    ActiveObject* actor = ringPop(worker.pinned);
+    if (actor == nullptr) {
+        actor = ringPop(worker.shared);
+    }
+    portEXIT_CRITICAL_SAFE(&worker.lock);
+    return actor;
+}
+
+// Only unpinned actors can be stolen
+ActiveObject* Executor::steal(Worker& thief) {
+    size_t count = _workerCount.load();
+    for (size_t n = 1; n < count; ++n) {
+        Worker& victim = _workers[(thief.index + n) % count];
+        portENTER_CRITICAL_SAFE(&victim.lock);
+        ActiveObject* actor = ringPop(victim.shared);
+        portEXIT_CRITICAL_SAFE(&victim.lock);
+        if (actor != nullptr) {
+            return actor;
+        }
+    }
+    return nullptr;
+}
+
+void Executor::taskEntry(void* data) {
+    Worker* worker = static_cast<Worker*>(data);
+    worker->owner->run(*worker);
+}
+
+void Executor::run(Worker& worker) {
+    const uint32_t bit = 1u << worker.index;
+    while (true) {
+        ActiveObject* actor = popLocal(worker);
+        if (actor == nullptr) {
+            actor = steal(worker);
+        }
+
+        if (actor == nullptr) {
+            // Advertise idleness before the final check, so a concurrent
+            // Schedule() either sees us idle and notifies, or we see its actor.
+            _idleMask.fetch_or(bit);
+            actor = popLocal(worker);
+            if (actor == nullptr) {
+                actor = steal(worker);
+            }
+            if (actor == nullptr) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            _idleMask.fetch_and(~bit);
+        }
+
+        if (actor != nullptr) {
+            actor->runTurn();
+        }
+    }
+}
@@ -0,0 +1,184 @@
+// isrChannel.cpp
+#include "isrChannel.h"
+#include "activeObject.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "IsrService";
+
+static uint32_t roundUpPow2(size_t n) {
+    uint32_t size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+IsrChannel::IsrChannel(const char* name, ActiveObject& target, Convert convert, void* context, size_t slots)
+    : _name(name),
+      _target(target),
+      _convert(convert),
+      _context(context),
+      _service(&IsrService::Instance()),
+      _slots(nullptr),
+      _mask(0),
+      _head(0),
+      _tail(0),
+      _dropped(0),
+      _highWater(0),
+      _next(nullptr) {
+    uint32_t size = roundUpPow2(slots > 0 ? slots : 1);
+    _slots = new Slot[size];
+    _mask = size - 1;
+    _service->add(this);
+}
+
+IsrChannel::~IsrChannel() {
+    _service->remove(this);
+    delete[] _slots;
+}
+
+bool IRAM_ATTR IsrChannel::Raise(uint32_t value, uint32_t aux, BaseType_t* higherPriorityTaskWoken) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    uint32_t tail = _tail.load(std::memory_order_acquire);
+    if (head - tail > _mask) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    _slots[head & _mask] = Slot{ static_cast<uint32_t>(esp_timer_get_time()), value, aux };
+    _head.store(head + 1, std::memory_order_seq_cst);
+
+    uint32_t depth = head + 1 - tail;
+    if (depth > _highWater.load(std::memory_order_relaxed)) {
+        _highWater.store(depth, std::memory_order_relaxed);
+    }
+
+    // Only the first slot of a burst wakes the drain task. Paired with the
+    // seq_cst tail store / head load in drain(): either the drain task sees
+    // this slot, or we see it caught up with us and notify.
+    if (_tail.load(std::memory_order_seq_cst) == head) {
+        _service->notifyFromISR(higherPriorityTaskWoken);
+    }
+    return true;
+}
+
+size_t IsrChannel::drain(size_t max, bool* backlog) {
+    const Event* batch[ISR_SERVICE_BATCH];
+    if (max > ISR_SERVICE_BATCH) {
+        max = ISR_SERVICE_BATCH;
+    }
+    // Never block the drain task on one actor: take only what fits
+    size_t space = _target.getMailbox().Space();
+    if (max > space) {
+        max = space;
+    }
+
+    size_t consumed = 0;
+    size_t events = 0;
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    while (consumed < max && tail != _head.load(std::memory_order_seq_cst)) {
+        const Event* e = _convert(_slots[tail & _mask], _context);
+        _tail.store(++tail, std::memory_order_seq_cst);
+        if (e != nullptr) {
+            batch[events++] = e;
+        }
+        consumed++;
+    }
+    *backlog = consumed == max && max < ISR_SERVICE_BATCH && tail != _head.load(std::memory_order_seq_cst);
+
+    if (events > 0) {
+        size_t posted = _target.TryPostBatch(batch, events);
+        if (posted < events) {
+            _dropped.fetch_add(static_cast<uint32_t>(events - posted), std::memory_order_relaxed);
+        }
+    }
+    return consumed;
+}
+
+IsrService::IsrService()
+    : _taskHandle(nullptr),
+      _first(nullptr) {
+    portMUX_INITIALIZE(&_lock);
+
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "IsrService", ISR_SERVICE_STACK_SIZE, this,
+                                                ISR_SERVICE_PRIORITY, &_taskHandle, tskNO_AFFINITY);
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        _taskHandle = nullptr;
+    }
+}
+
+IsrService& IsrService::Instance() {
+    static IsrService instance;
+    return instance;
+}
+
+void IsrService::add(IsrChannel* channel) {
+    portENTER_CRITICAL(&_lock);
+    channel->_next = _first;
+    _first = channel;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void IsrService::remove(IsrChannel* channel) {
+    portENTER_CRITICAL(&_lock);
+    for (IsrChannel** link = &_first; *link != nullptr; link = &(*link)->_next) {
+        if (*link == channel) {
+            *link = channel->_next;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+void IRAM_ATTR IsrService::notifyFromISR(BaseType_t* higherPriorityTaskWoken) {
+    if (_taskHandle != nullptr) {
+        vTaskNotifyGiveFromISR(_taskHandle, higherPriorityTaskWoken);
+    }
+}
+
+void IsrService::taskEntry(void* data) {
+    static_cast<IsrService*>(data)->run();
+}
+
+void IsrService::run() {
+    bool backlog = false;
+    while (true) {
+        // A backed-up ring gets no new notification (it is not empty), so
+        // retry it after a tick
+        ulTaskNotifyTake(pdTRUE, backlog ? ISR_SERVICE_RETRY_TICKS : portMAX_DELAY);
+
+        // Round robin over the channels until every ring is empty or waits
+        // for its actor, so one busy source cannot hold back the others
+        // for more than a batch.
+        bool more = true;
+        while (more) {
+            more = false;
+            backlog = false;
+            portENTER_CRITICAL(&_lock);
+            IsrChannel* channel = _first;
+            portEXIT_CRITICAL(&_lock);
+
+            for (; channel != nullptr; channel = channel->_next) {
+                bool full = false;
+                if (channel->drain(ISR_SERVICE_BATCH, &full) == ISR_SERVICE_BATCH) {
+                    more = true;
+                }
+                backlog = backlog || full;
+            }
+        }
+    }
+}
+
+void IsrService::DumpStats() const {
+    portENTER_CRITICAL(&_lock);
+    IsrChannel* channel = _first;
+    portEXIT_CRITICAL(&_lock);
+
+    for (; channel != nullptr; channel = channel->_next) {
+        ESP_LOGI(TAG, "[%s] raised %u, dropped %u, ring high-water %u/%u",
+                 channel->GetName(), (unsigned)channel->Raised(), (unsigned)channel->Dropped(),
+                 (unsigned)channel->HighWater(), (unsigned)(channel->_mask + 1));
+    }
+}
@@ -0,0 +1,240 @@
+// mailbox.cpp
+#include "mailbox.h"
+#include <algorithm>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+Mailbox::Mailbox(size_t capacity)
+    : _capacity(capacity),
+      _readyMask(0),
+      _count(0),
+      _highWater(0),
+      _coalesced(0),
+      _space(nullptr) {
+    portMUX_INITIALIZE(&_lock);
+
+    for (Policy& policy : _policies) {
+        policy = Policy{ Coalesce::KeepAll, nullptr };
+    }
+
+    // Every lane can hold the full capacity, the semaphore bounds the total.
+    Entry* storage = new Entry[LANES * capacity];
+    for (size_t p = 0; p < LANES; ++p) {
+        _lanes[p].slots = storage + p * capacity;
+        _lanes[p].head = 0;
+        _lanes[p].count = 0;
+    }
+
+    _space = xSemaphoreCreateCounting(capacity, capacity);
+    if (_space == nullptr) {
+        ESP_LOGE("Mailbox", "Failed to create mailbox semaphore");
+    }
+}
+
+Mailbox::~Mailbox() {
+    // Free any remaining events before releasing the lanes
+    const Event* e = nullptr;
+    while ((e = Pop()) != nullptr) {
+        e->Release();
+    }
+    delete[] _lanes[0].slots;
+    if (_space != nullptr) {
+        vSemaphoreDelete(_space);
+    }
+}
+
+bool Mailbox::IsValid() const {
+    return _space != nullptr;
+}
+
+void Mailbox::SetCoalescing(Event::Type type, Coalesce policy, MergeFunc merge) {
+    size_t index = static_cast<size_t>(type);
+    if (index >= static_cast<size_t>(Event::Type::Count)) return;
+    if (policy == Coalesce::Merge && merge == nullptr) {
+        ESP_LOGE("Mailbox", "Merge policy for %s without merge function", Event::typeToString(type));
+        return;
+    }
+    _policies[index] = Policy{ policy, merge };
+}
+
+size_t Mailbox::laneOf(const Event* e) const {
+    size_t p = static_cast<size_t>(e->getPriority());
+    return p < LANES ? p : LANES - 1;
+}
+
+// Try to absorb e into the newest event of its lane. On success *replaced
+// is the reference the caller has to release (the old or the new event).
+bool Mailbox::coalesce(const Event* e, const Event** replaced) {
+    const Policy& policy = _policies[static_cast<size_t>(e->getType())];
+    if (policy.mode == Coalesce::KeepAll) return false;
+
+    uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+    bool done = false;
+
+    portENTER_CRITICAL_SAFE(&_lock);
+    Lane& lane = _lanes[laneOf(e)];
+    if (lane.count > 0) {
+        Entry& newest = lane.slots[(lane.head + lane.count - 1) % _capacity];
+        if (newest.event->getType() == e->getType()) {
+            if (policy.mode == Coalesce::ReplaceLatest) {
+                *replaced = newest.event;
+                newest = Entry{ e, now };
+                done = true;
+            } else if (!newest.event->IsShared() &&
+                       policy.merge(const_cast<Event&>(*newest.event), *e)) {
+                // Only the mailbox holds the pending event, so changing it is safe
+                *replaced = e;
+                done = true;
+            }
+        }
+    }
+    if (done) {
+        _coalesced++;
+    }
+    portEXIT_CRITICAL_SAFE(&_lock);
+    return done;
+}
+
+bool Mailbox::enqueue(const Event* e) {
+    uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+
+    size_t p = laneOf(e);
+
+    portENTER_CRITICAL_SAFE(&_lock);
+    Lane& lane = _lanes[p];
+    bool ok = lane.count < _capacity;
+    if (ok) {
+        lane.slots[(lane.head + lane.count) % _capacity] = Entry{ e, now };
+        lane.count++;
+        _readyMask.store(_readyMask.load(std::memory_order_relaxed) | (1u << p), std::memory_order_relaxed);
+        if (++_count > _highWater) {
+            _highWater = _count;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&_lock);
+    return ok;
+}
+
+BaseType_t Mailbox::Push(const Event* e, TickType_t wait) {
+    if (e == nullptr || _space == nullptr) return pdFAIL;
+
+    const Event* replaced = nullptr;
+    if (coalesce(e, &replaced)) {
+        replaced->Release();
+        return pdPASS;
+    }
+
+    if (xSemaphoreTake(_space, wait) != pdPASS) return pdFAIL;
+    return enqueue(e) ? pdPASS : pdFAIL;
+}
+
+BaseType_t Mailbox::PushFromISR(const Event* e, BaseType_t* higherPriorityTaskWoken) {
+    if (e == nullptr || _space == nullptr) return pdFAIL;
+    if (xSemaphoreTakeFromISR(_space, higherPriorityTaskWoken) != pdPASS) return pdFAIL;
+    return enqueue(e) ? pdPASS : pdFAIL;
+}
+
+bool Mailbox::popLocked(Entry& entry) {
+    uint32_t mask = _readyMask.load(std::memory_order_relaxed);
+    if (mask == 0) return false;
+
+    // Lowest set bit = highest priority lane (Priority::High == 0)
+    size_t p = static_cast<size_t>(__builtin_ctz(mask));
+    Lane& lane = _lanes[p];
+    entry = lane.slots[lane.head];
+    lane.head = (lane.head + 1) % _capacity;
+    if (--lane.count == 0) {
+        _readyMask.store(mask & ~(1u << p), std::memory_order_relaxed);
+    }
+    _count--;
+    return true;
+}
+
+const Event* Mailbox::Pop(uint32_t* postedUs) {
+    Entry entry{ nullptr, 0 };
+
+    portENTER_CRITICAL_SAFE(&_lock);
+    bool ok = popLocked(entry);
+    portEXIT_CRITICAL_SAFE(&_lock);
+
+    if (!ok) return nullptr;
+    if (postedUs != nullptr) {
+        *postedUs = entry.postedUs;
+    }
+    if (_space != nullptr) {
+        xSemaphoreGive(_space);
+    }
+    return entry.event;
+}
+
+size_t Mailbox::PopBatch(Entry* out, size_t max, size_t* lane) {
+    size_t n = 0;
+
+    portENTER_CRITICAL_SAFE(&_lock);
+    uint32_t mask = _readyMask.load(std::memory_order_relaxed);
+    if (mask != 0 && max > 0) {
+        size_t p = static_cast<size_t>(__builtin_ctz(mask));
+        Lane& source = _lanes[p];
+        n = std::min(max, source.count);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = source.slots[(source.head + i) % _capacity];
+        }
+        source.head = (source.head + n) % _capacity;
+        source.count -= n;
+        if (source.count == 0) {
+            _readyMask.store(mask & ~(1u << p), std::memory_order_relaxed);
+        }
+        _count -= n;
+        *lane = p;
+    }
+    portEXIT_CRITICAL_SAFE(&_lock);
+    return n;
+}
+
+// The slots of the entries were never freed, so there is room for them
+void Mailbox::Unpop(const Entry* entries, size_t count, size_t lane) {
+    if (count == 0 || lane >= LANES) return;
+
+    portENTER_CRITICAL_SAFE(&_lock);
+    Lane& target = _lanes[lane];
+    target.head = (target.head + _capacity - count) % _capacity;
+    for (size_t i = 0; i < count; ++i) {
+        target.slots[(target.head + i) % _capacity] = entries[i];
+    }
+    target.count += count;
+    _readyMask.store(_readyMask.load(std::memory_order_relaxed) | (1u << lane), std::memory_order_relaxed);
+    _count += count;
+    portEXIT_CRITICAL_SAFE(&_lock);
+}
+
+void Mailbox::FreeSlots(size_t count) {
+    if (_space == nullptr) return;
+    for (size_t i = 0; i < count; ++i) {
+        xSemaphoreGive(_space);
+    }
+}
+
+size_t Mailbox::Count() const {
+    portENTER_CRITICAL_SAFE(&_lock);
+    size_t count = _count;
+    portEXIT_CRITICAL_SAFE(&_lock);
+    return count;
+}
+
+size_t Mailbox::Space() const {
+    return _space != nullptr ? uxSemaphoreGetCount(_space) : 0;
+}
+
+size_t Mailbox::HighWater() const {
+    portENTER_CRITICAL_SAFE(&_lock);
+    size_t highWater = _highWater;
+    portEXIT_CRITICAL_SAFE(&_lock);
+    return highWater;
+}
+
+uint32_t Mailbox::Coalesced() const {
+    portENTER_CRITICAL_SAFE(&_lock);
+    uint32_t coalesced = _coalesced;
+    portEXIT_CRITICAL_SAFE(&_lock);
+    return coalesced;
+}
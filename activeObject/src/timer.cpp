@@ -1,87 +1,55 @@
 #include "timer.h"
 #include <stdio.h>
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/timers.h"
 
-Timer::Timer(const std::string& Name, bool autoReload, std::function<void(Event*)> Callback, int Identify)
+Timer::Timer(const std::string& Name, bool autoReload, std::function<void(const Event*)> Callback, int Identify)
     : _timerName(Name),
       _identify(Identify),
-      _timerHandle(nullptr),
-      _event(nullptr),
       _callback(Callback),
       _autoReload(autoReload)
 {
-    _timerHandle = xTimerCreate(
-        _timerName.c_str(),
-        pdMS_TO_TICKS(1000),
-        autoReload ? pdTRUE : pdFALSE,
-        static_cast<void*>(this),  // Explicitly cast this pointer
-        timerCallback
-    );
-
-    if (_timerHandle == nullptr) {
-        ESP_LOGE("Timer", "Failed to create timer %s", _timerName.c_str());
-    }
+    _entry.callback = timerCallback;
+    _entry.context = this;
+}
+
+Timer::Timer(const std::string& Name, bool autoReload, ActiveObject& target, int Identify)
+    : _timerName(Name),
+      _identify(Identify),
+      _autoReload(autoReload)
+{
+    _entry.target = &target;
 }
 
 Timer::~Timer() {
-    if (_timerHandle) {
-        xTimerDelete(_timerHandle, 0);
-    }
-    // Free any remaining event
-    if (_event != nullptr) {
-        delete _event;
-        _event = nullptr;
-    }
+    // Disarms and drops the reference of any pending event
+    TimerService::Instance().Stop(_entry);
 }
 
 void Timer::Start(TickType_t duration) {
-    _event = nullptr;
-    if (_timerHandle == nullptr) {
-        ESP_LOGE("Timer", "Timer %s not initialized", _timerName.c_str());
-        return;
-    }
-
-    BaseType_t result = xTimerChangePeriod(_timerHandle, pdMS_TO_TICKS(duration), pdMS_TO_TICKS(100));
-    if (result != pdPASS) {
-        ESP_LOGE("Timer", "Failed to change period for timer %s", _timerName.c_str());
-        return;
-    }
-
-    result = xTimerStart(_timerHandle, pdMS_TO_TICKS(100));
-    if (result != pdPASS) {
-        ESP_LOGE("Timer", "Failed to start timer %s", _timerName.c_str());
-    }
+    Start(duration, nullptr);
 }
 
-void Timer::Start(TickType_t duration, Event* event) {
-    // Delete any existing event before assigning the new one
-    if (_event != nullptr) {
-        delete _event;
-    }
-    _event = event;
-    Start(duration);  // Reuse existing Start method
+void Timer::Start(TickType_t duration, const Event* event) {
+    TimerService::Instance().Start(_entry, pdMS_TO_TICKS(duration), _autoReload, event);
 }
 
 void Timer::Stop() {
-    if (_timerHandle) {
-        xTimerStop(_timerHandle, pdMS_TO_TICKS(100));
-    }
+    TimerService::Instance().Stop(_entry);
 }
 
 void Timer::Reset() {
-    if (_timerHandle) {
-        xTimerReset(_timerHandle, pdMS_TO_TICKS(100));
-    }
+    TimerService::Instance().Restart(_entry);
 }
 
-TimerHandle_t Timer::GetHandle() const {
-    return _timerHandle;
+bool Timer::IsActive() const {
+    return TimerService::Instance().IsActive(_entry);
 }
 
-void Timer::SetCallback(std::function<void(Event*)> callback) {
+void Timer::SetCallback(std::function<void(const Event*)> callback) {
     _callback = callback;
+    _entry.target = nullptr;
+    _entry.callback = timerCallback;
+    _entry.context = this;
 }
 
 void Timer::SetIdentify(int identify) {
@@ -100,33 +68,18 @@ const std::string& Timer::GetName() const {
     return _timerName;
 }
 
-void Timer::timerCallback(TimerHandle_t xTimer) 
+// Runs in the TimerService task
+void Timer::timerCallback(const Event* e, void* context)
 {
-    Timer* timer = static_cast<Timer*>(pvTimerGetTimerID(xTimer));
-    
-    if (timer == nullptr) 
-    {
-        ESP_LOGE("Timer", "Invalid timer pointer in callback");
-        return;
-    }
+    Timer* timer = static_cast<Timer*>(context);
 
-    if (timer->_callback == nullptr) 
+    if (!timer->_callback)
     {
         ESP_LOGE("Timer", "No callback registered for timer %s", timer->_timerName.c_str());
         return;
     }
 
-    // Create a local copy of the event pointer to prevent possible race conditions
-    Event* eventToProcess = timer->_event;
-    timer->_event = nullptr;  // Clear event pointer first for thread safety
-    
-    // Execute callback with the stored event
-    timer->_callback(eventToProcess);
-    
-    // Clean up event if it exists and timer is not auto-reload
-    // For auto-reload timers, the event is already cleared above
-    if (eventToProcess != nullptr) 
-    {
-        delete eventToProcess;
-    }
-}
\ No newline at end of file
+    // The callback only borrows the event and retains it if it hands it
+    // on (e.g. posts it to an actor); the service drops its reference
+    timer->_callback(e);
+}
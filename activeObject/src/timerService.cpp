@@ -0,0 +1,294 @@
+// timerService.cpp
+#include "timerService.h"
+#include "activeObject.h"
+#include "esp_log.h"
+
+static const char* TAG = "TimerService";
+
+TimerService::TimerService()
+    : _now(xTaskGetTickCount()),
+      _wakeAt(_now),
+      _active(0),
+      _missed(0),
+      _taskHandle(nullptr) {
+    portMUX_INITIALIZE(&_lock);
+    for (auto& wheel : _wheels) {
+        for (Entry*& slot : wheel) {
+            slot = nullptr;
+        }
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "TimerService", TIMER_SERVICE_STACK_SIZE, this,
+                                                TIMER_SERVICE_PRIORITY, &_taskHandle, tskNO_AFFINITY);
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create timer task");
+        _taskHandle = nullptr;
+    }
+}
+
+TimerService& TimerService::Instance() {
+    static TimerService instance;
+    return instance;
+}
+
+// File the entry by its distance to _now: wheel n holds entries due within
+// 64^(n+1) ticks, in the slot of bits [6n, 6n+6) of the expiry tick.
+void TimerService::link(Entry& entry) {
+    uint32_t delta = entry.expires - _now;
+    size_t wheel = 0;
+    while (wheel + 1 < WHEELS && delta >= (1u << (SLOT_BITS * (wheel + 1)))) {
+        wheel++;
+    }
+
+    size_t slot;
+    if (delta >= (1u << (SLOT_BITS * WHEELS))) {
+        // Beyond the last wheel: park in the slot that turns last
+        slot = ((_now >> (SLOT_BITS * wheel)) + SLOTS - 1) & (SLOTS - 1);
+    } else {
+        slot = (entry.expires >> (SLOT_BITS * wheel)) & (SLOTS - 1);
+    }
+
+    Entry*& head = _wheels[wheel][slot];
+    entry.next = head;
+    if (head != nullptr) {
+        head->pprev = &entry.next;
+    }
+    entry.pprev = &head;
+    head = &entry;
+}
+
+void TimerService::unlink(Entry& entry) {
+    *entry.pprev = entry.next;
+    if (entry.next != nullptr) {
+        entry.next->pprev = entry.pprev;
+    }
+    entry.pprev = nullptr;
+    entry.next = nullptr;
+}
+
+// (Re)file the entry delay ticks from now. Called with the lock held;
+// true if the task has to wake up earlier than planned.
+bool TimerService::arm(Entry& entry, TickType_t delay, bool periodic) {
+    if (delay == 0) {
+        delay = 1;
+    }
+
+    bool wake = false;
+    if (entry.active) {
+        unlink(entry);
+    } else {
+        entry.active = true;
+        wake = (_active++ == 0);
+    }
+    entry.interval = delay;
+    entry.period = periodic ? delay : 0;
+    entry.expires = xTaskGetTickCount() + delay;
+    if (static_cast<int32_t>(entry.expires - _now) <= 0) {
+        entry.expires = _now + 1;
+    }
+    link(entry);
+    return wake || static_cast<int32_t>(entry.expires - _wakeAt) < 0;
+}
+
+void TimerService::Start(Entry& entry, TickType_t delay, bool periodic, const Event* event) {
+    portENTER_CRITICAL(&_lock);
+    const Event* previous = entry.event;
+    entry.event = event;
+    bool wake = arm(entry, delay, periodic);
+    portEXIT_CRITICAL(&_lock);
+
+    // Also when event == previous: the caller handed over a reference of
+    // its own (Retain()), the entry's old one is dropped
+    if (previous != nullptr) {
+        previous->Release();
+    }
+    if (wake && _taskHandle != nullptr) {
+        xTaskNotifyGive(_taskHandle);
+    }
+}
+
+void TimerService::Restart(Entry& entry) {
+    portENTER_CRITICAL(&_lock);
+    // Never started: nothing to restart
+    bool wake = entry.interval != 0 && arm(entry, entry.interval, entry.period != 0);
+    portEXIT_CRITICAL(&_lock);
+
+    if (wake && _taskHandle != nullptr) {
+        xTaskNotifyGive(_taskHandle);
+    }
+}
+
+void TimerService::Stop(Entry& entry) {
+    const Event* event = nullptr;
+
+    portENTER_CRITICAL(&_lock);
+    if (entry.active) {
+        unlink(entry);
+        entry.active = false;
+        _active--;
+    }
+    event = entry.event;
+    entry.event = nullptr;
+    portEXIT_CRITICAL(&_lock);
+
+    if (event != nullptr) {
+        event->Release();
+    }
+}
+
+bool TimerService::IsActive(const Entry& entry) const {
+    portENTER_CRITICAL(&_lock);
+    bool active = entry.active;
+    portEXIT_CRITICAL(&_lock);
+    return active;
+}
+
+size_t TimerService::ActiveCount() const {
+    portENTER_CRITICAL(&_lock);
+    size_t active = _active;
+    portEXIT_CRITICAL(&_lock);
+    return active;
+}
+
+uint32_t TimerService::Missed() const {
+    portENTER_CRITICAL(&_lock);
+    uint32_t missed = _missed;
+    portEXIT_CRITICAL(&_lock);
+    return missed;
+}
+
+// Move the slot of the upper wheel that is due now one level (or more) down
+void TimerService::cascade(size_t wheel) {
+    size_t slot = (_now >> (SLOT_BITS * wheel)) & (SLOTS - 1);
+    Entry* entry = _wheels[wheel][slot];
+    _wheels[wheel][slot] = nullptr;
+
+    while (entry != nullptr) {
+        Entry* next = entry->next;
+        entry->next = nullptr;
+        link(*entry);
+        entry = next;
+    }
+}
+
+// Unlink up to max expired entries of the current slot; periodic ones are
+// re-filed for their next period. Every expiry posts a new reference of
+// the event, the entry keeps its own for the next period or Restart().
+size_t TimerService::collect(Expiry* out, size_t max) {
+    Entry*& slot = _wheels[0][_now & (SLOTS - 1)];
+    size_t n = 0;
+
+    while (n < max && slot != nullptr) {
+        Entry& entry = *slot;
+        unlink(entry);
+
+        Expiry& expiry = out[n++];
+        expiry.target = entry.target;
+        expiry.callback = entry.callback;
+        expiry.context = entry.context;
+
+        expiry.event = entry.event != nullptr ? entry.event->Retain() : nullptr;
+
+        if (entry.period != 0) {
+            entry.expires += entry.period;
+            while (static_cast<int32_t>(entry.expires - _now) <= 0) {
+                entry.expires += entry.period;
+            }
+            link(entry);
+        } else {
+            entry.active = false;
+            _active--;
+        }
+    }
+    return n;
+}
+
+void TimerService::deliver(const Expiry& expiry) {
+    if (expiry.target != nullptr) {
+        if (expiry.event != nullptr && expiry.target->TryPost(expiry.event) != pdPASS) {
+            portENTER_CRITICAL(&_lock);
+            _missed++;
+            portEXIT_CRITICAL(&_lock);
+        }
+        return;
+    }
+
+    // The callback borrows the event
+    if (expiry.callback != nullptr) {
+        expiry.callback(expiry.event, expiry.context);
+    }
+    if (expiry.event != nullptr) {
+        expiry.event->Release();
+    }
+}
+
+void TimerService::advance(uint32_t tick) {
+    Expiry batch[EXPIRY_BATCH];
+
+    while (true) {
+        portENTER_CRITICAL(&_lock);
+        if (static_cast<int32_t>(tick - _now) <= 0) {
+            portEXIT_CRITICAL(&_lock);
+            return;
+        }
+        _now++;
+        // Upper wheels first, an entry may drop through several levels
+        for (size_t wheel = WHEELS - 1; wheel > 0; --wheel) {
+            if ((_now & ((1u << (SLOT_BITS * wheel)) - 1)) == 0) {
+                cascade(wheel);
+            }
+        }
+
+        size_t n;
+        do {
+            n = collect(batch, EXPIRY_BATCH);
+            portEXIT_CRITICAL(&_lock);
+
+            for (size_t i = 0; i < n; ++i) {
+                deliver(batch[i]);
+            }
+
+            portENTER_CRITICAL(&_lock);
+        } while (n == EXPIRY_BATCH);
+        portEXIT_CRITICAL(&_lock);
+    }
+}
+
+// Ticks from _now to the next occupied wheel-0 slot or the next cascade,
+// whichever comes first. Called with the lock held.
+TickType_t TimerService::ticksToNextSlot() const {
+    if (_active == 0) return portMAX_DELAY;
+
+    for (uint32_t i = 1; i <= SLOTS; ++i) {
+        uint32_t tick = _now + i;
+        if ((tick & (SLOTS - 1)) == 0 || _wheels[0][tick & (SLOTS - 1)] != nullptr) {
+            return i;
+        }
+    }
+    return SLOTS;
+}
+
+void TimerService::taskEntry(void* data) {
+    static_cast<TimerService*>(data)->run();
+}
+
+void TimerService::run() {
+    while (true) {
+        portENTER_CRITICAL(&_lock);
+        TickType_t next = ticksToNextSlot();
+        // Idle: any Start() wakes us anyway (first active timer)
+        uint32_t wakeAt = (next == portMAX_DELAY) ? _now : _now + next;
+        _wakeAt = wakeAt;
+        portEXIT_CRITICAL(&_lock);
+
+        TickType_t wait = portMAX_DELAY;
+        if (next != portMAX_DELAY) {
+            int32_t remaining = static_cast<int32_t>(wakeAt - xTaskGetTickCount());
+            wait = remaining > 0 ? static_cast<TickType_t>(remaining) : 0;
+        }
+
+        // Start() notifies when a timer is due before _wakeAt
+        ulTaskNotifyTake(pdTRUE, wait);
+        advance(xTaskGetTickCount());
+    }
+}
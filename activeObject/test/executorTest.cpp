@@ -0,0 +1,160 @@
+// Executor-hosted actors: per-actor FIFO order with several workers
+// stealing, and recovery from a ready queue overflow (more actors ready at
+// once than EXECUTOR_MAX_ACTORS).
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "activeObject.h"
+#include "hostTest.h"
+
+namespace
+{
+
+constexpr size_t ACTORS = 8;
+constexpr int EVENTS_PER_ACTOR = 4000;
+
+class SeqEvent : public TypedEvent<SeqEvent, Event::Type::Dummy> {
+public:
+    explicit SeqEvent(int seq) : TypedEvent("Test"), seq(seq) {}
+    int seq;
+};
+
+class GateEvent : public TypedEvent<GateEvent, Event::Type::OnStart, Event::Priority::High> {
+public:
+    GateEvent() : TypedEvent("Test") {}
+};
+
+// Checks that its events arrive in order and never in two workers at once
+class Sequenced : public ActiveObject {
+public:
+    Sequenced(Executor& executor) : ActiveObject("Sequenced", executor, 16)
+    {
+        on<SeqEvent>([this](const SeqEvent& e) {
+            if (_running.exchange(true)) {
+                concurrent++;
+            }
+            if (e.seq != expected) {
+                outOfOrder++;
+            }
+            expected = e.seq + 1;
+            _running.store(false);
+            handled.fetch_add(1);
+        });
+    }
+
+    int expected = 0;
+    int outOfOrder = 0;
+    int concurrent = 0;
+    std::atomic<int> handled{ 0 };
+
+private:
+    std::atomic<bool> _running{ false };
+};
+
+// Blocks its worker on a GateEvent until Open()
+class Gate : public ActiveObject {
+public:
+    Gate(Executor& executor) : ActiveObject("Gate", executor, 4)
+    {
+        on<GateEvent>([this](const GateEvent&) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _closed = true;
+            _changed.notify_all();
+            _changed.wait(lock, [this] { return _open; });
+        });
+    }
+
+    void Close()
+    {
+        Post(new GateEvent());
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this] { return _closed; });
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = true;
+        _changed.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    bool _closed = false;
+    bool _open = false;
+};
+
+void orderedWithStealing()
+{
+    static Executor executor("OrderExecutor", 4096, 1, 2);
+    std::vector<Sequenced*> actors;
+    for (size_t i = 0; i < ACTORS; ++i) {
+        actors.push_back(new Sequenced(executor));
+    }
+    for (int seq = 0; seq < EVENTS_PER_ACTOR; ++seq) {
+        for (Sequenced* actor : actors) {
+            actor->Post(new SeqEvent(seq));
+        }
+    }
+    CHECK(HostTest::WaitFor([&] {
+        for (Sequenced* actor : actors) {
+            if (actor->handled.load() < EVENTS_PER_ACTOR) {
+                return false;
+            }
+        }
+        return true;
+    }));
+    for (Sequenced* actor : actors) {
+        CHECK_EQ(actor->handled.load(), EVENTS_PER_ACTOR);
+        CHECK_EQ(actor->outOfOrder, 0);
+        CHECK_EQ(actor->concurrent, 0);
+    }
+    CHECK_EQ(executor.GetOverflowCount(), 0u);
+}
+
+// One worker, blocked by the gate; EXECUTOR_MAX_ACTORS + 1 actors become
+// ready, one more than the ring holds. The one left out must run once it
+// gets another post, not be stuck with its scheduled flag set.
+void overflowRecovers()
+{
+    static Executor executor("OverflowExecutor", 4096, 1, 1);
+    static Gate gate(executor);
+    std::vector<Sequenced*> actors;
+    for (size_t i = 0; i < EXECUTOR_MAX_ACTORS + 1; ++i) {
+        actors.push_back(new Sequenced(executor));
+    }
+
+    gate.Close();
+    for (Sequenced* actor : actors) {
+        actor->Post(new SeqEvent(0));
+    }
+    CHECK_EQ(executor.GetOverflowCount(), 1u);
+    gate.Open();
+
+    Sequenced* left = actors.back();
+    CHECK(HostTest::WaitFor([&] {
+        for (size_t i = 0; i + 1 < actors.size(); ++i) {
+            if (actors[i]->handled.load() < 1) {
+                return false;
+            }
+        }
+        return true;
+    }));
+    CHECK_EQ(left->handled.load(), 0);
+
+    left->Post(new SeqEvent(1));
+    CHECK(HostTest::WaitFor([&] { return left->handled.load() == 2; }));
+    CHECK_EQ(left->outOfOrder, 0);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("8 actors, 4000 events each, in order", orderedWithStealing);
+    HostTest::Run("ready queue overflow: actor runs on the next post", overflowRecovers);
+    return HostTest::Report();
+}
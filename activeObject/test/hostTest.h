@@ -0,0 +1,81 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+/**
+ * @brief   Minimal checks for the host tests (POSIX port), no framework.
+ *
+ * A test is a plain function; CHECK() records a failure and carries on,
+ * so one run shows every broken expectation. main() calls Run() per test
+ * and returns Report(), which ctest takes as the verdict.
+ *
+ *   int main() {
+ *       HostTest::Run("lanes in priority order", testLanes);
+ *       return HostTest::Report();
+ *   }
+ */
+namespace HostTest
+{
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+inline void Fail(const char* file, int line, const char* what)
+{
+    failures()++;
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, what);
+}
+
+inline void Run(const char* name, const std::function<void()>& test)
+{
+    int before = failures();
+    test();
+    printf("%s %s\n", failures() == before ? "[ OK ]" : "[FAIL]", name);
+}
+
+inline int Report()
+{
+    if (failures() != 0) {
+        printf("%d check(s) failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+
+// Polls until done() or the timeout; for results produced by actor tasks
+inline bool WaitFor(const std::function<bool()>& done, int timeoutMs = 2000)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace HostTest
+
+#define CHECK(condition)                                            \
+    do {                                                            \
+        if (!(condition)) {                                         \
+            HostTest::Fail(__FILE__, __LINE__, #condition);         \
+        }                                                           \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                  \
+    do {                                                            \
+        if (!((actual) == (expected))) {                            \
+            HostTest::Fail(__FILE__, __LINE__, #actual " == " #expected); \
+        }                                                           \
+    } while (0)
+
+#endif // HOST_TEST_H
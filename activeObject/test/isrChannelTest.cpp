@@ -0,0 +1,160 @@
+// IsrChannel: slots raised by an "ISR" (a test thread) reach the actor in
+// order, overflow is counted instead of blocking the drain task, and a
+// stalled actor does not hold up the other channels.
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "activeObject.h"
+#include "eventPool.h"
+#include "hostTest.h"
+#include "isrChannel.h"
+
+namespace
+{
+
+constexpr uint32_t STREAM_SLOTS = 200000;
+
+class SlotEvent : public TypedEvent<SlotEvent, Event::Type::Dummy> {
+public:
+    explicit SlotEvent(uint32_t value) : TypedEvent("Test"), value(value) {}
+    uint32_t value;
+};
+
+class GateEvent : public TypedEvent<GateEvent, Event::Type::OnStart, Event::Priority::High> {
+public:
+    GateEvent() : TypedEvent("Test") {}
+};
+
+const Event* toEvent(const IsrChannel::Slot& slot, void*)
+{
+    return new SlotEvent(slot.value);
+}
+
+// Records slot values; a GateEvent blocks it until Open()
+class Consumer : public ActiveObject {
+public:
+    Consumer(const char* name, size_t queueSize)
+        : ActiveObject(name, TaskConfig{ 4096, 1, tskNO_AFFINITY }, queueSize)
+    {
+        on<SlotEvent>([this](const SlotEvent& e) {
+            if (e.value != next) {
+                outOfOrder++;
+            }
+            next = e.value + 1;
+            handled.fetch_add(1);
+        });
+        on<GateEvent>([this](const GateEvent&) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _closed = true;
+            _changed.notify_all();
+            _changed.wait(lock, [this] { return _open; });
+        });
+    }
+
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = false;
+            _open = false;
+        }
+        Post(new GateEvent());
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this] { return _closed; });
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = true;
+        _changed.notify_all();
+    }
+
+    uint32_t next = 0;
+    int outOfOrder = 0;
+    std::atomic<uint32_t> handled{ 0 };
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    bool _closed = false;
+    bool _open = false;
+};
+
+bool raise(IsrChannel& channel, uint32_t value)
+{
+    BaseType_t woken = pdFALSE;
+    return channel.Raise(value, 0, &woken);
+}
+
+uint32_t poolInUse()
+{
+    return EventPool::GetStats(EventPool::SizeClass::Small).inUse +
+           EventPool::GetStats(EventPool::SizeClass::Large).inUse;
+}
+
+// The producer retries a full ring (each refusal counts as dropped), so
+// nothing is lost
+void streamInOrder()
+{
+    static Consumer consumer("StreamConsumer", 16);
+    static IsrChannel channel("Stream", consumer, toEvent, nullptr, 64);
+    uint32_t inUse = poolInUse();
+
+    for (uint32_t value = 0; value < STREAM_SLOTS; ++value) {
+        while (!raise(channel, value)) {
+            std::this_thread::yield();
+        }
+    }
+    CHECK(HostTest::WaitFor([&] { return consumer.handled.load() == STREAM_SLOTS; }, 20000));
+    CHECK_EQ(consumer.handled.load(), STREAM_SLOTS);
+    CHECK_EQ(consumer.outOfOrder, 0);
+    CHECK_EQ(channel.Raised(), STREAM_SLOTS);
+    // The drain task never found the mailbox full
+    CHECK_EQ(consumer.GetStats().BlockedPosts(), 0u);
+    CHECK(HostTest::WaitFor([&] { return poolInUse() == inUse; }));
+}
+
+// Actor stalled: its mailbox (8) and ring (16) fill, the rest is dropped
+// and counted; nothing is lost or reordered once the actor resumes.
+// Meanwhile a second channel keeps delivering.
+void stalledActorOverflows()
+{
+    static Consumer slow("SlowConsumer", 8);
+    static Consumer other("OtherConsumer", 8);
+    static IsrChannel slowChannel("Slow", slow, toEvent, nullptr, 16);
+    static IsrChannel otherChannel("Other", other, toEvent, nullptr, 16);
+    uint32_t inUse = poolInUse();
+
+    slow.Close();
+    for (uint32_t value = 0; value < 40; ++value) {
+        raise(slowChannel, value);
+        // Let the drain task move what fits into the mailbox
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    CHECK_EQ(slowChannel.Dropped(), 16u);
+
+    for (uint32_t value = 0; value < 10; ++value) {
+        CHECK(raise(otherChannel, value));
+    }
+    CHECK(HostTest::WaitFor([&] { return other.handled.load() == 10; }));
+    CHECK_EQ(other.outOfOrder, 0);
+
+    slow.Open();
+    CHECK(HostTest::WaitFor([&] { return slow.handled.load() == 24; }));
+    CHECK_EQ(slow.handled.load(), 24u);
+    CHECK_EQ(slow.outOfOrder, 0);
+    CHECK(HostTest::WaitFor([&] { return poolInUse() == inUse; }));
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("200k slots delivered in order, pool balanced", streamInOrder);
+    HostTest::Run("stalled actor: overflow counted, other channel unaffected", stalledActorOverflows);
+    return HostTest::Report();
+}
@@ -0,0 +1,184 @@
+// Mailbox priority order as the actor sees it: a High event posted behind
+// a burst of Low events is dispatched first, for actors with their own
+// task and for executor-hosted ones, also while a chunk of Low events is
+// being drained.
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "activeObject.h"
+#include "hostTest.h"
+
+namespace
+{
+
+class HoldEvent : public TypedEvent<HoldEvent, Event::Type::OnStart, Event::Priority::High> {
+public:
+    HoldEvent() : TypedEvent("Test") {}
+};
+
+class HighEvent : public TypedEvent<HighEvent, Event::Type::SystemReset, Event::Priority::High> {
+public:
+    explicit HighEvent(int seq) : TypedEvent("Test"), seq(seq) {}
+    int seq;
+};
+
+class NormalEvent : public TypedEvent<NormalEvent, Event::Type::TimerTick, Event::Priority::Normal> {
+public:
+    explicit NormalEvent(int seq) : TypedEvent("Test"), seq(seq) {}
+    int seq;
+};
+
+class LowEvent : public TypedEvent<LowEvent, Event::Type::Dummy, Event::Priority::Low> {
+public:
+    explicit LowEvent(int seq) : TypedEvent("Test"), seq(seq) {}
+    int seq;
+};
+
+/**
+ * Logs every event as "H0", "N3", "L7", ... HoldEvent blocks the actor
+ * until Release(), so a test can queue up a backlog first. With
+ * highAfterLow set, the handler of Low event n posts a High event to the
+ * actor itself, i.e. while the rest of its chunk is pending.
+ */
+class Recorder : public ActiveObject {
+public:
+    Recorder(const char* name) : ActiveObject(name, TaskConfig{ 4096, 1, tskNO_AFFINITY }, 64) { setup(); }
+    Recorder(const char* name, Executor& executor) : ActiveObject(name, executor, 64) { setup(); }
+
+    void Hold()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _held = false;
+            _released = false;
+        }
+        Post(new HoldEvent());
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this] { return _held; });
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _released = true;
+        _changed.notify_all();
+    }
+
+    void PostHighAfterLow(int seq) { _highAfterLow = seq; }
+
+    std::vector<std::string> Wait(size_t count)
+    {
+        HostTest::WaitFor([&] {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _log.size() >= count;
+        });
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::string> log = _log;
+        _log.clear();
+        return log;
+    }
+
+private:
+    void setup()
+    {
+        on<HoldEvent>([this](const HoldEvent&) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _held = true;
+            _changed.notify_all();
+            _changed.wait(lock, [this] { return _released; });
+        });
+        on<HighEvent>([this](const HighEvent& e) { record("H", e.seq); });
+        on<NormalEvent>([this](const NormalEvent& e) { record("N", e.seq); });
+        on<LowEvent>([this](const LowEvent& e) {
+            record("L", e.seq);
+            if (e.seq == _highAfterLow) {
+                Post(new HighEvent(99));
+            }
+        });
+    }
+
+    void record(const char* lane, int seq)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _log.push_back(lane + std::to_string(seq));
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    bool _held = false;
+    bool _released = false;
+    int _highAfterLow = -1;
+    std::vector<std::string> _log;
+};
+
+std::vector<std::string> expect(std::initializer_list<const char*> items)
+{
+    return std::vector<std::string>(items.begin(), items.end());
+}
+
+void lanesInPriorityOrder(Recorder& actor)
+{
+    actor.Hold();
+    for (int i = 0; i < 5; ++i) {
+        actor.Post(new LowEvent(i));
+    }
+    for (int i = 0; i < 3; ++i) {
+        actor.Post(new NormalEvent(i));
+    }
+    actor.Post(new HighEvent(0));
+    actor.Post(new HighEvent(1));
+    actor.Release();
+
+    CHECK(actor.Wait(10) == expect({ "H0", "H1", "N0", "N1", "N2", "L0", "L1", "L2", "L3", "L4" }));
+}
+
+void highOvertakesLowBurst(Recorder& actor)
+{
+    actor.Hold();
+    for (int i = 0; i < 20; ++i) {
+        actor.Post(new LowEvent(i));
+    }
+    actor.Post(new HighEvent(0));
+    actor.Release();
+
+    std::vector<std::string> log = actor.Wait(21);
+    CHECK(!log.empty() && log[0] == "H0");
+    CHECK(log.size() == 21 && log[1] == "L0" && log[20] == "L19");
+}
+
+// The High event arrives while the Low events of the current chunk are
+// already popped; it has to go next, not after the chunk
+void highPostedDuringChunk(Recorder& actor)
+{
+    actor.PostHighAfterLow(0);
+    actor.Hold();
+    for (int i = 0; i < 12; ++i) {
+        actor.Post(new LowEvent(i));
+    }
+    actor.Release();
+
+    std::vector<std::string> log = actor.Wait(13);
+    actor.PostHighAfterLow(-1);
+    CHECK(log.size() == 13);
+    CHECK(log.size() >= 3 && log[0] == "L0" && log[1] == "H99" && log[2] == "L1");
+    CHECK(log.size() == 13 && log[12] == "L11");
+}
+
+} // namespace
+
+int main()
+{
+    static Recorder task("TaskActor");
+    static Executor executor("TestExecutor", 4096, 1, 1);
+    static Recorder hosted("HostedActor", executor);
+
+    HostTest::Run("task actor: lanes in priority order", [] { lanesInPriorityOrder(task); });
+    HostTest::Run("task actor: High overtakes a Low burst", [] { highOvertakesLowBurst(task); });
+    HostTest::Run("task actor: High posted during a chunk", [] { highPostedDuringChunk(task); });
+    HostTest::Run("executor actor: lanes in priority order", [] { lanesInPriorityOrder(hosted); });
+    HostTest::Run("executor actor: High overtakes a Low burst", [] { highOvertakesLowBurst(hosted); });
+    HostTest::Run("executor actor: High posted during a chunk", [] { highPostedDuringChunk(hosted); });
+    return HostTest::Report();
+}
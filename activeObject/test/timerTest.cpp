@@ -0,0 +1,144 @@
+// Timers on the TimerService: event references across re-arms, Reset()
+// of an expired one-shot, many timers firing once and never early, and
+// the rate of a periodic timer.
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "activeObject.h"
+#include "esp_timer.h"
+#include "hostTest.h"
+
+namespace
+{
+
+class TickEvent : public TypedEvent<TickEvent, Event::Type::TimerTick> {
+public:
+    TickEvent() : TypedEvent("Test") {}
+};
+
+class Ticked : public ActiveObject {
+public:
+    Ticked() : ActiveObject("Ticked", TaskConfig{ 4096, 1, tskNO_AFFINITY }, 8)
+    {
+        on<TickEvent>([this](const TickEvent&) { ticks.fetch_add(1); });
+    }
+
+    std::atomic<int> ticks{ 0 };
+};
+
+// Re-arming with a retained event of the owner, as the actors do with
+// their tick: the owner's reference is the only one left after Stop()
+void rearmKeepsReferenceCount()
+{
+    Timer timer("Rearm", false, [](const Event*) {});
+    const Event* tick = new TickEvent();
+    for (int i = 0; i < 100; ++i) {
+        timer.Start(1000, tick->Retain());
+    }
+    CHECK(tick->IsShared());
+    timer.Stop();
+    CHECK(!tick->IsShared());
+    tick->Release();
+}
+
+// Expiries in between: each posts a reference, the entry keeps its own
+void expiriesKeepReferenceCount()
+{
+    static Ticked actor;
+    Timer timer("Expiring", false, actor);
+    const Event* tick = new TickEvent();
+    for (int i = 1; i <= 5; ++i) {
+        timer.Start(2, tick->Retain());
+        CHECK(HostTest::WaitFor([&] { return actor.ticks.load() == i; }));
+    }
+    timer.Stop();
+    CHECK(HostTest::WaitFor([&] { return !tick->IsShared(); }));
+    tick->Release();
+}
+
+void resetAfterOneShotFired()
+{
+    static Ticked actor;
+    Timer timer("OneShot", false, actor);
+    timer.Start(5, new TickEvent());
+    CHECK(HostTest::WaitFor([&] { return actor.ticks.load() == 1; }));
+    CHECK(!timer.IsActive());
+
+    timer.Reset();
+    CHECK(timer.IsActive());
+    CHECK(HostTest::WaitFor([&] { return actor.ticks.load() == 2; }));
+}
+
+// 500 one-shots over the first two wheels: each fires exactly once, not
+// before its delay (less the partial tick the start fell into)
+void manyTimersFireOnceNeverEarly()
+{
+    constexpr int TIMERS = 500;
+    struct Probe {
+        int64_t due;
+        std::atomic<int> fired{ 0 };
+        std::atomic<int> early{ 0 };
+    };
+    std::vector<std::unique_ptr<Probe>> probes;
+    std::vector<std::unique_ptr<Timer>> timers;
+    srand(12);
+    for (int i = 0; i < TIMERS; ++i) {
+        probes.emplace_back(new Probe());
+        Probe* probe = probes.back().get();
+        timers.emplace_back(new Timer("Probe", false, [probe](const Event*) {
+            if (esp_timer_get_time() < probe->due) {
+                probe->early.fetch_add(1);
+            }
+            probe->fired.fetch_add(1);
+        }));
+        uint32_t delayMs = 1 + rand() % 300;
+        probe->due = esp_timer_get_time() + (delayMs - 1) * 1000;
+        timers.back()->Start(delayMs, new TickEvent());
+    }
+
+    CHECK(HostTest::WaitFor([&] {
+        for (auto& probe : probes) {
+            if (probe->fired.load() == 0) {
+                return false;
+            }
+        }
+        return true;
+    }));
+    // Nothing fires twice afterwards either
+    vTaskDelay(pdMS_TO_TICKS(50));
+    int once = 0;
+    int early = 0;
+    for (auto& probe : probes) {
+        once += probe->fired.load() == 1;
+        early += probe->early.load();
+    }
+    CHECK_EQ(once, TIMERS);
+    CHECK_EQ(early, 0);
+    CHECK_EQ(TimerService::Instance().ActiveCount(), 0u);
+}
+
+void periodicRate()
+{
+    std::atomic<int> fired{ 0 };
+    Timer timer("Periodic", true, [&](const Event*) { fired.fetch_add(1); });
+    timer.Start(10, new TickEvent());
+    vTaskDelay(pdMS_TO_TICKS(505));
+    timer.Stop();
+    int count = fired.load();
+    CHECK(count >= 48 && count <= 51);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("re-arm with a retained event keeps the count", rearmKeepsReferenceCount);
+    HostTest::Run("one-shot expiries keep the count", expiriesKeepReferenceCount);
+    HostTest::Run("Reset() after a one-shot fired posts again", resetAfterOneShotFired);
+    HostTest::Run("500 timers fire once, none early", manyTimersFireOnceNeverEarly);
+    HostTest::Run("periodic 10 ms: 50 expiries in 505 ms", periodicRate);
+    return HostTest::Report();
+}
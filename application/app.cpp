@@ -9,12 +9,22 @@
 
 #include "button.h"
 #include "led.h"
+#include "sensors.h"
+#include "historyLogger.h"
+#include "rollupService.h"
 #include "wifi.h"
+#include "telemetry.h"
+#include "seriesPublisher.h"
 
 static const char* TAG = "App";
 
 namespace App {
 
+// Rote LED: 2 s an, 2 s aus, rund um die Uhr (läuft im LEDC/esp_timer,
+// ohne Event pro Flanke)
+const LED::LedStep RED_BLINK_STEPS[] = { { 255, 0, 2000 }, { 0, 0, 2000 } };
+const LED::LedPattern RedBlink = LED::MakePattern(RED_BLINK_STEPS, 0, "red_blink");
+
 enum class State {
     INIT,
     IDLE,
@@ -22,15 +32,16 @@ enum class State {
 };
 
 // Event-Handler für Button-Events
-void handleButtonEvent(ButtonClicked* buttonEvent, LED::LedActor& greenLed, LED::LedActor& blueLed) {
-    int buttonId = buttonEvent->getID();
-    auto actionType = buttonEvent->getActionType();
+void handleButtonEvent(const ButtonClicked& buttonEvent, LED::LedActor& greenLed, LED::LedActor& blueLed) {
+    int buttonId = buttonEvent.getID();
+    auto actionType = buttonEvent.getActionType();
     
     // Log Button-Aktion mit mehr Details
     ESP_LOGI(TAG, "Button %d %s pressed (GPIO %d)", buttonId, 
              actionType == ButtonClicked::ActionType::SINGLE ? "SINGLE" : 
              actionType == ButtonClicked::ActionType::DOUBLE ? "DOUBLE" : 
-             actionType == ButtonClicked::ActionType::LONG ? "LONG" : "UNKNOWN", 
+             actionType == ButtonClicked::ActionType::LONG ? "LONG" :
+             actionType == ButtonClicked::ActionType::HOLD ? "HOLD" : "UNKNOWN", 
              buttonId);
     
     // Für einen einfachen Druck (SHORT PRESS) - Grüne LED blinken
@@ -48,63 +59,94 @@ void handleButtonEvent(ButtonClicked* buttonEvent, LED::LedActor& greenLed, LED:
         blueLed.Post(new LedControlEvent(LedMode::BLINK_SLOW, "ButtonHandler"));
         ESP_LOGI(TAG, "Blue LED blinking on button %d DOUBLE press", buttonId);
     }
+
+    // Langer Druck (LONG PRESS) - beide LEDs atmen gedimmt
+    else if (actionType == ButtonClicked::ActionType::LONG) {
+        greenLed.Post(new LED::LedPatternEvent(LED::Patterns::Breathe, 128, "ButtonHandler"));
+        blueLed.Post(new LED::LedPatternEvent(LED::Patterns::Heartbeat, 64, "ButtonHandler"));
+        ESP_LOGI(TAG, "Green/blue LED patterns on button %d LONG press", buttonId);
+    }
 }
 
 void AppStart() 
 {
     static WiFiActor wifi;
 
-    static ButtonActor button1(GPIO_NUM_1);
-    static ButtonActor button2(GPIO_NUM_2);
-    static ButtonActor button3(GPIO_NUM_3);
+    // One actor serves all buttons; events carry the GPIO number as id
+    static ButtonActor buttons{ GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3 };
 
     static LED::LedActor led1(GPIO_NUM_11);  // Rot
     static LED::LedActor led2(GPIO_NUM_12);  // Grün 
     static LED::LedActor led3(GPIO_NUM_13);  // Blau
 
-    // Timer für die rote LED (blinkt kontinuierlich)
-    static Timer blinkTimer("BlinkTimer", true, [&](Event* e) {
-        static bool ledState = false;
-        ledState = !ledState;
-        if (ledState) {
-            led1.Post(new LedControlEvent(LedMode::ON, "BlinkTimer"));
-        } else {
-            led1.Post(new LedControlEvent(LedMode::OFF, "BlinkTimer"));
-        }
-    }, 0);
+    // Kapazitiver Füllstandssensor an GPIO 4 (ADC1 Kanal 3)
+    Sensors::LevelSensor::Config levelConfig;
+    levelConfig.channel = ADC_CHANNEL_3;
+    static Sensors::LevelSensor level(levelConfig);
+
+    // Durchflusssensor an GPIO 5 (Pumpenüberwachung)
+    Sensors::FlowSensor::Config flowConfig;
+    flowConfig.pin = GPIO_NUM_5;
+    static Sensors::FlowSensor flow(flowConfig);
+
+    // DS18B20-Temperaturfühler an GPIO 6 (1-Wire, beliebig viele)
+    Sensors::TemperatureSensor::Config temperatureConfig;
+    temperatureConfig.pin = GPIO_NUM_6;
+    static Sensors::TemperatureSensor temperature(temperatureConfig);
+
+    // Messwertverlauf im Flash (Partition "history")
+    static Storage::HistoryLogger history;
+    // Laufende Statistiken (1 s .. 1 h) für Anzeige und Home Assistant
+    static Storage::RollupService rollup;
+    // Alle 10 s ein Snapshot aller Sensoren an den MQTT-Broker
+    static TelemetryPublisher telemetry(wifi.Comm());
+    // Jeder einzelne Messwert, minütlich gebündelt und komprimiert (CBOR)
+    static SeriesPublisher samples(wifi.Comm());
 
     // Eventbus-Abonnement für Button-Events
     ESP_LOGI(TAG, "Subscribing to ButtonClicked events");
-    EventBus::get().subscribe(Event::Type::ButtonClicked, [&](const Event* event) {
+    EventBus::get().subscribe<ButtonClicked>([&](const ButtonClicked& buttonEvent) {
         ESP_LOGI(TAG, "Received ButtonClicked event");
-        // Button-Event empfangen
-        const ButtonClicked* buttonEvent = static_cast<const ButtonClicked*>(event);
         // Event-Handler aufrufen
-        handleButtonEvent(const_cast<ButtonClicked*>(buttonEvent), led2, led3);
+        handleButtonEvent(buttonEvent, led2, led3);
     });
 
     wifi.Configure("MySSID", "MyPassword");
 
+    WiFiComm::Config mqttConfig;
+    mqttConfig.host = "192.168.1.10";
+    wifi.ConfigureMqtt(mqttConfig);
+
     vTaskDelay(pdMS_TO_TICKS(100));
 
     wifi.Start();     
     vTaskDelay(pdMS_TO_TICKS(5));
 
-    button1.Start();  
-    vTaskDelay(pdMS_TO_TICKS(5));
-    button2.Start();  
-    vTaskDelay(pdMS_TO_TICKS(5));
-    button3.Start();  
+    buttons.Start();
     vTaskDelay(pdMS_TO_TICKS(5));
 
+    history.Start();
+    history.Post(new OnStart("App"));
+    rollup.Start();
+    rollup.Post(new OnStart("App"));
+    telemetry.Start();
+    telemetry.Post(new OnStart("App"));
+    samples.Start();
+    samples.Post(new OnStart("App"));
+
     led1.Start();
     led2.Start();
     led3.Start();
+    level.Start();
+    flow.Start();
+    temperature.Start();
 
-    // Direkt den Wert in Millisekunden übergeben, nicht in Ticks
-    blinkTimer.Start(2000);
+    led1.Post(new LED::LedPatternEvent(RedBlink, 255, "App"));
 
     wifi.Post(new OnStart("App"));
+    level.Post(new OnStart("App"));
+    flow.Post(new OnStart("App"));
+    temperature.Post(new OnStart("App"));
 }
 
 } // namespace App
\ No newline at end of file
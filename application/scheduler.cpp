@@ -0,0 +1,241 @@
+#include "scheduler.h"
+#include <algorithm>
+#include <functional>
+#include <sys/time.h>
+#include <time.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "Scheduler";
+
+static constexpr uint32_t DAY_MS = 24u * 60u * 60u * 1000u;
+
+Scheduler::Window Scheduler::Window::Daily(int startHour, int startMinute, int endHour, int endMinute) {
+    return Window{ static_cast<uint32_t>((startHour * 60 + startMinute) * 60000) % DAY_MS,
+                   static_cast<uint32_t>((endHour * 60 + endMinute) * 60000) % DAY_MS };
+}
+
+Scheduler::Scheduler()
+    : ActiveObject("Scheduler", Executor::Shared(), 4),
+      _tick(new SchedulerTickEvent()),
+      _lock(xSemaphoreCreateMutex()),
+      _dropped(0) {
+    on<SchedulerTickEvent>([this](const SchedulerTickEvent&) { onTick(); });
+    // A tick only asks for a re-evaluation, one pending is enough
+    coalesce<SchedulerTickEvent>(Mailbox::Coalesce::ReplaceLatest);
+}
+
+Scheduler& Scheduler::get() {
+    static Scheduler instance;
+    return instance;
+}
+
+Scheduler::ScheduleId Scheduler::AddCycle(ActiveObject& target, std::chrono::seconds on, std::chrono::seconds off,
+                                          const Event* onEvent, const Event* offEvent, Window window) {
+    if (on.count() <= 0 || off.count() < 0) {
+        ESP_LOGE(TAG, "Invalid cycle for %s", target.getName().c_str());
+        if (onEvent != nullptr) onEvent->Release();
+        if (offEvent != nullptr) offEvent->Release();
+        return INVALID_SCHEDULE;
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    size_t id = 0;
+    while (id < _schedules.size() && _schedules[id].used) {
+        ++id;
+    }
+    if (id == INVALID_SCHEDULE) {
+        xSemaphoreGive(_lock);
+        ESP_LOGE(TAG, "Too many schedules");
+        if (onEvent != nullptr) onEvent->Release();
+        if (offEvent != nullptr) offEvent->Release();
+        return INVALID_SCHEDULE;
+    }
+    if (id == _schedules.size()) {
+        _schedules.push_back(Schedule{});
+    }
+
+    Schedule& schedule = _schedules[id];
+    schedule.target = &target;
+    schedule.onEvent = onEvent;
+    schedule.offEvent = offEvent;
+    schedule.onMs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(on).count());
+    schedule.offMs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(off).count());
+    schedule.window = window;
+    schedule.state = -1;
+    schedule.used = true;
+    // Due now: the first evaluation posts the current state
+    push(Deadline{ 0, static_cast<ScheduleId>(id), schedule.generation });
+    xSemaphoreGive(_lock);
+
+    wakeUp();
+    return static_cast<ScheduleId>(id);
+}
+
+Scheduler::ScheduleId Scheduler::AddWindow(ActiveObject& target, Window window,
+                                           const Event* onEvent, const Event* offEvent) {
+    return AddCycle(target, std::chrono::hours(24), std::chrono::seconds(0), onEvent, offEvent, window);
+}
+
+bool Scheduler::Remove(ScheduleId id) {
+    const Event* onEvent = nullptr;
+    const Event* offEvent = nullptr;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool found = id < _schedules.size() && _schedules[id].used;
+    if (found) {
+        Schedule& schedule = _schedules[id];
+        onEvent = schedule.onEvent;
+        offEvent = schedule.offEvent;
+        schedule.onEvent = schedule.offEvent = nullptr;
+        schedule.used = false;
+        schedule.generation++;
+    }
+    xSemaphoreGive(_lock);
+
+    if (onEvent != nullptr) onEvent->Release();
+    if (offEvent != nullptr) offEvent->Release();
+    return found;
+}
+
+void Scheduler::Resync() {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _heap.clear();
+    for (size_t id = 0; id < _schedules.size(); ++id) {
+        if (_schedules[id].used) {
+            push(Deadline{ 0, static_cast<ScheduleId>(id), _schedules[id].generation });
+        }
+    }
+    xSemaphoreGive(_lock);
+
+    wakeUp();
+}
+
+size_t Scheduler::Count() const {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    size_t count = std::count_if(_schedules.begin(), _schedules.end(),
+                                 [](const Schedule& schedule) { return schedule.used; });
+    xSemaphoreGive(_lock);
+    return count;
+}
+
+uint32_t Scheduler::Dropped() const {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint32_t dropped = _dropped;
+    xSemaphoreGive(_lock);
+    return dropped;
+}
+
+void Scheduler::push(const Deadline& deadline) {
+    _heap.push_back(deadline);
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<Deadline>());
+}
+
+void Scheduler::wakeUp() {
+    Post(_tick->Retain());
+}
+
+uint32_t Scheduler::localMsOfDay() {
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    time_t seconds = now.tv_sec;
+    struct tm local;
+    localtime_r(&seconds, &local);
+    return static_cast<uint32_t>((local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec) * 1000 +
+                                 now.tv_usec / 1000) % DAY_MS;
+}
+
+// State of the schedule at msOfDay and the time (ms, at least 1) until it
+// next changes or the window opens / closes.
+uint32_t Scheduler::evaluate(const Schedule& schedule, uint32_t msOfDay, bool* on) {
+    const Window& window = schedule.window;
+    uint32_t length = (window.endMs + DAY_MS - window.startMs) % DAY_MS;
+    if (length == 0) {
+        length = DAY_MS;
+    }
+    uint32_t sinceStart = (msOfDay + DAY_MS - window.startMs) % DAY_MS;
+
+    uint32_t delta;
+    if (sinceStart >= length) {
+        *on = false;
+        delta = DAY_MS - sinceStart;
+    } else if (schedule.offMs == 0) {
+        *on = true;
+        delta = length - sinceStart;
+    } else {
+        uint32_t period = schedule.onMs + schedule.offMs;
+        uint32_t phase = sinceStart % period;
+        *on = phase < schedule.onMs;
+        delta = std::min(*on ? schedule.onMs - phase : period - phase, length - sinceStart);
+    }
+    return std::max<uint32_t>(delta, 1);
+}
+
+void Scheduler::onTick() {
+    int64_t nowUs = esp_timer_get_time();
+    uint32_t msOfDay = localMsOfDay();
+    Transition edges[EDGES_PER_PASS];
+    size_t count = 0;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    while (count < EDGES_PER_PASS && !_heap.empty() && _heap.front().atUs <= nowUs) {
+        Deadline due = _heap.front();
+        std::pop_heap(_heap.begin(), _heap.end(), std::greater<Deadline>());
+        _heap.pop_back();
+
+        Schedule& schedule = _schedules[due.id];
+        if (!schedule.used || schedule.generation != due.generation) continue;
+
+        bool on = false;
+        uint32_t delta = evaluate(schedule, msOfDay, &on);
+        if (schedule.state != static_cast<int8_t>(on)) {
+            schedule.state = static_cast<int8_t>(on);
+            const Event* event = on ? schedule.onEvent : schedule.offEvent;
+            if (event != nullptr) {
+                edges[count++] = Transition{ schedule.target, event->Retain(), due.id, due.generation };
+            }
+        }
+        push(Deadline{ nowUs + static_cast<int64_t>(delta) * 1000, due.id, due.generation });
+    }
+    xSemaphoreGive(_lock);
+
+    // Never wait on a full mailbox, other actors share this worker
+    size_t dropped = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (edges[i].target->TryPost(edges[i].event) != pdPASS) {
+            edges[dropped++] = edges[i];
+        }
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t i = 0; i < dropped; ++i) {
+        Schedule& schedule = _schedules[edges[i].id];
+        ESP_LOGW(TAG, "%s: mailbox full, edge retried in %u ms", edges[i].target->getName().c_str(),
+                 (unsigned)RETRY_MS);
+        _dropped++;
+        if (!schedule.used || schedule.generation != edges[i].generation) continue;
+        // Unknown state and a new generation: the retry posts whatever is
+        // due then, the old deadline is skipped
+        schedule.state = -1;
+        schedule.generation++;
+        push(Deadline{ nowUs + static_cast<int64_t>(RETRY_MS) * 1000, edges[i].id, schedule.generation });
+    }
+    bool more = !_heap.empty() && _heap.front().atUs <= nowUs;
+    int64_t nextUs = _heap.empty() ? -1 : _heap.front().atUs;
+    xSemaphoreGive(_lock);
+
+    if (more) {
+        // More edges due than fit one pass: the rest in the next one
+        TryPost(_tick->Retain());
+        return;
+    }
+    if (nextUs < 0) {
+        _timer.Stop();
+        return;
+    }
+    // Round up, waking early would only cost an extra pass
+    TickType_t waitMs = static_cast<TickType_t>((nextUs - nowUs + 999) / 1000);
+    _timer.Start(waitMs, _tick->Retain());
+    ESP_LOGD(TAG, "%u edges posted, next in %u ms", (unsigned)(count - dropped), (unsigned)waitMs);
+}
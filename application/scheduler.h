@@ -0,0 +1,122 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "activeObject.h"
+#include "events.h"
+
+/**
+ * @brief   Deadline-ordered on/off scheduler for lights and pumps.
+ *
+ * Every schedule switches one target actor between ON and OFF by posting
+ * its own on/off event: a duty cycle (on for `on`, off for `off`) that
+ * runs inside a daily time-of-day window and is OFF outside of it. The
+ * cycle restarts at the window start every day.
+ *
+ * The next transition of every schedule sits in a min-heap, so the
+ * scheduler sleeps on a single timer until the earliest edge and finds
+ * the next one in O(log n) - no polling, however many zones and pumps.
+ * A schedule's state is recomputed from the local time of day at each of
+ * its edges, so a missed or late wakeup never leaves an output stuck.
+ *
+ * The time of day comes from the system clock; until SNTP sets it, it
+ * counts from boot (boot is midnight). Call Resync() after the clock was
+ * set or changed.
+ *
+ * The scheduler runs on a shared executor worker, so it never blocks on
+ * a target: edges go out with TryPost(), at most EDGES_PER_PASS per pass.
+ * An edge that finds the target's mailbox full is counted in Dropped()
+ * and its schedule is evaluated again RETRY_MS later.
+ */
+class Scheduler : public ActiveObject {
+public:
+    using ScheduleId = uint16_t;
+    static constexpr ScheduleId INVALID_SCHEDULE = 0xFFFF;
+
+    // Daily time-of-day window; end before start wraps over midnight
+    struct Window {
+        uint32_t startMs;
+        uint32_t endMs;
+
+        static Window AllDay() { return Window{ 0, 0 }; }
+        static Window Daily(int startHour, int startMinute, int endHour, int endMinute);
+    };
+
+    static Scheduler& get();
+
+    // Takes over one reference of onEvent and offEvent, which are posted
+    // with Retain() on every edge. off == 0 keeps the target on for the
+    // whole window.
+    ScheduleId AddCycle(ActiveObject& target, std::chrono::seconds on, std::chrono::seconds off,
+                        const Event* onEvent, const Event* offEvent, Window window = Window::AllDay());
+    // On for the whole window, off outside of it (e.g. a grow light photoperiod)
+    ScheduleId AddWindow(ActiveObject& target, Window window, const Event* onEvent, const Event* offEvent);
+    // The target keeps its last state
+    bool Remove(ScheduleId id);
+
+    // Re-evaluate all schedules now, e.g. after the wall clock was set
+    void Resync();
+
+    size_t Count() const;
+    // Edges not delivered because the target's mailbox was full
+    uint32_t Dropped() const;
+
+private:
+    static constexpr size_t EDGES_PER_PASS = 8;
+    static constexpr uint32_t RETRY_MS = 100;
+
+    Scheduler();
+
+    struct Schedule {
+        ActiveObject* target;
+        const Event* onEvent;
+        const Event* offEvent;
+        uint32_t onMs;
+        uint32_t offMs;
+        Window window;
+        uint16_t generation;    // bumped on Remove() and on a dropped edge, stale heap entries are skipped
+        int8_t state;           // -1 unknown, 0 off, 1 on
+        bool used;
+    };
+
+    struct Deadline {
+        int64_t atUs;           // esp_timer time of the next edge
+        ScheduleId id;
+        uint16_t generation;
+
+        bool operator>(const Deadline& other) const { return atUs > other.atUs; }
+    };
+
+    // Edge to post once the lock is released
+    struct Transition {
+        ActiveObject* target;
+        const Event* event;
+        ScheduleId id;
+        uint16_t generation;
+    };
+
+    static uint32_t localMsOfDay();
+    static uint32_t evaluate(const Schedule& schedule, uint32_t msOfDay, bool* on);
+
+    void onTick();
+    void push(const Deadline& deadline);
+    void wakeUp();
+
+    std::vector<Schedule> _schedules;
+    std::vector<Deadline> _heap;
+    const Event* _tick;
+    SemaphoreHandle_t _lock;
+    uint32_t _dropped;
+};
+
+class SchedulerTickEvent : public TypedEvent<SchedulerTickEvent, Event::Type::TimerTick> {
+public:
+    SchedulerTickEvent() : TypedEvent("Scheduler") {}
+};
+
+#endif // SCHEDULER_H
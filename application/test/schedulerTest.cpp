@@ -0,0 +1,266 @@
+// Scheduler edges as a target actor sees them: duty cycle timing, windows
+// that open and close around the current time of day, deadlines of many
+// schedules in order, Remove(), and an edge that finds the target's
+// mailbox full (dropped, counted, retried). Runs in UTC against the real
+// clock, so it takes a few seconds.
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <sys/time.h>
+#include <time.h>
+#include <vector>
+
+#include "esp_timer.h"
+#include "hostTest.h"
+#include "scheduler.h"
+
+namespace
+{
+
+constexpr uint32_t DAY_MS = 24u * 60u * 60u * 1000u;
+// Wakeup latency allowed per edge
+constexpr int64_t SLACK_MS = 30;
+
+class SwitchEvent : public TypedEvent<SwitchEvent, Event::Type::Dummy> {
+public:
+    SwitchEvent(int id, bool on) : TypedEvent("Test"), id(id), on(on) {}
+    int id;
+    bool on;
+};
+
+struct Edge {
+    int id;
+    bool on;
+    int64_t atMs;
+};
+
+class Switch : public ActiveObject {
+public:
+    Switch() : ActiveObject("Switch", TaskConfig{ 4096, 1, tskNO_AFFINITY }, 32)
+    {
+        on<SwitchEvent>([this](const SwitchEvent& e) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _edges.push_back(Edge{ e.id, e.on, esp_timer_get_time() / 1000 });
+        });
+    }
+
+    std::vector<Edge> Wait(size_t count, int timeoutMs)
+    {
+        HostTest::WaitFor([&] {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _edges.size() >= count;
+        }, timeoutMs);
+        return Take();
+    }
+
+    std::vector<Edge> Take()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<Edge> edges = _edges;
+        _edges.clear();
+        return edges;
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<Edge> _edges;
+};
+
+Switch& target()
+{
+    static Switch instance;
+    return instance;
+}
+
+// One mailbox slot; the handler holds the first event until Release()
+class Stuck : public ActiveObject {
+public:
+    Stuck() : ActiveObject("Stuck", TaskConfig{ 4096, 1, tskNO_AFFINITY }, 1)
+    {
+        on<SwitchEvent>([this](const SwitchEvent& e) {
+            _held = true;
+            while (!_released) {
+                vTaskDelay(1);
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            _edges.push_back(Edge{ e.id, e.on, esp_timer_get_time() / 1000 });
+        });
+    }
+
+    bool Held() const { return _held; }
+    void Release() { _released = true; }
+
+    std::vector<Edge> Wait(size_t count, int timeoutMs)
+    {
+        HostTest::WaitFor([&] {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _edges.size() >= count;
+        }, timeoutMs);
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _edges;
+    }
+
+private:
+    std::atomic<bool> _held{ false };
+    std::atomic<bool> _released{ false };
+    std::mutex _mutex;
+    std::vector<Edge> _edges;
+};
+
+uint32_t msOfDay()
+{
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return static_cast<uint32_t>((now.tv_sec % 86400) * 1000 + now.tv_usec / 1000);
+}
+
+// Window from now + fromMs to now + toMs (may be negative)
+Scheduler::Window around(int64_t fromMs, int64_t toMs)
+{
+    int64_t now = msOfDay();
+    return Scheduler::Window{ static_cast<uint32_t>((now + fromMs + DAY_MS) % DAY_MS),
+                              static_cast<uint32_t>((now + toMs + DAY_MS) % DAY_MS) };
+}
+
+Scheduler::ScheduleId addCycle(int id, int onSeconds, int offSeconds, Scheduler::Window window)
+{
+    return Scheduler::get().AddCycle(target(), std::chrono::seconds(onSeconds), std::chrono::seconds(offSeconds),
+                                     new SwitchEvent(id, true), new SwitchEvent(id, false), window);
+}
+
+// 1 s on / 1 s off: the current state right away, then a flip every second
+void cycleTogglesOnTime()
+{
+    Scheduler::ScheduleId id = addCycle(1, 1, 1, Scheduler::Window::AllDay());
+    std::vector<Edge> edges = target().Wait(4, 5000);
+    Scheduler::get().Remove(id);
+
+    CHECK_EQ(edges.size(), 4u);
+    for (size_t i = 1; i < edges.size(); ++i) {
+        CHECK(edges[i].on != edges[i - 1].on);
+        if (i >= 2) {
+            int64_t interval = edges[i].atMs - edges[i - 1].atMs;
+            CHECK(interval >= 1000 - SLACK_MS && interval <= 1000 + SLACK_MS);
+        }
+    }
+}
+
+// Open since a second, closes in 1.5 s: on now, off at the window end
+void windowAroundNow()
+{
+    int64_t start = esp_timer_get_time() / 1000;
+    Scheduler::ScheduleId id = Scheduler::get().AddWindow(target(), around(-1000, 1500), new SwitchEvent(2, true),
+                                                          new SwitchEvent(2, false));
+    std::vector<Edge> edges = target().Wait(2, 3000);
+    Scheduler::get().Remove(id);
+
+    CHECK_EQ(edges.size(), 2u);
+    if (edges.size() == 2) {
+        CHECK(edges[0].on && edges[0].atMs - start <= SLACK_MS);
+        CHECK(!edges[1].on);
+        int64_t closedAfter = edges[1].atMs - start;
+        CHECK(closedAfter >= 1500 - SLACK_MS && closedAfter <= 1500 + SLACK_MS);
+    }
+}
+
+void windowExcludingNow()
+{
+    Scheduler::ScheduleId id = Scheduler::get().AddWindow(target(), around(60000, 120000), new SwitchEvent(3, true),
+                                                          new SwitchEvent(3, false));
+    std::vector<Edge> edges = target().Wait(1, 1000);
+    CHECK_EQ(edges.size(), 1u);
+    CHECK(edges.size() == 1 && !edges[0].on);
+    CHECK(Scheduler::get().Remove(id));
+}
+
+// Twenty windows closing 50 ms apart, added in reverse: the off edges
+// come out of the heap in deadline order
+void deadlinesInOrder()
+{
+    constexpr int SCHEDULES = 20;
+    std::vector<Scheduler::ScheduleId> ids;
+    for (int i = SCHEDULES - 1; i >= 0; --i) {
+        ids.push_back(Scheduler::get().AddWindow(target(), around(-1000, 300 + 50 * i), new SwitchEvent(i, true),
+                                                 new SwitchEvent(i, false)));
+    }
+    CHECK_EQ(Scheduler::get().Count(), static_cast<size_t>(SCHEDULES));
+    std::vector<Edge> edges = target().Wait(2 * SCHEDULES, 3000);
+    for (Scheduler::ScheduleId id : ids) {
+        Scheduler::get().Remove(id);
+    }
+
+    std::vector<int> offOrder;
+    for (const Edge& edge : edges) {
+        if (!edge.on) {
+            offOrder.push_back(edge.id);
+        }
+    }
+    CHECK_EQ(offOrder.size(), static_cast<size_t>(SCHEDULES));
+    for (size_t i = 0; i < offOrder.size(); ++i) {
+        CHECK_EQ(offOrder[i], static_cast<int>(i));
+    }
+}
+
+void removeStopsEdges()
+{
+    Scheduler::ScheduleId id = addCycle(4, 1, 1, Scheduler::Window::AllDay());
+    CHECK_EQ(target().Wait(1, 1000).size(), 1u);
+    CHECK(Scheduler::get().Remove(id));
+    CHECK(!Scheduler::get().Remove(id));
+    CHECK_EQ(Scheduler::get().Count(), 0u);
+
+    vTaskDelay(pdMS_TO_TICKS(2500));
+    CHECK(target().Take().empty());
+}
+
+// The target's handler is busy and its mailbox full: the edge is dropped
+// without blocking the scheduler, counted, and delivered RETRY_MS later
+void fullMailboxRetried()
+{
+    static Stuck stuck;
+    stuck.Post(new SwitchEvent(10, true));
+    CHECK(HostTest::WaitFor([] { return stuck.Held(); }, 1000));
+    stuck.Post(new SwitchEvent(11, true));
+
+    uint32_t dropped = Scheduler::get().Dropped();
+    Scheduler::ScheduleId id = Scheduler::get().AddWindow(stuck, Scheduler::Window::AllDay(),
+                                                          new SwitchEvent(12, true), new SwitchEvent(12, false));
+    CHECK(HostTest::WaitFor([&] { return Scheduler::get().Dropped() > dropped; }, 1000));
+    int64_t droppedAt = esp_timer_get_time() / 1000;
+
+    // Other targets still get their edges meanwhile
+    Scheduler::ScheduleId other = Scheduler::get().AddWindow(target(), Scheduler::Window::AllDay(),
+                                                             new SwitchEvent(13, true), new SwitchEvent(13, false));
+    std::vector<Edge> edges = target().Wait(1, 1000);
+    CHECK(edges.size() == 1 && edges[0].id == 13 && edges[0].on);
+
+    stuck.Release();
+    edges = stuck.Wait(3, 2000);
+    Scheduler::get().Remove(id);
+    Scheduler::get().Remove(other);
+
+    CHECK_EQ(edges.size(), 3u);
+    if (edges.size() == 3) {
+        CHECK(edges[0].id == 10 && edges[1].id == 11);
+        CHECK(edges[2].id == 12 && edges[2].on);
+        CHECK(edges[2].atMs - droppedAt >= 100 - SLACK_MS);
+    }
+    CHECK_EQ(Scheduler::get().Dropped(), dropped + 1);
+}
+
+} // namespace
+
+int main()
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    HostTest::Run("1 s / 1 s cycle toggles on time", cycleTogglesOnTime);
+    HostTest::Run("window around now: on, off at its end", windowAroundNow);
+    HostTest::Run("window excluding now: off", windowExcludingNow);
+    HostTest::Run("20 schedules: edges in deadline order", deadlinesInOrder);
+    HostTest::Run("Remove() stops the edges", removeStopsEdges);
+    HostTest::Run("full target mailbox: edge dropped, counted, retried", fullMailboxRetried);
+    return HostTest::Report();
+}
@@ -2,24 +2,50 @@
 #include "events.h"
 #include "eventBus.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
-#include <string.h> // Using C-style header instead of cstring
 
 static const char* TAG = "Button";
 
-ButtonActor::ButtonActor(gpio_num_t pin)
-    : ActiveObject("Button", 4096, 10),
-      _pin(pin),
-      _pressTick(0),
-      _waitingRelease(false),
-      _clickCount(0),
-      _lastClickTick(0),
-      _eventPending(false),
-      _buttonPressed(false),
-      _deferredAction(ActionType::NONE)
+// Wrap-safe comparison of 32 bit microsecond timestamps
+static inline int32_t elapsedUs(uint32_t nowUs, uint32_t sinceUs) {
+    return static_cast<int32_t>(nowUs - sinceUs);
+}
+
+static inline uint32_t nowUs32() {
+    return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+ButtonActor::ButtonActor(std::initializer_list<gpio_num_t> pins)
+    : ActiveObject("Button", Executor::Shared(), 16),
+      _buttons{},
+      _buttonCount(0),
+      _edges("button", *this, toEdgeEvent, nullptr, 32),
+      _tick(new ButtonTimerEvent())
+{
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+
+    on<ButtonEdgeEvent>([this](const ButtonEdgeEvent& e) {
+        onEdge(static_cast<size_t>(e.getID()), e.getTimeUs());
+    });
+    on<ButtonTimerEvent>([this](const ButtonTimerEvent&) {
+        onDeadline();
+    });
+    // A deadline only asks for a re-evaluation, one pending is enough
+    coalesce<ButtonTimerEvent>(Mailbox::Coalesce::ReplaceLatest);
+
+    for (gpio_num_t pin : pins) {
+        AddButton(pin);
+    }
+}
+
+bool ButtonActor::AddButton(gpio_num_t pin)
 {
+    if (_buttonCount >= _buttons.size()) {
+        ESP_LOGE(TAG, "No slot left for GPIO %d (BUTTON_MAX_PINS %d)", (int)pin, BUTTON_MAX_PINS);
+        return false;
+    }
+
     gpio_config_t io_conf = {};
     io_conf.intr_type = GPIO_INTR_ANYEDGE;
     io_conf.mode = GPIO_MODE_INPUT;
@@ -27,142 +53,178 @@ ButtonActor::ButtonActor(gpio_num_t pin)
     io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
     gpio_config(&io_conf);
 
-    esp_log_level_set(TAG, ESP_LOG_INFO); // Erhöhe Log-Level auf INFO
-
-    // Log Button-Initialisierung
-    ESP_LOGI(TAG, "Button initialized on GPIO %d", pin);
+    // Zero-initialized with the actor, each slot is used once
+    Button& button = _buttons[_buttonCount];
+    button.owner = this;
+    button.pin = pin;
+    // Starts released: a button held at boot settles back to released
+    // on its first edge without reporting anything
 
-    // ISR einrichten
     esp_err_t err = gpio_install_isr_service(0);
-    if (err == ESP_OK || err == ESP_ERR_INVALID_STATE) { // INVALID_STATE bedeutet bereits installiert
-        ESP_LOGI(TAG, "ISR service setup: %s", (err == ESP_OK) ? "OK" : "Already installed");
-        err = gpio_isr_handler_add(pin, isrHandler, this);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to add ISR handler for GPIO %d: %s", pin, esp_err_to_name(err));
-        }
-    } else {
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) { // INVALID_STATE: already installed
         ESP_LOGE(TAG, "Failed to install ISR service: %s", esp_err_to_name(err));
+        return false;
+    }
+    err = gpio_isr_handler_add(pin, isrHandler, &button);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add ISR handler for GPIO %d: %s", (int)pin, esp_err_to_name(err));
+        return false;
     }
 
-    // Konfiguriere den geerbten Timer für Button-Polling
-    _timer.SetCallback([this](Event* e) {
-        this->Post(e);
-    });
-
-    // Timer starten für regelmäßige Button-Abfrage
-    ESP_LOGI(TAG, "Starting button polling timer");
-    _timer.Start(10, new ButtonTimerEvent());
+    _buttonCount++;
+    ESP_LOGI(TAG, "Button %u on GPIO %d", (unsigned)(_buttonCount - 1), (int)pin);
+    return true;
 }
 
+// All GPIO handlers run one after another in the GPIO ISR service, so the
+// channel keeps a single producer however many pins share it. Edges within
+// the debounce window of the last raised one only move lastEdgeUs, which
+// the actor reads when the window ends.
 void IRAM_ATTR ButtonActor::isrHandler(void* arg)
 {
-    ButtonActor* self = static_cast<ButtonActor*>(arg);
-    // In ISR we only set a flag to indicate state change
-    // The actual level reading is done in the timer handler
-    self->_eventPending = true;
+    Button* button = static_cast<Button*>(arg);
+    ButtonActor* self = button->owner;
+    uint32_t now = nowUs32();
+    button->lastEdgeUs.store(now, std::memory_order_relaxed);
+    if (button->raised && elapsedUs(now, button->raisedUs) < (int32_t)(DEBOUNCE_MS * 1000)) {
+        return;
+    }
+    button->raised = true;
+    button->raisedUs = now;
+
+    BaseType_t woken = pdFALSE;
+    self->_edges.Raise(static_cast<uint32_t>(button - self->_buttons.data()), 0, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Runs in the IsrService task
+const Event* ButtonActor::toEdgeEvent(const IsrChannel::Slot& slot, void* context)
+{
+    (void)context;
+    return new ButtonEdgeEvent(static_cast<int>(slot.value), slot.timeUs);
 }
 
-void ButtonActor::Dispatcher(Event* e)
+void ButtonActor::onEdge(size_t index, uint32_t timeUs)
 {
-    if (e == nullptr) {
-        ESP_LOGW(TAG, "Received null event");
+    if (index >= _buttonCount) {
         return;
     }
-
-    // Füge eine periodische Statusprüfung alle 500ms hinzu
-    static TickType_t lastStatusCheck = 0;
-    TickType_t now = xTaskGetTickCount();
-    
-    if (now - lastStatusCheck > pdMS_TO_TICKS(500)) {
-        lastStatusCheck = now;
-        // Direkte Statusprüfung der Buttons
-        int level = gpio_get_level(_pin);
-        ESP_LOGI(TAG, "Button GPIO %d status: %s", (int)_pin, level ? "HIGH" : "LOW");
+    Button& button = _buttons[index];
+    if (!button.debouncing) {
+        button.debouncing = true;
+        button.firstEdgeUs = timeUs;
     }
+    rearm(nowUs32());
+}
 
-    // Only process timer events for button polling
-    if (e->getType() == Event::Type::TimerTick && 
-        strcmp(e->getSource(), "ButtonPoll") == 0) {
-        
-        // Process button state at regular intervals
-        processButtonState();
-        
-        // Restart the timer for next polling interval
-        _timer.Start(10, new ButtonTimerEvent());
+void ButtonActor::onDeadline()
+{
+    uint32_t now = nowUs32();
+    for (size_t i = 0; i < _buttonCount; ++i) {
+        update(_buttons[i], now);
     }
+    rearm(now);
 }
 
-void ButtonActor::processButtonState()
+void ButtonActor::update(Button& button, uint32_t nowUs)
 {
-    TickType_t now = xTaskGetTickCount();
-    int level = gpio_get_level(_pin);
-
-    // Debug if state change was flagged by ISR
-    if (_eventPending) {
-        ESP_LOGI(TAG, "Button GPIO %d level changed to %d", (int)_pin, level);
-        _eventPending = false; // Clear the flag
-    }
-
-    // Handle button press
-    if (level == 0 && !_buttonPressed) {
-        _buttonPressed = true;
-        _pressTick = now;
-        _waitingRelease = true;
-        ESP_LOGI(TAG, "Button GPIO %d pressed", (int)_pin);
-    }
-    // Handle button release
-    else if (level == 1 && _buttonPressed) {
-        _buttonPressed = false;
-        _waitingRelease = false;
-        TickType_t pressDuration = now - _pressTick;
-
-        ESP_LOGI(TAG, "Button GPIO %d released after %d ms", (int)_pin, 
-                 (int)(pressDuration * portTICK_PERIOD_MS));
-
-        if (pressDuration >= pdMS_TO_TICKS(LONG_PRESS_MS)) {
-            // Long press detected
-            ESP_LOGI(TAG, "Long press detected on GPIO %d", (int)_pin);
-            // Convert enum to equivalent ButtonClicked::ActionType
-            ButtonClicked::ActionType action = ButtonClicked::ActionType::LONG;
-            EventBus::get().publish(new ButtonClicked(static_cast<int>(_pin), action, "ButtonActor"));
-            _clickCount = 0; // Reset click count after long press
-        } else {
-            // Short press - could be part of a single or double click
-            if (_clickCount == 0) {
-                _lastClickTick = now;
+    // Settled: the level decides, so a dropped edge cannot desync the state
+    if (button.debouncing &&
+        elapsedUs(nowUs, button.lastEdgeUs.load(std::memory_order_relaxed)) >= (int32_t)(DEBOUNCE_MS * 1000)) {
+        button.debouncing = false;
+        bool down = gpio_get_level(button.pin) == 0;
+        if (down && !button.pressed) {
+            button.pressed = true;
+            button.pressUs = button.firstEdgeUs;
+            button.longFired = false;
+        } else if (!down && button.pressed) {
+            button.pressed = false;
+            if (button.longFired) {
+                button.clicks = 0;
+            } else {
+                button.releaseUs = button.firstEdgeUs;
+                button.clicks++;
             }
-            // Handle volatile variable increment safely
-            int currentCount = _clickCount;
-            _clickCount = currentCount + 1;
-            ESP_LOGI(TAG, "Click count for GPIO %d: %d", (int)_pin, _clickCount);
         }
     }
 
-    // Check for click completion after a timeout
-    if (_clickCount > 0 && (now - _lastClickTick > pdMS_TO_TICKS(DOUBLE_CLICK_GAP_MS))) {
-        int currentClickCount = _clickCount;
-        
-        if (currentClickCount == 1) {
-            ESP_LOGI(TAG, "Single click detected on GPIO %d, publishing event", (int)_pin);
-            ButtonClicked::ActionType action = ButtonClicked::ActionType::SINGLE;
-            EventBus::get().publish(new ButtonClicked(static_cast<int>(_pin), action, "ButtonActor"));
-        } else if (currentClickCount == 2) {
-            ESP_LOGI(TAG, "Double click detected on GPIO %d, publishing event", (int)_pin);
-            ButtonClicked::ActionType action = ButtonClicked::ActionType::DOUBLE;
-            EventBus::get().publish(new ButtonClicked(static_cast<int>(_pin), action, "ButtonActor"));
+    if (button.pressed && !button.longFired &&
+        elapsedUs(nowUs, button.pressUs) >= (int32_t)(LONG_PRESS_MS * 1000)) {
+        ESP_LOGI(TAG, "Long press on GPIO %d", (int)button.pin);
+        publish(button, ButtonClicked::ActionType::LONG);
+        button.longFired = true;
+        button.clicks = 0;
+        button.nextRepeatUs = button.pressUs + (LONG_PRESS_MS + HOLD_REPEAT_MS) * 1000;
+    } else if (button.pressed && button.longFired && !button.debouncing &&
+               elapsedUs(nowUs, button.nextRepeatUs) >= 0) {
+        publish(button, ButtonClicked::ActionType::HOLD);
+        button.nextRepeatUs += HOLD_REPEAT_MS * 1000;
+        // Woken late: skip the missed repeats instead of bursting them
+        if (elapsedUs(nowUs, button.nextRepeatUs) >= 0) {
+            button.nextRepeatUs = nowUs + HOLD_REPEAT_MS * 1000;
+        }
+    }
+
+    if (!button.pressed && !button.debouncing && button.clicks > 0 &&
+        elapsedUs(nowUs, button.releaseUs) >= (int32_t)(DOUBLE_CLICK_GAP_MS * 1000)) {
+        if (button.clicks == 1) {
+            ESP_LOGI(TAG, "Single click on GPIO %d", (int)button.pin);
+            publish(button, ButtonClicked::ActionType::SINGLE);
+        } else if (button.clicks == 2) {
+            ESP_LOGI(TAG, "Double click on GPIO %d", (int)button.pin);
+            publish(button, ButtonClicked::ActionType::DOUBLE);
         } else {
-            ESP_LOGI(TAG, "Multiple clicks (%d) detected on GPIO %d", currentClickCount, (int)_pin);
+            ESP_LOGI(TAG, "Multiple clicks (%d) on GPIO %d", (int)button.clicks, (int)button.pin);
+        }
+        button.clicks = 0;
+    }
+}
+
+// Earliest time update() has something to do for this button
+bool ButtonActor::nextDeadline(const Button& button, uint32_t* atUs) const
+{
+    if (button.debouncing) {
+        *atUs = button.lastEdgeUs.load(std::memory_order_relaxed) + DEBOUNCE_MS * 1000;
+        return true;
+    }
+    if (button.pressed) {
+        *atUs = button.longFired ? button.nextRepeatUs : button.pressUs + LONG_PRESS_MS * 1000;
+        return true;
+    }
+    if (button.clicks > 0) {
+        *atUs = button.releaseUs + DOUBLE_CLICK_GAP_MS * 1000;
+        return true;
+    }
+    return false;
+}
+
+// Sleep until the earliest deadline of any button, or not at all when idle
+void ButtonActor::rearm(uint32_t nowUs)
+{
+    bool pending = false;
+    int32_t waitUs = 0;
+    for (size_t i = 0; i < _buttonCount; ++i) {
+        uint32_t atUs;
+        if (!nextDeadline(_buttons[i], &atUs)) continue;
+        int32_t delta = elapsedUs(atUs, nowUs);
+        if (!pending || delta < waitUs) {
+            waitUs = delta;
+            pending = true;
         }
-        _clickCount = 0; // Reset click count after event
     }
 
-    // Check for long press while button is still held down
-    if (_buttonPressed && _waitingRelease && (now - _pressTick >= pdMS_TO_TICKS(LONG_PRESS_MS))) {
-        // Button has been held long enough for a long press and is still down
-        _waitingRelease = false; // Prevent repeated long-press events
-        ESP_LOGI(TAG, "Long press while held detected on GPIO %d, publishing event", (int)_pin);
-        ButtonClicked::ActionType action = ButtonClicked::ActionType::LONG;
-        EventBus::get().publish(new ButtonClicked(static_cast<int>(_pin), action, "ButtonActor"));
-        _clickCount = 0;
+    if (!pending) {
+        _timer.Stop();
+        return;
     }
+    // Round up, waking early would only cost an extra pass
+    TickType_t waitMs = waitUs > 0 ? static_cast<TickType_t>((waitUs + 999) / 1000) : 1;
+    _timer.Start(waitMs, _tick->Retain());
+}
+
+void ButtonActor::publish(const Button& button, ButtonClicked::ActionType action)
+{
+    EventBus::get().publish(new ButtonClicked(static_cast<int>(button.pin), action, "ButtonActor"));
 }
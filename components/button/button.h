@@ -4,67 +4,124 @@
 #include "activeObject.h"
 #include "events.h"
 #include "timer.h"
+#include "isrChannel.h"
 #include "driver/gpio.h"
 #include <array>
-#include <memory>
+#include <atomic>
+#include <initializer_list>
 
-class ButtonActor : public ActiveObject {
-public:
-    enum class ActionType : int { NONE, SINGLE, DOUBLE, LONG, MAX };
-
-    ButtonActor(gpio_num_t pin);
-
-    void Dispatcher(Event* e) override;
-
-private:
-    static void IRAM_ATTR isrHandler(void* arg);
-    void processButtonState();
-
-    gpio_num_t _pin;
-    volatile TickType_t _pressTick;
-    volatile bool _waitingRelease;
-    volatile int _clickCount;
-    volatile TickType_t _lastClickTick;
-    volatile bool _eventPending = false;
-    volatile bool _buttonPressed = false;
-    volatile ActionType _deferredAction = ActionType::NONE;
-
-    static constexpr int DOUBLE_CLICK_GAP_MS = 300;
-    static constexpr int LONG_PRESS_MS = 1000;
-    static constexpr int DEBOUNCE_MS = 50;
-};
+// Maximum number of pins one ButtonActor serves
+#ifndef BUTTON_MAX_PINS
+#define BUTTON_MAX_PINS 8
+#endif
 
-class ButtonClicked : public Event {
+class ButtonClicked : public TypedEvent<ButtonClicked, Event::Type::ButtonClicked> {
 public:
     enum class ActionType {
         NONE,
         SINGLE,
         DOUBLE,
         LONG,
+        HOLD,       // repeated while a long press is held
         MAX
     };
 
     ButtonClicked(int id, ActionType action, const char* source = "Unknown")
-        : Event(source), _buttonID(id), _action(action) {}
+        : TypedEvent(source), _buttonID(id), _action(action) {}
 
-    Type getType() const override { return Type::ButtonClicked; }
     int getID() const { return _buttonID; }
     ActionType getActionType() const { return _action; }
 
-    Event* Clone() const override {
-        return new ButtonClicked(_buttonID, _action, _source);
-    }
-
 private:
     int _buttonID;
     ActionType _action;
 };
 
-class ButtonTimerEvent : public Event {
+// GPIO edge, forwarded from the ISR through the button's IsrChannel
+class ButtonEdgeEvent : public TypedEvent<ButtonEdgeEvent, Event::Type::ButtonEdge> {
 public:
-    ButtonTimerEvent() : Event("ButtonPoll") {}
-    Type getType() const override { return Type::TimerTick; }
-    Event* Clone() const override { return new ButtonTimerEvent(); }
+    ButtonEdgeEvent(int id, uint32_t timeUs) : TypedEvent("ButtonISR"), _buttonID(id), _timeUs(timeUs) {}
+
+    int getID() const { return _buttonID; }
+    uint32_t getTimeUs() const { return _timeUs; }
+
+private:
+    int _buttonID;
+    uint32_t _timeUs;
 };
 
-#endif // BUTTON_H
\ No newline at end of file
+// Next gesture deadline of any button is due
+class ButtonTimerEvent : public TypedEvent<ButtonTimerEvent, Event::Type::TimerTick> {
+public:
+    ButtonTimerEvent() : TypedEvent("ButtonDeadline") {}
+};
+
+/**
+ * @brief   Gesture engine for any number of push buttons (active low).
+ *
+ * The GPIO ISR forwards the first edge of a bounce burst with its
+ * timestamp through an IsrChannel; further edges of the same pin within
+ * DEBOUNCE_MS of it only update the pin's latest edge time, so a bouncing
+ * contact costs one slot and one event per debounce window instead of one
+ * per edge. Per button, a small state machine debounces (the level is
+ * sampled once the pin has been quiet for DEBOUNCE_MS since its latest
+ * edge, the press time is the first edge of the bounce) and classifies
+ * single, double and long presses plus hold-repeats while a long press is
+ * held.
+ *
+ * The actor only runs on an edge or on the next pending deadline of any
+ * button (debounce, click gap, long press, repeat); with no button in
+ * motion its timer is stopped and nothing runs at all.
+ */
+class ButtonActor : public ActiveObject {
+public:
+    explicit ButtonActor(std::initializer_list<gpio_num_t> pins = {});
+
+    // Configure the pin as input with pull-up and watch it; before Start()
+    bool AddButton(gpio_num_t pin);
+
+private:
+    struct Button {
+        ButtonActor* owner;
+        gpio_num_t pin;
+        bool pressed;           // debounced state
+        bool debouncing;
+        bool longFired;
+        uint8_t clicks;
+        uint32_t firstEdgeUs;   // first edge of the current bounce burst
+        // Written by the ISR: latest edge, and the last edge it raised
+        std::atomic<uint32_t> lastEdgeUs;
+        uint32_t raisedUs;
+        bool raised;
+        uint32_t pressUs;
+        uint32_t releaseUs;
+        uint32_t nextRepeatUs;
+    };
+
+    static void IRAM_ATTR isrHandler(void* arg);
+    static const Event* toEdgeEvent(const IsrChannel::Slot& slot, void* context);
+
+    void onEdge(size_t index, uint32_t timeUs);
+    void onDeadline();
+    void update(Button& button, uint32_t nowUs);
+    bool nextDeadline(const Button& button, uint32_t* atUs) const;
+    void rearm(uint32_t nowUs);
+    void publish(const Button& button, ButtonClicked::ActionType action);
+
+    std::array<Button, BUTTON_MAX_PINS> _buttons;
+    size_t _buttonCount;
+    IsrChannel _edges;
+    const Event* _tick;
+
+    static constexpr uint32_t DEBOUNCE_MS = 30;
+    static constexpr uint32_t DOUBLE_CLICK_GAP_MS = 300;
+    static constexpr uint32_t LONG_PRESS_MS = 1000;
+    static constexpr uint32_t HOLD_REPEAT_MS = 500;
+};
+
+static_assert(sizeof(ButtonClicked) <= EventPoolLayout::SmallBlockSize,
+              "ButtonClicked no longer fits the small EventPool class");
+static_assert(sizeof(ButtonEdgeEvent) <= EventPoolLayout::SmallBlockSize,
+              "ButtonEdgeEvent no longer fits the small EventPool class");
+
+#endif // BUTTON_H
@@ -0,0 +1,114 @@
+// ButtonActor against simulated bouncing contacts (mockGpio.h): gestures
+// come out right, and a bounce burst reaches the actor as one edge event
+// per debounce window instead of one per edge.
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "button.h"
+#include "eventBus.h"
+#include "hostTest.h"
+#include "mockGpio.h"
+
+namespace
+{
+
+const gpio_num_t PIN = static_cast<gpio_num_t>(4);
+using Action = ButtonClicked::ActionType;
+
+std::mutex g_mutex;
+std::vector<Action> g_actions;
+
+void sleepMs(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// A contact that bounces `edges` times, 300 us apart, and settles at level
+void bounceTo(int level, int edges)
+{
+    for (int i = 0; i < edges; ++i) {
+        MockGpio::SetLevel(PIN, (edges - i) % 2 == 0 ? !level : level);
+        std::this_thread::sleep_for(std::chrono::microseconds(300));
+    }
+    MockGpio::SetLevel(PIN, level);
+}
+
+void press(int holdMs, int bounces = 7)
+{
+    bounceTo(0, bounces);
+    sleepMs(holdMs);
+    bounceTo(1, bounces);
+}
+
+std::vector<Action> takeActions()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::vector<Action> actions = g_actions;
+    g_actions.clear();
+    return actions;
+}
+
+uint32_t edgeEvents(ButtonActor& button)
+{
+    const ActorStats::TypeStats* stats = button.GetStats().Get(Event::Type::ButtonEdge);
+    return stats != nullptr ? stats->exec.Count() : 0;
+}
+
+// Press and release each bounce 7 times within 2 ms: one edge event each
+void bouncingClick(ButtonActor& button)
+{
+    uint32_t before = edgeEvents(button);
+    press(100);
+    sleepMs(500);
+    CHECK(takeActions() == std::vector<Action>{ Action::SINGLE });
+    CHECK_EQ(edgeEvents(button) - before, 2u);
+}
+
+void bouncingDoubleClick(ButtonActor& button)
+{
+    press(80);
+    sleepMs(100);
+    press(80);
+    sleepMs(500);
+    CHECK(takeActions() == std::vector<Action>{ Action::DOUBLE });
+}
+
+// Bounces for ~45 ms, longer than the debounce window: at most one edge
+// event per window, still a single click
+void longBounce(ButtonActor& button)
+{
+    uint32_t before = edgeEvents(button);
+    press(150, 151);
+    sleepMs(500);
+    CHECK(takeActions() == std::vector<Action>{ Action::SINGLE });
+    uint32_t events = edgeEvents(button) - before;
+    CHECK(events >= 2 && events <= 6);
+}
+
+// Held 1.8 s: LONG at 1 s, one HOLD at 1.5 s, no click on release
+void longPressWithHold(ButtonActor&)
+{
+    press(1800);
+    sleepMs(500);
+    CHECK(takeActions() == (std::vector<Action>{ Action::LONG, Action::HOLD }));
+}
+
+} // namespace
+
+int main()
+{
+    EventBus::get().subscribe<ButtonClicked>([](const ButtonClicked& e) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_actions.push_back(e.getActionType());
+    });
+    static ButtonActor button({ PIN });
+    button.Start();
+
+    HostTest::Run("bouncing click: SINGLE, one edge event per burst", [] { bouncingClick(button); });
+    HostTest::Run("bouncing double click: DOUBLE", [] { bouncingDoubleClick(button); });
+    HostTest::Run("45 ms bounce: SINGLE, edges bounded by the window", [] { longBounce(button); });
+    HostTest::Run("long press: LONG and HOLD, no click", [] { longPressWithHold(button); });
+    return HostTest::Report();
+}
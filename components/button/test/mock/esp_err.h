@@ -0,0 +1,11 @@
+// Host mock (button tests): the subset of esp_err.h used by the ButtonActor
+#pragma once
+
+typedef int esp_err_t;
+
+#define ESP_OK                      0
+#define ESP_FAIL                    -1
+#define ESP_ERR_INVALID_ARG         0x102
+#define ESP_ERR_INVALID_STATE       0x103
+
+const char* esp_err_to_name(esp_err_t code);
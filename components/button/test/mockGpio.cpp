@@ -0,0 +1,78 @@
+// Host mock of the GPIO driver for the button tests (mockGpio.h)
+#include "mockGpio.h"
+
+#include <atomic>
+
+namespace
+{
+
+struct Pin {
+    std::atomic<int> level{ 1 };
+    gpio_isr_t handler = nullptr;
+    void* arg = nullptr;
+};
+
+Pin pins[GPIO_NUM_MAX];
+
+bool valid(gpio_num_t pin)
+{
+    return pin >= 0 && pin < GPIO_NUM_MAX;
+}
+
+} // namespace
+
+const char* esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+esp_err_t gpio_config(const gpio_config_t* config)
+{
+    for (int i = 0; i < GPIO_NUM_MAX; ++i) {
+        if (config->pin_bit_mask & (1ULL << i)) {
+            pins[i].level = config->pull_up_en == GPIO_PULLUP_ENABLE ? 1 : 0;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int flags)
+{
+    (void)flags;
+    static bool installed = false;
+    if (installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void* arg)
+{
+    if (!valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[pin].handler = handler;
+    pins[pin].arg = arg;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin)
+{
+    return valid(pin) ? pins[pin].level.load() : 0;
+}
+
+namespace MockGpio
+{
+
+void SetLevel(gpio_num_t pin, int level)
+{
+    if (!valid(pin) || pins[pin].level.exchange(level) == level) {
+        return;
+    }
+    if (pins[pin].handler != nullptr) {
+        pins[pin].handler(pins[pin].arg);
+    }
+}
+
+} // namespace MockGpio
@@ -0,0 +1,19 @@
+#ifndef MOCK_GPIO_H
+#define MOCK_GPIO_H
+
+#include "driver/gpio.h"
+
+/**
+ * Simulated GPIO pins behind the mock driver/gpio.h. Inputs configured
+ * with a pull-up idle high. SetLevel() changes a pin and, on a change,
+ * calls its ISR handler right away in the calling thread, which stands in
+ * for the GPIO interrupt: drive all pins from one thread.
+ */
+namespace MockGpio
+{
+
+void SetLevel(gpio_num_t pin, int level);
+
+} // namespace MockGpio
+
+#endif // MOCK_GPIO_H
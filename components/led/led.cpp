@@ -1,90 +1,151 @@
 #include "led.h"
 #include "esp_log.h"
+#include "esp_idf_version.h"
 
 namespace LED
 {
 static const char* TAG = "LED";
 
+// Channels are handed out in construction order
+static int s_nextChannel = 0;
+
 LedActor::LedActor(gpio_num_t pin)
-    : ActiveObject("LED", 4096, 10),
+    : ActiveObject("LED", Executor::Shared(), 10),
       _pin(pin),
-      _mode(LedMode::OFF),
-      _state(false),
-      _timer("led.timer", false, [this](Event* e) { Post(e); })
+      _channel(LEDC_CHANNEL_MAX),
+      _stepTimer(nullptr),
+      _lock(xSemaphoreCreateMutex()),
+      _lit(false)
 {
-    gpio_config_t io_conf = {
-        .pin_bit_mask = 1ULL << pin,
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&io_conf);
-    gpio_set_level(_pin, 0);
-}
+    if (s_nextChannel == 0) {
+        ledc_timer_config_t timer = {};
+        timer.speed_mode = LEDC_LOW_SPEED_MODE;
+        timer.duty_resolution = static_cast<ledc_timer_bit_t>(LED_PWM_RESOLUTION_BITS);
+        timer.timer_num = LED_PWM_TIMER;
+        timer.freq_hz = LED_PWM_FREQUENCY_HZ;
+        timer.clk_cfg = LEDC_AUTO_CLK;
+        ESP_ERROR_CHECK(ledc_timer_config(&timer));
+        ESP_ERROR_CHECK(ledc_fade_func_install(0));
+    }
 
-void LedActor::Dispatcher(Event* e)
-{
-    if (e->getType() == Event::Type::LedStop) {
-        _mode = LedMode::OFF;
-        _blinkMode = LedMode::OFF;
-        _timer.Stop();
-        gpio_set_level(_pin, 0);
-        ESP_LOGI("LED", "🛑 Stopped blinking on GPIO %d", _pin);
+    if (s_nextChannel >= LEDC_CHANNEL_MAX) {
+        ESP_LOGE(TAG, "No LEDC channel left for GPIO %d", (int)pin);
         return;
     }
-    
-    if (e->getType() != Event::Type::LedControl)
-        return;
+    _channel = static_cast<ledc_channel_t>(s_nextChannel++);
 
-    LedControlEvent* ledEvent = static_cast<LedControlEvent*>(e);
-    LedMode mode = ledEvent->getMode();
+    ledc_channel_config_t channel = {};
+    channel.gpio_num = pin;
+    channel.speed_mode = LEDC_LOW_SPEED_MODE;
+    channel.channel = _channel;
+    channel.intr_type = LEDC_INTR_DISABLE;
+    channel.timer_sel = LED_PWM_TIMER;
+    channel.duty = 0;
+    channel.hpoint = 0;
+    ESP_ERROR_CHECK(ledc_channel_config(&channel));
+
+    esp_timer_create_args_t args = {};
+    args.callback = stepCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "led_step";
+    ESP_ERROR_CHECK(esp_timer_create(&args, &_stepTimer));
+
+    on<LedStopEvent>([this](const LedStopEvent&) { onStop(); });
+    on<LedControlEvent>([this](const LedControlEvent& e) { onControl(e.getMode()); });
+    on<LedPatternEvent>([this](const LedPatternEvent& e) { play(e.getPattern(), e.getBrightness()); });
+    // Only the newest LED command matters
+    coalesce<LedControlEvent>(Mailbox::Coalesce::ReplaceLatest);
+    coalesce<LedPatternEvent>(Mailbox::Coalesce::ReplaceLatest);
+
+    ESP_LOGI(TAG, "LED on GPIO %d, LEDC channel %d", (int)pin, (int)_channel);
+}
 
+void LedActor::onStop()
+{
+    play(Patterns::Off, 255);
+    ESP_LOGI(TAG, "🛑 Stopped pattern on GPIO %d", (int)_pin);
+}
+
+void LedActor::onControl(LedMode mode)
+{
     switch (mode)
     {
         case LedMode::ON:
-            _mode = LedMode::ON;
-            _blinkMode = LedMode::OFF;
-            _timer.Stop();
-            gpio_set_level(_pin, 1);
+            play(Patterns::On, 255);
             break;
 
         case LedMode::OFF:
-            _mode = LedMode::OFF;
-            _blinkMode = LedMode::OFF;
-            _timer.Stop();
-            gpio_set_level(_pin, 0);
+            play(Patterns::Off, 255);
             break;
 
-        case LedMode::TOGGLE:
-            _state = !_state;
-            gpio_set_level(_pin, _state ? 1 : 0);
-            ESP_LOGI("LED", "Toggled GPIO %d → %d", _pin, _state);
-
-            if (_blinkMode == LedMode::BLINK_FAST)
-                _timer.Start(pdMS_TO_TICKS(250), new LedControlEvent(LedMode::TOGGLE, "blink_fast"));
-            else if (_blinkMode == LedMode::BLINK_SLOW)
-                _timer.Start(pdMS_TO_TICKS(1000), new LedControlEvent(LedMode::TOGGLE, "blink_slow"));
+        case LedMode::TOGGLE: {
+            xSemaphoreTake(_lock, portMAX_DELAY);
+            bool lit = _lit;
+            xSemaphoreGive(_lock);
+            play(lit ? Patterns::Off : Patterns::On, 255);
             break;
+        }
 
         case LedMode::BLINK_FAST:
-            _mode = LedMode::TOGGLE;
-            _blinkMode = LedMode::BLINK_FAST;
-            _timer.Stop();
-            _timer.Start(pdMS_TO_TICKS(250), new LedControlEvent(LedMode::TOGGLE, "blink_fast"));
-            ESP_LOGI("LED", "Starting BLINK_FAST on GPIO %d", _pin);
+            play(Patterns::BlinkFast, 255);
             break;
 
         case LedMode::BLINK_SLOW:
-            _mode = LedMode::TOGGLE;
-            _blinkMode = LedMode::BLINK_SLOW;
-            _timer.Stop();
-            _timer.Start(pdMS_TO_TICKS(1000), new LedControlEvent(LedMode::TOGGLE, "blink_slow"));
-            ESP_LOGI("LED", "Starting BLINK_SLOW on GPIO %d", _pin);
+            play(Patterns::BlinkSlow, 255);
+            break;
+
+        case LedMode::BREATHE:
+            play(Patterns::Breathe, 255);
             break;
     }
 }
 
+void LedActor::play(const LedPattern& pattern, uint8_t brightness)
+{
+    if (_channel == LEDC_CHANNEL_MAX) {
+        return;
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    esp_timer_stop(_stepTimer);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    // Cut a fade of the previous pattern short instead of waiting for it
+    ledc_fade_stop(LEDC_LOW_SPEED_MODE, _channel);
+#endif
+    apply(_sequencer.Begin(pattern, brightness));
+    xSemaphoreGive(_lock);
+
+    ESP_LOGD(TAG, "GPIO %d plays %s", (int)_pin, pattern.name);
+}
+
+void LedActor::apply(const LedSequencer::Command& command)
+{
+    uint32_t duty = LedSequencer::ToDuty(command.level, LED_PWM_RESOLUTION_BITS);
+    if (command.fadeMs == 0) {
+        ledc_set_duty_and_update(LEDC_LOW_SPEED_MODE, _channel, duty, 0);
+    } else {
+        ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, _channel, duty, command.fadeMs, LEDC_FADE_NO_WAIT);
+    }
+    _lit = command.level != 0;
 
+    if (!command.done) {
+        uint64_t waitUs = command.waitMs > 0 ? static_cast<uint64_t>(command.waitMs) * 1000 : 1000;
+        esp_timer_start_once(_stepTimer, waitUs);
+    }
+}
+
+// Runs in the esp_timer task, the actor is not involved
+void LedActor::stepCallback(void* arg)
+{
+    LedActor* self = static_cast<LedActor*>(arg);
 
-}
\ No newline at end of file
+    xSemaphoreTake(self->_lock, portMAX_DELAY);
+    // Stale expiry: play() restarted or stopped the pattern meanwhile
+    if (self->_sequencer.IsRunning() && !esp_timer_is_active(self->_stepTimer)) {
+        self->apply(self->_sequencer.Advance());
+    }
+    xSemaphoreGive(self->_lock);
+}
+
+}
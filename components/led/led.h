@@ -1,27 +1,78 @@
-
 #ifndef LED_H
 #define LED_H
 
 #include "activeObject.h"
 #include "events.h"
+#include "ledPattern.h"
 #include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// LEDC PWM setup shared by all LEDs (one timer, one channel per LED)
+#ifndef LED_PWM_FREQUENCY_HZ
+#define LED_PWM_FREQUENCY_HZ 5000
+#endif
+
+#ifndef LED_PWM_RESOLUTION_BITS
+#define LED_PWM_RESOLUTION_BITS 13
+#endif
+
+#ifndef LED_PWM_TIMER
+#define LED_PWM_TIMER LEDC_TIMER_0
+#endif
 
 namespace LED
 {
 
+    /**
+     * @brief   LED on an LEDC PWM channel, driven by a pattern sequencer.
+     *
+     * The actor only handles commands (LedControlEvent, LedPatternEvent,
+     * LedStopEvent). Playing a pattern runs outside of it: every step is
+     * one hardware fade (or duty update) plus a one-shot esp_timer for the
+     * next step, so a blinking or breathing LED never wakes the actor,
+     * allocates an event or touches a mailbox.
+     */
     class LedActor : public ActiveObject {
         public:
             LedActor(gpio_num_t pin);
-            void Dispatcher(Event* e) override;
-        
+
         private:
-        
+            void onStop();
+            void onControl(LedMode mode);
+            void play(const LedPattern& pattern, uint8_t brightness);
+            // Caller holds _lock
+            void apply(const LedSequencer::Command& command);
+
+            // esp_timer task: next step of the running pattern
+            static void stepCallback(void* arg);
+
             gpio_num_t _pin;
-            LedMode _mode;
-            LedMode _blinkMode = LedMode::OFF;
-            bool _state;
-            Timer _timer;
+            ledc_channel_t _channel;
+            LedSequencer _sequencer;
+            esp_timer_handle_t _stepTimer;
+            SemaphoreHandle_t _lock;
+            bool _lit;
         };
+
+    // Play a pattern, brightness scales all of its levels
+    class LedPatternEvent : public TypedEvent<LedPatternEvent, Event::Type::LedPattern> {
+    public:
+        LedPatternEvent(const LedPattern& pattern, uint8_t brightness = 255, const char* source = "Unknown")
+            : TypedEvent(source), _pattern(&pattern), _brightness(brightness) {}
+
+        const LedPattern& getPattern() const { return *_pattern; }
+        uint8_t getBrightness() const { return _brightness; }
+
+    private:
+        const LedPattern* _pattern;
+        uint8_t _brightness;
+    };
+
+    static_assert(sizeof(LedPatternEvent) <= EventPoolLayout::SmallBlockSize,
+                  "LedPatternEvent no longer fits the small EventPool class");
 }
 
-#endif // End: LED_H
\ No newline at end of file
+#endif // End: LED_H
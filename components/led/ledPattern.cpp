@@ -0,0 +1,80 @@
+#include "ledPattern.h"
+
+namespace LED
+{
+
+namespace {
+
+const LedStep OFF_STEPS[] = { { 0, 0, 0 } };
+const LedStep ON_STEPS[] = { { 255, 0, 0 } };
+const LedStep BLINK_SLOW_STEPS[] = { { 255, 0, 1000 }, { 0, 0, 1000 } };
+const LedStep BLINK_FAST_STEPS[] = { { 255, 0, 250 }, { 0, 0, 250 } };
+const LedStep BREATHE_STEPS[] = { { 255, 1400, 100 }, { 0, 1400, 100 } };
+const LedStep HEARTBEAT_STEPS[] = { { 255, 0, 100 }, { 0, 0, 100 }, { 255, 0, 100 }, { 0, 0, 900 } };
+const LedStep FADE_IN_STEPS[] = { { 255, 1000, 0 } };
+const LedStep FADE_OUT_STEPS[] = { { 0, 1000, 0 } };
+
+} // namespace
+
+namespace Patterns {
+    const LedPattern Off = MakePattern(OFF_STEPS, 1, "off");
+    const LedPattern On = MakePattern(ON_STEPS, 1, "on");
+    const LedPattern BlinkSlow = MakePattern(BLINK_SLOW_STEPS, 0, "blink_slow");
+    const LedPattern BlinkFast = MakePattern(BLINK_FAST_STEPS, 0, "blink_fast");
+    const LedPattern Breathe = MakePattern(BREATHE_STEPS, 0, "breathe");
+    const LedPattern Heartbeat = MakePattern(HEARTBEAT_STEPS, 0, "heartbeat");
+    const LedPattern FadeIn = MakePattern(FADE_IN_STEPS, 1, "fade_in");
+    const LedPattern FadeOut = MakePattern(FADE_OUT_STEPS, 1, "fade_out");
+}
+
+LedSequencer::LedSequencer()
+    : _pattern(nullptr), _step(0), _loop(0), _brightness(255), _running(false) {}
+
+LedSequencer::Command LedSequencer::Begin(const LedPattern& pattern, uint8_t brightness)
+{
+    _pattern = &pattern;
+    _step = 0;
+    _loop = 0;
+    _brightness = brightness;
+    _running = pattern.count > 0;
+    if (!_running) {
+        return Command{ 0, 0, 0, true };
+    }
+    return current();
+}
+
+LedSequencer::Command LedSequencer::Advance()
+{
+    if (!_running) {
+        return Command{ 0, 0, 0, true };
+    }
+    if (++_step >= _pattern->count) {
+        _step = 0;
+        ++_loop;
+    }
+    return current();
+}
+
+LedSequencer::Command LedSequencer::current()
+{
+    const LedStep& step = _pattern->steps[_step];
+    bool lastLoop = _pattern->repeat != 0 && _loop + 1 >= _pattern->repeat;
+    // A looping single step never changes the output again
+    bool done = (lastLoop && _step + 1 == _pattern->count) || _pattern->count == 1;
+    if (done) {
+        _running = false;
+    }
+    uint8_t level = static_cast<uint8_t>((step.level * _brightness + 127) / 255);
+    return Command{ level, step.fadeMs, static_cast<uint32_t>(step.fadeMs) + step.holdMs, done };
+}
+
+// Quadratic curve, close enough to perceived brightness for indicator LEDs
+uint32_t LedSequencer::ToDuty(uint8_t level, uint8_t resolutionBits)
+{
+    uint32_t maxDuty = (1u << resolutionBits) - 1;
+    uint32_t duty = static_cast<uint32_t>((static_cast<uint64_t>(level) * level * maxDuty + 255 * 255 / 2) / (255 * 255));
+    // Keep the dimmest non-zero level visible
+    return (level != 0 && duty == 0) ? 1 : duty;
+}
+
+} // namespace LED
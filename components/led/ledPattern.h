@@ -0,0 +1,96 @@
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace LED
+{
+
+/**
+ * @brief   One step of an LED pattern: fade to level, then hold it.
+ *
+ * Levels are perceptual brightness 0..255; the driver maps them to PWM
+ * duty through a gamma curve. fadeMs == 0 jumps to the level.
+ */
+struct LedStep {
+    uint8_t level;
+    uint16_t fadeMs;
+    uint16_t holdMs;
+};
+
+/**
+ * @brief   Compiled LED pattern: a constant table of steps.
+ *
+ * Patterns are plain constant data (usually static const), so a pattern
+ * change is a pointer in an event and playing one allocates nothing.
+ * repeat == 0 loops forever, otherwise the steps run repeat times and the
+ * LED stays at the level of the last step.
+ */
+struct LedPattern {
+    const LedStep* steps;
+    uint8_t count;
+    uint8_t repeat;
+    const char* name;
+};
+
+template <size_t N>
+constexpr LedPattern MakePattern(const LedStep (&steps)[N], uint8_t repeat, const char* name) {
+    static_assert(N > 0 && N <= 255, "A pattern has 1..255 steps");
+    return LedPattern{ steps, static_cast<uint8_t>(N), repeat, name };
+}
+
+// Built-in patterns
+namespace Patterns {
+    extern const LedPattern Off;
+    extern const LedPattern On;
+    extern const LedPattern BlinkSlow;      // 1 s on, 1 s off
+    extern const LedPattern BlinkFast;      // 250 ms on, 250 ms off
+    extern const LedPattern Breathe;        // 3 s fade in and out
+    extern const LedPattern Heartbeat;      // double pulse every 1.2 s
+    extern const LedPattern FadeIn;         // 1 s to full, then stays on
+    extern const LedPattern FadeOut;        // 1 s to dark, then stays off
+}
+
+/**
+ * @brief   Steps through a pattern; no hardware, no RTOS.
+ *
+ * Begin() and Advance() return the next hardware command: fade to level
+ * over fadeMs and call Advance() again after waitMs. A command with done
+ * set is the last one, the level stays after it. Brightness scales every
+ * level of the pattern.
+ */
+class LedSequencer {
+public:
+    struct Command {
+        uint8_t level;
+        uint32_t fadeMs;
+        uint32_t waitMs;    // fade plus hold
+        bool done;
+    };
+
+    LedSequencer();
+
+    Command Begin(const LedPattern& pattern, uint8_t brightness = 255);
+    Command Advance();
+    void Stop() { _running = false; }
+
+    bool IsRunning() const { return _running; }
+    const LedPattern* GetPattern() const { return _pattern; }
+
+    // Perceptual level (0..255) to PWM duty at the given resolution
+    static uint32_t ToDuty(uint8_t level, uint8_t resolutionBits);
+
+private:
+    Command current();
+
+    const LedPattern* _pattern;
+    uint8_t _step;
+    uint8_t _loop;
+    uint8_t _brightness;
+    bool _running;
+};
+
+} // namespace LED
+
+#endif // LED_PATTERN_H
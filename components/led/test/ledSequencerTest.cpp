@@ -0,0 +1,146 @@
+// LedSequencer: the hardware commands of the built-in and custom patterns
+// (levels, fades, step timing), looping and repeat counts, brightness, and
+// the gamma mapping to PWM duty.
+#include <vector>
+
+#include "hostTest.h"
+#include "ledPattern.h"
+
+namespace
+{
+
+using LED::LedPattern;
+using LED::LedSequencer;
+using LED::LedStep;
+namespace Patterns = LED::Patterns;
+
+// Begin() plus count - 1 Advance() calls
+std::vector<LedSequencer::Command> play(LedSequencer& sequencer, const LedPattern& pattern, size_t count,
+                                        uint8_t brightness = 255)
+{
+    std::vector<LedSequencer::Command> commands;
+    commands.push_back(sequencer.Begin(pattern, brightness));
+    while (commands.size() < count) {
+        commands.push_back(sequencer.Advance());
+    }
+    return commands;
+}
+
+bool is(const LedSequencer::Command& command, uint8_t level, uint32_t fadeMs, uint32_t waitMs, bool done)
+{
+    return command.level == level && command.fadeMs == fadeMs && command.waitMs == waitMs && command.done == done;
+}
+
+void blinkLoopsForever()
+{
+    LedSequencer sequencer;
+    std::vector<LedSequencer::Command> commands = play(sequencer, Patterns::BlinkSlow, 10);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        CHECK(is(commands[i], i % 2 == 0 ? 255 : 0, 0, 1000, false));
+    }
+    CHECK(sequencer.IsRunning());
+}
+
+// Step timing: the waits add up to the pattern's period
+void heartbeatPeriod()
+{
+    LedSequencer sequencer;
+    std::vector<LedSequencer::Command> commands = play(sequencer, Patterns::Heartbeat, 8);
+    uint32_t firstLoop = 0;
+    uint32_t secondLoop = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        firstLoop += commands[i].waitMs;
+        secondLoop += commands[i + 4].waitMs;
+    }
+    CHECK_EQ(firstLoop, 1200u);
+    CHECK_EQ(secondLoop, 1200u);
+    CHECK(is(commands[2], 255, 0, 100, false));
+    CHECK(is(commands[3], 0, 0, 900, false));
+}
+
+// A fade step waits for its fade plus its hold
+void breatheFades()
+{
+    LedSequencer sequencer;
+    std::vector<LedSequencer::Command> commands = play(sequencer, Patterns::Breathe, 4);
+    CHECK(is(commands[0], 255, 1400, 1500, false));
+    CHECK(is(commands[1], 0, 1400, 1500, false));
+    CHECK(is(commands[2], 255, 1400, 1500, false));
+}
+
+// Single-step patterns are done right away and the level stays
+void singleStepIsDone()
+{
+    LedSequencer sequencer;
+    CHECK(is(sequencer.Begin(Patterns::FadeIn), 255, 1000, 1000, true));
+    CHECK(!sequencer.IsRunning());
+    CHECK(is(sequencer.Begin(Patterns::Off), 0, 0, 0, true));
+    CHECK(is(sequencer.Begin(Patterns::On), 255, 0, 0, true));
+}
+
+void repeatCount()
+{
+    static const LedStep steps[] = { { 200, 50, 100 }, { 20, 0, 300 } };
+    static const LedPattern pattern = LED::MakePattern(steps, 3, "test");
+    LedSequencer sequencer;
+    std::vector<LedSequencer::Command> commands = play(sequencer, pattern, 6);
+    for (size_t i = 0; i < 6; ++i) {
+        bool last = i == 5;
+        CHECK(is(commands[i], i % 2 == 0 ? 200 : 20, i % 2 == 0 ? 50 : 0, i % 2 == 0 ? 150 : 300, last));
+    }
+    CHECK(!sequencer.IsRunning());
+    CHECK(sequencer.Advance().done);
+}
+
+void brightnessScales()
+{
+    LedSequencer sequencer;
+    std::vector<LedSequencer::Command> commands = play(sequencer, Patterns::BlinkFast, 2, 128);
+    CHECK(is(commands[0], 128, 0, 250, false));
+    CHECK(is(commands[1], 0, 0, 250, false));
+    CHECK_EQ(sequencer.Begin(Patterns::On, 1).level, 1);
+    CHECK_EQ(sequencer.Begin(Patterns::On, 0).level, 0);
+}
+
+void stopEndsPattern()
+{
+    LedSequencer sequencer;
+    sequencer.Begin(Patterns::Breathe);
+    sequencer.Stop();
+    CHECK(!sequencer.IsRunning());
+    CHECK(sequencer.Advance().done);
+    CHECK(sequencer.GetPattern() == &Patterns::Breathe);
+}
+
+void gammaDuty()
+{
+    CHECK_EQ(LedSequencer::ToDuty(0, 13), 0u);
+    CHECK_EQ(LedSequencer::ToDuty(255, 13), 8191u);
+    CHECK_EQ(LedSequencer::ToDuty(255, 8), 255u);
+    // Dimmest level stays visible, half level is a quarter duty
+    CHECK_EQ(LedSequencer::ToDuty(1, 8), 1u);
+    CHECK_EQ(LedSequencer::ToDuty(128, 13), 2064u);
+    uint32_t previous = 0;
+    bool monotonic = true;
+    for (int level = 1; level <= 255; ++level) {
+        uint32_t duty = LedSequencer::ToDuty(static_cast<uint8_t>(level), 13);
+        monotonic = monotonic && duty >= previous;
+        previous = duty;
+    }
+    CHECK(monotonic);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("blink: alternating levels, loops forever", blinkLoopsForever);
+    HostTest::Run("heartbeat: steps add up to 1.2 s", heartbeatPeriod);
+    HostTest::Run("breathe: fade time plus hold", breatheFades);
+    HostTest::Run("single-step patterns are done at once", singleStepIsDone);
+    HostTest::Run("repeat 3: six steps, the last one done", repeatCount);
+    HostTest::Run("brightness scales the levels", brightnessScales);
+    HostTest::Run("Stop() ends the pattern", stopEndsPattern);
+    HostTest::Run("gamma: 0..255 to duty", gammaDuty);
+    return HostTest::Report();
+}
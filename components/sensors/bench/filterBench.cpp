@@ -0,0 +1,112 @@
+// Cost per sample of the filters in filters.h on the host, sample by
+// sample (Update) and over DMA-sized blocks (ProcessBlock):
+//
+//   moving average  int16_t fixed point vs float, windows 8 and 64
+//   EMA             EmaShift on int16_t vs float Ema
+//   median          windows 5 and 15 (sorted insert/remove)
+//   Hampel          windows 5 and 7 (median plus MAD per sample)
+//   Kalman1D        float vs Q12 on int16_t
+//   pipelines       the level sensor's LevelFilter, and a three-stage
+//                   chain per sample vs stage by stage over the block
+//
+// Build with -DCMAKE_BUILD_TYPE=Release. Host numbers only rank the
+// filters: the median-based stages cost tens of times the running sums.
+// MovingAverage and Ema have block loops of their own (Ema on the esp-dsp
+// biquad when that is in the build); the other stages run the same loop
+// in both columns.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "filters.h"
+#include "levelFilter.h"
+
+namespace
+{
+
+using namespace Sensors::Filters;
+
+constexpr size_t SAMPLES = 1 << 20;
+constexpr size_t BLOCK = 64;               // LEVEL_ADC_FRAME_SAMPLES
+
+// Keeps the results alive
+volatile double g_sink;
+
+template <typename T>
+std::vector<T> signal()
+{
+    std::vector<T> samples(SAMPLES);
+    srand(3);
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        int spike = rand() % 100 == 0 ? 1500 : 0;
+        samples[i] = static_cast<T>(1800 + (i / 1024) % 100 + rand() % 13 - 6 + spike);
+    }
+    return samples;
+}
+
+template <typename T>
+void consume(const std::vector<T>& out)
+{
+    double sum = 0;
+    for (size_t i = 0; i < out.size(); i += 97) {
+        sum += out[i];
+    }
+    g_sink = sum;
+}
+
+double nsPerSample(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / SAMPLES;
+}
+
+template <typename Filter, typename T>
+void measure(const char* name, Filter filter, const std::vector<T>& in)
+{
+    std::vector<T> out(in.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = filter.Update(in[i]);
+    }
+    double update = nsPerSample(start);
+    consume(out);
+
+    filter.Reset();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < in.size(); i += BLOCK) {
+        filter.ProcessBlock(&in[i], &out[i], BLOCK);
+    }
+    double block = nsPerSample(start);
+    consume(out);
+
+    printf("%-32s %10.2f %10.2f\n", name, update, block);
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<int16_t> fixed = signal<int16_t>();
+    std::vector<float> floats = signal<float>();
+
+    printf("%zu samples, blocks of %zu; ns per sample\n", SAMPLES, BLOCK);
+    printf("%-32s %10s %10s\n", "filter", "Update", "block");
+    measure("MovingAverage<int16_t, 8>", MovingAverage<int16_t, 8>(), fixed);
+    measure("MovingAverage<float, 8>", MovingAverage<float, 8>(), floats);
+    measure("MovingAverage<int16_t, 64>", MovingAverage<int16_t, 64>(), fixed);
+    measure("MovingAverage<float, 64>", MovingAverage<float, 64>(), floats);
+    measure("EmaShift<int16_t, 4>", EmaShift<int16_t, 4>(), fixed);
+    measure("Ema<float>", Ema<float>(1.0f / 16), floats);
+    measure("Median<int16_t, 5>", Median<int16_t, 5>(), fixed);
+    measure("Median<int16_t, 15>", Median<int16_t, 15>(), fixed);
+    measure("Hampel<float, 5>", Hampel<float, 5>(3.0f, 6.0f), floats);
+    measure("Hampel<float, 7>", Hampel<float, 7>(3.0f, 6.0f), floats);
+    measure("Kalman1D<float>", Kalman1D<float>(9.0f, 4.0f), floats);
+    measure("Kalman1D<int16_t, 12>", Kalman1D<int16_t, 12>(9.0f, 4.0f), fixed);
+    measure("LevelFilter", Sensors::MakeLevelFilter(9.0f, 4.0f), floats);
+    measure("Median 5 > MovingAverage 8 > EMA",
+            Pipeline<int16_t, Median<int16_t, 5>, MovingAverage<int16_t, 8>, EmaShift<int16_t, 3>>(), fixed);
+    return EXIT_SUCCESS;
+}
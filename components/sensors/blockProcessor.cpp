@@ -0,0 +1,88 @@
+#include "blockProcessor.h"
+#include <cmath>
+
+namespace Sensors
+{
+
+BlockStats BlockProcessor::Process(const uint16_t* samples, size_t count) const
+{
+    BlockStats stats = { 0.0f, 0.0f, 0, 0, 0, 0 };
+    if (count == 0) {
+        return stats;
+    }
+
+    // Integer sums are exact for any block a frame can hold
+    uint64_t sum = 0;
+    uint64_t sumSquares = 0;
+    uint16_t low = UINT16_MAX;
+    uint16_t high = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t sample = samples[i];
+        sum += sample;
+        sumSquares += sample * sample;
+        low = sample < low ? sample : low;
+        high = sample > high ? sample : high;
+    }
+
+    double mean = static_cast<double>(sum) / count;
+    double variance = static_cast<double>(sumSquares) / count - mean * mean;
+    double stdDev = variance > 0.0 ? std::sqrt(variance) : 0.0;
+    double limit = _outlierSigma * stdDev;
+
+    uint64_t keptSum = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (std::fabs(samples[i] - mean) <= limit) {
+            keptSum += samples[i];
+            kept++;
+        }
+    }
+
+    stats.mean = kept > 0 ? static_cast<float>(static_cast<double>(keptSum) / kept) : static_cast<float>(mean);
+    stats.stdDev = static_cast<float>(stdDev);
+    stats.accepted = static_cast<uint16_t>(kept);
+    stats.rejected = static_cast<uint16_t>(count - kept);
+    stats.min = low;
+    stats.max = high;
+    return stats;
+}
+
+Decimator::Decimator(uint32_t periodUs)
+    : _periodUs(periodUs), _windowStartUs(0), _open(false), _sum(0.0), _count(0) {}
+
+bool Decimator::Add(const BlockStats& block, uint32_t timeUs, float* mean, uint32_t* sampleUs)
+{
+    if (!_open) {
+        _open = true;
+        _windowStartUs = timeUs;
+    }
+    _sum += static_cast<double>(block.mean) * block.accepted;
+    _count += block.accepted;
+
+    if (static_cast<int32_t>(timeUs - _windowStartUs) < static_cast<int32_t>(_periodUs)) {
+        return false;
+    }
+
+    bool ready = _count > 0;
+    if (ready) {
+        *mean = static_cast<float>(_sum / _count);
+        *sampleUs = timeUs;
+    }
+    // The next period starts where this one ended, so the rate does not drift
+    _windowStartUs += _periodUs;
+    if (static_cast<int32_t>(timeUs - _windowStartUs) >= static_cast<int32_t>(_periodUs)) {
+        _windowStartUs = timeUs;
+    }
+    _sum = 0.0;
+    _count = 0;
+    return ready;
+}
+
+void Decimator::Reset()
+{
+    _open = false;
+    _sum = 0.0;
+    _count = 0;
+}
+
+} // namespace Sensors
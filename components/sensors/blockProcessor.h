@@ -0,0 +1,63 @@
+#ifndef BLOCK_PROCESSOR_H
+#define BLOCK_PROCESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Sensors
+{
+
+// Summary of one block of raw ADC codes
+struct BlockStats {
+    float mean;             // mean of the accepted samples
+    float stdDev;           // of the whole block, before rejection
+    uint16_t accepted;
+    uint16_t rejected;
+    uint16_t min;
+    uint16_t max;
+};
+
+/**
+ * @brief   Reduces a whole block of raw samples to one value.
+ *
+ * Sigma clipping: samples further than outlierSigma standard deviations
+ * from the block mean (pump switching spikes, splashes) are dropped and
+ * the rest is averaged. No hardware or RTOS dependency, so the same code
+ * runs on recorded sample files on the host.
+ */
+class BlockProcessor {
+public:
+    explicit BlockProcessor(float outlierSigma = 3.0f) : _outlierSigma(outlierSigma) {}
+
+    BlockStats Process(const uint16_t* samples, size_t count) const;
+
+private:
+    float _outlierSigma;
+};
+
+/**
+ * @brief   Decimates block results to one sample per period.
+ *
+ * Averages the blocks of a period, weighted by their accepted samples.
+ * The output is stamped with the end time of the period's last block.
+ * Times are 32 bit microseconds and may wrap.
+ */
+class Decimator {
+public:
+    explicit Decimator(uint32_t periodUs);
+
+    // Block ending at timeUs; true when a decimated sample is ready
+    bool Add(const BlockStats& block, uint32_t timeUs, float* mean, uint32_t* sampleUs);
+    void Reset();
+
+private:
+    uint32_t _periodUs;
+    uint32_t _windowStartUs;
+    bool _open;
+    double _sum;
+    uint32_t _count;
+};
+
+} // namespace Sensors
+
+#endif // BLOCK_PROCESSOR_H
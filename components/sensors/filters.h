@@ -0,0 +1,541 @@
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#if __has_include("dsps_biquad.h")
+#include "dsps_biquad.h"
+#define FILTERS_HAVE_ESP_DSP 1
+#endif
+
+/**
+ * @brief   Header-only sample filters, composed at compile time.
+ *
+ * Every filter has Update(x) -> y for one sample, ProcessBlock(in, out, n)
+ * for a block (in == out is fine) and Reset(). Integer sample types run
+ * in fixed point (accumulators one size up, EMA by shift, Kalman gain in
+ * Q format), float samples use the FPU; nothing allocates and the window
+ * sizes are template parameters. Pipeline<Stages...> chains filters; its
+ * ProcessBlock() runs the stages one after another over the whole block,
+ * which keeps each inner loop tight.
+ *
+ * MovingAverage and Ema have block loops of their own; with esp-dsp in
+ * the build (dsps_biquad.h) the float Ema runs on its biquad kernel. All
+ * other filters step through the block sample by sample.
+ *
+ * No hardware or RTOS dependency, the same code runs on the host.
+ */
+namespace Sensors
+{
+namespace Filters
+{
+
+// Accumulator for sums of samples: one size up for integers
+template <typename T> struct Accumulator { using type = T; };
+template <> struct Accumulator<int8_t> { using type = int32_t; };
+template <> struct Accumulator<uint8_t> { using type = uint32_t; };
+template <> struct Accumulator<int16_t> { using type = int32_t; };
+template <> struct Accumulator<uint16_t> { using type = uint32_t; };
+template <> struct Accumulator<int32_t> { using type = int64_t; };
+template <> struct Accumulator<uint32_t> { using type = uint64_t; };
+
+// Qm.Frac fixed point helpers
+template <int Frac>
+constexpr int32_t ToFixed(float value) {
+    return static_cast<int32_t>(value * (1 << Frac) + (value < 0 ? -0.5f : 0.5f));
+}
+
+template <int Frac>
+constexpr float FromFixed(int32_t value) {
+    return static_cast<float>(value) / (1 << Frac);
+}
+
+// Sample by sample over a block, for filters without a faster block path
+template <typename Derived, typename T>
+class BlockFilter {
+public:
+    void ProcessBlock(const T* in, T* out, size_t count) {
+        Derived& self = static_cast<Derived&>(*this);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = self.Update(in[i]);
+        }
+    }
+};
+
+/**
+ * @brief   Running mean over the last N samples, O(1) per sample.
+ *
+ * Float sums are rebuilt from the window once per N samples, so rounding
+ * errors of the running sum cannot pile up. ProcessBlock() gives the same
+ * results; once the window is full it runs up to each wrap of the window
+ * without a branch and divides by the constant N.
+ */
+template <typename T, size_t N>
+class MovingAverage {
+    static_assert(N > 0, "Window must not be empty");
+    using Acc = typename Accumulator<T>::type;
+
+public:
+    MovingAverage() { Reset(); }
+
+    T Update(T x) {
+        if (_count < N) {
+            _count++;
+        } else {
+            _sum -= _window[_next];
+        }
+        _window[_next] = x;
+        _sum += x;
+        if (++_next == N) {
+            _next = 0;
+            if constexpr (std::is_floating_point<T>::value) {
+                _sum = windowSum();
+            }
+        }
+        return divide(_sum, _count);
+    }
+
+    void ProcessBlock(const T* in, T* out, size_t count) {
+        size_t i = 0;
+        // Still filling: the divisor changes with every sample
+        for (; i < count && _count < N; ++i) {
+            out[i] = Update(in[i]);
+        }
+        // Sum and position in locals: a store through out may alias members
+        Acc sum = _sum;
+        size_t next = _next;
+        while (i < count) {
+            size_t run = std::min(count - i, N - next);
+            for (size_t k = 0; k < run; ++k) {
+                T x = in[i + k];
+                sum -= _window[next + k];
+                _window[next + k] = x;
+                sum += x;
+                out[i + k] = divide(sum, N);
+            }
+            i += run;
+            next += run;
+            if (next == N) {
+                next = 0;
+                if constexpr (std::is_floating_point<T>::value) {
+                    // Update() re-sums before it divides
+                    sum = windowSum();
+                    out[i - 1] = divide(sum, N);
+                }
+            }
+        }
+        _sum = sum;
+        _next = next;
+    }
+
+    void Reset() {
+        _sum = 0;
+        _next = 0;
+        _count = 0;
+    }
+
+private:
+    Acc windowSum() const {
+        Acc sum = 0;
+        for (size_t i = 0; i < N; ++i) {
+            sum += _window[i];
+        }
+        return sum;
+    }
+
+    static T divide(Acc sum, size_t count) {
+        if constexpr (std::is_floating_point<T>::value) {
+            return static_cast<T>(sum / static_cast<Acc>(count));
+        } else {
+            // Round half away from zero
+            Acc half = static_cast<Acc>(count / 2);
+            return static_cast<T>((sum >= 0 ? sum + half : sum - half) / static_cast<Acc>(count));
+        }
+    }
+
+    T _window[N];
+    Acc _sum;
+    size_t _next;
+    size_t _count;
+};
+
+/**
+ * @brief   Exponential moving average, y += alpha * (x - y); float samples.
+ *
+ * ProcessBlock() keeps y in a register instead of storing it per sample
+ * (out may alias the filter), with the same results as Update(). With
+ * esp-dsp, float blocks run through dsps_biquad_f32 as the first-order
+ * section y = alpha * x + (1 - alpha) * y[-1], which rounds differently
+ * in the last bits.
+ */
+template <typename T = float>
+class Ema {
+    static_assert(std::is_floating_point<T>::value, "Use EmaShift for integer samples");
+
+public:
+    explicit Ema(T alpha = T(0.1)) : _alpha(alpha) { Reset(); }
+
+    T Update(T x) {
+        if (!_primed) {
+            _primed = true;
+            _y = x;
+        } else {
+            _y += _alpha * (x - _y);
+        }
+        return _y;
+    }
+
+    void ProcessBlock(const T* in, T* out, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        size_t i = 0;
+        if (!_primed) {
+            out[0] = Update(in[0]);
+            i = 1;
+        }
+#ifdef FILTERS_HAVE_ESP_DSP
+        if constexpr (std::is_same<T, float>::value) {
+            if (_alpha > T(0) && count > i) {
+                // Direct form II: w = x + (1 - alpha) * w[-1], y = alpha * w
+                float coef[5] = { _alpha, 0.0f, 0.0f, _alpha - 1.0f, 0.0f };
+                float w[2] = { _y / _alpha, 0.0f };
+                dsps_biquad_f32(in + i, out + i, static_cast<int>(count - i), coef, w);
+                _y = out[count - 1];
+                return;
+            }
+        }
+#endif
+        T y = _y;
+        const T alpha = _alpha;
+        for (; i < count; ++i) {
+            y += alpha * (in[i] - y);
+            out[i] = y;
+        }
+        _y = y;
+    }
+
+    void Reset() {
+        _y = 0;
+        _primed = false;
+    }
+
+private:
+    T _alpha;
+    T _y;
+    bool _primed;
+};
+
+// Exponential moving average with alpha = 2^-Shift in fixed point; the
+// state keeps Shift extra fraction bits so small steps are not lost
+template <typename T, int Shift>
+class EmaShift : public BlockFilter<EmaShift<T, Shift>, T> {
+    static_assert(std::is_integral<T>::value, "Use Ema for float samples");
+    static_assert(Shift > 0 && Shift < 16, "Shift out of range");
+    using Acc = typename Accumulator<T>::type;
+
+public:
+    EmaShift() { Reset(); }
+
+    T Update(T x) {
+        if (!_primed) {
+            _primed = true;
+            _state = static_cast<Acc>(x) * (Acc(1) << Shift);
+        } else {
+            _state += static_cast<Acc>(x) - round(_state);
+        }
+        return static_cast<T>(round(_state));
+    }
+
+    void Reset() {
+        _state = 0;
+        _primed = false;
+    }
+
+private:
+    static Acc round(Acc state) {
+        Acc half = Acc(1) << (Shift - 1);
+        return state >= 0 ? (state + half) / (Acc(1) << Shift) : (state - half) / (Acc(1) << Shift);
+    }
+
+    Acc _state;
+    bool _primed;
+};
+
+// Sorted copy of the last N samples, shared by Median and Hampel
+template <typename T, size_t N>
+class SortedWindow {
+public:
+    SortedWindow() { Reset(); }
+
+    void Push(T x) {
+        if (_count == N) {
+            remove(_window[_next]);
+        } else {
+            _count++;
+        }
+        _window[_next] = x;
+        _next = (_next + 1) % N;
+        insert(x);
+    }
+
+    // Lower median while the window is still filling with an even count
+    T Median() const { return _sorted[(_count - 1) / 2]; }
+    size_t Count() const { return _count; }
+    const T* Sorted() const { return _sorted; }
+
+    void Reset() {
+        _next = 0;
+        _count = 0;
+    }
+
+private:
+    void remove(T x) {
+        size_t i = static_cast<size_t>(std::lower_bound(_sorted, _sorted + _count, x) - _sorted);
+        std::copy(_sorted + i + 1, _sorted + _count, _sorted + i);
+    }
+
+    void insert(T x) {
+        size_t filled = _count - 1;
+        size_t i = static_cast<size_t>(std::upper_bound(_sorted, _sorted + filled, x) - _sorted);
+        std::copy_backward(_sorted + i, _sorted + filled, _sorted + filled + 1);
+        _sorted[i] = x;
+    }
+
+    T _window[N];
+    T _sorted[N];
+    size_t _next;
+    size_t _count;
+};
+
+// Median of the last N samples (N odd), O(N) per sample
+template <typename T, size_t N>
+class Median : public BlockFilter<Median<T, N>, T> {
+    static_assert(N % 2 == 1, "Use an odd window for a true median");
+
+public:
+    T Update(T x) {
+        _window.Push(x);
+        return _window.Median();
+    }
+
+    void Reset() { _window.Reset(); }
+
+private:
+    SortedWindow<T, N> _window;
+};
+
+/**
+ * @brief   Hampel outlier filter over the last N samples (causal).
+ *
+ * A sample further than k * 1.4826 * MAD (median absolute deviation,
+ * scaled to a standard deviation) from the window median is replaced by
+ * the median; everything else passes unchanged. minDeviation keeps a flat
+ * signal (MAD 0) from flagging every bit of noise.
+ */
+template <typename T, size_t N>
+class Hampel : public BlockFilter<Hampel<T, N>, T> {
+    static_assert(N >= 3, "Hampel needs a window of at least 3");
+
+public:
+    explicit Hampel(float k = 3.0f, float minDeviation = 0.0f) : _k(k), _minDeviation(minDeviation) {}
+
+    T Update(T x) {
+        _window.Push(x);
+        size_t count = _window.Count();
+        if (count < 3) {
+            return x;
+        }
+
+        T median = _window.Median();
+        float deviations[N];
+        const T* sorted = _window.Sorted();
+        for (size_t i = 0; i < count; ++i) {
+            deviations[i] = std::fabs(static_cast<float>(sorted[i]) - static_cast<float>(median));
+        }
+        float* mid = deviations + (count - 1) / 2;
+        std::nth_element(deviations, mid, deviations + count);
+
+        float limit = std::max(_k * 1.4826f * *mid, _minDeviation);
+        bool outlier = std::fabs(static_cast<float>(x) - static_cast<float>(median)) > limit;
+        _outliers += outlier ? 1 : 0;
+        return outlier ? median : x;
+    }
+
+    void Reset() {
+        _window.Reset();
+        _outliers = 0;
+    }
+
+    uint32_t Outliers() const { return _outliers; }
+
+private:
+    SortedWindow<T, N> _window;
+    float _k;
+    float _minDeviation;
+    uint32_t _outliers = 0;
+};
+
+/**
+ * @brief   1-D Kalman filter for a slowly moving value (random walk).
+ *
+ * processNoise: variance the true value gains per sample; measurement
+ * noise: variance of one reading. Their ratio sets the smoothing.
+ *
+ * Float samples run in floating point (Frac unused). 8- and 16-bit
+ * integer samples run in Q(Frac) fixed point: state and variances are
+ * ToFixed<Frac> of sample units, the gain p / (p + r) is one 64-bit
+ * division per sample and applied by a 32 x 32 -> 64 bit multiply. The
+ * variances must stay below 2^(31 - Frac) squared codes; the output is
+ * the state rounded to the nearest code.
+ */
+template <typename T = float, int Frac = 12, bool = std::is_floating_point<T>::value>
+class Kalman1D;
+
+template <typename T, int Frac>
+class Kalman1D<T, Frac, true> : public BlockFilter<Kalman1D<T, Frac, true>, T> {
+public:
+    Kalman1D(T processNoise, T measurementNoise)
+        : _q(processNoise), _r(measurementNoise) { Reset(); }
+
+    T Update(T z) {
+        if (!_primed) {
+            _primed = true;
+            _x = z;
+            _p = _r;
+            return _x;
+        }
+        _p += _q;
+        T gain = _p / (_p + _r);
+        _x += gain * (z - _x);
+        _p *= T(1) - gain;
+        return _x;
+    }
+
+    void Reset() {
+        _x = 0;
+        _p = 0;
+        _primed = false;
+    }
+
+    T Variance() const { return _p; }
+
+private:
+    T _q;
+    T _r;
+    T _x;
+    T _p;
+    bool _primed;
+};
+
+template <typename T, int Frac>
+class Kalman1D<T, Frac, false> : public BlockFilter<Kalman1D<T, Frac, false>, T> {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 2, "Fixed-point Kalman1D takes 8- or 16-bit samples");
+    static_assert(Frac > 0 && Frac <= 14, "Frac out of range");
+    static constexpr int32_t ONE = int32_t(1) << Frac;
+
+public:
+    Kalman1D(float processNoise, float measurementNoise)
+        : _q(static_cast<uint32_t>(ToFixed<Frac>(processNoise))),
+          _r(static_cast<uint32_t>(ToFixed<Frac>(measurementNoise))) { Reset(); }
+
+    T Update(T z) {
+        int32_t measured = static_cast<int32_t>(z) * ONE;
+        if (!_primed) {
+            _primed = true;
+            _x = measured;
+            _p = _r;
+            return z;
+        }
+        _p += _q;
+        uint64_t total = static_cast<uint64_t>(_p) + _r;
+        int32_t gain = total > 0 ? static_cast<int32_t>((static_cast<uint64_t>(_p) << Frac) / total) : ONE;
+        _x += static_cast<int32_t>(shift(static_cast<int64_t>(gain) * (measured - _x)));
+        _p = static_cast<uint32_t>(shift(static_cast<int64_t>(_p) * (ONE - gain)));
+        return static_cast<T>(shift(_x));
+    }
+
+    void Reset() {
+        _x = 0;
+        _p = 0;
+        _primed = false;
+    }
+
+    float Variance() const { return FromFixed<Frac>(static_cast<int32_t>(_p)); }
+
+private:
+    // value / 2^Frac, halves rounded away from zero
+    static int64_t shift(int64_t value) {
+        int64_t half = ONE / 2;
+        return value >= 0 ? (value + half) / ONE : (value - half) / ONE;
+    }
+
+    uint32_t _q;
+    uint32_t _r;
+    int32_t _x;
+    uint32_t _p;
+    bool _primed;
+};
+
+/**
+ * @brief   Chain of filters, first stage first.
+ *
+ *     Pipeline<float, Hampel<float, 7>, Kalman1D<float>> level(
+ *         Hampel<float, 7>(3.0f), Kalman1D<float>(0.01f, 4.0f));
+ */
+template <typename T, typename... Stages>
+class Pipeline {
+public:
+    Pipeline() = default;
+    explicit Pipeline(Stages... stages) : _stages(stages...) {}
+
+    T Update(T x) {
+        return update<0>(x);
+    }
+
+    // Stage by stage over the whole block
+    void ProcessBlock(const T* in, T* out, size_t count) {
+        processBlock<0>(in, out, count);
+    }
+
+    void Reset() {
+        std::apply([](auto&... stage) { (stage.Reset(), ...); }, _stages);
+    }
+
+    template <size_t I>
+    auto& Stage() { return std::get<I>(_stages); }
+
+private:
+    template <size_t I>
+    T update(T x) {
+        if constexpr (I == sizeof...(Stages)) {
+            return x;
+        } else {
+            return update<I + 1>(std::get<I>(_stages).Update(x));
+        }
+    }
+
+    template <size_t I>
+    void processBlock(const T* in, T* out, size_t count) {
+        if constexpr (I == sizeof...(Stages)) {
+            if (in != out) {
+                std::copy(in, in + count, out);
+            }
+        } else {
+            std::get<I>(_stages).ProcessBlock(in, out, count);
+            processBlock<I + 1>(out, out, count);
+        }
+    }
+
+    std::tuple<Stages...> _stages;
+};
+
+} // namespace Filters
+} // namespace Sensors
+
+#endif // FILTERS_H
@@ -0,0 +1,96 @@
+#include "flowEstimator.h"
+#include <cmath>
+
+namespace Sensors
+{
+
+FlowEstimator::FlowEstimator(const Config& config)
+    : _config(config),
+      _started(false),
+      _lastCount(0),
+      _lastUs(0),
+      _pulseUs(0),
+      _periodCount(0),
+      _periodUs(0),
+      _periodOpen(false),
+      _rate(0.0f),
+      _reported(0.0f),
+      _volume(0.0),
+      _pulses(0) {}
+
+float FlowEstimator::toRate(uint32_t pulses, uint32_t spanUs) const
+{
+    if (spanUs == 0) {
+        return _rate;
+    }
+    return pulses * US_PER_MINUTE / (static_cast<float>(spanUs) * _config.pulsesPerLiter);
+}
+
+bool FlowEstimator::Update(uint32_t timeUs, int32_t count)
+{
+    if (!_started) {
+        _started = true;
+        _lastCount = count;
+        _lastUs = _pulseUs = timeUs;
+        return false;
+    }
+
+    uint32_t pulses = static_cast<uint32_t>(count) - static_cast<uint32_t>(_lastCount);
+    uint32_t windowUs = timeUs - _lastUs;
+
+    if (pulses > 0) {
+        if (!_periodOpen) {
+            // From standstill: a busy window is a measurement of its own,
+            // a pulse or two only opens the first period
+            if (pulses >= _config.minPeriodPulses) {
+                _rate = toRate(pulses, windowUs);
+            }
+            _periodOpen = true;
+            _periodCount = count;
+            _periodUs = timeUs;
+        } else {
+            uint32_t periodPulses = static_cast<uint32_t>(count) - static_cast<uint32_t>(_periodCount);
+            uint32_t periodUs = timeUs - _periodUs;
+            // Long enough that one pulse (or one window) more or less hardly matters
+            if (periodPulses >= _config.minPeriodPulses || periodUs >= _config.maxPeriodUs) {
+                _rate = toRate(periodPulses, periodUs);
+                _periodCount = count;
+                _periodUs = timeUs;
+            }
+        }
+        _pulseUs = timeUs;
+    } else if (timeUs - _pulseUs >= _config.zeroTimeoutUs) {
+        _rate = 0.0f;
+        _periodOpen = false;
+    }
+
+    // A sudden slowdown (pump running dry) must not wait for the period:
+    // this window had fewer than pulses + 1, and the last pulse may have
+    // come early in its window, so these bound the rate from above
+    float bound = toRate(pulses + 1, windowUs);
+    uint32_t silentUs = timeUs - _pulseUs;
+    if (pulses == 0 && silentUs > windowUs) {
+        float silentBound = toRate(1, silentUs - windowUs);
+        bound = silentBound < bound ? silentBound : bound;
+    }
+    if (bound < _rate) {
+        _rate = bound;
+        _periodCount = count;
+        _periodUs = timeUs;
+    }
+
+    _pulses += pulses;
+    _volume += pulses / static_cast<double>(_config.pulsesPerLiter);
+    _lastCount = count;
+    _lastUs = timeUs;
+
+    float threshold = std::fmax(_config.minChange, _config.relativeChange * _reported);
+    bool startedOrStopped = (_rate == 0.0f) != (_reported == 0.0f);
+    if (startedOrStopped || std::fabs(_rate - _reported) >= threshold) {
+        _reported = _rate;
+        return true;
+    }
+    return false;
+}
+
+} // namespace Sensors
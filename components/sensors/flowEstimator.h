@@ -0,0 +1,66 @@
+#ifndef FLOW_ESTIMATOR_H
+#define FLOW_ESTIMATOR_H
+
+#include <cstdint>
+
+namespace Sensors
+{
+
+/**
+ * @brief   Flow rate and volume from a cumulative pulse count.
+ *
+ * Fed with the counter value at the end of every window. The rate is
+ * measured over periods between two windows with pulses that span at
+ * least minPeriodPulses pulses or maxPeriodUs: at high flows that is a
+ * window or two, at low flows, where a window sees a pulse or none, the
+ * period stretches so the one-pulse and one-window quantisation stays
+ * small. A window with far fewer pulses than the rate predicts lowers it
+ * at once (e.g. a pump running dry); when pulses stop, the rate decays
+ * with the time since the last pulse and drops to zero after
+ * zeroTimeoutUs.
+ *
+ * Update() reports only meaningful changes of the rate, so the caller can
+ * stay silent while the flow is steady. No hardware or RTOS dependency.
+ */
+class FlowEstimator {
+public:
+    struct Config {
+        float pulsesPerLiter = 450.0f;      // Elecrow G1/2": f = 7.5 * Q (L/min)
+        uint32_t minPeriodPulses = 32;      // a period ends after this many pulses
+        uint32_t maxPeriodUs = 2000000;     // ... or after this long, if it saw pulses
+        uint32_t zeroTimeoutUs = 3000000;
+        float minChange = 0.1f;             // L/min
+        float relativeChange = 0.05f;
+    };
+
+    explicit FlowEstimator(const Config& config);
+
+    // Cumulative count (may wrap) at timeUs; true when the rate changed meaningfully
+    bool Update(uint32_t timeUs, int32_t count);
+
+    float Rate() const { return _rate; }            // L/min
+    double Volume() const { return _volume; }       // L since start
+    uint32_t Pulses() const { return _pulses; }
+
+private:
+    static constexpr float US_PER_MINUTE = 60.0e6f;
+
+    float toRate(uint32_t pulses, uint32_t spanUs) const;
+
+    Config _config;
+    bool _started;
+    int32_t _lastCount;
+    uint32_t _lastUs;
+    uint32_t _pulseUs;      // end of the last window with pulses
+    int32_t _periodCount;   // start of the running measurement period
+    uint32_t _periodUs;
+    bool _periodOpen;
+    float _rate;
+    float _reported;
+    double _volume;
+    uint32_t _pulses;
+};
+
+} // namespace Sensors
+
+#endif // FLOW_ESTIMATOR_H
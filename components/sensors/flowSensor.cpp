@@ -0,0 +1,81 @@
+#include "flowSensor.h"
+#include "eventBus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace Sensors
+{
+static const char* TAG = "Flow";
+
+FlowSensor::FlowSensor(const Config& config)
+    : ActiveObject("Flow", Executor::Shared(), 4),
+      _config(config),
+      _unit(nullptr),
+      _channel(nullptr),
+      _estimator(config.estimator),
+      _tick(new FlowWindowEvent()),
+      _running(false)
+{
+    pcnt_unit_config_t unitConfig = {};
+    unitConfig.low_limit = -1;
+    unitConfig.high_limit = FLOW_PCNT_HIGH_LIMIT;
+    // Keep counting across the limit, the driver adds up the overflows
+    unitConfig.flags.accum_count = 1;
+    ESP_ERROR_CHECK(pcnt_new_unit(&unitConfig, &_unit));
+
+    pcnt_glitch_filter_config_t filter = {};
+    filter.max_glitch_ns = config.glitchNs;
+    ESP_ERROR_CHECK(pcnt_unit_set_glitch_filter(_unit, &filter));
+
+    pcnt_chan_config_t channelConfig = {};
+    channelConfig.edge_gpio_num = config.pin;
+    channelConfig.level_gpio_num = -1;
+    ESP_ERROR_CHECK(pcnt_new_channel(_unit, &channelConfig, &_channel));
+    ESP_ERROR_CHECK(pcnt_channel_set_edge_action(_channel, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                                 PCNT_CHANNEL_EDGE_ACTION_HOLD));
+    ESP_ERROR_CHECK(pcnt_unit_add_watch_point(_unit, FLOW_PCNT_HIGH_LIMIT));
+
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<FlowWindowEvent>([this](const FlowWindowEvent&) { onWindow(); });
+    coalesce<FlowWindowEvent>(Mailbox::Coalesce::ReplaceLatest);
+
+    ESP_LOGI(TAG, "Flow meter on GPIO %d, %u ms window, %.0f pulses/L", (int)config.pin,
+             (unsigned)config.windowMs, config.estimator.pulsesPerLiter);
+}
+
+void FlowSensor::start()
+{
+    if (_running) {
+        return;
+    }
+    ESP_ERROR_CHECK(pcnt_unit_enable(_unit));
+    ESP_ERROR_CHECK(pcnt_unit_clear_count(_unit));
+    ESP_ERROR_CHECK(pcnt_unit_start(_unit));
+    _running = true;
+
+    _estimator.Update(static_cast<uint32_t>(esp_timer_get_time()), 0);
+    _timer.Start(_config.windowMs, _tick->Retain());
+}
+
+void FlowSensor::onWindow()
+{
+    // Re-arm first so handling time does not stretch the window
+    _timer.Start(_config.windowMs, _tick->Retain());
+
+    int count = 0;
+    if (pcnt_unit_get_count(_unit, &count) != ESP_OK) {
+        return;
+    }
+    uint32_t nowUs = static_cast<uint32_t>(esp_timer_get_time());
+    if (!_estimator.Update(nowUs, static_cast<int32_t>(count))) {
+        return;
+    }
+
+    ESP_LOGD(TAG, "Flow %.2f L/min, %.2f L total", _estimator.Rate(), _estimator.Volume());
+    EventBus::get().publish(new MeasurementEvent(MeasurementEvent::Quantity::Flow, _estimator.Rate(),
+                                                 nowUs, "Flow"));
+    EventBus::get().publish(new MeasurementEvent(MeasurementEvent::Quantity::Volume,
+                                                 static_cast<float>(_estimator.Volume()), nowUs, "Flow"));
+}
+
+} // namespace Sensors
@@ -0,0 +1,32 @@
+#ifndef LEVEL_FILTER_H
+#define LEVEL_FILTER_H
+
+#include <cmath>
+
+#include "filters.h"
+
+namespace Sensors
+{
+
+/**
+ * @brief   Smoothing of the decimated water level, one raw value per period.
+ *
+ * The BlockProcessor only sees one block at a time, so a disturbance
+ * longer than a block (a pump starting, a wave against the probe) skews
+ * a whole period. The Hampel stage replaces such a period by the median
+ * of the last five; a real step therefore shows up two periods late. The
+ * Kalman stage then smooths the sloshing of the surface.
+ */
+using LevelFilter = Filters::Pipeline<float, Filters::Hampel<float, 5>, Filters::Kalman1D<float>>;
+
+// drift: variance the level gains per period; noise: variance of one
+// period's mean (both in raw codes squared)
+inline LevelFilter MakeLevelFilter(float drift, float noise)
+{
+    return LevelFilter(Filters::Hampel<float, 5>(3.0f, 3.0f * std::sqrt(noise)),
+                       Filters::Kalman1D<float>(drift, noise));
+}
+
+} // namespace Sensors
+
+#endif // LEVEL_FILTER_H
@@ -0,0 +1,152 @@
+#include "levelSensor.h"
+#include "eventBus.h"
+#include "esp_log.h"
+
+namespace Sensors
+{
+static const char* TAG = "Level";
+
+LevelSensor::LevelSensor(const Config& config)
+    : ActiveObject("Level", Executor::Shared(), 8),
+      _config(config),
+      _adc(nullptr),
+      _frames("adc_level", *this, toFrameEvent, this, 8),
+      _processor(config.outlierSigma),
+      _decimator(config.publishMs * 1000),
+      _filter(MakeLevelFilter(config.levelDrift, config.levelNoise)),
+      _frameUs(static_cast<uint32_t>(1000000ull * LEVEL_ADC_FRAME_SAMPLES / config.sampleRateHz)),
+      _running(false),
+      _overruns(0)
+{
+    adc_continuous_handle_cfg_t handleConfig = {};
+    handleConfig.max_store_buf_size = LEVEL_ADC_POOL_FRAMES * FRAME_BYTES;
+    handleConfig.conv_frame_size = FRAME_BYTES;
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handleConfig, &_adc));
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = LEVEL_ADC_ATTEN;
+    pattern.channel = config.channel;
+    pattern.unit = ADC_UNIT_1;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    adc_continuous_config_t adcConfig = {};
+    adcConfig.pattern_num = 1;
+    adcConfig.adc_pattern = &pattern;
+    adcConfig.sample_freq_hz = config.sampleRateHz;
+    adcConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    adcConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    ESP_ERROR_CHECK(adc_continuous_config(_adc, &adcConfig));
+
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_conv_done = onConversionDone;
+    callbacks.on_pool_ovf = onPoolOverflow;
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(_adc, &callbacks, this));
+
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<AdcFrameEvent>([this](const AdcFrameEvent& e) { onFrames(e.getDoneUs()); });
+    // One pending frame event is enough, each one drains the whole pool
+    coalesce<AdcFrameEvent>(Mailbox::Coalesce::ReplaceLatest);
+
+    ESP_LOGI(TAG, "ADC1 channel %d, %u Hz, %u samples per block, publish every %u ms",
+             (int)config.channel, (unsigned)config.sampleRateHz, (unsigned)LEVEL_ADC_FRAME_SAMPLES,
+             (unsigned)config.publishMs);
+}
+
+void LevelSensor::start()
+{
+    if (_running) {
+        return;
+    }
+    _decimator.Reset();
+    _filter.Reset();
+    ESP_ERROR_CHECK(adc_continuous_start(_adc));
+    _running = true;
+}
+
+// DMA frame complete (ISR)
+bool IRAM_ATTR LevelSensor::onConversionDone(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* data,
+                                             void* context)
+{
+    (void)handle;
+    (void)data;
+    LevelSensor* self = static_cast<LevelSensor*>(context);
+    BaseType_t woken = pdFALSE;
+    self->_frames.Raise(0, 0, &woken);
+    return woken == pdTRUE;
+}
+
+// Driver pool full, the oldest frame is lost (ISR)
+bool IRAM_ATTR LevelSensor::onPoolOverflow(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* data,
+                                           void* context)
+{
+    (void)handle;
+    (void)data;
+    static_cast<LevelSensor*>(context)->_overruns.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// Runs in the IsrService task
+const Event* LevelSensor::toFrameEvent(const IsrChannel::Slot& slot, void* context)
+{
+    (void)context;
+    return new AdcFrameEvent(slot.timeUs);
+}
+
+void LevelSensor::onFrames(uint32_t doneUs)
+{
+    // Read everything pending first: the last frame ended at doneUs, each
+    // earlier one a frame period before
+    size_t frames = 0;
+    while (frames < LEVEL_ADC_POOL_FRAMES &&
+           adc_continuous_read(_adc, _buffer[frames], FRAME_BYTES, &_lengths[frames], 0) == ESP_OK) {
+        frames++;
+    }
+
+    for (size_t i = 0; i < frames; ++i) {
+        size_t count = extract(_buffer[i], _lengths[i], _samples);
+        if (count == 0) continue;
+
+        BlockStats block = _processor.Process(_samples, count);
+        uint32_t blockUs = doneUs - static_cast<uint32_t>(frames - 1 - i) * _frameUs;
+        if (block.rejected > 0) {
+            ESP_LOGD(TAG, "Block: %u outliers rejected (%u..%u)", (unsigned)block.rejected,
+                     (unsigned)block.min, (unsigned)block.max);
+        }
+
+        float raw;
+        uint32_t sampleUs;
+        if (_decimator.Add(block, blockUs, &raw, &sampleUs)) {
+            float filtered = _filter.Update(raw);
+            float level = toLevel(filtered);
+            ESP_LOGD(TAG, "Level %.1f %% (raw %.1f, filtered %.1f)", level, raw, filtered);
+            EventBus::get().publish(new MeasurementEvent(MeasurementEvent::Quantity::WaterLevel, level,
+                                                         sampleUs, "Level"));
+        }
+    }
+}
+
+// Raw codes of our channel out of a DMA frame
+size_t LevelSensor::extract(const uint8_t* frame, uint32_t length, uint16_t* samples) const
+{
+    size_t count = 0;
+    for (uint32_t offset = 0; offset + SOC_ADC_DIGI_RESULT_BYTES <= length && count < LEVEL_ADC_FRAME_SAMPLES;
+         offset += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* result = reinterpret_cast<const adc_digi_output_data_t*>(&frame[offset]);
+        if (result->type2.channel == static_cast<uint32_t>(_config.channel)) {
+            samples[count++] = static_cast<uint16_t>(result->type2.data);
+        }
+    }
+    return count;
+}
+
+float LevelSensor::toLevel(float raw) const
+{
+    float span = static_cast<float>(_config.fullRaw) - static_cast<float>(_config.emptyRaw);
+    if (span == 0.0f) {
+        return 0.0f;
+    }
+    float level = (raw - _config.emptyRaw) * 100.0f / span;
+    return level < 0.0f ? 0.0f : (level > 100.0f ? 100.0f : level);
+}
+
+} // namespace Sensors
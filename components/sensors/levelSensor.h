@@ -0,0 +1,109 @@
+#ifndef LEVEL_SENSOR_H
+#define LEVEL_SENSOR_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "activeObject.h"
+#include "events.h"
+#include "isrChannel.h"
+#include "blockProcessor.h"
+#include "levelFilter.h"
+#include "esp_adc/adc_continuous.h"
+
+// Samples per DMA frame (one block for the BlockProcessor)
+#ifndef LEVEL_ADC_FRAME_SAMPLES
+#define LEVEL_ADC_FRAME_SAMPLES 64
+#endif
+
+// Frames the driver buffers between two reads by the actor
+#ifndef LEVEL_ADC_POOL_FRAMES
+#define LEVEL_ADC_POOL_FRAMES 4
+#endif
+
+#ifndef LEVEL_ADC_ATTEN
+#define LEVEL_ADC_ATTEN ADC_ATTEN_DB_12
+#endif
+
+namespace Sensors
+{
+
+/**
+ * @brief   Capacitive water-level sensor on the continuous (DMA) ADC.
+ *
+ * The ADC samples one channel in the background and DMA fills frames of
+ * LEVEL_ADC_FRAME_SAMPLES into the driver's pool; the CPU only sees the
+ * frame-done interrupt, which is forwarded through an IsrChannel. The
+ * actor then reads every pending frame, reduces each one with the
+ * BlockProcessor (outlier rejection, mean), decimates the blocks to one
+ * value per publish period and smooths those with the LevelFilter
+ * (levelFilter.h) into a MeasurementEvent (Quantity::WaterLevel, % of
+ * the calibrated range) on the EventBus.
+ *
+ * Sampling starts on OnStart.
+ */
+class LevelSensor : public ActiveObject {
+public:
+    struct Config {
+        adc_channel_t channel = ADC_CHANNEL_0;  // ADC1 only
+        uint32_t sampleRateHz = 1000;
+        uint32_t publishMs = 1000;
+        uint16_t emptyRaw = 0;                  // raw code at 0 %
+        uint16_t fullRaw = 4095;                // raw code at 100 %
+        float outlierSigma = 3.0f;
+        float levelDrift = 9.0f;                // LevelFilter, raw codes^2 per period
+        float levelNoise = 4.0f;                // LevelFilter, raw codes^2
+    };
+
+    explicit LevelSensor(const Config& config);
+
+    // Frames the driver had to drop because the actor read too late
+    uint32_t Overruns() const { return _overruns.load(std::memory_order_relaxed); }
+
+private:
+    static bool IRAM_ATTR onConversionDone(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* data,
+                                           void* context);
+    static bool IRAM_ATTR onPoolOverflow(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* data,
+                                         void* context);
+    static const Event* toFrameEvent(const IsrChannel::Slot& slot, void* context);
+
+    void start();
+    void onFrames(uint32_t doneUs);
+    size_t extract(const uint8_t* frame, uint32_t length, uint16_t* samples) const;
+    float toLevel(float raw) const;
+
+    static constexpr size_t FRAME_BYTES = LEVEL_ADC_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES;
+
+    Config _config;
+    adc_continuous_handle_t _adc;
+    IsrChannel _frames;
+    BlockProcessor _processor;
+    Decimator _decimator;
+    LevelFilter _filter;
+    uint32_t _frameUs;
+    bool _running;
+    std::atomic<uint32_t> _overruns;
+
+    uint8_t _buffer[LEVEL_ADC_POOL_FRAMES][FRAME_BYTES];
+    uint32_t _lengths[LEVEL_ADC_POOL_FRAMES];
+    uint16_t _samples[LEVEL_ADC_FRAME_SAMPLES];
+
+    // Disallow copy and assignment
+    LevelSensor(const LevelSensor&) = delete;
+    LevelSensor& operator=(const LevelSensor&) = delete;
+};
+
+// DMA frame(s) ready, stamped with the frame-done interrupt time
+class AdcFrameEvent : public TypedEvent<AdcFrameEvent, Event::Type::AdcFrame, Event::Priority::High> {
+public:
+    explicit AdcFrameEvent(uint32_t doneUs) : TypedEvent("ADC"), _doneUs(doneUs) {}
+
+    uint32_t getDoneUs() const { return _doneUs; }
+
+private:
+    uint32_t _doneUs;
+};
+
+} // namespace Sensors
+
+#endif // LEVEL_SENSOR_H
@@ -0,0 +1,288 @@
+#include "oneWireBus.h"
+#include "esp_log.h"
+
+namespace Sensors
+{
+static const char* TAG = "OneWire";
+
+// Slot timing in microseconds (RMT resolution 1 MHz)
+static constexpr uint32_t RESOLUTION_HZ = 1000000;
+static constexpr uint16_t RESET_LOW_US = 500;
+static constexpr uint16_t RESET_RELEASE_US = 480;
+static constexpr uint16_t PRESENCE_MIN_US = 30;
+static constexpr uint16_t SLOT_1_LOW_US = 6;
+static constexpr uint16_t SLOT_1_HIGH_US = 64;
+static constexpr uint16_t SLOT_0_LOW_US = 60;
+static constexpr uint16_t SLOT_0_HIGH_US = 10;
+// A read slot held low beyond this by a device reads as 0
+static constexpr uint16_t READ_ZERO_US = 15;
+
+// Receptions end when the line idles longer than the longest gap of the
+// sequence: the reset release, or the high phase of a 1 slot
+static const rmt_receive_config_t RESET_RX = { 1000, 1000000 };
+static const rmt_receive_config_t SLOTS_RX = { 1000, 100000 };
+
+static rmt_symbol_word_t makeSymbol(uint16_t lowUs, uint16_t highUs)
+{
+    rmt_symbol_word_t symbol = {};
+    symbol.level0 = 0;
+    symbol.duration0 = lowUs;
+    symbol.level1 = 1;
+    symbol.duration1 = highUs;
+    return symbol;
+}
+
+OneWireBus::OneWireBus(gpio_num_t pin)
+    : _pin(pin),
+      _tx(nullptr),
+      _rx(nullptr),
+      _encoder(nullptr),
+      _done(xQueueCreate(1, sizeof(rmt_rx_done_event_data_t)))
+{
+    // RX first, the TX channel then shares the pin (open drain, looped back)
+    rmt_rx_channel_config_t rxConfig = {};
+    rxConfig.gpio_num = pin;
+    rxConfig.clk_src = RMT_CLK_SRC_DEFAULT;
+    rxConfig.resolution_hz = RESOLUTION_HZ;
+    rxConfig.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL;
+    if (rmt_new_rx_channel(&rxConfig, &_rx) != ESP_OK) {
+        ESP_LOGE(TAG, "No RMT RX channel for GPIO %d", (int)pin);
+        _rx = nullptr;
+        return;
+    }
+
+    rmt_tx_channel_config_t txConfig = {};
+    txConfig.gpio_num = pin;
+    txConfig.clk_src = RMT_CLK_SRC_DEFAULT;
+    txConfig.resolution_hz = RESOLUTION_HZ;
+    txConfig.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL;
+    txConfig.trans_queue_depth = 2;
+    txConfig.flags.io_loop_back = 1;
+    txConfig.flags.io_od_mode = 1;
+    if (rmt_new_tx_channel(&txConfig, &_tx) != ESP_OK) {
+        ESP_LOGE(TAG, "No RMT TX channel for GPIO %d", (int)pin);
+        _tx = nullptr;
+        return;
+    }
+
+    rmt_copy_encoder_config_t encoderConfig = {};
+    ESP_ERROR_CHECK(rmt_new_copy_encoder(&encoderConfig, &_encoder));
+
+    rmt_rx_event_callbacks_t callbacks = {};
+    callbacks.on_recv_done = onReceiveDone;
+    ESP_ERROR_CHECK(rmt_rx_register_event_callbacks(_rx, &callbacks, this));
+
+    ESP_ERROR_CHECK(rmt_enable(_rx));
+    ESP_ERROR_CHECK(rmt_enable(_tx));
+    gpio_pullup_en(pin);
+}
+
+OneWireBus::~OneWireBus()
+{
+    if (_tx != nullptr) {
+        rmt_disable(_tx);
+        rmt_del_channel(_tx);
+    }
+    if (_rx != nullptr) {
+        rmt_disable(_rx);
+        rmt_del_channel(_rx);
+    }
+    if (_encoder != nullptr) {
+        rmt_del_encoder(_encoder);
+    }
+    vQueueDelete(_done);
+}
+
+bool IRAM_ATTR OneWireBus::onReceiveDone(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t* data,
+                                         void* context)
+{
+    (void)channel;
+    OneWireBus* self = static_cast<OneWireBus*>(context);
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(self->_done, data, &woken);
+    return woken == pdTRUE;
+}
+
+bool OneWireBus::receive(TickType_t timeout, size_t* symbols)
+{
+    rmt_rx_done_event_data_t data;
+    bool received = xQueueReceive(_done, &data, timeout) == pdTRUE;
+    // The symbols must stay put until the transmission is over, too
+    rmt_tx_wait_all_done(_tx, timeout);
+    if (!received) {
+        ESP_LOGW(TAG, "GPIO %d: bus timeout", (int)_pin);
+        return false;
+    }
+    *symbols = data.num_symbols;
+    return true;
+}
+
+bool OneWireBus::Reset()
+{
+    if (!IsValid()) {
+        return false;
+    }
+
+    rmt_symbol_word_t pulse = makeSymbol(RESET_LOW_US, RESET_RELEASE_US);
+    rmt_transmit_config_t txConfig = {};
+    if (rmt_receive(_rx, _rxSymbols, sizeof(_rxSymbols), &RESET_RX) != ESP_OK ||
+        rmt_transmit(_tx, _encoder, &pulse, sizeof(pulse), &txConfig) != ESP_OK) {
+        return false;
+    }
+    size_t symbols = 0;
+    if (!receive(pdMS_TO_TICKS(10), &symbols)) {
+        return false;
+    }
+
+    // Our reset pulse, then a device pulling low again in the release phase
+    for (size_t i = 0; i < symbols; ++i) {
+        const rmt_symbol_word_t& s = _rxSymbols[i];
+        if (i > 0 && s.level0 == 0 && s.duration0 >= PRESENCE_MIN_US) return true;
+        if (s.level1 == 0 && s.duration1 >= PRESENCE_MIN_US) return true;
+    }
+    return false;
+}
+
+bool OneWireBus::transfer(uint8_t tx, size_t bits, uint8_t* rx)
+{
+    if (!IsValid() || bits == 0 || bits > 8) {
+        return false;
+    }
+
+    rmt_symbol_word_t slots[8];
+    for (size_t i = 0; i < bits; ++i) {
+        slots[i] = ((tx >> i) & 1) ? makeSymbol(SLOT_1_LOW_US, SLOT_1_HIGH_US)
+                                   : makeSymbol(SLOT_0_LOW_US, SLOT_0_HIGH_US);
+    }
+
+    rmt_transmit_config_t txConfig = {};
+    if (rmt_receive(_rx, _rxSymbols, sizeof(_rxSymbols), &SLOTS_RX) != ESP_OK ||
+        rmt_transmit(_tx, _encoder, slots, bits * sizeof(rmt_symbol_word_t), &txConfig) != ESP_OK) {
+        return false;
+    }
+    size_t symbols = 0;
+    if (!receive(pdMS_TO_TICKS(10), &symbols)) {
+        return false;
+    }
+
+    // One low phase per slot, in order
+    uint8_t value = 0;
+    size_t slot = 0;
+    for (size_t i = 0; i < symbols && slot < bits; ++i) {
+        const rmt_symbol_word_t& s = _rxSymbols[i];
+        if (s.level0 == 0 && s.duration0 > 0) {
+            value |= (s.duration0 < READ_ZERO_US ? 1 : 0) << slot++;
+        }
+        if (slot < bits && s.level1 == 0 && s.duration1 > 0) {
+            value |= (s.duration1 < READ_ZERO_US ? 1 : 0) << slot++;
+        }
+    }
+    if (slot != bits) {
+        ESP_LOGW(TAG, "GPIO %d: %u of %u slots seen", (int)_pin, (unsigned)slot, (unsigned)bits);
+        return false;
+    }
+    if (rx != nullptr) {
+        *rx = value;
+    }
+    return true;
+}
+
+bool OneWireBus::WriteByte(uint8_t value)
+{
+    return transfer(value, 8, nullptr);
+}
+
+bool OneWireBus::WriteBytes(const uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        if (!transfer(data[i], 8, nullptr)) return false;
+    }
+    return true;
+}
+
+bool OneWireBus::ReadBytes(uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        if (!transfer(0xFF, 8, &data[i])) return false;
+    }
+    return true;
+}
+
+bool OneWireBus::Select(RomCode rom)
+{
+    if (!Reset()) {
+        return false;
+    }
+    if (rom == 0) {
+        return WriteByte(CMD_SKIP_ROM);
+    }
+    uint8_t command[9] = { CMD_MATCH_ROM };
+    for (size_t i = 0; i < 8; ++i) {
+        command[1 + i] = static_cast<uint8_t>(rom >> (8 * i));
+    }
+    return WriteBytes(command, sizeof(command));
+}
+
+size_t OneWireBus::Search(RomCode* roms, size_t maxRoms)
+{
+    size_t found = 0;
+    RomCode rom = 0;
+    int lastDiscrepancy = -1;
+
+    while (found < maxRoms) {
+        if (!Reset() || !WriteByte(CMD_SEARCH_ROM)) {
+            break;
+        }
+
+        int discrepancy = -1;
+        bool ok = true;
+        for (int bit = 0; bit < 64 && ok; ++bit) {
+            // Two read slots: the bit of all devices still in the search,
+            // then its complement
+            uint8_t pair = 0;
+            ok = transfer(0x03, 2, &pair);
+            bool idBit = pair & 1;
+            bool complement = pair & 2;
+            if (!ok || (idBit && complement)) {
+                ok = false;
+                break;
+            }
+
+            bool direction;
+            if (idBit != complement) {
+                direction = idBit;
+            } else if (bit < lastDiscrepancy) {
+                direction = (rom >> bit) & 1;
+            } else {
+                direction = bit == lastDiscrepancy;
+            }
+            if (idBit == complement && !direction) {
+                discrepancy = bit;
+            }
+
+            rom = direction ? (rom | (1ull << bit)) : (rom & ~(1ull << bit));
+            ok = transfer(direction ? 1 : 0, 1, nullptr);
+        }
+        if (!ok) {
+            break;
+        }
+
+        uint8_t bytes[8];
+        for (size_t i = 0; i < 8; ++i) {
+            bytes[i] = static_cast<uint8_t>(rom >> (8 * i));
+        }
+        if (Crc8(bytes, sizeof(bytes)) == 0) {
+            roms[found++] = rom;
+        } else {
+            ESP_LOGW(TAG, "GPIO %d: ROM code with bad CRC skipped", (int)_pin);
+        }
+
+        lastDiscrepancy = discrepancy;
+        if (lastDiscrepancy < 0) {
+            break;
+        }
+    }
+    return found;
+}
+
+} // namespace Sensors
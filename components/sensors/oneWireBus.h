@@ -0,0 +1,84 @@
+#ifndef ONE_WIRE_BUS_H
+#define ONE_WIRE_BUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_rx.h"
+#include "oneWireCrc.h"
+
+namespace Sensors
+{
+
+/**
+ * @brief   1-Wire bus master on the RMT peripheral.
+ *
+ * Every reset and every group of up to eight time slots is one RMT
+ * transmission (open drain, looped back) plus one RMT reception of the
+ * same pin; the slot timing comes from the peripheral, not from busy
+ * waiting with interrupts disabled. The calling task blocks on the
+ * receive-done queue for the few hundred microseconds a byte takes, so
+ * it must not be an executor worker.
+ *
+ * Needs the usual external pull-up (4.7 kOhm) and externally powered
+ * devices (no strong pull-up for parasite power).
+ */
+class OneWireBus {
+public:
+    using RomCode = uint64_t;   // family code in the low byte, CRC in the high byte
+
+    static constexpr uint8_t CMD_SEARCH_ROM = 0xF0;
+    static constexpr uint8_t CMD_MATCH_ROM = 0x55;
+    static constexpr uint8_t CMD_SKIP_ROM = 0xCC;
+
+    explicit OneWireBus(gpio_num_t pin);
+    ~OneWireBus();
+
+    bool IsValid() const { return _tx != nullptr && _rx != nullptr; }
+
+    // Reset pulse; true if at least one device answered with a presence pulse
+    bool Reset();
+    bool WriteByte(uint8_t value);
+    bool WriteBytes(const uint8_t* data, size_t length);
+    bool ReadBytes(uint8_t* data, size_t length);
+
+    // Reset plus MATCH ROM (or SKIP ROM for rom == 0)
+    bool Select(RomCode rom);
+
+    // ROM search over the whole bus; returns the number of codes found
+    // (codes with a bad CRC are skipped)
+    size_t Search(RomCode* roms, size_t maxRoms);
+
+    // Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1); 0 over data plus its CRC
+    static uint8_t Crc8(const uint8_t* data, size_t length) { return OneWireCrc8(data, length); }
+
+private:
+    // Up to 8 slots: the bits of tx (LSB first) are written, a 1 bit is a
+    // read slot; the sampled bits go to *rx
+    bool transfer(uint8_t tx, size_t bits, uint8_t* rx);
+    bool receive(TickType_t timeout, size_t* symbols);
+
+    static bool IRAM_ATTR onReceiveDone(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t* data,
+                                        void* context);
+
+    static constexpr size_t RX_SYMBOLS = 16;
+
+    gpio_num_t _pin;
+    rmt_channel_handle_t _tx;
+    rmt_channel_handle_t _rx;
+    rmt_encoder_handle_t _encoder;
+    QueueHandle_t _done;
+    rmt_symbol_word_t _rxSymbols[RX_SYMBOLS];
+
+    // Disallow copy and assignment
+    OneWireBus(const OneWireBus&) = delete;
+    OneWireBus& operator=(const OneWireBus&) = delete;
+};
+
+} // namespace Sensors
+
+#endif // ONE_WIRE_BUS_H
@@ -0,0 +1,23 @@
+#include "oneWireCrc.h"
+
+namespace Sensors
+{
+
+uint8_t OneWireCrc8(const uint8_t* data, size_t length)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            bool mix = (crc ^ byte) & 1;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
+
+} // namespace Sensors
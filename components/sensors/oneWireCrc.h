@@ -0,0 +1,16 @@
+#ifndef ONE_WIRE_CRC_H
+#define ONE_WIRE_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Sensors
+{
+
+// Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1, reflected, initial 0) of ROM
+// codes and scratchpads; 0 over data plus its CRC. No driver dependency.
+uint8_t OneWireCrc8(const uint8_t* data, size_t length);
+
+} // namespace Sensors
+
+#endif // ONE_WIRE_CRC_H
@@ -0,0 +1,9 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+// All sensors of the tower; each one publishes MeasurementEvents on the EventBus
+#include "levelSensor.h"
+#include "flowSensor.h"
+#include "temperatureSensor.h"
+
+#endif // SENSORS_H
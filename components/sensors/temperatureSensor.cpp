@@ -0,0 +1,134 @@
+#include "temperatureSensor.h"
+#include "eventBus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace Sensors
+{
+static const char* TAG = "Temperature";
+
+TemperatureSensor::TemperatureSensor(const Config& config)
+    : ActiveObject("Temperature", TaskConfig{ 3072, 1, tskNO_AFFINITY }, 4),
+      _config(config),
+      _bus(config.pin),
+      _probes{},
+      _probeCount(0),
+      _phase(Phase::Idle),
+      _conversionUs(0),
+      _crcErrors(0),
+      _tick(new TemperatureTickEvent())
+{
+    if (_config.resolutionBits < 9 || _config.resolutionBits > 12) {
+        _config.resolutionBits = 12;
+    }
+
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<TemperatureTickEvent>([this](const TemperatureTickEvent&) { onTick(); });
+    coalesce<TemperatureTickEvent>(Mailbox::Coalesce::ReplaceLatest);
+}
+
+// 750 ms at 12 bit, halved per bit less
+uint32_t TemperatureSensor::conversionMs() const
+{
+    return 750u >> (12 - _config.resolutionBits);
+}
+
+void TemperatureSensor::start()
+{
+    if (_phase != Phase::Idle || _timer.IsActive()) {
+        return;
+    }
+    onTick();
+}
+
+void TemperatureSensor::onTick()
+{
+    if (_phase == Phase::Converting) {
+        readProbes();
+        _phase = Phase::Idle;
+        uint32_t restMs = _config.periodMs > conversionMs() ? _config.periodMs - conversionMs() : 1;
+        _timer.Start(restMs, _tick->Retain());
+        return;
+    }
+
+    if (_probeCount == 0) {
+        search();
+    }
+    if (_probeCount == 0) {
+        _timer.Start(_config.periodMs, _tick->Retain());
+        return;
+    }
+    startConversion();
+}
+
+void TemperatureSensor::search()
+{
+    OneWireBus::RomCode roms[TEMP_MAX_PROBES];
+    size_t found = _bus.Search(roms, TEMP_MAX_PROBES);
+
+    _probeCount = 0;
+    for (size_t i = 0; i < found; ++i) {
+        if ((roms[i] & 0xFF) == FAMILY_DS18B20) {
+            _probes[_probeCount++] = roms[i];
+            ESP_LOGI(TAG, "Probe %u: %08X%08X", (unsigned)(_probeCount - 1), (unsigned)(roms[i] >> 32),
+                     (unsigned)roms[i]);
+        }
+    }
+    if (_probeCount == 0) {
+        ESP_LOGW(TAG, "No DS18B20 on GPIO %d", (int)_config.pin);
+        return;
+    }
+
+    // Same resolution for all probes: TH, TL, config register
+    uint8_t configRegister = static_cast<uint8_t>(((_config.resolutionBits - 9) << 5) | 0x1F);
+    uint8_t command[4] = { CMD_WRITE_SCRATCHPAD, 0x4B, 0x46, configRegister };
+    if (!_bus.Select(0) || !_bus.WriteBytes(command, sizeof(command))) {
+        ESP_LOGW(TAG, "Setting the resolution failed");
+    }
+}
+
+void TemperatureSensor::startConversion()
+{
+    // One broadcast converts every probe on the bus at the same time
+    if (!_bus.Select(0) || !_bus.WriteByte(CMD_CONVERT_T)) {
+        ESP_LOGW(TAG, "No presence on GPIO %d, searching again", (int)_config.pin);
+        _probeCount = 0;
+        _timer.Start(_config.periodMs, _tick->Retain());
+        return;
+    }
+    _conversionUs = static_cast<uint32_t>(esp_timer_get_time());
+    _phase = Phase::Converting;
+    // Slack for the probes' clock tolerance
+    _timer.Start(conversionMs() + 10, _tick->Retain());
+}
+
+void TemperatureSensor::readProbes()
+{
+    for (size_t i = 0; i < _probeCount; ++i) {
+        uint8_t scratchpad[9];
+        if (!_bus.Select(_probes[i]) || !_bus.WriteByte(CMD_READ_SCRATCHPAD) ||
+            !_bus.ReadBytes(scratchpad, sizeof(scratchpad))) {
+            ESP_LOGW(TAG, "Probe %u did not answer", (unsigned)i);
+            continue;
+        }
+        if (OneWireBus::Crc8(scratchpad, sizeof(scratchpad)) != 0) {
+            _crcErrors++;
+            ESP_LOGW(TAG, "Probe %u: scratchpad CRC error (%u so far)", (unsigned)i, (unsigned)_crcErrors);
+            continue;
+        }
+
+        int16_t raw = static_cast<int16_t>((scratchpad[1] << 8) | scratchpad[0]);
+        if (raw == POWER_ON_RAW) {
+            ESP_LOGW(TAG, "Probe %u: power-on value, conversion missed", (unsigned)i);
+            continue;
+        }
+        // Below 12 bit the low bits are undefined
+        raw &= static_cast<int16_t>(~((1 << (12 - _config.resolutionBits)) - 1));
+        float celsius = raw / 16.0f;
+        ESP_LOGD(TAG, "Probe %u: %.2f °C", (unsigned)i, celsius);
+        EventBus::get().publish(new MeasurementEvent(MeasurementEvent::Quantity::Temperature, celsius,
+                                                     _conversionUs, "DS18B20", static_cast<uint8_t>(i)));
+    }
+}
+
+} // namespace Sensors
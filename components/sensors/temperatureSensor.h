@@ -0,0 +1,86 @@
+#ifndef TEMPERATURE_SENSOR_H
+#define TEMPERATURE_SENSOR_H
+
+#include <cstdint>
+
+#include "activeObject.h"
+#include "events.h"
+#include "oneWireBus.h"
+
+// Probes served per bus
+#ifndef TEMP_MAX_PROBES
+#define TEMP_MAX_PROBES 8
+#endif
+
+namespace Sensors
+{
+
+/**
+ * @brief   DS18B20 probes on one 1-Wire bus, converted in parallel.
+ *
+ * Every cycle starts the conversion of all probes with one broadcast
+ * (SKIP ROM, CONVERT T) and arms the actor's timer for the conversion
+ * time instead of sleeping; then it reads each probe's scratchpad (MATCH
+ * ROM), checks its CRC and publishes one MeasurementEvent
+ * (Quantity::Temperature in °C, channel = probe index) stamped with the
+ * start of the conversion. Eight probes cost one conversion time, not
+ * eight.
+ *
+ * Runs on its own low-priority task, as the bus transfers block for the
+ * ~1 ms of every byte. Probes are searched on OnStart and again whenever
+ * none are known.
+ */
+class TemperatureSensor : public ActiveObject {
+public:
+    struct Config {
+        gpio_num_t pin = GPIO_NUM_NC;
+        uint32_t periodMs = 10000;      // conversion start to conversion start
+        uint8_t resolutionBits = 12;    // 9..12, 94 ms .. 750 ms per conversion
+    };
+
+    explicit TemperatureSensor(const Config& config);
+
+    size_t ProbeCount() const { return _probeCount; }
+    uint32_t CrcErrors() const { return _crcErrors; }
+
+private:
+    enum class Phase : uint8_t {
+        Idle,
+        Converting
+    };
+
+    static constexpr uint8_t FAMILY_DS18B20 = 0x28;
+    static constexpr uint8_t CMD_CONVERT_T = 0x44;
+    static constexpr uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+    static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+    static constexpr int16_t POWER_ON_RAW = 0x0550;    // 85 °C, no conversion happened
+
+    void start();
+    void onTick();
+    void search();
+    void startConversion();
+    void readProbes();
+    uint32_t conversionMs() const;
+
+    Config _config;
+    OneWireBus _bus;
+    OneWireBus::RomCode _probes[TEMP_MAX_PROBES];
+    size_t _probeCount;
+    Phase _phase;
+    uint32_t _conversionUs;
+    uint32_t _crcErrors;
+    const Event* _tick;
+
+    // Disallow copy and assignment
+    TemperatureSensor(const TemperatureSensor&) = delete;
+    TemperatureSensor& operator=(const TemperatureSensor&) = delete;
+};
+
+class TemperatureTickEvent : public TypedEvent<TemperatureTickEvent, Event::Type::TimerTick> {
+public:
+    TemperatureTickEvent() : TypedEvent("Temperature") {}
+};
+
+} // namespace Sensors
+
+#endif // TEMPERATURE_SENSOR_H
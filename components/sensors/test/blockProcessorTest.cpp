@@ -0,0 +1,128 @@
+// BlockProcessor and Decimator: outlier rejection and statistics of single
+// blocks, period weighting and timing, and the whole block path on the
+// recorded sample file (path as the first argument).
+#include <cmath>
+#include <vector>
+
+#include "blockProcessor.h"
+#include "hostTest.h"
+#include "levelReplay.h"
+
+namespace
+{
+
+using Sensors::BlockProcessor;
+using Sensors::BlockStats;
+using Sensors::Decimator;
+
+const char* g_sampleFile = nullptr;
+
+void constantBlock()
+{
+    std::vector<uint16_t> samples(64, 1234);
+    BlockStats stats = BlockProcessor().Process(samples.data(), samples.size());
+    CHECK_EQ(stats.mean, 1234.0f);
+    CHECK_EQ(stats.stdDev, 0.0f);
+    CHECK_EQ(stats.accepted, 64);
+    CHECK_EQ(stats.rejected, 0);
+    CHECK(stats.min == 1234 && stats.max == 1234);
+}
+
+void spikeRejected()
+{
+    std::vector<uint16_t> samples;
+    for (int i = 0; i < 63; ++i) {
+        samples.push_back(static_cast<uint16_t>(i % 2 == 0 ? 998 : 1002));
+    }
+    samples.push_back(4095);
+    BlockStats stats = BlockProcessor().Process(samples.data(), samples.size());
+    CHECK_EQ(stats.rejected, 1);
+    CHECK_EQ(stats.accepted, 63);
+    CHECK(std::fabs(stats.mean - 999.97f) < 0.01f);
+    CHECK(stats.min == 998 && stats.max == 4095);
+    // The deviation is the block's, spike included
+    CHECK(stats.stdDev > 300.0f);
+}
+
+void emptyBlock()
+{
+    BlockStats stats = BlockProcessor().Process(nullptr, 0);
+    CHECK(stats.accepted == 0 && stats.rejected == 0 && stats.mean == 0.0f);
+}
+
+// Blocks weighted by their accepted samples; a period is closed by the
+// first block at or past its end and stamped with that block's time
+void decimatorPeriods()
+{
+    Decimator decimator(500000);
+    float mean = 0.0f;
+    uint32_t sampleUs = 0;
+    std::vector<uint32_t> times;
+    std::vector<float> means;
+    for (uint32_t i = 1; i <= 16; ++i) {
+        BlockStats block = { static_cast<float>(i * 10), 0.0f, static_cast<uint16_t>(i % 2 == 0 ? 60 : 20), 0, 0, 0 };
+        if (decimator.Add(block, i * 100000, &mean, &sampleUs)) {
+            times.push_back(sampleUs);
+            means.push_back(mean);
+        }
+    }
+    CHECK(times == (std::vector<uint32_t>{ 600000, 1100000, 1600000 }));
+    // First period: blocks 1..6, (10*20 + 20*60 + 30*20 + 40*60 + 50*20 + 60*60) / 240
+    CHECK(means.size() == 3 && std::fabs(means[0] - 37.5f) < 1e-4f);
+}
+
+// Timestamps wrap at 2^32 us (~71 min)
+void decimatorWraps()
+{
+    Decimator decimator(1000000);
+    float mean;
+    uint32_t sampleUs;
+    BlockStats block = { 5.0f, 0.0f, 64, 0, 0, 0 };
+    uint32_t t = 0xFFFFFFFFu - 500000;
+    CHECK(!decimator.Add(block, t, &mean, &sampleUs));
+    CHECK(!decimator.Add(block, t + 600000, &mean, &sampleUs));
+    CHECK(decimator.Add(block, t + 1000000, &mean, &sampleUs));
+    CHECK_EQ(sampleUs, t + 1000000);
+}
+
+// Ramp 1800 -> 1900 codes over 5 s with rail spikes (see the file header):
+// every published value within 3 codes of the ramp at the period's middle
+void recordedFile()
+{
+    std::vector<uint16_t> samples;
+    CHECK(g_sampleFile != nullptr && LevelReplay::Load(g_sampleFile, samples));
+    CHECK_EQ(samples.size(), 5000u);
+
+    std::vector<LevelReplay::Output> outputs = LevelReplay::Run(samples, 1000, 1000, 3.0f);
+    CHECK_EQ(outputs.size(), 4u);
+    uint32_t rejected = 0;
+    for (const LevelReplay::Output& output : outputs) {
+        float truth = 1800.0f + 20.0f * (output.timeMs - 500) / 1000.0f;
+        CHECK(std::fabs(output.mean - truth) < 3.0f);
+        rejected += output.rejected;
+    }
+    CHECK(rejected >= 40);
+
+    // Without rejection the spikes pull the mean off
+    float worst = 0.0f;
+    for (const LevelReplay::Output& output : LevelReplay::Run(samples, 1000, 1000, 1e9f)) {
+        float truth = 1800.0f + 20.0f * (output.timeMs - 500) / 1000.0f;
+        worst = std::fmax(worst, std::fabs(output.mean - truth));
+    }
+    CHECK(worst > 5.0f);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    g_sampleFile = argc > 1 ? argv[1] : nullptr;
+
+    HostTest::Run("constant block: exact mean, nothing rejected", constantBlock);
+    HostTest::Run("rail spike rejected", spikeRejected);
+    HostTest::Run("empty block", emptyBlock);
+    HostTest::Run("decimator: weighted periods, drift-free stamps", decimatorPeriods);
+    HostTest::Run("decimator: 32 bit time wraps", decimatorWraps);
+    HostTest::Run("recorded file: level within 3 codes despite spikes", recordedFile);
+    return HostTest::Report();
+}
@@ -0,0 +1,277 @@
+// Filters (filters.h) against hand-computed outputs: integer rounding of
+// MovingAverage and EmaShift, windows still filling, Median and Hampel
+// selection, the Kalman1D gain sequence and steady-state variance in
+// float and in Q12, the block paths of MovingAverage and Ema and of a
+// Pipeline against sample-by-sample updates, and the level sensor's
+// pipeline on skewed periods and steps.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "filters.h"
+#include "hostTest.h"
+#include "levelFilter.h"
+
+namespace
+{
+
+using namespace Sensors::Filters;
+
+template <typename Filter, typename T>
+std::vector<T> run(Filter& filter, const std::vector<T>& in)
+{
+    std::vector<T> out;
+    for (T x : in) {
+        out.push_back(filter.Update(x));
+    }
+    return out;
+}
+
+// Mean of 1, 2, 3 ... while filling, halves rounded away from zero
+void movingAverageInteger()
+{
+    MovingAverage<int16_t, 4> average;
+    CHECK(run(average, std::vector<int16_t>{ 1, 2, 3, 4, 5, -3, -3, -3, -3, -4, -2 }) ==
+          (std::vector<int16_t>{ 1, 2, 2, 3, 4, 2, 1, -1, -3, -3, -3 }));
+
+    average.Reset();
+    CHECK(run(average, std::vector<int16_t>{ -1, -2 }) == (std::vector<int16_t>{ -1, -2 }));
+
+    // Sums beyond the sample type
+    MovingAverage<uint16_t, 8> wide;
+    uint16_t last = 0;
+    for (int i = 0; i < 8; ++i) {
+        last = wide.Update(65535);
+    }
+    CHECK_EQ(last, 65535);
+}
+
+// A million float samples: the periodic re-sum keeps the running sum exact
+void movingAverageFloatDrift()
+{
+    MovingAverage<float, 16> average;
+    float y = 0.0f;
+    for (int i = 0; i < 1000000; ++i) {
+        y = average.Update(i % 2 == 0 ? 0.1f : 1000.1f);
+    }
+    CHECK(std::fabs(y - 500.1f) < 1e-3f);
+}
+
+// alpha = 1/4 onto a step of 100 (and -100): 25, 44, 58 ... and it
+// settles exactly on the input
+void emaShiftStep()
+{
+    EmaShift<int16_t, 2> ema;
+    std::vector<int16_t> in(13, 100);
+    in[0] = 0;
+    CHECK(run(ema, in) == (std::vector<int16_t>{ 0, 25, 44, 58, 68, 76, 82, 87, 90, 93, 94, 96, 97 }));
+    int16_t y = 0;
+    for (int i = 0; i < 20; ++i) {
+        y = ema.Update(100);
+    }
+    CHECK_EQ(y, 100);
+
+    ema.Reset();
+    for (int16_t& x : in) {
+        x = static_cast<int16_t>(-x);
+    }
+    CHECK(run(ema, in) == (std::vector<int16_t>{ 0, -25, -44, -58, -68, -76, -82, -87, -90, -93, -94, -96, -97 }));
+}
+
+// A step of one code below 2^-Shift still gets through on the extra bits
+void emaShiftSmallStep()
+{
+    EmaShift<uint16_t, 3> ema;
+    CHECK(run(ema, std::vector<uint16_t>{ 0, 1, 1, 1, 1, 1 }) == (std::vector<uint16_t>{ 0, 0, 0, 0, 1, 1 }));
+}
+
+// Lower median while filling, then the middle of the last five
+void medianFilling()
+{
+    Median<int, 5> median;
+    CHECK(run(median, std::vector<int>{ 5, 1, 4, 2, 3, 100, 3, 100, 100 }) ==
+          (std::vector<int>{ 5, 1, 4, 2, 3, 3, 3, 3, 100 }));
+}
+
+void hampelReplacesSpikes()
+{
+    Hampel<float, 5> hampel(3.0f, 0.5f);
+    std::vector<float> in{ 10.0f, 500.0f, 10.2f, 9.8f, 10.1f, 9.9f, 60.0f, 10.0f, 10.3f, -40.0f, 10.1f };
+    std::vector<float> out = run(hampel, in);
+    // Fewer than three samples pass as they are
+    CHECK_EQ(out[1], 500.0f);
+    // Then spikes become the median of the last five
+    CHECK_EQ(out[6], 10.1f);
+    CHECK_EQ(out[9], 10.0f);
+    CHECK_EQ(hampel.Outliers(), 2u);
+    CHECK(out[5] == 9.9f && out[8] == 10.3f);
+}
+
+// minDeviation: a flat signal does not turn its noise into outliers
+void hampelMinDeviation()
+{
+    Hampel<int, 5> strict(3.0f);
+    Hampel<int, 5> tolerant(3.0f, 2.0f);
+    std::vector<int> in{ 100, 100, 100, 100, 101, 100, 99, 100 };
+    run(strict, in);
+    CHECK_EQ(strict.Outliers(), 2u);
+    CHECK(run(tolerant, in) == in);
+    CHECK_EQ(tolerant.Outliers(), 0u);
+}
+
+// q = 1, r = 4: gains 5/9, ... and the variance settles at
+// (-q + sqrt(q^2 + 4qr)) / 2
+void kalmanSequence()
+{
+    Kalman1D<float> kalman(1.0f, 4.0f);
+    std::vector<float> out = run(kalman, std::vector<float>{ 10.0f, 12.0f, 8.0f, 11.0f, 9.0f });
+    const float expected[] = { 10.0f, 11.11111f, 9.72308f, 10.24717f, 9.75111f };
+    bool close = true;
+    for (size_t i = 0; i < out.size(); ++i) {
+        close = close && std::fabs(out[i] - expected[i]) < 1e-4f;
+    }
+    CHECK(close);
+    for (int i = 0; i < 50; ++i) {
+        kalman.Update(10.0f);
+    }
+    CHECK(std::fabs(kalman.Variance() - 1.5615528f) < 1e-5f);
+}
+
+// The same sequence scaled by 100 in Q12: the gains do not depend on the
+// scale, so the outputs are the float ones rounded to whole codes
+void kalmanFixedSequence()
+{
+    Kalman1D<int16_t, 12> kalman(1.0f, 4.0f);
+    CHECK(run(kalman, std::vector<int16_t>{ 1000, 1200, 800, 1100, 900 }) ==
+          (std::vector<int16_t>{ 1000, 1111, 972, 1025, 975 }));
+    for (int i = 0; i < 50; ++i) {
+        kalman.Update(1000);
+    }
+    CHECK(std::fabs(kalman.Variance() - 1.5615528f) < 2.0f / 4096);
+
+    kalman.Reset();
+    CHECK(run(kalman, std::vector<int16_t>{ -1000, -1200, -800 }) == (std::vector<int16_t>{ -1000, -1111, -972 }));
+}
+
+// Noisy ADC codes with spikes, both signs: Q12 within a code of the float
+// filter rounded
+void kalmanFixedMatchesFloat()
+{
+    Kalman1D<int16_t, 12> fixed(0.5f, 40.0f);
+    Kalman1D<float> floating(0.5f, 40.0f);
+    int worst = 0;
+    for (int i = 0; i < 5000; ++i) {
+        int16_t z = static_cast<int16_t>((i / 500) * 700 - 3000 + (i * 7919) % 41 - 20 + (i % 97 == 0 ? 900 : 0));
+        int y = fixed.Update(z);
+        int reference = static_cast<int>(std::lround(floating.Update(static_cast<float>(z))));
+        worst = std::max(worst, std::abs(y - reference));
+    }
+    CHECK(worst <= 1);
+}
+
+template <typename Filter, typename T>
+bool blockMatches(Filter filter, const std::vector<T>& in, size_t block)
+{
+    Filter bySample = filter;
+    std::vector<T> expected = run(bySample, in);
+    std::vector<T> out(in);
+    for (size_t i = 0; i < out.size(); i += block) {
+        filter.ProcessBlock(&out[i], &out[i], std::min(block, out.size() - i));
+    }
+    return out == expected;
+}
+
+// MovingAverage and Ema block loops, in place, with blocks that end inside
+// the filling phase and on every offset against the window
+void blockPathsMatchUpdate()
+{
+    std::vector<int16_t> codes;
+    std::vector<float> floats;
+    for (int i = 0; i < 1000; ++i) {
+        codes.push_back(static_cast<int16_t>((i * 7919) % 4001 - 2000));
+        floats.push_back(static_cast<float>(codes.back()) * 0.37f);
+    }
+    size_t matched = 0;
+    const size_t blocks[] = { 1, 3, 7, 8, 64, 1000 };
+    for (size_t block : blocks) {
+        matched += blockMatches(MovingAverage<int16_t, 8>(), codes, block);
+        matched += blockMatches(MovingAverage<float, 8>(), floats, block);
+        matched += blockMatches(MovingAverage<float, 5>(), floats, block);
+#ifndef FILTERS_HAVE_ESP_DSP
+        matched += blockMatches(Ema<float>(0.1f), floats, block);
+#else
+        matched++;
+#endif
+    }
+    CHECK_EQ(matched, 4 * (sizeof(blocks) / sizeof(blocks[0])));
+}
+
+// Block processing stage by stage, in place or not, matches Update()
+void pipelineBlockMatchesUpdate()
+{
+    using Chain = Pipeline<float, Hampel<float, 5>, MovingAverage<float, 4>, Kalman1D<float>>;
+    Chain bySample(Hampel<float, 5>(3.0f), MovingAverage<float, 4>(), Kalman1D<float>(0.01f, 4.0f));
+    Chain byBlock = bySample;
+    Chain inPlace = bySample;
+
+    std::vector<float> in;
+    for (int i = 0; i < 200; ++i) {
+        in.push_back(100.0f + (i % 7) - (i % 37 == 0 ? 200.0f : 0.0f));
+    }
+    std::vector<float> expected = run(bySample, in);
+    std::vector<float> out(in.size());
+    byBlock.ProcessBlock(in.data(), out.data(), 64);
+    byBlock.ProcessBlock(in.data() + 64, out.data() + 64, in.size() - 64);
+    std::vector<float> block = in;
+    inPlace.ProcessBlock(block.data(), block.data(), block.size());
+
+    CHECK(out == expected);
+    CHECK(block == expected);
+    CHECK_EQ(byBlock.Stage<0>().Outliers(), bySample.Stage<0>().Outliers());
+
+    byBlock.Reset();
+    CHECK_EQ(byBlock.Update(42.0f), 42.0f);
+}
+
+// Periods of 1850 +-1 codes with one skewed by a pump start, then a step
+// to 1950: the skewed period is replaced, the step passes two periods late
+void levelFilterPeriods()
+{
+    Sensors::LevelFilter filter = Sensors::MakeLevelFilter(9.0f, 4.0f);
+    float worst = 0.0f;
+    for (int i = 0; i < 20; ++i) {
+        float raw = i == 12 ? 1900.0f : 1850.0f + (i % 3) - 1;
+        worst = std::fmax(worst, std::fabs(filter.Update(raw) - 1850.0f));
+    }
+    CHECK(worst < 2.0f);
+    CHECK_EQ(filter.Stage<0>().Outliers(), 1u);
+
+    std::vector<float> out;
+    for (int i = 0; i < 10; ++i) {
+        out.push_back(filter.Update(1950.0f));
+    }
+    CHECK(out[0] < 1852.0f && out[1] < 1852.0f);
+    CHECK(out[2] > 1900.0f);
+    CHECK(std::fabs(out[6] - 1950.0f) < 1.0f);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("MovingAverage<int16_t>: filling, rounding, wide sums", movingAverageInteger);
+    HostTest::Run("MovingAverage<float>: no drift over 1M samples", movingAverageFloatDrift);
+    HostTest::Run("EmaShift: step response, settles exactly", emaShiftStep);
+    HostTest::Run("EmaShift: one-code step", emaShiftSmallStep);
+    HostTest::Run("Median: filling window, spikes", medianFilling);
+    HostTest::Run("Hampel: spikes replaced by the median", hampelReplacesSpikes);
+    HostTest::Run("Hampel: minDeviation on a flat signal", hampelMinDeviation);
+    HostTest::Run("Kalman1D: gain sequence, steady variance", kalmanSequence);
+    HostTest::Run("Kalman1D<int16_t, 12>: gain sequence, steady variance", kalmanFixedSequence);
+    HostTest::Run("Kalman1D<int16_t, 12>: within a code of float", kalmanFixedMatchesFloat);
+    HostTest::Run("MovingAverage, Ema: block = sample by sample", blockPathsMatchUpdate);
+    HostTest::Run("Pipeline: block = sample by sample", pipelineBlockMatchesUpdate);
+    HostTest::Run("LevelFilter: skewed period dropped, step two periods late", levelFilterPeriods);
+    return HostTest::Report();
+}
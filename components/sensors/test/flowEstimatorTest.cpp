@@ -0,0 +1,176 @@
+// FlowEstimator fed like the FlowSensor does, from a simulated meter: the
+// rate and volume at steady and low flow, the drop to zero when the
+// pulses stop, the recovery when they start again, and a wrapping count.
+#include <cmath>
+#include <vector>
+
+#include "flowEstimator.h"
+#include "hostTest.h"
+
+namespace
+{
+
+using Sensors::FlowEstimator;
+
+constexpr uint32_t WINDOW_US = 250000;      // FlowSensor's default window
+constexpr float PULSES_PER_LITER = 450.0f;
+
+// A hall-effect meter: 7.5 pulses/s per L/min, read once per window
+class Meter {
+public:
+    explicit Meter(int32_t count = 0) : _count(count) {}
+
+    // Runs the flow for durationMs; one sample per window
+    void Run(float litersPerMinute, uint32_t durationMs)
+    {
+        float hz = litersPerMinute * PULSES_PER_LITER / 60.0f;
+        for (uint32_t elapsed = 0; elapsed < durationMs * 1000; elapsed += WINDOW_US) {
+            _fraction += hz * WINDOW_US / 1e6f;
+            uint32_t whole = static_cast<uint32_t>(_fraction);
+            _fraction -= whole;
+            _count = static_cast<int32_t>(static_cast<uint32_t>(_count) + whole);
+            _timeUs += WINDOW_US;
+            samples.push_back(Sample{ _timeUs, estimator.Update(_timeUs, _count), estimator.Rate() });
+        }
+    }
+
+    struct Sample {
+        uint32_t timeUs;
+        bool reported;
+        float rate;
+    };
+
+    FlowEstimator estimator{ FlowEstimator::Config{} };
+    std::vector<Sample> samples;
+
+private:
+    int32_t _count;
+    uint32_t _timeUs = 0;
+    float _fraction = 0.5f;
+};
+
+bool within(float value, float expected, float tolerance)
+{
+    return std::fabs(value - expected) <= tolerance * expected;
+}
+
+// Samples from index `from` on
+size_t reports(const Meter& meter, size_t from)
+{
+    size_t count = 0;
+    for (size_t i = from; i < meter.samples.size(); ++i) {
+        count += meter.samples[i].reported;
+    }
+    return count;
+}
+
+// 10 L/min, ~19 pulses per window: within 2% after a second, volume
+// exact to a pulse, and quiet while the flow holds
+void steadyFlow()
+{
+    Meter meter;
+    meter.estimator.Update(0, 0);
+    meter.Run(10.0f, 1000);
+    size_t settled = meter.samples.size();
+    meter.Run(10.0f, 29000);
+
+    bool close = true;
+    for (size_t i = settled; i < meter.samples.size(); ++i) {
+        close = close && within(meter.samples[i].rate, 10.0f, 0.02f);
+    }
+    CHECK(close);
+    CHECK(std::fabs(meter.estimator.Volume() - 5.0) <= 1.0 / PULSES_PER_LITER);
+    CHECK_EQ(meter.estimator.Pulses(), 2250u);
+    CHECK(reports(meter, settled) <= 1);
+}
+
+// 0.5 L/min, ~1 pulse per window: the period stretches to 2 s, the rate
+// stays within 15% and never falls to zero between pulses
+void lowFlow()
+{
+    Meter meter;
+    meter.estimator.Update(0, 0);
+    meter.Run(0.5f, 5000);
+    size_t settled = meter.samples.size();
+    meter.Run(0.5f, 55000);
+
+    bool close = true;
+    for (size_t i = settled; i < meter.samples.size(); ++i) {
+        close = close && within(meter.samples[i].rate, 0.5f, 0.15f);
+    }
+    CHECK(close);
+    CHECK(std::fabs(meter.estimator.Volume() - 0.5) <= 1.0 / PULSES_PER_LITER);
+}
+
+// Pulses stop: the rate is bounded down within a second, reaches zero at
+// the zero timeout, and the stop is reported
+void stop()
+{
+    Meter meter;
+    meter.estimator.Update(0, 0);
+    meter.Run(10.0f, 5000);
+    double volume = meter.estimator.Volume();
+    size_t stopped = meter.samples.size();
+    meter.Run(0.0f, 5000);
+
+    const Meter::Sample& afterSecond = meter.samples[stopped + 3];
+    CHECK(afterSecond.rate < 1.0f);
+    size_t zero = stopped;
+    while (zero < meter.samples.size() && meter.samples[zero].rate != 0.0f) {
+        ++zero;
+    }
+    CHECK(zero < meter.samples.size());
+    if (zero < meter.samples.size()) {
+        uint32_t afterUs = meter.samples[zero].timeUs - meter.samples[stopped - 1].timeUs;
+        CHECK(afterUs >= 3000000 && afterUs <= 3000000 + WINDOW_US);
+        CHECK(meter.samples[zero].reported);
+    }
+    CHECK_EQ(meter.estimator.Volume(), volume);
+    CHECK_EQ(reports(meter, zero + 1), 0u);
+}
+
+// Flow resumes after a stop: 9 pulses a window only open the period, the
+// rate comes back, reported, once it has seen 32 pulses (~1 s)
+void restart()
+{
+    Meter meter;
+    meter.estimator.Update(0, 0);
+    meter.Run(10.0f, 3000);
+    meter.Run(0.0f, 5000);
+    CHECK_EQ(meter.estimator.Rate(), 0.0f);
+    size_t restarted = meter.samples.size();
+    meter.Run(5.0f, 3000);
+
+    size_t first = restarted;
+    while (first < meter.samples.size() && meter.samples[first].rate == 0.0f) {
+        ++first;
+    }
+    CHECK(first <= restarted + 4);
+    if (first < meter.samples.size()) {
+        CHECK(meter.samples[first].reported);
+        CHECK(within(meter.samples[first].rate, 5.0f, 0.05f));
+    }
+    CHECK(within(meter.estimator.Rate(), 5.0f, 0.02f));
+}
+
+// The pulse counter wraps: differences stay right across it
+void countWraps()
+{
+    Meter meter(0x7FFFFF00);
+    meter.estimator.Update(0, 0x7FFFFF00);
+    meter.Run(10.0f, 30000);
+    CHECK(within(meter.estimator.Rate(), 10.0f, 0.02f));
+    CHECK_EQ(meter.estimator.Pulses(), 2250u);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("steady 10 L/min: within 2%, exact volume, quiet", steadyFlow);
+    HostTest::Run("low 0.5 L/min: within 15%, never zero", lowFlow);
+    HostTest::Run("stop: bounded at once, zero after the timeout", stop);
+    HostTest::Run("restart after a stop", restart);
+    HostTest::Run("count wraps", countWraps);
+    return HostTest::Report();
+}
@@ -0,0 +1,37 @@
+// Replays a recorded level sensor sample file through the block path
+// (levelReplay.h) and prints one line per published value.
+//
+// Usage: levelReplay <file> [sampleRateHz=1000] [publishMs=1000] [outlierSigma=3]
+//                    [drift=9] [noise=4]
+#include <cstdio>
+#include <cstdlib>
+
+#include "levelReplay.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file> [sampleRateHz] [publishMs] [outlierSigma] [drift] [noise]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    uint32_t rate = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 1000;
+    uint32_t publishMs = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 1000;
+    float sigma = argc > 4 ? static_cast<float>(atof(argv[4])) : 3.0f;
+    float drift = argc > 5 ? static_cast<float>(atof(argv[5])) : LevelReplay::LEVEL_DRIFT;
+    float noise = argc > 6 ? static_cast<float>(atof(argv[6])) : LevelReplay::LEVEL_NOISE;
+
+    std::vector<uint16_t> samples;
+    if (!LevelReplay::Load(argv[1], samples)) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu samples, %u Hz, %zu per block, publish every %u ms, outliers beyond %.1f sigma\n",
+           samples.size(), (unsigned)rate, LevelReplay::FRAME_SAMPLES, (unsigned)publishMs, sigma);
+    printf("%8s %10s %10s %9s\n", "time ms", "raw mean", "filtered", "rejected");
+    for (const LevelReplay::Output& output : LevelReplay::Run(samples, rate, publishMs, sigma, drift, noise)) {
+        printf("%8u %10.2f %10.2f %9u\n", (unsigned)output.timeMs, output.mean, output.filtered,
+               (unsigned)output.rejected);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#ifndef LEVEL_REPLAY_H
+#define LEVEL_REPLAY_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "blockProcessor.h"
+#include "levelFilter.h"
+
+/**
+ * Host replay of the level sensor's block path: a sample file (one raw
+ * ADC code per line, '#' comments) cut into blocks of a DMA frame, each
+ * reduced by the BlockProcessor, decimated to one value per period and
+ * smoothed by the LevelFilter, the same calls LevelSensor::onFrames()
+ * makes on the device.
+ */
+namespace LevelReplay
+{
+
+constexpr size_t FRAME_SAMPLES = 64;
+// LevelSensor::Config defaults
+constexpr float LEVEL_DRIFT = 9.0f;
+constexpr float LEVEL_NOISE = 4.0f;
+
+struct Output {
+    uint32_t timeMs;        // end of the period
+    float mean;
+    float filtered;         // after the LevelFilter
+    uint32_t rejected;      // samples dropped in the period
+};
+
+inline bool Load(const char* path, std::vector<uint16_t>& samples)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        samples.push_back(static_cast<uint16_t>(strtoul(line.c_str(), nullptr, 10)));
+    }
+    return true;
+}
+
+inline std::vector<Output> Run(const std::vector<uint16_t>& samples, uint32_t sampleRateHz, uint32_t publishMs,
+                               float outlierSigma, float drift = LEVEL_DRIFT, float noise = LEVEL_NOISE)
+{
+    Sensors::BlockProcessor processor(outlierSigma);
+    Sensors::Decimator decimator(publishMs * 1000);
+    Sensors::LevelFilter filter = Sensors::MakeLevelFilter(drift, noise);
+    std::vector<Output> outputs;
+    uint32_t rejected = 0;
+
+    for (size_t start = 0; start + FRAME_SAMPLES <= samples.size(); start += FRAME_SAMPLES) {
+        Sensors::BlockStats block = processor.Process(&samples[start], FRAME_SAMPLES);
+        rejected += block.rejected;
+        uint32_t blockUs = static_cast<uint32_t>(1000000ull * (start + FRAME_SAMPLES) / sampleRateHz);
+        float mean;
+        uint32_t sampleUs;
+        if (decimator.Add(block, blockUs, &mean, &sampleUs)) {
+            outputs.push_back(Output{ sampleUs / 1000, mean, filter.Update(mean), rejected });
+            rejected = 0;
+        }
+    }
+    return outputs;
+}
+
+} // namespace LevelReplay
+
+#endif // LEVEL_REPLAY_H
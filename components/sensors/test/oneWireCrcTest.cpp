@@ -0,0 +1,59 @@
+// OneWireCrc8 against published values: the ROM code example of Maxim's
+// application note 27, the CRC-8/MAXIM catalogue check value, and the
+// DS18B20 power-on scratchpad; plus detection of single-bit errors.
+#include <cstring>
+
+#include "hostTest.h"
+#include "oneWireCrc.h"
+
+namespace
+{
+
+using Sensors::OneWireCrc8;
+
+// AN27 example: family 0x02, serial 0x0000000001B81C, CRC 0xA2 (LSB first)
+const uint8_t ROM[8] = { 0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2 };
+
+void referenceRomCode()
+{
+    CHECK_EQ(OneWireCrc8(ROM, 7), 0xA2);
+    CHECK_EQ(OneWireCrc8(ROM, 8), 0);
+}
+
+void checkValue()
+{
+    const char* text = "123456789";
+    CHECK_EQ(OneWireCrc8(reinterpret_cast<const uint8_t*>(text), strlen(text)), 0xA1);
+    CHECK_EQ(OneWireCrc8(nullptr, 0), 0);
+}
+
+// 85.0 C, TH 75, TL 70, 12 bit, as read right after power-up
+void powerOnScratchpad()
+{
+    const uint8_t scratchpad[9] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x1C };
+    CHECK_EQ(OneWireCrc8(scratchpad, 8), 0x1C);
+    CHECK_EQ(OneWireCrc8(scratchpad, 9), 0);
+}
+
+void singleBitErrorsDetected()
+{
+    int missed = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        uint8_t rom[8];
+        memcpy(rom, ROM, sizeof(rom));
+        rom[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+        missed += OneWireCrc8(rom, sizeof(rom)) == 0;
+    }
+    CHECK_EQ(missed, 0);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("AN27 reference ROM code: CRC 0xA2", referenceRomCode);
+    HostTest::Run("CRC-8/MAXIM check value 0xA1", checkValue);
+    HostTest::Run("DS18B20 power-on scratchpad", powerOnScratchpad);
+    HostTest::Run("every single-bit error in a ROM code detected", singleBitErrorsDetected);
+    return HostTest::Report();
+}
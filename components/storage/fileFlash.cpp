@@ -0,0 +1,83 @@
+#include "fileFlash.h"
+#include <vector>
+
+namespace Storage
+{
+
+FileFlash::FileFlash(const std::string& path, size_t size, size_t sectorSize)
+    : _file(nullptr), _size(size), _sectorSize(sectorSize), _cut(false), _budget(0), _erases(0)
+{
+    _file = std::fopen(path.c_str(), "r+b");
+    if (_file == nullptr) {
+        // New chip: all erased
+        _file = std::fopen(path.c_str(), "w+b");
+        if (_file == nullptr) {
+            return;
+        }
+        std::vector<uint8_t> erased(_sectorSize, 0xFF);
+        for (size_t offset = 0; offset < _size; offset += _sectorSize) {
+            std::fwrite(erased.data(), 1, erased.size(), _file);
+        }
+        std::fflush(_file);
+    }
+}
+
+FileFlash::~FileFlash()
+{
+    if (_file != nullptr) {
+        std::fclose(_file);
+    }
+}
+
+bool FileFlash::Read(size_t offset, void* data, size_t length)
+{
+    if (_file == nullptr || offset + length > _size) {
+        return false;
+    }
+    std::fseek(_file, static_cast<long>(offset), SEEK_SET);
+    return std::fread(data, 1, length, _file) == length;
+}
+
+bool FileFlash::Write(size_t offset, const void* data, size_t length)
+{
+    if (_file == nullptr || offset + length > _size || PowerLost()) {
+        return false;
+    }
+
+    size_t programmed = length;
+    if (_cut && _budget < length) {
+        programmed = _budget;
+    }
+
+    std::vector<uint8_t> cells(programmed);
+    if (!Read(offset, cells.data(), programmed)) {
+        return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < programmed; ++i) {
+        cells[i] &= bytes[i];
+    }
+    std::fseek(_file, static_cast<long>(offset), SEEK_SET);
+    std::fwrite(cells.data(), 1, programmed, _file);
+    std::fflush(_file);
+
+    if (_cut) {
+        _budget -= programmed;
+    }
+    return programmed == length;
+}
+
+bool FileFlash::EraseSector(size_t offset)
+{
+    if (_file == nullptr || offset % _sectorSize != 0 || offset >= _size || PowerLost()) {
+        return false;
+    }
+    std::vector<uint8_t> erased(_sectorSize, 0xFF);
+    std::fseek(_file, static_cast<long>(offset), SEEK_SET);
+    std::fwrite(erased.data(), 1, erased.size(), _file);
+    std::fflush(_file);
+    _erases++;
+    return true;
+}
+
+} // namespace Storage
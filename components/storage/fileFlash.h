@@ -0,0 +1,57 @@
+#ifndef FILE_FLASH_H
+#define FILE_FLASH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "flashDevice.h"
+
+namespace Storage
+{
+
+/**
+ * @brief   File-backed NOR flash emulator for host builds.
+ *
+ * Keeps NOR semantics (erase to 0xFF, writes AND into the old contents)
+ * and can simulate a power cut: after CutPowerAfter(n) the next n bytes
+ * are programmed, the write in flight stops half way and every later
+ * write or erase fails without touching the file, as on a dead chip.
+ * Reopen the file with a new instance to "reboot".
+ */
+class FileFlash : public FlashDevice {
+public:
+    FileFlash(const std::string& path, size_t size, size_t sectorSize = 4096);
+    ~FileFlash() override;
+
+    bool IsValid() const { return _file != nullptr; }
+
+    size_t Size() const override { return _size; }
+    size_t SectorSize() const override { return _sectorSize; }
+
+    bool Read(size_t offset, void* data, size_t length) override;
+    bool Write(size_t offset, const void* data, size_t length) override;
+    bool EraseSector(size_t offset) override;
+
+    // Simulated power cut after this many more programmed bytes
+    void CutPowerAfter(size_t bytes) { _budget = bytes; _cut = true; }
+    bool PowerLost() const { return _cut && _budget == 0; }
+
+    uint32_t Erases() const { return _erases; }
+
+private:
+    std::FILE* _file;
+    size_t _size;
+    size_t _sectorSize;
+    bool _cut;
+    size_t _budget;
+    uint32_t _erases;
+
+    // Disallow copy and assignment
+    FileFlash(const FileFlash&) = delete;
+    FileFlash& operator=(const FileFlash&) = delete;
+};
+
+} // namespace Storage
+
+#endif // FILE_FLASH_H
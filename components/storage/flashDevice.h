@@ -0,0 +1,30 @@
+#ifndef FLASH_DEVICE_H
+#define FLASH_DEVICE_H
+
+#include <cstddef>
+
+namespace Storage
+{
+
+/**
+ * @brief   Raw NOR flash region as seen by the storage code.
+ *
+ * NOR semantics: erase sets a whole sector to 0xFF, a write can only clear
+ * bits (programming over already written bytes ANDs them). Offsets are
+ * relative to the start of the region.
+ */
+class FlashDevice {
+public:
+    virtual ~FlashDevice() {}
+
+    virtual size_t Size() const = 0;
+    virtual size_t SectorSize() const = 0;
+
+    virtual bool Read(size_t offset, void* data, size_t length) = 0;
+    virtual bool Write(size_t offset, const void* data, size_t length) = 0;
+    virtual bool EraseSector(size_t offset) = 0;
+};
+
+} // namespace Storage
+
+#endif // FLASH_DEVICE_H
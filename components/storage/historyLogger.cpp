@@ -0,0 +1,68 @@
+#include "historyLogger.h"
+#include <cmath>
+#include <ctime>
+#include "eventBus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace Storage
+{
+static const char* TAG = "History";
+
+static uint32_t uptimeSeconds()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000000);
+}
+
+HistoryLogger::HistoryLogger()
+    : ActiveObject("History", TaskConfig{ 4096, 1, tskNO_AFFINITY }, 32),
+      _flash(HISTORY_PARTITION),
+      _log(_flash),
+      _tick(new HistoryFlushEvent()),
+      _running(false)
+{
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<MeasurementEvent>([this](const MeasurementEvent& e) { onMeasurement(e); });
+    on<HistoryFlushEvent>([this](const HistoryFlushEvent&) { onFlush(); });
+    coalesce<HistoryFlushEvent>(Mailbox::Coalesce::ReplaceLatest);
+}
+
+void HistoryLogger::start()
+{
+    if (_running) {
+        return;
+    }
+    if (!_flash.IsValid() || !_log.Mount()) {
+        ESP_LOGE(TAG, "No history without the \"%s\" partition", HISTORY_PARTITION);
+        return;
+    }
+    _running = true;
+    _clock.Start(_log.NewestTime(), uptimeSeconds());
+
+    TimeSeriesLog::Stats stats = _log.GetStats();
+    ESP_LOGI(TAG, "%u of %u pages used, sequence %u, newest time %u", (unsigned)stats.usedPages,
+             (unsigned)stats.pages, (unsigned)stats.sequence, (unsigned)_log.NewestTime());
+
+    EventBus::get().subscribe<MeasurementEvent>([this](const MeasurementEvent& e) { TryPost(e.Retain()); });
+    _timer.Start(HISTORY_FLUSH_MS, _tick->Retain());
+}
+
+void HistoryLogger::onMeasurement(const MeasurementEvent& e)
+{
+    if (!_running || e.getQuantity() == MeasurementEvent::Quantity::Unknown || !std::isfinite(e.getValue())) {
+        return;
+    }
+    int32_t value = static_cast<int32_t>(std::lround(e.getValue() * 100.0f));
+    uint32_t now = _clock.Now(static_cast<uint32_t>(time(nullptr)), uptimeSeconds());
+    _log.Append(now, SeriesOf(e.getQuantity(), e.getChannel()), value);
+}
+
+void HistoryLogger::onFlush()
+{
+    if (!_log.Flush()) {
+        ESP_LOGW(TAG, "Flush failed, %u records pending", (unsigned)_log.Pending());
+    }
+    _timer.Start(HISTORY_FLUSH_MS, _tick->Retain());
+}
+
+} // namespace Storage
@@ -0,0 +1,72 @@
+#ifndef HISTORY_LOGGER_H
+#define HISTORY_LOGGER_H
+
+#include <cstdint>
+
+#include "activeObject.h"
+#include "events.h"
+#include "logClock.h"
+#include "partitionFlash.h"
+#include "seriesId.h"
+#include "timeSeriesLog.h"
+
+// Data partition holding the history ring (partitions.csv)
+#ifndef HISTORY_PARTITION
+#define HISTORY_PARTITION "history"
+#endif
+
+// Longest time a measurement waits in RAM before it is programmed
+#ifndef HISTORY_FLUSH_MS
+#define HISTORY_FLUSH_MS 60000
+#endif
+
+namespace Storage
+{
+
+/**
+ * @brief   Keeps every published MeasurementEvent in the flash history.
+ *
+ * Records go to a TimeSeriesLog on the history partition: series =
+ * SeriesOf(quantity, channel), value in hundredths, time in seconds of a
+ * LogClock: the wall clock once SNTP set it, before that the newest time
+ * in the log plus the uptime, so records of later boots always sort
+ * after the earlier ones.
+ * The RAM buffer is flushed when full and at least every
+ * HISTORY_FLUSH_MS, so a power cut costs at most that much history.
+ *
+ * Runs on its own low-priority task: a page change erases a sector, which
+ * takes tens of milliseconds and must not hold up an executor worker.
+ * Measurements are only forwarded with TryPost, a slow flash never
+ * blocks the sensors.
+ */
+class HistoryLogger : public ActiveObject {
+public:
+    HistoryLogger();
+
+    // For the actor's own context (e.g. a query handler)
+    TimeSeriesLog& Log() { return _log; }
+
+private:
+    void start();
+    void onMeasurement(const MeasurementEvent& e);
+    void onFlush();
+
+    PartitionFlash _flash;
+    TimeSeriesLog _log;
+    LogClock _clock;
+    const Event* _tick;
+    bool _running;
+
+    // Disallow copy and assignment
+    HistoryLogger(const HistoryLogger&) = delete;
+    HistoryLogger& operator=(const HistoryLogger&) = delete;
+};
+
+class HistoryFlushEvent : public TypedEvent<HistoryFlushEvent, Event::Type::TimerTick> {
+public:
+    HistoryFlushEvent() : TypedEvent("HistoryFlush") {}
+};
+
+} // namespace Storage
+
+#endif // HISTORY_LOGGER_H
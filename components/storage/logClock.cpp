@@ -0,0 +1,32 @@
+#include "logClock.h"
+
+namespace Storage
+{
+
+LogClock::LogClock()
+    : _base(0),
+      _last(0)
+{
+}
+
+void LogClock::Start(uint32_t newest, uint32_t uptime)
+{
+    // One second past the newest record, however long the boot took;
+    // nothing of this boot shares a second with an earlier one
+    _base = static_cast<int64_t>(newest) + 1 - uptime;
+    _last = newest < UINT32_MAX ? newest + 1 : newest;
+}
+
+uint32_t LogClock::Now(uint32_t wallTime, uint32_t uptime)
+{
+    int64_t now = IsWallTime(wallTime) ? wallTime : _base + uptime;
+    if (now > UINT32_MAX) {
+        now = UINT32_MAX;
+    }
+    if (now > _last) {
+        _last = static_cast<uint32_t>(now);
+    }
+    return _last;
+}
+
+} // namespace Storage
@@ -0,0 +1,46 @@
+#ifndef LOG_CLOCK_H
+#define LOG_CLOCK_H
+
+#include <cstdint>
+
+namespace Storage
+{
+
+/**
+ * @brief   Record times for the history that never run backwards across
+ *          reboots.
+ *
+ * The system clock restarts near 0 at every boot and only becomes wall
+ * time once SNTP (or an RTC) has set it. Until then the clock continues
+ * from the newest time already in the log (TimeSeriesLog::NewestTime())
+ * plus the uptime, so a boot always stamps its records after those of
+ * the previous one and time range queries and page summaries keep boots
+ * apart. Once the wall clock is valid it is used as it is; a wall clock
+ * set back is held at the last time handed out.
+ *
+ * Times in seconds. No IDF dependency: the caller passes the wall clock
+ * and the uptime.
+ */
+class LogClock {
+public:
+    // Wall clock from 2021-01-01 on counts as set
+    static constexpr uint32_t VALID_WALL_TIME = 1609459200;
+
+    LogClock();
+
+    // At mount: newest is the latest time in the log, uptime the seconds
+    // since boot right now
+    void Start(uint32_t newest, uint32_t uptime);
+
+    uint32_t Now(uint32_t wallTime, uint32_t uptime);
+    bool IsWallTime(uint32_t wallTime) const { return wallTime >= VALID_WALL_TIME; }
+
+private:
+    // Time of uptime 0 of this boot on the log's time line
+    int64_t _base;
+    uint32_t _last;
+};
+
+} // namespace Storage
+
+#endif // LOG_CLOCK_H
@@ -0,0 +1,45 @@
+#include "partitionFlash.h"
+#include "esp_log.h"
+
+namespace Storage
+{
+static const char* TAG = "PartitionFlash";
+
+PartitionFlash::PartitionFlash(const char* label)
+    : _partition(esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label))
+{
+    if (_partition == nullptr) {
+        ESP_LOGE(TAG, "No data partition \"%s\" in the partition table", label);
+        return;
+    }
+    ESP_LOGI(TAG, "Partition \"%s\": %u KB at 0x%06x", label, (unsigned)(_partition->size / 1024),
+             (unsigned)_partition->address);
+}
+
+size_t PartitionFlash::Size() const
+{
+    return _partition != nullptr ? _partition->size : 0;
+}
+
+size_t PartitionFlash::SectorSize() const
+{
+    return _partition != nullptr ? _partition->erase_size : 4096;
+}
+
+bool PartitionFlash::Read(size_t offset, void* data, size_t length)
+{
+    return _partition != nullptr && esp_partition_read(_partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlash::Write(size_t offset, const void* data, size_t length)
+{
+    return _partition != nullptr && esp_partition_write(_partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlash::EraseSector(size_t offset)
+{
+    return _partition != nullptr &&
+           esp_partition_erase_range(_partition, offset, _partition->erase_size) == ESP_OK;
+}
+
+} // namespace Storage
@@ -0,0 +1,31 @@
+#ifndef PARTITION_FLASH_H
+#define PARTITION_FLASH_H
+
+#include "flashDevice.h"
+#include "esp_partition.h"
+
+namespace Storage
+{
+
+// A data partition of the partition table (see partitions.csv)
+class PartitionFlash : public FlashDevice {
+public:
+    // Finds the data partition by label; IsValid() is false if it is missing
+    explicit PartitionFlash(const char* label);
+
+    bool IsValid() const { return _partition != nullptr; }
+
+    size_t Size() const override;
+    size_t SectorSize() const override;
+
+    bool Read(size_t offset, void* data, size_t length) override;
+    bool Write(size_t offset, const void* data, size_t length) override;
+    bool EraseSector(size_t offset) override;
+
+private:
+    const esp_partition_t* _partition;
+};
+
+} // namespace Storage
+
+#endif // PARTITION_FLASH_H
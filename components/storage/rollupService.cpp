@@ -0,0 +1,93 @@
+#include "rollupService.h"
+#include "eventBus.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace Storage
+{
+static const char* TAG = "Rollup";
+
+RollupService::RollupService()
+    : ActiveObject("Rollup", Executor::Shared(), 32),
+      _store(createStore()),
+      _lock(xSemaphoreCreateMutex()),
+      _running(false)
+{
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<MeasurementEvent>([this](const MeasurementEvent& e) { onMeasurement(e); });
+}
+
+RollupStore* RollupService::createStore()
+{
+    size_t series = ROLLUP_MAX_SERIES;
+    size_t bytes = RollupStore::RequiredBytes(series);
+    void* memory = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    bool external = memory != nullptr;
+    if (memory == nullptr) {
+        series = ROLLUP_INTERNAL_SERIES;
+        bytes = RollupStore::RequiredBytes(series);
+        memory = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (memory == nullptr) {
+        ESP_LOGE(TAG, "No memory for the rollup rings (%u bytes)", (unsigned)bytes);
+        return nullptr;
+    }
+    ESP_LOGI(TAG, "%u series, %u bytes in %s", (unsigned)series, (unsigned)bytes,
+             external ? "PSRAM" : "internal RAM");
+    return new RollupStore(memory, bytes, series);
+}
+
+uint32_t RollupService::nowSeconds()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000000);
+}
+
+void RollupService::start()
+{
+    if (_running || _store == nullptr) {
+        return;
+    }
+    _running = true;
+    EventBus::get().subscribe<MeasurementEvent>([this](const MeasurementEvent& e) { TryPost(e.Retain()); });
+}
+
+void RollupService::onMeasurement(const MeasurementEvent& e)
+{
+    if (e.getQuantity() == MeasurementEvent::Quantity::Unknown) {
+        return;
+    }
+    uint8_t series = SeriesOf(e.getQuantity(), e.getChannel());
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool added = _store->Add(series, e.getValue(), nowSeconds());
+    xSemaphoreGive(_lock);
+    if (!added) {
+        ESP_LOGW(TAG, "No room for series %u", (unsigned)series);
+    }
+}
+
+bool RollupService::Query(MeasurementEvent::Quantity quantity, uint8_t channel, uint32_t seconds,
+                          RollupStats* stats)
+{
+    if (_store == nullptr) {
+        return false;
+    }
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool found = _store->Query(SeriesOf(quantity, channel), seconds, nowSeconds(), stats);
+    xSemaphoreGive(_lock);
+    return found && stats->count > 0;
+}
+
+size_t RollupService::Buckets(MeasurementEvent::Quantity quantity, uint8_t channel, size_t level,
+                              RollupStats* out, size_t maxOut)
+{
+    if (_store == nullptr) {
+        return 0;
+    }
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    size_t count = _store->Buckets(SeriesOf(quantity, channel), level, nowSeconds(), out, maxOut);
+    xSemaphoreGive(_lock);
+    return count;
+}
+
+} // namespace Storage
@@ -0,0 +1,62 @@
+#ifndef ROLLUP_SERVICE_H
+#define ROLLUP_SERVICE_H
+
+#include <cstdint>
+
+#include "activeObject.h"
+#include "events.h"
+#include "rollupStore.h"
+#include "seriesId.h"
+#include "freertos/semphr.h"
+
+// Series kept with the rings in PSRAM (about 9 KB each)
+#ifndef ROLLUP_MAX_SERIES
+#define ROLLUP_MAX_SERIES 16
+#endif
+
+// Series kept when there is no PSRAM and the rings go to internal RAM
+#ifndef ROLLUP_INTERNAL_SERIES
+#define ROLLUP_INTERNAL_SERIES 4
+#endif
+
+namespace Storage
+{
+
+/**
+ * @brief   Live statistics of every published MeasurementEvent.
+ *
+ * Feeds a RollupStore with all measurements (series = SeriesOf(quantity,
+ * channel), time = seconds since boot) and answers window queries such
+ * as "mean water temperature of the last hour" from any task: the
+ * display, the MQTT publisher. Queries and updates share a mutex; a
+ * query merges at most one ring, so nobody waits long.
+ *
+ * The rings are allocated once, in PSRAM if there is any.
+ */
+class RollupService : public ActiveObject {
+public:
+    RollupService();
+
+    // Thread-safe; false if the series has no samples yet
+    bool Query(MeasurementEvent::Quantity quantity, uint8_t channel, uint32_t seconds, RollupStats* stats);
+    size_t Buckets(MeasurementEvent::Quantity quantity, uint8_t channel, size_t level, RollupStats* out,
+                   size_t maxOut);
+
+private:
+    void start();
+    void onMeasurement(const MeasurementEvent& e);
+    static uint32_t nowSeconds();
+    static RollupStore* createStore();
+
+    RollupStore* _store;
+    SemaphoreHandle_t _lock;
+    bool _running;
+
+    // Disallow copy and assignment
+    RollupService(const RollupService&) = delete;
+    RollupService& operator=(const RollupService&) = delete;
+};
+
+} // namespace Storage
+
+#endif // ROLLUP_SERVICE_H
@@ -0,0 +1,150 @@
+#include "rollupStore.h"
+#include <cstring>
+
+namespace Storage
+{
+
+size_t RollupStore::RequiredBytes(size_t maxSeries)
+{
+    return maxSeries * bucketsPerSeries() * sizeof(Bucket);
+}
+
+RollupStore::RollupStore(void* memory, size_t bytes, size_t maxSeries)
+    : _buckets(nullptr),
+      _maxSeries(0),
+      _seriesCount(0),
+      _levelOffset{}
+{
+    memset(_slot, NO_SLOT, sizeof(_slot));
+    if (maxSeries > NO_SLOT) {
+        maxSeries = NO_SLOT;
+    }
+    if (memory == nullptr || maxSeries == 0 || bytes < RequiredBytes(maxSeries)) {
+        return;
+    }
+
+    size_t offset = 0;
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        _levelOffset[level] = offset;
+        offset += LEVELS[level].buckets;
+    }
+
+    _buckets = static_cast<Bucket*>(memory);
+    _maxSeries = maxSeries;
+    for (size_t i = 0; i < maxSeries * bucketsPerSeries(); ++i) {
+        _buckets[i].epoch = UINT32_MAX;
+        _buckets[i].count = 0;
+    }
+}
+
+RollupStore::Bucket* RollupStore::ring(size_t slot, size_t level) const
+{
+    return _buckets + slot * bucketsPerSeries() + _levelOffset[level];
+}
+
+bool RollupStore::Add(uint8_t series, float value, uint32_t now)
+{
+    if (!IsValid() || series >= ROLLUP_SERIES_IDS) {
+        return false;
+    }
+    uint8_t slot = _slot[series];
+    if (slot == NO_SLOT) {
+        if (_seriesCount == _maxSeries) {
+            return false;
+        }
+        slot = static_cast<uint8_t>(_seriesCount++);
+        _slot[series] = slot;
+    }
+
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        uint32_t epoch = now / LEVELS[level].seconds;
+        Bucket& bucket = ring(slot, level)[epoch % LEVELS[level].buckets];
+        if (bucket.epoch != epoch || bucket.count == 0) {
+            // First sample of this slot, whatever the bucket held before
+            // is a whole lap old
+            bucket.epoch = epoch;
+            bucket.count = 1;
+            bucket.min = value;
+            bucket.max = value;
+            bucket.sum = value;
+        } else {
+            bucket.count++;
+            if (value < bucket.min) bucket.min = value;
+            if (value > bucket.max) bucket.max = value;
+            bucket.sum += value;
+        }
+        bucket.last = value;
+    }
+    return true;
+}
+
+void RollupStore::merge(RollupStats& into, const Bucket& bucket)
+{
+    if (into.count == 0) {
+        into.min = bucket.min;
+        into.max = bucket.max;
+    } else {
+        if (bucket.min < into.min) into.min = bucket.min;
+        if (bucket.max > into.max) into.max = bucket.max;
+    }
+    into.count += bucket.count;
+    into.sum += bucket.sum;
+    into.last = bucket.last;
+}
+
+bool RollupStore::Query(uint8_t series, uint32_t seconds, uint32_t now, RollupStats* stats) const
+{
+    if (!IsValid() || series >= ROLLUP_SERIES_IDS || _slot[series] == NO_SLOT) {
+        return false;
+    }
+
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        const Level& config = LEVELS[level];
+        uint32_t wanted = seconds == 0 ? 1 : (seconds + config.seconds - 1) / config.seconds;
+        if (wanted > config.buckets) {
+            continue;
+        }
+
+        *stats = RollupStats{ 0, 0.0f, 0.0f, 0.0f, 0.0f };
+        const Bucket* buckets = ring(_slot[series], level);
+        uint32_t current = now / config.seconds;
+        uint32_t first = current >= wanted - 1 ? current - (wanted - 1) : 0;
+        // Oldest first, so the newest bucket sets last
+        for (uint32_t epoch = first; epoch <= current; ++epoch) {
+            const Bucket& bucket = buckets[epoch % config.buckets];
+            if (bucket.epoch == epoch && bucket.count > 0) {
+                merge(*stats, bucket);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+size_t RollupStore::Buckets(uint8_t series, size_t level, uint32_t now, RollupStats* out, size_t maxOut) const
+{
+    if (!IsValid() || series >= ROLLUP_SERIES_IDS || _slot[series] == NO_SLOT || level >= LEVEL_COUNT) {
+        return 0;
+    }
+
+    const Level& config = LEVELS[level];
+    const Bucket* buckets = ring(_slot[series], level);
+    uint32_t current = now / config.seconds;
+    size_t count = maxOut < config.buckets ? maxOut : config.buckets;
+    // The newest `count` slots, oldest first
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t back = static_cast<uint32_t>(count - 1 - i);
+        out[i] = RollupStats{ 0, 0.0f, 0.0f, 0.0f, 0.0f };
+        if (back > current) {
+            continue;
+        }
+        uint32_t epoch = current - back;
+        const Bucket& bucket = buckets[epoch % config.buckets];
+        if (bucket.epoch == epoch && bucket.count > 0) {
+            merge(out[i], bucket);
+        }
+    }
+    return count;
+}
+
+} // namespace Storage
@@ -0,0 +1,109 @@
+#ifndef ROLLUP_STORE_H
+#define ROLLUP_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Series ids are 0 .. ROLLUP_SERIES_IDS - 1 (see SeriesOf)
+#define ROLLUP_SERIES_IDS 64
+
+namespace Storage
+{
+
+// count/min/max/sum/last of the samples in one bucket or window
+struct RollupStats {
+    uint32_t count;
+    float min;
+    float max;
+    float sum;
+    float last;
+
+    float Mean() const { return count > 0 ? sum / count : 0.0f; }
+};
+
+/**
+ * @brief   Fixed-memory statistics of recent samples at several resolutions.
+ *
+ * Every series keeps one ring of buckets per level (1 s, 1 min, 15 min,
+ * 1 h, see LEVELS). A sample updates the current bucket of each level,
+ * O(1) per sample. Each bucket carries the number of its time slot
+ * (epoch); a slot whose epoch is not the expected one is stale, so gaps
+ * in the stream never have to be cleared bucket by bucket.
+ *
+ * Query() answers "the last N seconds" from the finest level that spans
+ * the window, combining at most one ring (<= 120 buckets) no matter how
+ * many samples arrived. The window is rounded up to whole buckets of that
+ * level, including the current, still filling one.
+ *
+ * The caller provides the memory (RequiredBytes), e.g. from PSRAM. Time
+ * is monotonic seconds, also supplied by the caller. Not thread-safe; no
+ * IDF dependency, the host build feeds it synthetic streams.
+ */
+class RollupStore {
+public:
+    struct Level {
+        uint32_t seconds;   // bucket width
+        uint16_t buckets;   // ring length
+    };
+
+    static constexpr size_t LEVEL_COUNT = 4;
+    // 2 min of seconds, 2 h of minutes, 24 h of quarter hours, 48 h of hours
+    static constexpr Level LEVELS[LEVEL_COUNT] = { { 1, 120 }, { 60, 120 }, { 900, 96 }, { 3600, 48 } };
+
+    static size_t RequiredBytes(size_t maxSeries);
+
+    // memory must stay valid and be aligned for uint32_t
+    RollupStore(void* memory, size_t bytes, size_t maxSeries);
+
+    bool IsValid() const { return _buckets != nullptr; }
+    size_t MaxSeries() const { return _maxSeries; }
+    size_t SeriesCount() const { return _seriesCount; }
+
+    // False if the series is out of range or no slot is left for it
+    bool Add(uint8_t series, float value, uint32_t now);
+
+    // Samples of the last `seconds` up to now; false if the series is
+    // unknown or the window is longer than the coarsest ring
+    bool Query(uint8_t series, uint32_t seconds, uint32_t now, RollupStats* stats) const;
+
+    // The ring of one level, oldest bucket first (count 0 for empty
+    // buckets), e.g. for trend plots; returns the number of buckets
+    size_t Buckets(uint8_t series, size_t level, uint32_t now, RollupStats* out, size_t maxOut) const;
+
+private:
+    struct Bucket {
+        uint32_t epoch;     // now / level width when it was filled
+        uint32_t count;
+        float min;
+        float max;
+        float sum;
+        float last;
+    };
+
+    static constexpr uint8_t NO_SLOT = 0xFF;
+
+    static constexpr size_t bucketsPerSeries() {
+        size_t total = 0;
+        for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+            total += LEVELS[i].buckets;
+        }
+        return total;
+    }
+
+    Bucket* ring(size_t slot, size_t level) const;
+    static void merge(RollupStats& into, const Bucket& bucket);
+
+    Bucket* _buckets;
+    size_t _maxSeries;
+    size_t _seriesCount;
+    size_t _levelOffset[LEVEL_COUNT];
+    uint8_t _slot[ROLLUP_SERIES_IDS];
+
+    // Disallow copy and assignment
+    RollupStore(const RollupStore&) = delete;
+    RollupStore& operator=(const RollupStore&) = delete;
+};
+
+} // namespace Storage
+
+#endif // ROLLUP_STORE_H
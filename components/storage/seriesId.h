@@ -0,0 +1,20 @@
+#ifndef SERIES_ID_H
+#define SERIES_ID_H
+
+#include <cstdint>
+
+#include "events.h"
+
+namespace Storage
+{
+
+// One id per measured quantity and channel: quantity << 3 | channel
+// (8 channels per quantity, 0 .. 63 with room for 8 quantities)
+inline uint8_t SeriesOf(MeasurementEvent::Quantity quantity, uint8_t channel)
+{
+    return static_cast<uint8_t>((static_cast<uint8_t>(quantity) << 3) | (channel & 7));
+}
+
+} // namespace Storage
+
+#endif // SERIES_ID_H
@@ -0,0 +1,192 @@
+// RollupStore: every sample lands in a bucket of each level, the levels
+// agree with each other, Query() rounds the window up to whole buckets
+// of the finest level that spans it, and buckets left over from before a
+// gap are skipped instead of merged.
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "hostTest.h"
+#include "rollupStore.h"
+
+namespace
+{
+
+using Storage::RollupStats;
+using Storage::RollupStore;
+
+constexpr uint8_t SERIES = 5;
+
+class Store {
+public:
+    explicit Store(size_t maxSeries = 2)
+        : memory(RollupStore::RequiredBytes(maxSeries) / sizeof(uint32_t) + 1),
+          store(memory.data(), memory.size() * sizeof(uint32_t), maxSeries)
+    {
+    }
+
+    std::vector<uint32_t> memory;
+    RollupStore store;
+};
+
+// Small integers: the float sums stay exact
+float valueAt(uint32_t t)
+{
+    return static_cast<float>(t % 7);
+}
+
+// Brute force over one sample per second from `start` up to now
+RollupStats expected(uint32_t start, uint32_t from, uint32_t now)
+{
+    RollupStats stats = { 0, 0.0f, 0.0f, 0.0f, 0.0f };
+    for (uint32_t t = from < start ? start : from; t <= now; ++t) {
+        float value = valueAt(t);
+        stats.min = stats.count == 0 ? value : std::fmin(stats.min, value);
+        stats.max = stats.count == 0 ? value : std::fmax(stats.max, value);
+        stats.sum += value;
+        stats.last = value;
+        stats.count++;
+    }
+    return stats;
+}
+
+bool equal(const RollupStats& a, const RollupStats& b)
+{
+    return a.count == b.count && a.min == b.min && a.max == b.max && a.sum == b.sum && a.last == b.last;
+}
+
+RollupStats query(const RollupStore& store, uint32_t seconds, uint32_t now)
+{
+    RollupStats stats = { 0, 0.0f, 0.0f, 0.0f, 0.0f };
+    CHECK(store.Query(SERIES, seconds, now, &stats));
+    return stats;
+}
+
+// Three hours, one sample a second: each level's buckets hold what fell
+// into their slot
+void bucketsCascade()
+{
+    Store s;
+    const uint32_t start = 28 * 3600;
+    const uint32_t now = start + 3 * 3600 - 1;
+    for (uint32_t t = start; t <= now; ++t) {
+        CHECK(s.store.Add(SERIES, valueAt(t), t));
+    }
+
+    bool levelsAgree = true;
+    for (size_t level = 0; level < RollupStore::LEVEL_COUNT; ++level) {
+        const RollupStore::Level& config = RollupStore::LEVELS[level];
+        std::vector<RollupStats> buckets(config.buckets);
+        CHECK_EQ(s.store.Buckets(SERIES, level, now, buckets.data(), buckets.size()), config.buckets);
+        // Newest first from the back: the slot of `now`, then whole slots
+        for (size_t back = 0; back < config.buckets; ++back) {
+            uint32_t epoch = now / config.seconds - static_cast<uint32_t>(back);
+            uint32_t slotStart = epoch * config.seconds;
+            RollupStats want = expected(start, slotStart, std::min(now, slotStart + config.seconds - 1));
+            levelsAgree = levelsAgree && equal(buckets[config.buckets - 1 - back], want);
+        }
+    }
+    CHECK(levelsAgree);
+
+    // At the end of an hour, the last hour from the minute ring equals
+    // the hour ring's bucket
+    RollupStats hours[1];
+    s.store.Buckets(SERIES, 3, now, hours, 1);
+    RollupStats lastHour = query(s.store, 3600, now);
+    CHECK(equal(lastHour, expected(start, now - 3599, now)));
+    CHECK(equal(lastHour, hours[0]));
+}
+
+// The window grows to whole buckets of the finest level spanning it,
+// the current one included
+void windowRounding()
+{
+    Store s;
+    const uint32_t start = 200000;              // a whole hour
+    const uint32_t now = start + 2 * 3600 + 1234;
+    for (uint32_t t = start; t <= now; ++t) {
+        s.store.Add(SERIES, valueAt(t), t);
+    }
+
+    // Seconds ring: exact
+    CHECK(equal(query(s.store, 90, now), expected(start, now - 89, now)));
+    CHECK(equal(query(s.store, 120, now), expected(start, now - 119, now)));
+    CHECK_EQ(query(s.store, 0, now).count, 1u);
+    // 121 s: three minutes (two whole ones and the current)
+    uint32_t minute = now / 60 * 60;
+    CHECK(equal(query(s.store, 121, now), expected(start, minute - 120, now)));
+    CHECK(equal(query(s.store, 7200, now), expected(start, minute - 119 * 60, now)));
+    // 7201 s: nine quarter hours
+    uint32_t quarter = now / 900 * 900;
+    CHECK(equal(query(s.store, 7201, now), expected(start, quarter - 8 * 900, now)));
+    // 48 h is the hour ring, more is out of reach
+    CHECK_EQ(query(s.store, 48 * 3600, now).count, now - start + 1);
+    RollupStats stats;
+    CHECK(!s.store.Query(SERIES, 48 * 3600 + 1, now, &stats));
+
+    // Early on, windows reaching before time 0 start at 0
+    Store early;
+    early.store.Add(SERIES, 1.0f, 3);
+    CHECK_EQ(query(early.store, 3600, 10).count, 1u);
+}
+
+// A bucket whose slot comes round again after a gap holds the old lap:
+// skipped by queries, restarted by the next sample
+void staleSlotsSkipped()
+{
+    Store s;
+    for (uint32_t t = 1000; t < 1060; ++t) {
+        s.store.Add(SERIES, 50.0f, t);
+    }
+    // A lap of the seconds ring after the last sample: the window's slots
+    // are those of the samples, a lap old
+    uint32_t now = 1060 + 120;
+    CHECK_EQ(query(s.store, 120, now).count, 0u);
+    std::vector<RollupStats> seconds(120);
+    s.store.Buckets(SERIES, 0, now, seconds.data(), seconds.size());
+    bool empty = true;
+    for (const RollupStats& bucket : seconds) {
+        empty = empty && bucket.count == 0;
+    }
+    CHECK(empty);
+    // ... while the minute ring still has them
+    CHECK_EQ(query(s.store, 300, now).count, 60u);
+
+    s.store.Add(SERIES, 7.0f, now);
+    RollupStats fresh = query(s.store, 1, now);
+    CHECK(fresh.count == 1 && fresh.sum == 7.0f && fresh.min == 7.0f && fresh.max == 7.0f);
+
+    // Days later every ring has lapped
+    now += 3 * 24 * 3600;
+    CHECK_EQ(query(s.store, 48 * 3600, now).count, 0u);
+    s.store.Add(SERIES, 3.0f, now);
+    RollupStats day = query(s.store, 48 * 3600, now);
+    CHECK(day.count == 1 && day.sum == 3.0f && day.last == 3.0f);
+}
+
+void seriesSlots()
+{
+    Store s(2);
+    CHECK(s.store.Add(1, 1.0f, 10));
+    CHECK(s.store.Add(2, 2.0f, 10));
+    CHECK(!s.store.Add(3, 3.0f, 10));
+    CHECK(!s.store.Add(ROLLUP_SERIES_IDS, 3.0f, 10));
+    CHECK_EQ(s.store.SeriesCount(), 2u);
+    RollupStats stats;
+    CHECK(!s.store.Query(3, 10, 10, &stats));
+    CHECK(s.store.Query(2, 10, 10, &stats) && stats.sum == 2.0f);
+
+    RollupStore tooSmall(s.memory.data(), RollupStore::RequiredBytes(1) - 1, 1);
+    CHECK(!tooSmall.IsValid());
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("3 h of samples: every level's buckets agree", bucketsCascade);
+    HostTest::Run("Query() rounds up to whole buckets of the finest level", windowRounding);
+    HostTest::Run("stale slots after gaps are skipped", staleSlotsSkipped);
+    HostTest::Run("series slots and memory", seriesSlots);
+    return HostTest::Report();
+}
@@ -0,0 +1,372 @@
+// TimeSeriesLog on a FileFlash with the power cut after every possible
+// number of programmed bytes of a workload that wraps the ring: each cut
+// tears a page header, a chunk or a page summary (or falls between two
+// writes). After the reboot Mount() must recover exactly the records of
+// every completed flush that the ring still holds, the log must keep
+// appending, and no cell may ever be programmed twice between erases.
+// A second case power-cycles a logger whose clock restarts at every
+// boot: its LogClock keeps the record times of all boots in order.
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "fileFlash.h"
+#include "hostTest.h"
+#include "logClock.h"
+#include "timeSeriesLog.h"
+
+namespace
+{
+
+using Storage::FileFlash;
+using Storage::FlashDevice;
+using Storage::LogClock;
+using Storage::TimeSeriesLog;
+
+const std::string PATH = "timeSeriesLogTest.bin";
+constexpr size_t SECTOR = 1024;
+constexpr size_t PAGES = 4;
+constexpr uint32_t RECORDS = 900;
+constexpr uint32_t FLUSH_EVERY = 10;
+// About two full pages of the workload's records: the ring always keeps
+// at least its pages but the one being erased and the new head
+constexpr uint32_t MIN_KEPT = 480;
+// Offsets in a page (timeSeriesLog.h)
+constexpr size_t SUMMARY_OFFSET = 16;
+constexpr size_t DATA_OFFSET = 64;
+
+enum class Torn { None, Header, Summary, Chunk };
+
+// Forwards to the FileFlash; counts programming over cells that are no
+// longer erased and notes which part of a page a cut tore
+class Probe : public FlashDevice {
+public:
+    explicit Probe(FileFlash& flash) : _flash(flash) {}
+
+    size_t Size() const override { return _flash.Size(); }
+    size_t SectorSize() const override { return _flash.SectorSize(); }
+    bool Read(size_t offset, void* data, size_t length) override { return _flash.Read(offset, data, length); }
+    bool EraseSector(size_t offset) override { return _flash.EraseSector(offset); }
+
+    bool Write(size_t offset, const void* data, size_t length) override
+    {
+        std::vector<uint8_t> cells(length);
+        if (_flash.Read(offset, cells.data(), length)) {
+            for (uint8_t cell : cells) {
+                overwrites += cell != 0xFF;
+            }
+        }
+        bool alive = !_flash.PowerLost();
+        bool written = _flash.Write(offset, data, length);
+        if (alive && !written && _flash.PowerLost()) {
+            size_t inPage = offset % SECTOR;
+            torn = inPage < SUMMARY_OFFSET ? Torn::Header : (inPage < DATA_OFFSET ? Torn::Summary : Torn::Chunk);
+        }
+        return written;
+    }
+
+    uint32_t overwrites = 0;
+    Torn torn = Torn::None;
+
+private:
+    FileFlash& _flash;
+};
+
+// The log reports every torn page and failed write on stderr; thousands
+// of reboots would bury the result
+class QuietStderr {
+public:
+    QuietStderr() : _saved(dup(STDERR_FILENO))
+    {
+        int null = open("/dev/null", O_WRONLY);
+        fflush(stderr);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+
+    ~QuietStderr()
+    {
+        fflush(stderr);
+        dup2(_saved, STDERR_FILENO);
+        close(_saved);
+    }
+
+private:
+    int _saved;
+};
+
+TimeSeriesLog::Record record(uint32_t i)
+{
+    // Varied deltas so the chunks differ in length
+    return TimeSeriesLog::Record{ 1000 + i * 3, static_cast<uint8_t>(i % 3), static_cast<int32_t>(i * i % 977) - 400 };
+}
+
+bool collect(const TimeSeriesLog::Record& record, void* context)
+{
+    static_cast<std::vector<TimeSeriesLog::Record>*>(context)->push_back(record);
+    return true;
+}
+
+std::vector<TimeSeriesLog::Record> readAll(TimeSeriesLog& log)
+{
+    std::vector<TimeSeriesLog::Record> records;
+    log.Query(0, UINT32_MAX, TimeSeriesLog::ALL_SERIES, collect, &records);
+    return records;
+}
+
+bool same(const TimeSeriesLog::Record& a, const TimeSeriesLog::Record& b)
+{
+    return a.time == b.time && a.series == b.series && a.value == b.value;
+}
+
+// Records first..last of the workload, in order
+bool isRun(const std::vector<TimeSeriesLog::Record>& records, size_t from, size_t count, uint32_t first)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (from + i >= records.size() || !same(records[from + i], record(first + i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Outcome {
+    Torn torn;
+    uint32_t durable;           // records of the completed flushes
+    uint32_t tornChunks;        // reported by Mount()
+    uint32_t overwrites;
+    bool recovered;             // the durable tail, nothing made up
+    bool appended;              // new records after the reboot survive another one
+};
+
+// Formats, runs the workload with the power cut after `budget` bytes,
+// reboots, checks the recovery and appends more
+Outcome cutAfter(size_t budget)
+{
+    Outcome outcome = {};
+    std::remove(PATH.c_str());
+    {
+        FileFlash flash(PATH, SECTOR * PAGES, SECTOR);
+        Probe probe(flash);
+        TimeSeriesLog log(probe);
+        log.Format();
+        log.Mount();
+        flash.CutPowerAfter(budget);
+        for (uint32_t i = 0; i < RECORDS && !flash.PowerLost(); ++i) {
+            log.Append(record(i));
+            if ((i + 1) % FLUSH_EVERY == 0 && log.Flush()) {
+                outcome.durable = i + 1;
+            }
+        }
+        outcome.torn = probe.torn;
+        outcome.overwrites += probe.overwrites;
+    }
+
+    // Reboot
+    FileFlash flash(PATH, SECTOR * PAGES, SECTOR);
+    Probe probe(flash);
+    {
+        TimeSeriesLog log(probe);
+        log.Mount();
+        outcome.tornChunks = log.GetStats().tornChunks;
+
+        // The tail of the workload up to the last completed flush
+        std::vector<TimeSeriesLog::Record> records = readAll(log);
+        uint32_t count = static_cast<uint32_t>(records.size());
+        outcome.recovered = count <= outcome.durable && isRun(records, 0, count, outcome.durable - count) &&
+                            count >= (outcome.durable < MIN_KEPT ? outcome.durable : MIN_KEPT);
+
+        for (uint32_t i = 0; i < 50; ++i) {
+            log.Append(record(RECORDS + i));
+        }
+        log.Flush();
+    }
+    {
+        TimeSeriesLog log(probe);
+        log.Mount();
+        std::vector<TimeSeriesLog::Record> records = readAll(log);
+        outcome.appended = records.size() >= 50 && isRun(records, records.size() - 50, 50, RECORDS);
+    }
+    outcome.overwrites += probe.overwrites;
+    return outcome;
+}
+
+// Bytes the uninterrupted workload programs
+size_t workloadBytes()
+{
+    std::remove(PATH.c_str());
+    FileFlash flash(PATH, SECTOR * PAGES, SECTOR);
+    TimeSeriesLog log(flash);
+    log.Format();
+    log.Mount();
+    for (uint32_t i = 0; i < RECORDS; ++i) {
+        log.Append(record(i));
+        if ((i + 1) % FLUSH_EVERY == 0) {
+            log.Flush();
+        }
+    }
+    TimeSeriesLog::Stats stats = log.GetStats();
+    // Chunks, plus a header and a summary per page opened (the head has
+    // none yet: the last cut points see the whole workload)
+    return stats.bytesWritten + stats.sequence * (16 + 36);
+}
+
+void everyCutRecovers()
+{
+    size_t total = workloadBytes();
+    size_t failures = 0;
+    size_t tornHeaders = 0;
+    size_t tornSummaries = 0;
+    size_t tornChunks = 0;
+    uint32_t overwrites = 0;
+    {
+        QuietStderr quiet;
+        for (size_t budget = 0; budget <= total; ++budget) {
+            Outcome outcome = cutAfter(budget);
+            bool ok = outcome.recovered && outcome.appended;
+            switch (outcome.torn) {
+            case Torn::Header:
+                tornHeaders++;
+                break;
+            case Torn::Summary:
+                tornSummaries++;
+                break;
+            case Torn::Chunk:
+                tornChunks++;
+                // Found and the page closed behind it
+                ok = ok && outcome.tornChunks == 1;
+                break;
+            case Torn::None:
+                ok = ok && outcome.tornChunks == 0;
+                break;
+            }
+            overwrites += outcome.overwrites;
+            if (!ok && failures++ < 5) {
+                printf("  cut after %zu bytes: torn %d, durable %u, recovered %d, appended %d, torn chunks %u\n",
+                       budget, static_cast<int>(outcome.torn), (unsigned)outcome.durable, outcome.recovered,
+                       outcome.appended, (unsigned)outcome.tornChunks);
+            }
+        }
+    }
+    CHECK(total > SECTOR * PAGES);
+    printf("  %zu cut points: %zu in headers, %zu in summaries, %zu in chunks\n", total + 1, tornHeaders,
+           tornSummaries, tornChunks);
+    CHECK_EQ(failures, 0u);
+    CHECK(tornHeaders > 0 && tornSummaries > 0 && tornChunks > 0);
+    CHECK_EQ(overwrites, 0u);
+    std::remove(PATH.c_str());
+}
+
+struct Boot {
+    uint32_t wallTime;      // at mount, 0 while the wall clock is not set
+    uint32_t mountUptime;   // seconds from power-on to the mount
+    bool flushAtEnd;        // false: the power goes before the last flush
+};
+
+// One record per second for 80 s per boot, series = boot number; each boot
+// mounts the log from the file like a reboot does
+void bootsStayOrdered()
+{
+    constexpr uint32_t RECORDS_PER_BOOT = 80;
+    const uint32_t wall = LogClock::VALID_WALL_TIME + 5000000;
+    const Boot boots[] = {
+        { 0, 3, true },
+        { 0, 2, false },
+        { 0, 4, true },
+        { wall, 3, true },
+        // SNTP unreachable after the reboot, then back with a clock 10 s
+        // behind the log
+        { 0, 2, true },
+        { wall + 150, 2, true },
+    };
+    constexpr size_t BOOTS = sizeof(boots) / sizeof(boots[0]);
+
+    std::remove(PATH.c_str());
+    {
+        FileFlash flash(PATH, SECTOR * PAGES, SECTOR);
+        TimeSeriesLog log(flash);
+        CHECK(log.Format());
+    }
+
+    uint32_t lastFlushed = 0;
+    bool mountsContinue = true;
+    for (size_t b = 0; b < BOOTS; ++b) {
+        FileFlash flash(PATH, SECTOR * PAGES, SECTOR);
+        TimeSeriesLog log(flash);
+        CHECK(log.Mount());
+        mountsContinue = mountsContinue && log.NewestTime() == lastFlushed;
+
+        LogClock clock;
+        clock.Start(log.NewestTime(), boots[b].mountUptime);
+        for (uint32_t i = 0; i < RECORDS_PER_BOOT; ++i) {
+            uint32_t uptime = boots[b].mountUptime + i;
+            uint32_t wallTime = boots[b].wallTime != 0 ? boots[b].wallTime + i : uptime;
+            uint32_t time = clock.Now(wallTime, uptime);
+            log.Append(time, static_cast<uint8_t>(b), static_cast<int32_t>(i));
+            if (i % 10 == 9 && (boots[b].flushAtEnd || i < 60)) {
+                log.Flush();
+                lastFlushed = time;
+            }
+        }
+    }
+    CHECK(mountsContinue);
+
+    FileFlash flash(PATH, SECTOR * PAGES, SECTOR);
+    TimeSeriesLog log(flash);
+    CHECK(log.Mount());
+    std::vector<TimeSeriesLog::Record> records = readAll(log);
+    CHECK_EQ(records.size(), BOOTS * RECORDS_PER_BOOT - (RECORDS_PER_BOOT - 60));
+
+    // Times never go back, a later boot never goes below an earlier one
+    bool ordered = true;
+    for (size_t i = 1; i < records.size(); ++i) {
+        ordered = ordered && records[i].time >= records[i - 1].time;
+        if (records[i].series != records[i - 1].series) {
+            ordered = ordered && records[i].series == records[i - 1].series + 1 && records[i].time > records[i - 1].time;
+        }
+    }
+    CHECK(ordered);
+
+    // The time range of one boot holds that boot's records only
+    for (uint8_t b = 0; b < BOOTS; ++b) {
+        uint32_t from = UINT32_MAX;
+        uint32_t to = 0;
+        size_t count = 0;
+        for (const TimeSeriesLog::Record& record : records) {
+            if (record.series == b) {
+                from = record.time < from ? record.time : from;
+                to = record.time > to ? record.time : to;
+                count++;
+            }
+        }
+        std::vector<TimeSeriesLog::Record> range;
+        log.Query(from, to, TimeSeriesLog::ALL_SERIES, collect, &range);
+        bool onlyThisBoot = range.size() == count;
+        for (const TimeSeriesLog::Record& record : range) {
+            onlyThisBoot = onlyThisBoot && record.series == b;
+        }
+        CHECK(onlyThisBoot);
+    }
+
+    // Before SNTP the times are seconds after the previous boot, from
+    // the wall clock on wall time; the boot without it continues from
+    // there, the clock set back is held until it catches up
+    CHECK_EQ(records.front().time, 1u);
+    CHECK(records[3 * RECORDS_PER_BOOT - 20].time == wall);
+    CHECK(records[4 * RECORDS_PER_BOOT - 20].time == wall + RECORDS_PER_BOOT);
+    CHECK(records[5 * RECORDS_PER_BOOT - 20].time == wall + 2 * RECORDS_PER_BOOT);
+    CHECK(records[5 * RECORDS_PER_BOOT - 20 + 10].time == wall + 2 * RECORDS_PER_BOOT);
+    CHECK(records.back().time == wall + 150 + RECORDS_PER_BOOT - 1);
+    std::remove(PATH.c_str());
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("power cut after every byte: recovery, no cell programmed twice", everyCutRecovers);
+    HostTest::Run("power cycles without a wall clock: times stay in order", bootsStayOrdered);
+    return HostTest::Report();
+}
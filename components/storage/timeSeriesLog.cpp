@@ -0,0 +1,580 @@
+#include "timeSeriesLog.h"
+#include <cstring>
+#include "esp_log.h"
+
+namespace Storage
+{
+static const char* TAG = "TimeSeriesLog";
+
+// CRC-32 (IEEE, reflected) for headers and summaries
+static uint32_t crc32(const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// CRC-16/CCITT-FALSE for chunks
+static uint16_t crc16(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static size_t putVarint(uint64_t value, uint8_t* out)
+{
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = static_cast<uint8_t>(value);
+    return length;
+}
+
+// 0 if the varint runs past the end or is longer than 64 bits
+static size_t getVarint(const uint8_t* data, size_t length, uint64_t* value)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < length && i < 10; ++i) {
+        result |= static_cast<uint64_t>(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void TimeSeriesLog::Coder::Reset()
+{
+    time = 0;
+    memset(value, 0, sizeof(value));
+}
+
+TimeSeriesLog::TimeSeriesLog(FlashDevice& flash)
+    : _flash(flash),
+      _sectorSize(flash.SectorSize()),
+      _pages(static_cast<uint32_t>(flash.Size() / flash.SectorSize())),
+      _mounted(false),
+      _head(NO_PAGE),
+      _sequence(0),
+      _open(false),
+      _writeOffset(0),
+      _chunkLength(CHUNK_HEADER),
+      _pendingRecords(0),
+      _newestTime(0),
+      _appended(0),
+      _chunks(0),
+      _bytesWritten(0),
+      _erases(0),
+      _tornChunks(0),
+      _dropped(0)
+{
+    _coder.Reset();
+    clear(_headSummary, 0);
+    clear(_pendingSummary, 0);
+}
+
+void TimeSeriesLog::clear(PageSummary& summary, uint32_t sequence)
+{
+    summary.sequence = sequence;
+    summary.minTime = UINT32_MAX;
+    summary.maxTime = 0;
+    summary.minValue = INT32_MAX;
+    summary.maxValue = INT32_MIN;
+    summary.seriesMask = 0;
+    summary.records = 0;
+}
+
+void TimeSeriesLog::merge(PageSummary& into, const Record& record)
+{
+    if (record.time < into.minTime) into.minTime = record.time;
+    if (record.time > into.maxTime) into.maxTime = record.time;
+    if (record.value < into.minValue) into.minValue = record.value;
+    if (record.value > into.maxValue) into.maxValue = record.value;
+    into.seriesMask |= SeriesBit(record.series);
+    into.records++;
+}
+
+void TimeSeriesLog::mergeSummary(PageSummary& into, const PageSummary& from)
+{
+    if (from.records == 0) {
+        return;
+    }
+    if (from.minTime < into.minTime) into.minTime = from.minTime;
+    if (from.maxTime > into.maxTime) into.maxTime = from.maxTime;
+    if (from.minValue < into.minValue) into.minValue = from.minValue;
+    if (from.maxValue > into.maxValue) into.maxValue = from.maxValue;
+    into.seriesMask |= from.seriesMask;
+    into.records += from.records;
+}
+
+bool TimeSeriesLog::overlaps(const PageSummary& page, uint32_t from, uint32_t to, uint64_t seriesMask)
+{
+    return page.records > 0 && page.minTime <= to && page.maxTime >= from && (page.seriesMask & seriesMask) != 0;
+}
+
+bool TimeSeriesLog::readHeader(uint32_t page, uint32_t* sequence)
+{
+    PageHeader header;
+    if (!_flash.Read(pageOffset(page) + HEADER_OFFSET, &header, sizeof(header))) {
+        return false;
+    }
+    if (header.magic != PAGE_MAGIC || header.crc != crc32(&header, offsetof(PageHeader, crc))) {
+        return false;
+    }
+    *sequence = header.sequence;
+    return true;
+}
+
+bool TimeSeriesLog::loadSummary(uint32_t page, PageSummary* summary, size_t* dataEnd, bool* erased)
+{
+    StoredSummary stored;
+    *erased = false;
+    if (!_flash.Read(pageOffset(page) + SUMMARY_OFFSET, &stored, sizeof(stored))) {
+        return false;
+    }
+    if (stored.crc != crc32(&stored, offsetof(StoredSummary, crc))) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&stored);
+        *erased = true;
+        for (size_t i = 0; i < sizeof(stored); ++i) {
+            *erased = *erased && bytes[i] == 0xFF;
+        }
+        return false;
+    }
+    summary->minTime = stored.minTime;
+    summary->maxTime = stored.maxTime;
+    summary->minValue = stored.minValue;
+    summary->maxValue = stored.maxValue;
+    summary->seriesMask = (static_cast<uint64_t>(stored.maskHigh) << 32) | stored.maskLow;
+    summary->records = stored.records;
+    *dataEnd = stored.dataEnd;
+    return true;
+}
+
+bool TimeSeriesLog::Mount()
+{
+    _mounted = false;
+    if (_pages < 2 || _sectorSize < DATA_OFFSET + LOG_CHUNK_MAX || _sectorSize > 0x10000) {
+        ESP_LOGE(TAG, "Region of %u bytes in %u byte sectors cannot hold a log", (unsigned)_flash.Size(),
+                 (unsigned)_sectorSize);
+        return false;
+    }
+
+    _head = NO_PAGE;
+    _sequence = 0;
+    _open = false;
+    for (uint32_t page = 0; page < _pages; ++page) {
+        uint32_t sequence;
+        if (readHeader(page, &sequence) && (_head == NO_PAGE || sequence > _sequence)) {
+            _head = page;
+            _sequence = sequence;
+        }
+    }
+    _mounted = true;
+    _newestTime = findNewestTime();
+
+    if (_head == NO_PAGE) {
+        ESP_LOGI(TAG, "Empty log, %u pages of %u bytes", (unsigned)_pages, (unsigned)_sectorSize);
+        return true;
+    }
+
+    clear(_headSummary, _sequence);
+    size_t dataEnd;
+    bool erased;
+    if (loadSummary(_head, &_headSummary, &dataEnd, &erased)) {
+        // Closed before the reboot, the next flush opens a new page
+        ESP_LOGI(TAG, "Head page %u (seq %u) closed", (unsigned)_head, (unsigned)_sequence);
+        return true;
+    }
+
+    bool torn = false;
+    _writeOffset = scanPage(_head, _sectorSize, &_headSummary, nullptr, &torn);
+    if (!erased) {
+        // Cut while closing: the page stays without summary, queries scan it
+        ESP_LOGW(TAG, "Torn summary on page %u, leaving the page", (unsigned)_head);
+    } else if (torn) {
+        // Never program over the cells of a half-written chunk
+        _tornChunks++;
+        _open = true;
+        ESP_LOGW(TAG, "Torn chunk at page %u offset %u, closing the page", (unsigned)_head,
+                 (unsigned)_writeOffset);
+        closePage();
+    } else {
+        _open = true;
+    }
+    ESP_LOGI(TAG, "Head page %u (seq %u): %u records", (unsigned)_head, (unsigned)_sequence,
+             (unsigned)_headSummary.records);
+    return true;
+}
+
+uint32_t TimeSeriesLog::findNewestTime()
+{
+    // Closed pages by their summary, open ones (the head, a page whose
+    // summary was torn) by a scan
+    uint32_t newest = 0;
+    for (uint32_t page = 0; page < _pages; ++page) {
+        PageSummary summary;
+        uint32_t sequence;
+        if (!readHeader(page, &sequence)) {
+            continue;
+        }
+        clear(summary, sequence);
+        size_t dataEnd;
+        bool erased;
+        if (!loadSummary(page, &summary, &dataEnd, &erased)) {
+            bool torn;
+            scanPage(page, _sectorSize, &summary, nullptr, &torn);
+        }
+        if (summary.records > 0 && summary.maxTime > newest) {
+            newest = summary.maxTime;
+        }
+    }
+    return newest;
+}
+
+bool TimeSeriesLog::Format()
+{
+    for (uint32_t page = 0; page < _pages; ++page) {
+        if (!_flash.EraseSector(pageOffset(page))) {
+            ESP_LOGE(TAG, "Erasing page %u failed", (unsigned)page);
+            return false;
+        }
+        _erases++;
+    }
+    _head = NO_PAGE;
+    _sequence = 0;
+    _open = false;
+    _chunkLength = CHUNK_HEADER;
+    _pendingRecords = 0;
+    _newestTime = 0;
+    _coder.Reset();
+    clear(_headSummary, 0);
+    clear(_pendingSummary, 0);
+    _mounted = _pages >= 2;
+    return _mounted;
+}
+
+size_t TimeSeriesLog::encode(const Coder& coder, const Record& record, uint8_t* out)
+{
+    size_t length = putVarint(zigzag(static_cast<int64_t>(record.time) - coder.time), out);
+    out[length++] = record.series;
+    int64_t delta = static_cast<int64_t>(record.value) - coder.value[record.series];
+    length += putVarint(zigzag(delta), out + length);
+    return length;
+}
+
+bool TimeSeriesLog::Append(const Record& record)
+{
+    if (!_mounted || record.series >= LOG_MAX_SERIES) {
+        return false;
+    }
+
+    // Worst case: 5 + 1 + 5 bytes
+    uint8_t coded[16];
+    size_t length = encode(_coder, record, coded);
+    if (_chunkLength + length > LOG_CHUNK_MAX) {
+        if (!Flush()) {
+            // Make room rather than block the writer on a broken flash
+            _dropped += static_cast<uint32_t>(_pendingRecords);
+            _chunkLength = CHUNK_HEADER;
+            _pendingRecords = 0;
+            clear(_pendingSummary, 0);
+        }
+        _coder.Reset();
+        length = encode(_coder, record, coded);
+    }
+
+    memcpy(_chunk + _chunkLength, coded, length);
+    _chunkLength += length;
+    _coder.time = record.time;
+    _coder.value[record.series] = record.value;
+    _pendingRecords++;
+    merge(_pendingSummary, record);
+    if (record.time > _newestTime) {
+        _newestTime = record.time;
+    }
+    _appended++;
+    return true;
+}
+
+bool TimeSeriesLog::Flush()
+{
+    if (!_mounted) {
+        return false;
+    }
+    if (_pendingRecords == 0) {
+        return true;
+    }
+
+    if (_open && _writeOffset + _chunkLength > _sectorSize) {
+        closePage();
+    }
+    if (!_open && !openNextPage()) {
+        return false;
+    }
+    if (!writeChunk()) {
+        // Whatever made it into the cells is garbage now, move on and try
+        // the next page once
+        closePage();
+        if (!openNextPage() || !writeChunk()) {
+            return false;
+        }
+    }
+
+    mergeSummary(_headSummary, _pendingSummary);
+    _chunkLength = CHUNK_HEADER;
+    _pendingRecords = 0;
+    _coder.Reset();
+    clear(_pendingSummary, 0);
+    return true;
+}
+
+bool TimeSeriesLog::writeChunk()
+{
+    uint16_t payload = static_cast<uint16_t>(_chunkLength - CHUNK_HEADER);
+    uint16_t crc = crc16(_chunk + CHUNK_HEADER, payload);
+    memcpy(_chunk, &payload, sizeof(payload));
+    memcpy(_chunk + sizeof(payload), &crc, sizeof(crc));
+
+    if (!_flash.Write(pageOffset(_head) + _writeOffset, _chunk, _chunkLength)) {
+        ESP_LOGE(TAG, "Writing page %u offset %u failed", (unsigned)_head, (unsigned)_writeOffset);
+        return false;
+    }
+    _writeOffset += _chunkLength;
+    _bytesWritten += static_cast<uint32_t>(_chunkLength);
+    _chunks++;
+    return true;
+}
+
+bool TimeSeriesLog::closePage()
+{
+    if (!_open) {
+        return true;
+    }
+    _open = false;
+
+    StoredSummary stored;
+    stored.minTime = _headSummary.minTime;
+    stored.maxTime = _headSummary.maxTime;
+    stored.minValue = _headSummary.minValue;
+    stored.maxValue = _headSummary.maxValue;
+    stored.maskLow = static_cast<uint32_t>(_headSummary.seriesMask);
+    stored.maskHigh = static_cast<uint32_t>(_headSummary.seriesMask >> 32);
+    stored.records = _headSummary.records;
+    stored.dataEnd = static_cast<uint32_t>(_writeOffset);
+    stored.crc = crc32(&stored, offsetof(StoredSummary, crc));
+    if (!_flash.Write(pageOffset(_head) + SUMMARY_OFFSET, &stored, sizeof(stored))) {
+        // Mount() scans the page again; nothing is appended to it anyway
+        ESP_LOGW(TAG, "Writing the summary of page %u failed", (unsigned)_head);
+        return false;
+    }
+    return true;
+}
+
+bool TimeSeriesLog::openNextPage()
+{
+    uint32_t page = _head == NO_PAGE ? 0 : (_head + 1) % _pages;
+    if (!_flash.EraseSector(pageOffset(page))) {
+        ESP_LOGE(TAG, "Erasing page %u failed", (unsigned)page);
+        return false;
+    }
+    _erases++;
+
+    // The header makes the page the head; until it is complete the page
+    // reads as unused and the old head stays in charge
+    PageHeader header = {};
+    header.magic = PAGE_MAGIC;
+    header.sequence = _sequence + 1;
+    header.crc = crc32(&header, offsetof(PageHeader, crc));
+    header.reserved = 0xFFFFFFFF;
+    if (!_flash.Write(pageOffset(page) + HEADER_OFFSET, &header, sizeof(header))) {
+        ESP_LOGE(TAG, "Writing the header of page %u failed", (unsigned)page);
+        return false;
+    }
+
+    _head = page;
+    _sequence = header.sequence;
+    _open = true;
+    _writeOffset = DATA_OFFSET;
+    clear(_headSummary, _sequence);
+    return true;
+}
+
+void TimeSeriesLog::decodeChunk(const uint8_t* data, size_t length, PageSummary* summary, Walk* walk)
+{
+    Coder coder;
+    coder.Reset();
+    size_t position = 0;
+    while (position < length) {
+        uint64_t timeDelta;
+        uint64_t valueDelta;
+        size_t used = getVarint(data + position, length - position, &timeDelta);
+        if (used == 0 || position + used >= length) {
+            break;
+        }
+        position += used;
+        uint8_t series = data[position++];
+        used = getVarint(data + position, length - position, &valueDelta);
+        if (used == 0 || series >= LOG_MAX_SERIES) {
+            break;
+        }
+        position += used;
+
+        Record record;
+        record.time = static_cast<uint32_t>(coder.time + unzigzag(timeDelta));
+        record.series = series;
+        record.value = static_cast<int32_t>(coder.value[series] + unzigzag(valueDelta));
+        coder.time = record.time;
+        coder.value[series] = record.value;
+
+        if (summary != nullptr) {
+            merge(*summary, record);
+        }
+        if (walk != nullptr && record.time >= walk->from && record.time <= walk->to &&
+            (SeriesBit(series) & walk->seriesMask) != 0) {
+            walk->visited++;
+            if (!walk->visitor(record, walk->context)) {
+                walk->stop = true;
+                break;
+            }
+        }
+    }
+}
+
+size_t TimeSeriesLog::scanPage(uint32_t page, size_t end, PageSummary* summary, Walk* walk, bool* torn)
+{
+    uint8_t chunk[LOG_CHUNK_MAX];
+    size_t offset = DATA_OFFSET;
+    *torn = false;
+
+    while (offset + CHUNK_HEADER <= end && (walk == nullptr || !walk->stop)) {
+        uint16_t fields[2];
+        if (!_flash.Read(pageOffset(page) + offset, fields, sizeof(fields))) {
+            *torn = true;
+            break;
+        }
+        if (fields[0] == CHUNK_END && fields[1] == CHUNK_END) {
+            break;
+        }
+        size_t length = fields[0];
+        if (length == 0 || length > LOG_CHUNK_MAX - CHUNK_HEADER || offset + CHUNK_HEADER + length > end ||
+            !_flash.Read(pageOffset(page) + offset + CHUNK_HEADER, chunk, length) ||
+            crc16(chunk, length) != fields[1]) {
+            *torn = true;
+            break;
+        }
+        decodeChunk(chunk, length, summary, walk);
+        offset += CHUNK_HEADER + length;
+    }
+    return offset;
+}
+
+size_t TimeSeriesLog::Query(uint32_t from, uint32_t to, uint64_t seriesMask, Visitor visitor, void* context)
+{
+    if (!_mounted || visitor == nullptr) {
+        return 0;
+    }
+    Walk walk = { from, to, seriesMask, visitor, context, 0, false };
+
+    // Oldest page first: the one after the head
+    for (uint32_t i = 1; _head != NO_PAGE && i <= _pages && !walk.stop; ++i) {
+        uint32_t page = (_head + i) % _pages;
+        PageSummary summary;
+        if (!readHeader(page, &summary.sequence)) {
+            continue;
+        }
+        size_t end = _sectorSize;
+        bool erased;
+        if (page == _head && _open) {
+            if (!overlaps(_headSummary, from, to, seriesMask)) {
+                continue;
+            }
+            end = _writeOffset;
+        } else if (loadSummary(page, &summary, &end, &erased) && !overlaps(summary, from, to, seriesMask)) {
+            continue;
+        }
+        bool torn;
+        scanPage(page, end, nullptr, &walk, &torn);
+    }
+
+    if (!walk.stop && _pendingRecords > 0) {
+        decodeChunk(_chunk + CHUNK_HEADER, _chunkLength - CHUNK_HEADER, nullptr, &walk);
+    }
+    return walk.visited;
+}
+
+size_t TimeSeriesLog::QueryPages(uint32_t from, uint32_t to, PageVisitor visitor, void* context)
+{
+    size_t visited = 0;
+    if (!_mounted || visitor == nullptr || _head == NO_PAGE) {
+        return 0;
+    }
+
+    for (uint32_t i = 1; i <= _pages; ++i) {
+        uint32_t page = (_head + i) % _pages;
+        PageSummary summary;
+        if (!readHeader(page, &summary.sequence)) {
+            continue;
+        }
+        size_t end;
+        bool erased;
+        if (page == _head && _open) {
+            summary = _headSummary;
+        } else if (!loadSummary(page, &summary, &end, &erased)) {
+            // No summary (flash error or cut while closing): rebuild it
+            bool torn;
+            clear(summary, summary.sequence);
+            scanPage(page, _sectorSize, &summary, nullptr, &torn);
+        }
+        if (!overlaps(summary, from, to, ALL_SERIES)) {
+            continue;
+        }
+        visited++;
+        if (!visitor(summary, context)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+TimeSeriesLog::Stats TimeSeriesLog::GetStats() const
+{
+    Stats stats;
+    stats.pages = _pages;
+    // Pages are used in sequence order from the first one written
+    stats.usedPages = _head == NO_PAGE ? 0 : (_sequence < _pages ? _sequence : _pages);
+    stats.sequence = _sequence;
+    stats.appended = _appended;
+    stats.chunks = _chunks;
+    stats.bytesWritten = _bytesWritten;
+    stats.erases = _erases;
+    stats.tornChunks = _tornChunks;
+    stats.dropped = _dropped;
+    return stats;
+}
+
+} // namespace Storage
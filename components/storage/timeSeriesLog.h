@@ -0,0 +1,210 @@
+#ifndef TIME_SERIES_LOG_H
+#define TIME_SERIES_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "flashDevice.h"
+
+// RAM buffer of one chunk; a flush programs it as one write
+#ifndef LOG_CHUNK_MAX
+#define LOG_CHUNK_MAX 512
+#endif
+
+// Series ids are 0 .. LOG_MAX_SERIES - 1 (one bit each in the page masks)
+#define LOG_MAX_SERIES 64
+
+namespace Storage
+{
+
+/**
+ * @brief   Append-only circular log of time series records on raw flash.
+ *
+ * The region is split into pages of one erase sector each, written
+ * strictly round-robin, so every sector is erased once per lap of the
+ * ring (wear levelling without any mapping). A page holds:
+ *
+ *   - a header (magic, sequence number, CRC), programmed right after the
+ *     erase; the page with the highest valid sequence is the head,
+ *   - a summary (time range, value range, series mask, record count),
+ *     programmed once when the page is closed; queries skip pages by it,
+ *   - chunks: { length, CRC-16 } plus delta/varint coded records, one
+ *     chunk per flush of the RAM buffer.
+ *
+ * Power cuts: a torn header makes the page look unused, a torn chunk
+ * fails its CRC. Mount() takes the head, scans it if it is still open
+ * and closes it at the first torn chunk, so appending never programs
+ * over half-written cells. At most the unflushed RAM buffer is lost.
+ *
+ * Not thread-safe; owned by one actor. No IDF dependency, the host build
+ * runs it on a FileFlash.
+ */
+class TimeSeriesLog {
+public:
+    struct Record {
+        uint32_t time;      // seconds (any monotonic-ish epoch)
+        uint8_t series;     // 0 .. LOG_MAX_SERIES - 1
+        int32_t value;      // fixed point, scale chosen by the writer
+    };
+
+    // Summary of one page, also of the open head page
+    struct PageSummary {
+        uint32_t sequence;
+        uint32_t minTime;
+        uint32_t maxTime;
+        int32_t minValue;
+        int32_t maxValue;
+        uint64_t seriesMask;
+        uint32_t records;
+    };
+
+    struct Stats {
+        size_t pages;
+        size_t usedPages;
+        uint32_t sequence;
+        uint32_t appended;
+        uint32_t chunks;
+        uint32_t bytesWritten;
+        uint32_t erases;
+        uint32_t tornChunks;    // found by Mount()
+        uint32_t dropped;       // records lost to flash errors
+    };
+
+    // Return false to stop the walk
+    using Visitor = bool (*)(const Record& record, void* context);
+    using PageVisitor = bool (*)(const PageSummary& page, void* context);
+
+    static uint64_t SeriesBit(uint8_t series) { return 1ull << (series % LOG_MAX_SERIES); }
+    static constexpr uint64_t ALL_SERIES = ~0ull;
+
+    explicit TimeSeriesLog(FlashDevice& flash);
+
+    // Finds the head page and recovers an interrupted page; false if the
+    // region cannot hold a log (under two pages, or sectors below a chunk)
+    bool Mount();
+    // Erases the whole region
+    bool Format();
+
+    // Buffers the record; flushes by itself when the buffer is full
+    bool Append(const Record& record);
+    bool Append(uint32_t time, uint8_t series, int32_t value) { return Append(Record{ time, series, value }); }
+    // Programs the buffered records (one chunk); no-op if empty
+    bool Flush();
+    size_t Pending() const { return _pendingRecords; }
+    // Latest record time on flash or in the buffer, 0 if there is none; a
+    // writer whose clock restarts at boot continues from here
+    uint32_t NewestTime() const { return _newestTime; }
+
+    // Oldest first, including the records still buffered in RAM; returns
+    // the number of records visited
+    size_t Query(uint32_t from, uint32_t to, uint64_t seriesMask, Visitor visitor, void* context);
+    // Summaries of the pages overlapping [from, to], oldest first; enough
+    // for min/max overviews without decoding a single record
+    size_t QueryPages(uint32_t from, uint32_t to, PageVisitor visitor, void* context);
+
+    Stats GetStats() const;
+
+private:
+    static constexpr uint32_t PAGE_MAGIC = 0x54534C31;  // "TSL1"
+    static constexpr size_t HEADER_OFFSET = 0;
+    static constexpr size_t SUMMARY_OFFSET = 16;
+    static constexpr size_t DATA_OFFSET = 64;
+    static constexpr size_t CHUNK_HEADER = 4;
+    static constexpr uint16_t CHUNK_END = 0xFFFF;
+    static constexpr uint32_t NO_PAGE = 0xFFFFFFFF;
+
+    struct PageHeader {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t crc;
+        uint32_t reserved;
+    };
+
+    struct StoredSummary {
+        uint32_t minTime;
+        uint32_t maxTime;
+        int32_t minValue;
+        int32_t maxValue;
+        uint32_t maskLow;
+        uint32_t maskHigh;
+        uint32_t records;
+        uint32_t dataEnd;
+        uint32_t crc;
+    };
+
+    // Delta coder state, reset at the start of every chunk so each chunk
+    // decodes on its own
+    struct Coder {
+        uint32_t time;
+        int32_t value[LOG_MAX_SERIES];
+        void Reset();
+    };
+
+    // Record filter and visitor of a query, plus its progress
+    struct Walk {
+        uint32_t from;
+        uint32_t to;
+        uint64_t seriesMask;
+        Visitor visitor;
+        void* context;
+        size_t visited;
+        bool stop;
+    };
+
+    size_t pageOffset(uint32_t page) const { return static_cast<size_t>(page) * _sectorSize; }
+    bool readHeader(uint32_t page, uint32_t* sequence);
+    // Summary programmed at close; false if the page is still open (or
+    // the summary was torn), *erased tells which
+    bool loadSummary(uint32_t page, PageSummary* summary, size_t* dataEnd, bool* erased);
+    // Walks the chunks of a page up to end; returns the end of the valid
+    // data and reports whether it stopped at a torn chunk. summary and
+    // walk may be null.
+    size_t scanPage(uint32_t page, size_t end, PageSummary* summary, Walk* walk, bool* torn);
+    uint32_t findNewestTime();
+    bool closePage();
+    bool openNextPage();
+    bool writeChunk();
+
+    static size_t encode(const Coder& coder, const Record& record, uint8_t* out);
+    static void decodeChunk(const uint8_t* data, size_t length, PageSummary* summary, Walk* walk);
+    static void merge(PageSummary& into, const Record& record);
+    static void mergeSummary(PageSummary& into, const PageSummary& from);
+    static void clear(PageSummary& summary, uint32_t sequence);
+    static bool overlaps(const PageSummary& page, uint32_t from, uint32_t to, uint64_t seriesMask);
+
+    FlashDevice& _flash;
+    size_t _sectorSize;
+    uint32_t _pages;
+    bool _mounted;
+
+    // Head page and its write position; _open is false once its summary
+    // is programmed (or before the first page was opened)
+    uint32_t _head;
+    uint32_t _sequence;
+    bool _open;
+    size_t _writeOffset;
+    PageSummary _headSummary;
+
+    // RAM buffer: chunk header space, then the coded records
+    uint8_t _chunk[LOG_CHUNK_MAX];
+    size_t _chunkLength;
+    size_t _pendingRecords;
+    Coder _coder;
+    PageSummary _pendingSummary;
+    uint32_t _newestTime;
+
+    uint32_t _appended;
+    uint32_t _chunks;
+    uint32_t _bytesWritten;
+    uint32_t _erases;
+    uint32_t _tornChunks;
+    uint32_t _dropped;
+
+    // Disallow copy and assignment
+    TimeSeriesLog(const TimeSeriesLog&) = delete;
+    TimeSeriesLog& operator=(const TimeSeriesLog&) = delete;
+};
+
+} // namespace Storage
+
+#endif // TIME_SERIES_LOG_H
@@ -0,0 +1,114 @@
+#include "cborWriter.h"
+#include <cstring>
+
+CborWriter::CborWriter(uint8_t* out, size_t capacity)
+    : _out(out),
+      _capacity(out != nullptr ? capacity : 0),
+      _length(0),
+      _overflow(false)
+{
+}
+
+void CborWriter::put(const void* data, size_t length)
+{
+    if (_overflow || _capacity - _length < length) {
+        _overflow = true;
+        return;
+    }
+    if (length == 0) {
+        return;
+    }
+    memcpy(_out + _length, data, length);
+    _length += length;
+}
+
+void CborWriter::head(Major major, uint64_t argument)
+{
+    uint8_t bytes[9];
+    size_t size;
+    uint8_t type = static_cast<uint8_t>(major << 5);
+    if (argument < 24) {
+        bytes[0] = static_cast<uint8_t>(type | argument);
+        size = 1;
+    } else if (argument <= UINT8_MAX) {
+        bytes[0] = type | 24;
+        size = 2;
+    } else if (argument <= UINT16_MAX) {
+        bytes[0] = type | 25;
+        size = 3;
+    } else if (argument <= UINT32_MAX) {
+        bytes[0] = type | 26;
+        size = 5;
+    } else {
+        bytes[0] = type | 27;
+        size = 9;
+    }
+    // Big-endian argument behind the initial byte
+    for (size_t i = size - 1; i >= 1; --i) {
+        bytes[i] = static_cast<uint8_t>(argument);
+        argument >>= 8;
+    }
+    put(bytes, size);
+}
+
+CborWriter& CborWriter::BeginMap(size_t count)
+{
+    head(MAP, count);
+    return *this;
+}
+
+CborWriter& CborWriter::BeginArray(size_t count)
+{
+    head(ARRAY, count);
+    return *this;
+}
+
+CborWriter& CborWriter::Unsigned(uint64_t value)
+{
+    head(UNSIGNED, value);
+    return *this;
+}
+
+CborWriter& CborWriter::Integer(int64_t value)
+{
+    if (value < 0) {
+        // -1 - n, without overflowing at INT64_MIN
+        head(NEGATIVE, static_cast<uint64_t>(-(value + 1)));
+    } else {
+        head(UNSIGNED, static_cast<uint64_t>(value));
+    }
+    return *this;
+}
+
+CborWriter& CborWriter::Float(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t bytes[5] = { static_cast<uint8_t>((SIMPLE << 5) | 26), static_cast<uint8_t>(bits >> 24),
+                         static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 8),
+                         static_cast<uint8_t>(bits) };
+    put(bytes, sizeof(bytes));
+    return *this;
+}
+
+CborWriter& CborWriter::Text(const char* text)
+{
+    size_t length = text != nullptr ? strlen(text) : 0;
+    head(TEXT, length);
+    put(text, length);
+    return *this;
+}
+
+CborWriter& CborWriter::Bytes(const void* data, size_t length)
+{
+    head(BYTES, length);
+    put(data, length);
+    return *this;
+}
+
+CborWriter& CborWriter::Null()
+{
+    uint8_t byte = (SIMPLE << 5) | 22;
+    put(&byte, 1);
+    return *this;
+}
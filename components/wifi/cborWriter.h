@@ -0,0 +1,61 @@
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   Streaming CBOR (RFC 8949) serializer into a caller-provided
+ *          buffer.
+ *
+ * The binary counterpart of JsonWriter: writes straight into a span (a
+ * TxRing reservation), no heap, no formatting. Maps and arrays have
+ * definite lengths, so the caller states the number of entries up front;
+ * integers take the shortest head, floats go out as float32.
+ *
+ * When the buffer runs out the writer stops and Ok() turns false.
+ */
+class CborWriter {
+public:
+    CborWriter(uint8_t* out, size_t capacity);
+
+    // count pairs / items follow
+    CborWriter& BeginMap(size_t count);
+    CborWriter& BeginArray(size_t count);
+
+    CborWriter& Unsigned(uint64_t value);
+    CborWriter& Integer(int64_t value);
+    CborWriter& Float(float value);
+    CborWriter& Text(const char* text);
+    CborWriter& Bytes(const void* data, size_t length);
+    CborWriter& Null();
+
+    bool Ok() const { return !_overflow; }
+    size_t Length() const { return _length; }
+    const uint8_t* Data() const { return _out; }
+
+private:
+    enum Major : uint8_t {
+        UNSIGNED = 0,
+        NEGATIVE = 1,
+        BYTES = 2,
+        TEXT = 3,
+        ARRAY = 4,
+        MAP = 5,
+        SIMPLE = 7,
+    };
+
+    void head(Major major, uint64_t argument);
+    void put(const void* data, size_t length);
+
+    uint8_t* _out;
+    size_t _capacity;
+    size_t _length;
+    bool _overflow;
+
+    // Disallow copy and assignment
+    CborWriter(const CborWriter&) = delete;
+    CborWriter& operator=(const CborWriter&) = delete;
+};
+
+#endif // CBOR_WRITER_H
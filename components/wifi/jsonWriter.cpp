@@ -0,0 +1,208 @@
+#include "jsonWriter.h"
+#include <cmath>
+#include <cstring>
+
+JsonWriter::JsonWriter(char* out, size_t capacity)
+    : _out(out),
+      _capacity(out != nullptr ? capacity : 0),
+      _length(0),
+      _depth(0),
+      _hasMembers(0),
+      _afterKey(false),
+      _overflow(false)
+{
+}
+
+void JsonWriter::put(char c)
+{
+    if (_length < _capacity) {
+        _out[_length++] = c;
+    } else {
+        _overflow = true;
+    }
+}
+
+void JsonWriter::put(const char* text, size_t length)
+{
+    if (_capacity - _length < length) {
+        _overflow = true;
+        return;
+    }
+    memcpy(_out + _length, text, length);
+    _length += length;
+}
+
+void JsonWriter::separate()
+{
+    // A value right after its key needs nothing, any other value or key
+    // after a sibling needs a comma
+    if (_afterKey) {
+        _afterKey = false;
+        return;
+    }
+    if (_depth > 0) {
+        uint32_t bit = 1u << (_depth - 1);
+        if (_hasMembers & bit) {
+            put(',');
+        }
+        _hasMembers |= bit;
+    }
+}
+
+void JsonWriter::open(char bracket)
+{
+    separate();
+    if (_depth == MAX_DEPTH) {
+        _overflow = true;
+        return;
+    }
+    put(bracket);
+    _hasMembers &= ~(1u << _depth);
+    _depth++;
+}
+
+void JsonWriter::close(char bracket)
+{
+    if (_depth == 0) {
+        _overflow = true;
+        return;
+    }
+    _depth--;
+    _afterKey = false;
+    put(bracket);
+}
+
+JsonWriter& JsonWriter::BeginObject()
+{
+    open('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject()
+{
+    close('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray()
+{
+    open('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray()
+{
+    close(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(const char* key)
+{
+    separate();
+    putEscaped(key);
+    put(':');
+    _afterKey = true;
+    return *this;
+}
+
+void JsonWriter::putUnsigned(uint64_t value, size_t minDigits)
+{
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0 || count < minDigits);
+    put(digits + sizeof(digits) - count, count);
+}
+
+JsonWriter& JsonWriter::Number(double value, uint8_t decimals)
+{
+    static const double SCALE[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+    if (decimals > 6) {
+        decimals = 6;
+    }
+    double scaled = std::fabs(value) * SCALE[decimals];
+    if (!std::isfinite(value) || scaled >= 9.0e18) {
+        return Null();
+    }
+
+    uint64_t fixed = static_cast<uint64_t>(scaled + 0.5);
+    uint64_t unit = static_cast<uint64_t>(SCALE[decimals]);
+    uint64_t whole = fixed / unit;
+    uint64_t fraction = fixed % unit;
+    // Trailing zeros carry nothing: 21.500 goes out as 21.5
+    while (decimals > 0 && fraction % 10 == 0) {
+        fraction /= 10;
+        decimals--;
+    }
+
+    separate();
+    if (value < 0 && fixed > 0) {
+        put('-');
+    }
+    putUnsigned(whole, 1);
+    if (decimals > 0) {
+        put('.');
+        putUnsigned(fraction, decimals);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::Integer(int64_t value)
+{
+    separate();
+    if (value < 0) {
+        put('-');
+        putUnsigned(0 - static_cast<uint64_t>(value), 1);
+    } else {
+        putUnsigned(static_cast<uint64_t>(value), 1);
+    }
+    return *this;
+}
+
+void JsonWriter::putEscaped(const char* text)
+{
+    static const char HEX[] = "0123456789abcdef";
+    put('"');
+    for (const char* c = text != nullptr ? text : ""; *c != '\0'; ++c) {
+        unsigned char u = static_cast<unsigned char>(*c);
+        if (u == '"' || u == '\\') {
+            put('\\');
+            put(*c);
+        } else if (u == '\n') {
+            put("\\n", 2);
+        } else if (u < 0x20) {
+            char escape[6] = { '\\', 'u', '0', '0', HEX[u >> 4], HEX[u & 15] };
+            put(escape, sizeof(escape));
+        } else {
+            put(*c);
+        }
+    }
+    put('"');
+}
+
+JsonWriter& JsonWriter::String(const char* text)
+{
+    separate();
+    putEscaped(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value)
+{
+    separate();
+    if (value) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::Null()
+{
+    separate();
+    put("null", 4);
+    return *this;
+}
@@ -0,0 +1,65 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   Streaming JSON serializer into a caller-provided buffer.
+ *
+ * Writes keys and values straight into the span it is given (typically a
+ * TxRing reservation), commas and nesting included, without printf and
+ * without a heap allocation. Numbers are formatted in fixed point, which
+ * is all telemetry needs; NaN and infinities become null.
+ *
+ * When the buffer runs out the writer stops and Ok() turns false; the
+ * caller then discards the message instead of sending half an object.
+ */
+class JsonWriter {
+public:
+    static constexpr size_t MAX_DEPTH = 16;
+
+    JsonWriter(char* out, size_t capacity);
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+
+    // Next member of the enclosing object
+    JsonWriter& Key(const char* key);
+
+    JsonWriter& Number(double value, uint8_t decimals = 3);
+    JsonWriter& Integer(int64_t value);
+    JsonWriter& String(const char* text);
+    JsonWriter& Bool(bool value);
+    JsonWriter& Null();
+
+    // Everything fit and every object and array is closed
+    bool Ok() const { return !_overflow && _depth == 0; }
+    size_t Length() const { return _length; }
+    const char* Data() const { return _out; }
+
+private:
+    void separate();
+    void put(char c);
+    void put(const char* text, size_t length);
+    void putUnsigned(uint64_t value, size_t minDigits);
+    void putEscaped(const char* text);
+    void open(char bracket);
+    void close(char bracket);
+
+    char* _out;
+    size_t _capacity;
+    size_t _length;
+    size_t _depth;
+    uint32_t _hasMembers;   // one bit per open level
+    bool _afterKey;
+    bool _overflow;
+
+    // Disallow copy and assignment
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+};
+
+#endif // JSON_WRITER_H
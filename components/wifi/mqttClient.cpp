@@ -0,0 +1,342 @@
+#include "mqttClient.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static const char* TAG = "MQTT";
+
+MqttClient::MqttClient()
+    : _socket(-1),
+      _keepAliveS(0),
+      _connackSeen(false),
+      _connackCode(0),
+      _lastWriteUs(0),
+      _pingSentUs(0),
+      _inputLength(0)
+{
+}
+
+MqttClient::~MqttClient()
+{
+    Close();
+}
+
+size_t MqttClient::EncodeLength(uint8_t* out, size_t length)
+{
+    size_t used = 0;
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        out[used++] = length > 0 ? (digit | 0x80) : digit;
+    } while (length > 0);
+    return used;
+}
+
+static size_t putString(uint8_t* out, const char* text, size_t length)
+{
+    out[0] = static_cast<uint8_t>(length >> 8);
+    out[1] = static_cast<uint8_t>(length);
+    memcpy(out + 2, text, length);
+    return 2 + length;
+}
+
+bool MqttClient::openSocket(const Options& options)
+{
+    char port[8];
+    snprintf(port, sizeof(port), "%u", (unsigned)options.port);
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* address = nullptr;
+    if (getaddrinfo(options.host, port, &hints, &address) != 0 || address == nullptr) {
+        ESP_LOGW(TAG, "Cannot resolve %s", options.host);
+        return false;
+    }
+
+    int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(address);
+        return false;
+    }
+
+    // Non-blocking connect, so the timeout is ours and not the stack's
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int result = connect(fd, address->ai_addr, address->ai_addrlen);
+    freeaddrinfo(address);
+    if (result != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return false;
+    }
+    if (result != 0) {
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(fd, &writable);
+        timeval timeout = { static_cast<time_t>(options.timeoutMs / 1000),
+                            static_cast<suseconds_t>((options.timeoutMs % 1000) * 1000) };
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (select(fd + 1, nullptr, &writable, nullptr, &timeout) != 1 ||
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+            ESP_LOGW(TAG, "No connection to %s:%u", options.host, (unsigned)options.port);
+            close(fd);
+            return false;
+        }
+    }
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+
+    // Writes are batched already, Nagle would only add latency
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval sendTimeout = { static_cast<time_t>(options.timeoutMs / 1000),
+                            static_cast<suseconds_t>((options.timeoutMs % 1000) * 1000) };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+    _socket = fd;
+    _inputLength = 0;
+    return true;
+}
+
+bool MqttClient::sendConnect(const Options& options)
+{
+    size_t clientLength = strlen(options.clientId);
+    size_t userLength = options.username != nullptr ? strlen(options.username) : 0;
+    size_t passwordLength = options.password != nullptr ? strlen(options.password) : 0;
+    if (clientLength + userLength + passwordLength > 384) {
+        ESP_LOGE(TAG, "Client id or credentials too long");
+        return false;
+    }
+
+    uint8_t packet[512];
+    uint8_t flags = 0x02;   // clean session, replays are ours
+    size_t remaining = 10 + 2 + clientLength;
+    if (options.username != nullptr) {
+        flags |= 0x80;
+        remaining += 2 + userLength;
+    }
+    if (options.password != nullptr) {
+        flags |= 0x40;
+        remaining += 2 + passwordLength;
+    }
+
+    size_t used = 0;
+    packet[used++] = CONNECT << 4;
+    used += EncodeLength(packet + used, remaining);
+    used += putString(packet + used, "MQTT", 4);
+    packet[used++] = 4;     // protocol level 3.1.1
+    packet[used++] = flags;
+    packet[used++] = static_cast<uint8_t>(options.keepAliveS >> 8);
+    packet[used++] = static_cast<uint8_t>(options.keepAliveS);
+    used += putString(packet + used, options.clientId, clientLength);
+    if (options.username != nullptr) {
+        used += putString(packet + used, options.username, userLength);
+    }
+    if (options.password != nullptr) {
+        used += putString(packet + used, options.password, passwordLength);
+    }
+    return Write(packet, used);
+}
+
+bool MqttClient::Connect(const Options& options)
+{
+    Close();
+    if (options.host == nullptr || options.clientId == nullptr || !openSocket(options)) {
+        return false;
+    }
+
+    _keepAliveS = options.keepAliveS;
+    _connackSeen = false;
+    _pingSentUs = 0;
+    if (!sendConnect(options)) {
+        Close();
+        return false;
+    }
+
+    int64_t deadline = esp_timer_get_time() + static_cast<int64_t>(options.timeoutMs) * 1000;
+    while (!_connackSeen) {
+        int64_t left = deadline - esp_timer_get_time();
+        if (left <= 0 || !receive(static_cast<uint32_t>(left / 1000)) || !handleInput(nullptr, nullptr)) {
+            ESP_LOGW(TAG, "No CONNACK from %s:%u", options.host, (unsigned)options.port);
+            Close();
+            return false;
+        }
+    }
+    if (_connackCode != 0) {
+        ESP_LOGW(TAG, "Broker refused the connection (code %u)", (unsigned)_connackCode);
+        Close();
+        return false;
+    }
+    ESP_LOGI(TAG, "Connected to %s:%u as %s", options.host, (unsigned)options.port, options.clientId);
+    return true;
+}
+
+void MqttClient::Disconnect()
+{
+    if (_socket >= 0) {
+        const uint8_t packet[2] = { DISCONNECT << 4, 0 };
+        send(_socket, packet, sizeof(packet), MSG_NOSIGNAL);
+    }
+    Close();
+}
+
+void MqttClient::Close()
+{
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+    _inputLength = 0;
+}
+
+bool MqttClient::Write(const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (length > 0 && _socket >= 0) {
+        ssize_t sent = send(_socket, bytes, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            ESP_LOGW(TAG, "Write failed (errno %d)", errno);
+            Close();
+            return false;
+        }
+        bytes += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    _lastWriteUs = esp_timer_get_time();
+    return _socket >= 0;
+}
+
+bool MqttClient::Write(iovec* parts, size_t count)
+{
+    while (count > 0 && _socket >= 0) {
+        msghdr message = {};
+        message.msg_iov = parts;
+        message.msg_iovlen = count;
+        ssize_t sent = sendmsg(_socket, &message, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            ESP_LOGW(TAG, "Write failed (errno %d)", errno);
+            Close();
+            return false;
+        }
+        // Resume a partial write where the stack stopped
+        size_t done = static_cast<size_t>(sent);
+        while (count > 0 && done >= parts->iov_len) {
+            done -= parts->iov_len;
+            parts++;
+            count--;
+        }
+        if (count > 0) {
+            parts->iov_base = static_cast<uint8_t*>(parts->iov_base) + done;
+            parts->iov_len -= done;
+        }
+    }
+    _lastWriteUs = esp_timer_get_time();
+    return _socket >= 0;
+}
+
+bool MqttClient::receive(uint32_t timeoutMs)
+{
+    if (_socket < 0) {
+        return false;
+    }
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(_socket, &readable);
+    timeval timeout = { static_cast<time_t>(timeoutMs / 1000), static_cast<suseconds_t>((timeoutMs % 1000) * 1000) };
+    int ready = select(_socket + 1, &readable, nullptr, nullptr, &timeout);
+    if (ready < 0 && errno != EINTR) {
+        Close();
+        return false;
+    }
+    if (ready <= 0) {
+        return true;
+    }
+
+    ssize_t received = recv(_socket, _input + _inputLength, sizeof(_input) - _inputLength, 0);
+    if (received <= 0) {
+        ESP_LOGW(TAG, "Connection closed by the broker");
+        Close();
+        return false;
+    }
+    _inputLength += static_cast<size_t>(received);
+    return true;
+}
+
+bool MqttClient::handleInput(AckHandler onAck, void* context)
+{
+    size_t position = 0;
+    while (position + 2 <= _inputLength) {
+        // Everything we expect is short: one length byte
+        uint8_t type = _input[position] >> 4;
+        size_t length = _input[position + 1];
+        if (length & 0x80) {
+            ESP_LOGW(TAG, "Unexpected %u packet from the broker", (unsigned)type);
+            Close();
+            return false;
+        }
+        if (position + 2 + length > _inputLength) {
+            break;
+        }
+        const uint8_t* body = _input + position + 2;
+
+        if (type == CONNACK && length == 2) {
+            _connackSeen = true;
+            _connackCode = body[1];
+        } else if (type == PUBACK && length == 2) {
+            if (onAck != nullptr) {
+                onAck(static_cast<uint16_t>((body[0] << 8) | body[1]), context);
+            }
+        } else if (type == PINGRESP) {
+            _pingSentUs = 0;
+        }
+        position += 2 + length;
+    }
+
+    memmove(_input, _input + position, _inputLength - position);
+    _inputLength -= position;
+    return true;
+}
+
+bool MqttClient::Poll(uint32_t timeoutMs, AckHandler onAck, void* context)
+{
+    if (!receive(timeoutMs) || !handleInput(onAck, context)) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t keepAliveUs = static_cast<int64_t>(_keepAliveS) * 1000000;
+    if (keepAliveUs == 0) {
+        return true;
+    }
+    if (_pingSentUs != 0 && now - _pingSentUs > keepAliveUs) {
+        ESP_LOGW(TAG, "No PINGRESP, connection lost");
+        Close();
+        return false;
+    }
+    if (_pingSentUs == 0 && now - _lastWriteUs >= keepAliveUs / 2) {
+        const uint8_t packet[2] = { PINGREQ << 4, 0 };
+        if (!Write(packet, sizeof(packet))) {
+            return false;
+        }
+        _pingSentUs = now;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/uio.h>
+
+/**
+ * @brief   Minimal MQTT 3.1.1 publisher over a BSD socket.
+ *
+ * Only what telemetry needs: CONNECT, PUBLISH (QoS 0/1), PUBACK,
+ * PINGREQ/PINGRESP and DISCONNECT; no subscriptions, no TLS. The caller
+ * builds PUBLISH packets itself (TxRing keeps them ready to send) and
+ * hands the client whole runs of them as an iovec, so many small messages
+ * leave in one socket write without being copied.
+ *
+ * Blocking calls with timeouts, one task only. The same code runs on
+ * lwIP and on Linux (tests against a broker on loopback).
+ */
+class MqttClient {
+public:
+    enum PacketType : uint8_t {
+        CONNECT = 1,
+        CONNACK = 2,
+        PUBLISH = 3,
+        PUBACK = 4,
+        PINGREQ = 12,
+        PINGRESP = 13,
+        DISCONNECT = 14,
+    };
+
+    // DUP flag in the first byte of a PUBLISH packet
+    static constexpr uint8_t PUBLISH_DUP = 0x08;
+
+    struct Options {
+        const char* host = nullptr;
+        uint16_t port = 1883;
+        const char* clientId = "hydrotower";
+        const char* username = nullptr;
+        const char* password = nullptr;
+        uint16_t keepAliveS = 30;
+        uint32_t timeoutMs = 5000;     // TCP connect and CONNACK each
+    };
+
+    // Called for every PUBACK with its packet identifier
+    using AckHandler = void (*)(uint16_t packetId, void* context);
+
+    MqttClient();
+    ~MqttClient();
+
+    // TCP connect, CONNECT, wait for a successful CONNACK
+    bool Connect(const Options& options);
+    // Sends DISCONNECT (best effort) and closes the socket
+    void Disconnect();
+    // Closes the socket without a word, e.g. after an error
+    void Close();
+    bool IsConnected() const { return _socket >= 0; }
+
+    // Writes all bytes or closes the connection
+    bool Write(const void* data, size_t length);
+    // Same for a gather list (modified while partial writes are resumed)
+    bool Write(iovec* parts, size_t count);
+
+    // Waits up to timeoutMs for input and handles it; sends PINGREQ when
+    // the connection was idle for half the keep-alive. False once the
+    // connection is gone.
+    bool Poll(uint32_t timeoutMs, AckHandler onAck, void* context);
+
+    // Remaining length field (1 to 4 bytes); returns the bytes written
+    static size_t EncodeLength(uint8_t* out, size_t length);
+
+private:
+    bool openSocket(const Options& options);
+    bool sendConnect(const Options& options);
+    // Reads what is available into the input buffer; false on EOF or error
+    bool receive(uint32_t timeoutMs);
+    // Handles the complete packets in the input buffer
+    bool handleInput(AckHandler onAck, void* context);
+
+    int _socket;
+    uint16_t _keepAliveS;
+    bool _connackSeen;
+    uint8_t _connackCode;
+    int64_t _lastWriteUs;
+    int64_t _pingSentUs;
+
+    // PUBACK and friends are tiny, CONNACK is 4 bytes
+    uint8_t _input[64];
+    size_t _inputLength;
+
+    // Disallow copy and assignment
+    MqttClient(const MqttClient&) = delete;
+    MqttClient& operator=(const MqttClient&) = delete;
+};
+
+#endif // MQTT_CLIENT_H
@@ -0,0 +1,77 @@
+#include "reconnectPolicy.h"
+
+// wifi_err_reason_t values, kept here so the policy needs no ESP-IDF header
+static constexpr uint16_t REASON_NO_AP_FOUND = 201;
+static constexpr uint16_t REASON_NO_AP_FOUND_SECURITY = 210;    // IDF 5.x: ..._W_COMPATIBLE_SECURITY
+static constexpr uint16_t REASON_NO_AP_FOUND_AUTHMODE = 211;    // ..._IN_AUTHMODE_THRESHOLD
+static constexpr uint16_t REASON_NO_AP_FOUND_RSSI = 212;        // ..._IN_RSSI_THRESHOLD
+
+// Signed: WIFI_FAST_ATTEMPTS may be 0, and "unsigned < 0" is a warning
+static constexpr int32_t FAST_ATTEMPTS = WIFI_FAST_ATTEMPTS;
+
+ReconnectPolicy::ReconnectPolicy()
+    : _cached(false),
+      _failures(0),
+      _fastFailures(0),
+      _fullFailures(0),
+      _last(Scan::Full)
+{
+}
+
+bool ReconnectPolicy::IsApNotFound(uint16_t reason)
+{
+    return reason == REASON_NO_AP_FOUND || reason == REASON_NO_AP_FOUND_SECURITY ||
+           reason == REASON_NO_AP_FOUND_AUTHMODE || reason == REASON_NO_AP_FOUND_RSSI;
+}
+
+void ReconnectPolicy::Reset()
+{
+    _failures = 0;
+    _fastFailures = 0;
+    _fullFailures = 0;
+}
+
+ReconnectPolicy::Attempt ReconnectPolicy::Start()
+{
+    Reset();
+    _last = _cached && FAST_ATTEMPTS > 0 ? Scan::Fast : Scan::Full;
+    return Attempt{ _last, 0 };
+}
+
+bool ReconnectPolicy::Next(uint16_t reason, uint32_t random, Attempt& attempt)
+{
+    _failures++;
+    if (_failures >= WIFI_MAX_RETRIES) {
+        return false;
+    }
+
+    if (_last == Scan::Fast) {
+        _fastFailures++;
+        if (static_cast<int32_t>(_fastFailures) < FAST_ATTEMPTS && !IsApNotFound(reason)) {
+            // A lost handshake or a busy AP: the same target, right away
+            attempt = Attempt{ Scan::Fast, 0 };
+            return true;
+        }
+        // The first full scan goes at once, the fast phase was the delay
+        _last = Scan::Full;
+        attempt = Attempt{ Scan::Full, 0 };
+        return true;
+    }
+
+    uint32_t delay = WIFI_BACKOFF_MIN_MS;
+    for (uint32_t i = 0; i < _fullFailures && delay < WIFI_BACKOFF_MAX_MS; ++i) {
+        delay *= 2;
+    }
+    if (delay > WIFI_BACKOFF_MAX_MS) {
+        delay = WIFI_BACKOFF_MAX_MS;
+    }
+    _fullFailures++;
+    attempt = Attempt{ Scan::Full, delay / 2 + random % (delay / 2 + 1) };
+    return true;
+}
+
+uint32_t ReconnectPolicy::RecoveryDelay(uint32_t random)
+{
+    uint32_t spread = WIFI_FAILED_RETRY_MS / 5;
+    return WIFI_FAILED_RETRY_MS - spread / 2 + random % (spread + 1);
+}
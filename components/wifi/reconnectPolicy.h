@@ -0,0 +1,90 @@
+#ifndef RECONNECT_POLICY_H
+#define RECONNECT_POLICY_H
+
+#include <cstdint>
+
+// Targeted attempts on the cached BSSID/channel before a full scan
+#ifndef WIFI_FAST_ATTEMPTS
+#define WIFI_FAST_ATTEMPTS 2
+#endif
+
+// Full-scan backoff: first delay, doubled per failure up to the maximum
+#ifndef WIFI_BACKOFF_MIN_MS
+#define WIFI_BACKOFF_MIN_MS 500
+#endif
+
+#ifndef WIFI_BACKOFF_MAX_MS
+#define WIFI_BACKOFF_MAX_MS 30000
+#endif
+
+// Failed attempts in a row before the actor gives up (state FAILED)
+#ifndef WIFI_MAX_RETRIES
+#define WIFI_MAX_RETRIES 8
+#endif
+
+// Time in FAILED before the whole sequence starts over
+#ifndef WIFI_FAILED_RETRY_MS
+#define WIFI_FAILED_RETRY_MS 300000
+#endif
+
+/**
+ * @brief   When and how the WiFi station tries to (re)connect.
+ *
+ * Pure decision logic, no ESP-IDF calls, so the same code runs in the
+ * host harness (tools/wifiSim). A sequence starts at boot, after a link
+ * loss and after the FAILED timeout:
+ *
+ *   1. Up to WIFI_FAST_ATTEMPTS targeted attempts on the cached BSSID and
+ *      channel (no scan, a fraction of a second), if there is a cache.
+ *      An "AP not found" ends the fast phase at once: the AP moved or is
+ *      down, asking again on the same channel will not help.
+ *   2. Full scans with exponential backoff from WIFI_BACKOFF_MIN_MS to
+ *      WIFI_BACKOFF_MAX_MS. Half of each delay is random ("equal
+ *      jitter"), so a room full of devices does not hammer an AP that
+ *      just came back in lockstep.
+ *   3. After WIFI_MAX_RETRIES failures: give up until the recovery delay
+ *      (WIFI_FAILED_RETRY_MS, +-10 % jitter) has passed, then back to 1.
+ *
+ * The caller passes the random numbers, which keeps runs reproducible.
+ */
+class ReconnectPolicy {
+public:
+    enum class Scan : uint8_t {
+        Fast,   // cached BSSID and channel
+        Full,   // all channels, strongest AP of the SSID
+    };
+
+    struct Attempt {
+        Scan scan;
+        uint32_t delayMs;
+    };
+
+    ReconnectPolicy();
+
+    // Whether a cached BSSID/channel exists (changes the next sequence)
+    void SetCached(bool cached) { _cached = cached; }
+
+    // First attempt of a sequence, immediately
+    Attempt Start();
+    // The last attempt failed with the given disconnect reason; false if
+    // the sequence is exhausted (go to FAILED)
+    bool Next(uint16_t reason, uint32_t random, Attempt& attempt);
+    // Wait in FAILED before Start() again
+    static uint32_t RecoveryDelay(uint32_t random);
+    // Connected: the next sequence starts from scratch
+    void Reset();
+
+    uint32_t Failures() const { return _failures; }
+
+    // Disconnect reasons that mean "no such AP on that channel"
+    static bool IsApNotFound(uint16_t reason);
+
+private:
+    bool _cached;
+    uint32_t _failures;
+    uint32_t _fastFailures;
+    uint32_t _fullFailures;
+    Scan _last;
+};
+
+#endif // RECONNECT_POLICY_H
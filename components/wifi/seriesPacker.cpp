@@ -0,0 +1,113 @@
+#include "seriesPacker.h"
+#include <cstring>
+
+static unsigned leadingZeros(uint32_t value)
+{
+    return value == 0 ? 32 : static_cast<unsigned>(__builtin_clz(value));
+}
+
+static unsigned trailingZeros(uint32_t value)
+{
+    return value == 0 ? 32 : static_cast<unsigned>(__builtin_ctz(value));
+}
+
+SeriesPacker::SeriesPacker(uint8_t* buffer, size_t capacity)
+    : _buffer(buffer),
+      _capacityBits(buffer != nullptr ? capacity * 8 : 0)
+{
+    Reset();
+}
+
+void SeriesPacker::Reset()
+{
+    _bits = 0;
+    _count = 0;
+    _firstTime = 0;
+    _lastTime = 0;
+    _lastDelta = 0;
+    _lastValue = 0;
+    _leading = 0xFF;
+    _trailing = 0;
+}
+
+void SeriesPacker::putBits(uint32_t value, unsigned count)
+{
+    // MSB first; the buffer is zeroed ahead of the write position
+    while (count > 0) {
+        size_t byte = _bits / 8;
+        unsigned free = 8 - static_cast<unsigned>(_bits % 8);
+        unsigned take = count < free ? count : free;
+        uint32_t chunk = (value >> (count - take)) & ((1u << take) - 1);
+        if (free == 8) {
+            _buffer[byte] = 0;
+        }
+        _buffer[byte] |= static_cast<uint8_t>(chunk << (free - take));
+        _bits += take;
+        count -= take;
+    }
+}
+
+bool SeriesPacker::Add(uint64_t timeMs, float value)
+{
+    if (_capacityBits - _bits < MAX_SAMPLE_BITS) {
+        return false;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    if (_count == 0) {
+        _firstTime = timeMs;
+        _lastTime = timeMs;
+        _lastDelta = 0;
+        putBits(bits, 32);
+        _lastValue = bits;
+        _count = 1;
+        return true;
+    }
+
+    int64_t delta = static_cast<int64_t>(timeMs - _lastTime);
+    int64_t dod = delta - _lastDelta;
+    if (dod < INT32_MIN || dod > INT32_MAX) {
+        return false;
+    }
+    if (dod == 0) {
+        putBits(0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        putBits(0x2, 2);
+        putBits(static_cast<uint32_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        putBits(0x6, 3);
+        putBits(static_cast<uint32_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        putBits(0xE, 4);
+        putBits(static_cast<uint32_t>(dod + 2047), 12);
+    } else {
+        putBits(0xF, 4);
+        putBits(static_cast<uint32_t>(static_cast<int32_t>(dod)), 32);
+    }
+    _lastTime = timeMs;
+    _lastDelta = delta;
+
+    uint32_t xored = bits ^ _lastValue;
+    _lastValue = bits;
+    if (xored == 0) {
+        putBits(0, 1);
+    } else {
+        unsigned leading = leadingZeros(xored);
+        unsigned trailing = trailingZeros(xored);
+        if (_leading != 0xFF && leading >= _leading && trailing >= _trailing) {
+            putBits(0x2, 2);
+            putBits(xored >> _trailing, 32 - _leading - _trailing);
+        } else {
+            unsigned length = 32 - leading - trailing;
+            putBits(0x3, 2);
+            putBits(leading, 5);
+            putBits(length - 1, 5);
+            putBits(xored >> trailing, length);
+            _leading = static_cast<uint8_t>(leading);
+            _trailing = static_cast<uint8_t>(trailing);
+        }
+    }
+    _count++;
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef SERIES_PACKER_H
+#define SERIES_PACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   Gorilla-style compression of one (time, value) series into a
+ *          caller-provided bit buffer.
+ *
+ * Timestamps (milliseconds) are stored as delta-of-delta: a steady sample
+ * period costs one bit, a few milliseconds of jitter nine. Values are
+ * float32; each is XORed with its predecessor and only the meaningful bits
+ * of the XOR are kept, reusing the previous leading/trailing-zero window
+ * when it fits. A sensor that repeats its value costs one bit, a slowly
+ * drifting one about a dozen.
+ *
+ * The first timestamp and the sample count travel outside the bit stream
+ * (see telemetryFormat.h); the first value is stored raw. Bits are packed
+ * MSB first:
+ *
+ *   time   dod == 0              '0'
+ *          -63 .. 64             '10'   + 7 bits
+ *          -255 .. 256           '110'  + 9 bits
+ *          -2047 .. 2048         '1110' + 12 bits
+ *          otherwise             '1111' + 32 bits
+ *   value  xor == 0              '0'
+ *          inside last window    '10'   + meaningful bits
+ *          new window            '11'   + 5 bits leading zeros
+ *                                       + 5 bits length - 1 + meaningful bits
+ *
+ * Add() never writes half a sample: it refuses the sample when the buffer
+ * could not hold the worst case, and the caller publishes and Reset()s.
+ */
+class SeriesPacker {
+public:
+    // Worst case of one sample in bits (time + value)
+    static constexpr size_t MAX_SAMPLE_BITS = 4 + 32 + 2 + 5 + 5 + 32;
+
+    SeriesPacker(uint8_t* buffer, size_t capacity);
+
+    // False if the sample does not fit (or its time step exceeds 32 bits)
+    bool Add(uint64_t timeMs, float value);
+    void Reset();
+
+    size_t Count() const { return _count; }
+    uint64_t FirstTime() const { return _firstTime; }
+    const uint8_t* Data() const { return _buffer; }
+    size_t Bytes() const { return (_bits + 7) / 8; }
+
+private:
+    void putBits(uint32_t value, unsigned count);
+
+    uint8_t* _buffer;
+    size_t _capacityBits;
+    size_t _bits;
+    size_t _count;
+
+    uint64_t _firstTime;
+    uint64_t _lastTime;
+    int64_t _lastDelta;
+    uint32_t _lastValue;
+    uint8_t _leading;       // window of the last stored XOR
+    uint8_t _trailing;
+
+    // Disallow copy and assignment
+    SeriesPacker(const SeriesPacker&) = delete;
+    SeriesPacker& operator=(const SeriesPacker&) = delete;
+};
+
+#endif // SERIES_PACKER_H
@@ -0,0 +1,136 @@
+#include "seriesPublisher.h"
+#include <sys/time.h>
+#include "eventBus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "telemetryFormat.h"
+
+static const char* TAG = "Series";
+
+SeriesPublisher::SeriesPublisher(WiFiComm& comm, const char* topic, uint8_t qos)
+    : ActiveObject("Series", Executor::Shared(), 32),
+      _comm(comm),
+      _topic(topic),
+      _qos(qos),
+      _stats{},
+      _tick(new SeriesPublishEvent()),
+      _running(false)
+{
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<MeasurementEvent>([this](const MeasurementEvent& e) { onMeasurement(e); });
+    on<SeriesPublishEvent>([this](const SeriesPublishEvent&) { onPublish(); });
+    coalesce<SeriesPublishEvent>(Mailbox::Coalesce::ReplaceLatest);
+}
+
+void SeriesPublisher::start()
+{
+    if (_running) {
+        return;
+    }
+    _running = true;
+    EventBus::get().subscribe<MeasurementEvent>([this](const MeasurementEvent& e) { TryPost(e.Retain()); });
+    _timer.Start(SERIES_PUBLISH_MS, _tick->Retain());
+}
+
+SeriesPublisher::Slot* SeriesPublisher::slotFor(uint8_t quantity, uint8_t channel)
+{
+    Slot* free = nullptr;
+    for (Slot& slot : _slots) {
+        if (slot.packer.Count() == 0) {
+            if (free == nullptr) {
+                free = &slot;
+            }
+        } else if (slot.quantity == quantity && slot.channel == channel) {
+            return &slot;
+        }
+    }
+    if (free != nullptr) {
+        free->quantity = quantity;
+        free->channel = channel;
+    }
+    return free;
+}
+
+void SeriesPublisher::onMeasurement(const MeasurementEvent& e)
+{
+    if (e.getQuantity() == MeasurementEvent::Quantity::Unknown) {
+        return;
+    }
+    // The sample time is a 32-bit esp_timer stamp; its age is exact for
+    // the first 71 minutes, plenty for a queued event
+    int64_t now = esp_timer_get_time();
+    uint32_t ageUs = static_cast<uint32_t>(now) - e.getSampleUs();
+    uint64_t timeMs = static_cast<uint64_t>((now - ageUs) / 1000);
+
+    Slot* slot = slotFor(static_cast<uint8_t>(e.getQuantity()), e.getChannel());
+    if (slot == nullptr) {
+        _stats.dropped++;
+        return;
+    }
+    if (!slot->packer.Add(timeMs, e.getValue())) {
+        // Buffer full: the batch goes now, the sample starts the next one
+        publish();
+        slot = slotFor(static_cast<uint8_t>(e.getQuantity()), e.getChannel());
+        if (slot == nullptr || !slot->packer.Add(timeMs, e.getValue())) {
+            _stats.dropped++;
+            return;
+        }
+    }
+    _stats.samples++;
+}
+
+void SeriesPublisher::onPublish()
+{
+    _timer.Start(SERIES_PUBLISH_MS, _tick->Retain());
+    publish();
+}
+
+void SeriesPublisher::publish()
+{
+    TelemetryFormat::SeriesView series[SERIES_MAX];
+    size_t count = 0;
+    size_t samples = 0;
+    for (const Slot& slot : _slots) {
+        if (slot.packer.Count() > 0) {
+            series[count++] = TelemetryFormat::SeriesView{ slot.quantity, slot.channel, &slot.packer };
+            samples += slot.packer.Count();
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // Wall clock only once SNTP (or anyone) has set it
+    timeval wall;
+    gettimeofday(&wall, nullptr);
+    uint64_t unixMs = wall.tv_sec > 1600000000
+                          ? static_cast<uint64_t>(wall.tv_sec) * 1000 + static_cast<uint64_t>(wall.tv_usec / 1000)
+                          : 0;
+    uint64_t uptimeMs = static_cast<uint64_t>(esp_timer_get_time() / 1000);
+
+    size_t length = 0;
+    {
+        // The ring is locked while the message lives, keep this short
+        WiFiComm::Message message = _comm.Begin(_topic, TelemetryFormat::MessageBound(series, count), _qos);
+        if (message) {
+            CborWriter cbor(message.Data(), message.Capacity());
+            if (TelemetryFormat::WriteMessage(cbor, uptimeMs, unixMs, series, count) &&
+                message.Commit(cbor.Length())) {
+                length = cbor.Length();
+            }
+        }
+    }
+
+    // Sent or not, the batch is done with: the ring is the offline buffer
+    for (Slot& slot : _slots) {
+        slot.packer.Reset();
+    }
+    if (length == 0) {
+        _stats.dropped += static_cast<uint32_t>(samples);
+        ESP_LOGW(TAG, "Batch of %u samples dropped", (unsigned)samples);
+        return;
+    }
+    _stats.messages++;
+    _stats.bytes += static_cast<uint32_t>(length);
+    ESP_LOGD(TAG, "%u samples in %u bytes", (unsigned)samples, (unsigned)length);
+}
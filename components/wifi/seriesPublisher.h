@@ -0,0 +1,86 @@
+#ifndef SERIES_PUBLISHER_H
+#define SERIES_PUBLISHER_H
+
+#include <cstdint>
+
+#include "activeObject.h"
+#include "events.h"
+#include "seriesPacker.h"
+#include "wifiComm.h"
+
+// Longest time a sample waits before its batch is published
+#ifndef SERIES_PUBLISH_MS
+#define SERIES_PUBLISH_MS 60000
+#endif
+
+// Series batched at the same time (quantity and channel)
+#ifndef SERIES_MAX
+#define SERIES_MAX 8
+#endif
+
+// Packed bits per series; a full buffer publishes the batch early
+#ifndef SERIES_BUFFER_BYTES
+#define SERIES_BUFFER_BYTES 192
+#endif
+
+/**
+ * @brief   Publishes every measurement, batched and compressed, as CBOR.
+ *
+ * Collects all MeasurementEvents per quantity and channel in a
+ * SeriesPacker (delta-of-delta timestamps, XOR-compressed floats) and
+ * every SERIES_PUBLISH_MS, or as soon as one series buffer is full, sends
+ * the whole batch as one binary message (layout in telemetryFormat.h)
+ * written in place into the WiFiComm TX ring. A steady sensor costs a few
+ * bits per sample instead of a JSON object; the host decoder in
+ * tools/telemetry turns the messages back into samples.
+ *
+ * The JSON snapshot (TelemetryPublisher) stays for Home Assistant.
+ */
+class SeriesPublisher : public ActiveObject {
+public:
+    explicit SeriesPublisher(WiFiComm& comm, const char* topic = "hydrotower/samples", uint8_t qos = 1);
+
+    struct Stats {
+        uint32_t samples;
+        uint32_t messages;
+        uint32_t bytes;
+        uint32_t dropped;       // no free series slot or no room in the ring
+    };
+    // From the actor's own context, or as a rough snapshot
+    Stats GetStats() const { return _stats; }
+
+private:
+    struct Slot {
+        Slot() : quantity(0), channel(0), buffer{}, packer(buffer, sizeof(buffer)) {}
+
+        uint8_t quantity;
+        uint8_t channel;
+        uint8_t buffer[SERIES_BUFFER_BYTES];
+        SeriesPacker packer;
+    };
+
+    void start();
+    void onMeasurement(const MeasurementEvent& e);
+    void onPublish();
+    void publish();
+    Slot* slotFor(uint8_t quantity, uint8_t channel);
+
+    WiFiComm& _comm;
+    const char* _topic;
+    uint8_t _qos;
+    Slot _slots[SERIES_MAX];
+    Stats _stats;
+    const Event* _tick;
+    bool _running;
+
+    // Disallow copy and assignment
+    SeriesPublisher(const SeriesPublisher&) = delete;
+    SeriesPublisher& operator=(const SeriesPublisher&) = delete;
+};
+
+class SeriesPublishEvent : public TypedEvent<SeriesPublishEvent, Event::Type::TimerTick> {
+public:
+    SeriesPublishEvent() : TypedEvent("SeriesPublish") {}
+};
+
+#endif // SERIES_PUBLISHER_H
@@ -0,0 +1,105 @@
+#include "telemetry.h"
+#include "eventBus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "Telemetry";
+
+static const char* quantityName(MeasurementEvent::Quantity quantity)
+{
+    switch (quantity) {
+        case MeasurementEvent::Quantity::WaterLevel:  return "level";
+        case MeasurementEvent::Quantity::Flow:        return "flow";
+        case MeasurementEvent::Quantity::Volume:      return "volume";
+        case MeasurementEvent::Quantity::Temperature: return "temperature";
+        default:                                      return nullptr;
+    }
+}
+
+TelemetryPublisher::TelemetryPublisher(WiFiComm& comm, const char* topic, uint8_t qos)
+    : ActiveObject("Telemetry", Executor::Shared(), 32),
+      _comm(comm),
+      _topic(topic),
+      _qos(qos),
+      _latest{},
+      _tick(new TelemetryPublishEvent()),
+      _running(false)
+{
+    on<OnStart>([this](const OnStart&) { start(); });
+    on<MeasurementEvent>([this](const MeasurementEvent& e) { onMeasurement(e); });
+    on<TelemetryPublishEvent>([this](const TelemetryPublishEvent&) { onPublish(); });
+    coalesce<TelemetryPublishEvent>(Mailbox::Coalesce::ReplaceLatest);
+}
+
+void TelemetryPublisher::start()
+{
+    if (_running) {
+        return;
+    }
+    _running = true;
+    EventBus::get().subscribe<MeasurementEvent>([this](const MeasurementEvent& e) { TryPost(e.Retain()); });
+    _timer.Start(TELEMETRY_PERIOD_MS, _tick->Retain());
+}
+
+void TelemetryPublisher::onMeasurement(const MeasurementEvent& e)
+{
+    size_t quantity = static_cast<size_t>(e.getQuantity());
+    if (quantity == 0 || quantity >= QUANTITIES || e.getChannel() >= TELEMETRY_MAX_CHANNELS) {
+        return;
+    }
+    Latest& latest = _latest[quantity][e.getChannel()];
+    latest.value = e.getValue();
+    latest.updatedUs = esp_timer_get_time();
+}
+
+void TelemetryPublisher::snapshot(JsonWriter& json, int64_t now) const
+{
+    int64_t staleUs = static_cast<int64_t>(TELEMETRY_PERIOD_MS) * 3000;
+
+    json.BeginObject();
+    json.Key("uptime").Integer(now / 1000000);
+    for (size_t quantity = 1; quantity < QUANTITIES; ++quantity) {
+        // Up to the highest channel that has ever reported
+        size_t channels = 0;
+        for (size_t channel = 0; channel < TELEMETRY_MAX_CHANNELS; ++channel) {
+            if (_latest[quantity][channel].updatedUs != 0) {
+                channels = channel + 1;
+            }
+        }
+        const char* name = quantityName(static_cast<MeasurementEvent::Quantity>(quantity));
+        if (channels == 0 || name == nullptr) {
+            continue;
+        }
+        json.Key(name).BeginArray();
+        for (size_t channel = 0; channel < channels; ++channel) {
+            const Latest& latest = _latest[quantity][channel];
+            if (latest.updatedUs == 0 || now - latest.updatedUs > staleUs) {
+                json.Null();
+            } else {
+                json.Number(latest.value, 2);
+            }
+        }
+        json.EndArray();
+    }
+    json.EndObject();
+}
+
+void TelemetryPublisher::onPublish()
+{
+    _timer.Start(TELEMETRY_PERIOD_MS, _tick->Retain());
+
+    bool fits;
+    {
+        // The ring is locked while the message lives, keep this short
+        WiFiComm::Message message = _comm.Begin(_topic, TELEMETRY_MAX_PAYLOAD, _qos);
+        if (!message) {
+            return;
+        }
+        JsonWriter json(message.Text(), message.Capacity());
+        snapshot(json, esp_timer_get_time());
+        fits = json.Ok() && message.Commit(json.Length());
+    }
+    if (!fits) {
+        ESP_LOGW(TAG, "Snapshot exceeds %u bytes, dropped", (unsigned)TELEMETRY_MAX_PAYLOAD);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstdint>
+
+#include "activeObject.h"
+#include "events.h"
+#include "jsonWriter.h"
+#include "wifiComm.h"
+
+// One snapshot of all sensors this often
+#ifndef TELEMETRY_PERIOD_MS
+#define TELEMETRY_PERIOD_MS 10000
+#endif
+
+// Channels per quantity in a snapshot (e.g. temperature probes)
+#ifndef TELEMETRY_MAX_CHANNELS
+#define TELEMETRY_MAX_CHANNELS 8
+#endif
+
+// Room reserved in the TX ring for one snapshot
+#ifndef TELEMETRY_MAX_PAYLOAD
+#define TELEMETRY_MAX_PAYLOAD 512
+#endif
+
+/**
+ * @brief   Publishes the latest value of every sensor as one JSON message.
+ *
+ * Keeps the newest MeasurementEvent value per quantity and channel and
+ * every TELEMETRY_PERIOD_MS serializes the snapshot with a JsonWriter
+ * straight into the WiFiComm TX ring:
+ *
+ *   {"uptime":1234,"level":[55.2],"flow":[1.25],"volume":[12.5],
+ *    "temperature":[21.5,null,22.06]}
+ *
+ * Values not refreshed for three periods go out as null. Publishing
+ * allocates nothing: the tick event is reused and the payload is written
+ * where the network task sends it from.
+ */
+class TelemetryPublisher : public ActiveObject {
+public:
+    explicit TelemetryPublisher(WiFiComm& comm, const char* topic = "hydrotower/telemetry", uint8_t qos = 1);
+
+private:
+    static constexpr size_t QUANTITIES = static_cast<size_t>(MeasurementEvent::Quantity::Temperature) + 1;
+
+    struct Latest {
+        float value;
+        int64_t updatedUs;      // 0: never
+    };
+
+    void start();
+    void onMeasurement(const MeasurementEvent& e);
+    void onPublish();
+    void snapshot(JsonWriter& json, int64_t now) const;
+
+    WiFiComm& _comm;
+    const char* _topic;
+    uint8_t _qos;
+    Latest _latest[QUANTITIES][TELEMETRY_MAX_CHANNELS];
+    const Event* _tick;
+    bool _running;
+
+    // Disallow copy and assignment
+    TelemetryPublisher(const TelemetryPublisher&) = delete;
+    TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+};
+
+class TelemetryPublishEvent : public TypedEvent<TelemetryPublishEvent, Event::Type::TimerTick> {
+public:
+    TelemetryPublishEvent() : TypedEvent("Telemetry") {}
+};
+
+#endif // TELEMETRY_H
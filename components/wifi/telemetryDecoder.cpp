@@ -0,0 +1,335 @@
+#include "telemetryDecoder.h"
+#include <cstring>
+#include "telemetryFormat.h"
+
+namespace Telemetry
+{
+
+namespace
+{
+
+// Just enough CBOR for the telemetry messages: definite lengths only
+class CborReader {
+public:
+    CborReader(const uint8_t* data, size_t length) : _position(data), _end(data + length) {}
+
+    bool AtEnd() const { return _position == _end; }
+
+    bool Head(uint8_t& major, uint64_t& argument)
+    {
+        if (_position == _end) {
+            return false;
+        }
+        uint8_t initial = *_position++;
+        major = initial >> 5;
+        uint8_t info = initial & 0x1F;
+        if (info < 24) {
+            argument = info;
+            return true;
+        }
+        if (info > 27) {
+            return false;   // indefinite lengths and reserved values
+        }
+        size_t size = static_cast<size_t>(1) << (info - 24);
+        if (static_cast<size_t>(_end - _position) < size) {
+            return false;
+        }
+        argument = 0;
+        for (size_t i = 0; i < size; ++i) {
+            argument = (argument << 8) | *_position++;
+        }
+        return true;
+    }
+
+    bool Unsigned(uint64_t& value)
+    {
+        uint8_t major;
+        return Head(major, value) && major == 0;
+    }
+
+    bool Bytes(const uint8_t*& data, size_t& length)
+    {
+        uint8_t major;
+        uint64_t argument;
+        if (!Head(major, argument) || major != 2 || argument > static_cast<uint64_t>(_end - _position)) {
+            return false;
+        }
+        data = _position;
+        length = static_cast<size_t>(argument);
+        _position += length;
+        return true;
+    }
+
+    bool Container(uint8_t expected, uint64_t& count)
+    {
+        uint8_t major;
+        return Head(major, count) && major == expected;
+    }
+
+    // Skips one complete item of any type
+    bool Skip(unsigned depth = 0)
+    {
+        uint8_t major;
+        uint64_t argument;
+        if (depth > 16 || !Head(major, argument)) {
+            return false;
+        }
+        switch (major) {
+            case 2:
+            case 3:
+                if (argument > static_cast<uint64_t>(_end - _position)) {
+                    return false;
+                }
+                _position += argument;
+                return true;
+            case 4:
+            case 5: {
+                uint64_t items = major == 5 ? argument * 2 : argument;
+                for (uint64_t i = 0; i < items; ++i) {
+                    if (!Skip(depth + 1)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            case 6:
+                return Skip(depth + 1);     // tag: skip the tagged item
+            default:
+                return true;                // integers, floats, simple values
+        }
+    }
+
+private:
+    const uint8_t* _position;
+    const uint8_t* _end;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t length) : _data(data), _bits(length * 8), _position(0) {}
+
+    bool Read(unsigned count, uint32_t& value)
+    {
+        if (_bits - _position < count) {
+            return false;
+        }
+        value = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            uint8_t bit = (_data[_position / 8] >> (7 - _position % 8)) & 1;
+            value = (value << 1) | bit;
+            _position++;
+        }
+        return true;
+    }
+
+    // Number of leading 1 bits, at most limit (the terminating 0 consumed)
+    bool Ones(unsigned limit, unsigned& count)
+    {
+        count = 0;
+        uint32_t bit;
+        while (count < limit) {
+            if (!Read(1, bit)) {
+                return false;
+            }
+            if (bit == 0) {
+                return true;
+            }
+            count++;
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* _data;
+    size_t _bits;
+    size_t _position;
+};
+
+bool fail(std::string* error, const char* reason)
+{
+    if (error != nullptr) {
+        *error = reason;
+    }
+    return false;
+}
+
+} // namespace
+
+bool UnpackSeries(const uint8_t* bits, size_t length, size_t count, uint64_t firstMs, std::vector<Sample>& out)
+{
+    BitReader reader(bits, length);
+    uint64_t time = firstMs;
+    int64_t delta = 0;
+    uint32_t value = 0;
+    unsigned leading = 0;
+    unsigned trailing = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 0) {
+            if (!reader.Read(32, value)) {
+                return false;
+            }
+        } else {
+            // Timestamp: '0', '10', '110', '1110', '1111' buckets
+            static const unsigned WIDTH[] = { 0, 7, 9, 12, 32 };
+            static const int32_t BIAS[] = { 0, 63, 255, 2047, 0 };
+            unsigned bucket;
+            uint32_t raw = 0;
+            if (!reader.Ones(4, bucket) || (bucket > 0 && !reader.Read(WIDTH[bucket], raw))) {
+                return false;
+            }
+            int64_t dod = bucket == 4 ? static_cast<int32_t>(raw) : static_cast<int64_t>(raw) - BIAS[bucket];
+            delta += dod;
+            time += static_cast<uint64_t>(delta);
+
+            // Value: '0' same, '10' last window, '11' new window
+            unsigned control;
+            if (!reader.Ones(2, control)) {
+                return false;
+            }
+            if (control > 0) {
+                if (control == 2) {
+                    uint32_t newLeading;
+                    uint32_t newLength;
+                    if (!reader.Read(5, newLeading) || !reader.Read(5, newLength)) {
+                        return false;
+                    }
+                    if (newLeading + newLength + 1 > 32) {
+                        return false;
+                    }
+                    leading = newLeading;
+                    trailing = 32 - leading - (newLength + 1);
+                }
+                uint32_t meaningful;
+                if (!reader.Read(32 - leading - trailing, meaningful)) {
+                    return false;
+                }
+                value ^= meaningful << trailing;
+            }
+        }
+        Sample sample;
+        sample.uptimeMs = time;
+        sample.unixMs = -1;
+        memcpy(&sample.value, &value, sizeof(value));
+        out.push_back(sample);
+    }
+    return true;
+}
+
+bool DecodeMessage(const uint8_t* data, size_t length, Message& message, std::string* error)
+{
+    using namespace TelemetryFormat;
+    CborReader reader(data, length);
+    message = Message();
+
+    uint64_t pairs;
+    if (!reader.Container(5, pairs)) {
+        return fail(error, "message is not a map");
+    }
+    bool seenVersion = false;
+    for (uint64_t pair = 0; pair < pairs; ++pair) {
+        uint64_t key;
+        if (!reader.Unsigned(key)) {
+            return fail(error, "message key is not an unsigned integer");
+        }
+        uint64_t value;
+        if (key == MESSAGE_VERSION) {
+            if (!reader.Unsigned(value)) {
+                return fail(error, "bad version");
+            }
+            message.version = static_cast<unsigned>(value);
+            seenVersion = true;
+            if (message.version != VERSION) {
+                return fail(error, "unsupported version");
+            }
+        } else if (key == MESSAGE_UPTIME_MS) {
+            if (!reader.Unsigned(message.uptimeMs)) {
+                return fail(error, "bad uptime");
+            }
+        } else if (key == MESSAGE_UNIX_MS) {
+            if (!reader.Unsigned(message.unixMs)) {
+                return fail(error, "bad unix time");
+            }
+            message.hasUnixTime = true;
+        } else if (key == MESSAGE_SERIES) {
+            uint64_t count;
+            if (!reader.Container(4, count)) {
+                return fail(error, "series is not an array");
+            }
+            for (uint64_t s = 0; s < count; ++s) {
+                uint64_t fields;
+                if (!reader.Container(5, fields)) {
+                    return fail(error, "series entry is not a map");
+                }
+                Series series{ 0, 0, {} };
+                uint64_t samples = 0;
+                uint64_t firstMs = 0;
+                const uint8_t* packed = nullptr;
+                size_t packedLength = 0;
+                for (uint64_t f = 0; f < fields; ++f) {
+                    uint64_t field;
+                    if (!reader.Unsigned(field)) {
+                        return fail(error, "series key is not an unsigned integer");
+                    }
+                    bool ok = true;
+                    if (field == SERIES_QUANTITY) {
+                        ok = reader.Unsigned(value) && value <= UINT8_MAX;
+                        series.quantity = static_cast<uint8_t>(value);
+                    } else if (field == SERIES_CHANNEL) {
+                        ok = reader.Unsigned(value) && value <= UINT8_MAX;
+                        series.channel = static_cast<uint8_t>(value);
+                    } else if (field == SERIES_COUNT) {
+                        ok = reader.Unsigned(samples);
+                    } else if (field == SERIES_FIRST_MS) {
+                        ok = reader.Unsigned(firstMs);
+                    } else if (field == SERIES_PACKED) {
+                        ok = reader.Bytes(packed, packedLength);
+                    } else {
+                        ok = reader.Skip();
+                    }
+                    if (!ok) {
+                        return fail(error, "bad series field");
+                    }
+                }
+                // Every sample takes at least two bits
+                if (samples > 0 && (packed == nullptr || samples > packedLength * 4 + 1)) {
+                    return fail(error, "series without samples");
+                }
+                if (samples > 0 && !UnpackSeries(packed, packedLength, static_cast<size_t>(samples), firstMs,
+                                                  series.samples)) {
+                    return fail(error, "truncated series");
+                }
+                message.series.push_back(std::move(series));
+            }
+        } else if (!reader.Skip()) {
+            return fail(error, "bad message field");
+        }
+    }
+    if (!seenVersion) {
+        return fail(error, "no version");
+    }
+
+    // Sample times on the wall clock, where the device knew it
+    if (message.hasUnixTime) {
+        int64_t offset = static_cast<int64_t>(message.unixMs) - static_cast<int64_t>(message.uptimeMs);
+        for (Series& series : message.series) {
+            for (Sample& sample : series.samples) {
+                sample.unixMs = static_cast<int64_t>(sample.uptimeMs) + offset;
+            }
+        }
+    }
+    return true;
+}
+
+const char* QuantityName(uint8_t quantity)
+{
+    switch (quantity) {
+        case 1: return "level";
+        case 2: return "flow";
+        case 3: return "volume";
+        case 4: return "temperature";
+        default: return "unknown";
+    }
+}
+
+} // namespace Telemetry
@@ -0,0 +1,52 @@
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Host-side decoder of the binary telemetry (SeriesPublisher).
+ *
+ * Reads the CBOR message described in telemetryFormat.h and unpacks the
+ * SeriesPacker bit streams back into (time, value) samples, bit-exact.
+ * Unknown keys are skipped, so newer firmware with extra fields still
+ * decodes. Plain C++17, no dependencies: link it into a bridge, a logger
+ * or a test.
+ */
+namespace Telemetry
+{
+
+struct Sample {
+    uint64_t uptimeMs;
+    int64_t unixMs;         // -1 if the device clock was not set
+    float value;
+};
+
+struct Series {
+    uint8_t quantity;       // MeasurementEvent::Quantity
+    uint8_t channel;
+    std::vector<Sample> samples;
+};
+
+struct Message {
+    unsigned version = 0;
+    uint64_t uptimeMs = 0;
+    bool hasUnixTime = false;
+    uint64_t unixMs = 0;
+    std::vector<Series> series;
+};
+
+// False (and a reason in error, if given) on malformed input
+bool DecodeMessage(const uint8_t* data, size_t length, Message& message, std::string* error = nullptr);
+
+// One SeriesPacker stream of count samples starting at firstMs
+bool UnpackSeries(const uint8_t* bits, size_t length, size_t count, uint64_t firstMs, std::vector<Sample>& out);
+
+// "level", "flow", "volume", "temperature" or "unknown"
+const char* QuantityName(uint8_t quantity);
+
+} // namespace Telemetry
+
+#endif // TELEMETRY_DECODER_H
@@ -0,0 +1,40 @@
+#include "telemetryFormat.h"
+
+namespace TelemetryFormat
+{
+
+// Map and array heads, keys and integers of one series besides its bits
+static constexpr size_t SERIES_OVERHEAD = 32;
+static constexpr size_t MESSAGE_OVERHEAD = 32;
+
+size_t MessageBound(const SeriesView* series, size_t count)
+{
+    size_t bound = MESSAGE_OVERHEAD;
+    for (size_t i = 0; i < count; ++i) {
+        bound += SERIES_OVERHEAD + series[i].packer->Bytes();
+    }
+    return bound;
+}
+
+bool WriteMessage(CborWriter& cbor, uint64_t uptimeMs, uint64_t unixMs, const SeriesView* series, size_t count)
+{
+    cbor.BeginMap(unixMs != 0 ? 4 : 3);
+    cbor.Unsigned(MESSAGE_VERSION).Unsigned(VERSION);
+    cbor.Unsigned(MESSAGE_UPTIME_MS).Unsigned(uptimeMs);
+    if (unixMs != 0) {
+        cbor.Unsigned(MESSAGE_UNIX_MS).Unsigned(unixMs);
+    }
+    cbor.Unsigned(MESSAGE_SERIES).BeginArray(count);
+    for (size_t i = 0; i < count; ++i) {
+        const SeriesPacker& packer = *series[i].packer;
+        cbor.BeginMap(5);
+        cbor.Unsigned(SERIES_QUANTITY).Unsigned(series[i].quantity);
+        cbor.Unsigned(SERIES_CHANNEL).Unsigned(series[i].channel);
+        cbor.Unsigned(SERIES_COUNT).Unsigned(packer.Count());
+        cbor.Unsigned(SERIES_FIRST_MS).Unsigned(packer.FirstTime());
+        cbor.Unsigned(SERIES_PACKED).Bytes(packer.Data(), packer.Bytes());
+    }
+    return cbor.Ok();
+}
+
+} // namespace TelemetryFormat
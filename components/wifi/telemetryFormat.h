@@ -0,0 +1,68 @@
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cborWriter.h"
+#include "seriesPacker.h"
+
+/**
+ * Binary telemetry message (SeriesPublisher), one CBOR map with small
+ * unsigned integer keys:
+ *
+ *   {
+ *     0: 1,                  format version
+ *     1: uptime ms,          when the message was built
+ *     2: unix time ms,       same moment; only once the clock is set
+ *     3: [ series, ... ]
+ *   }
+ *
+ *   series = {
+ *     0: quantity,           MeasurementEvent::Quantity (1 level, 2 flow,
+ *                            3 volume, 4 temperature)
+ *     1: channel,
+ *     2: sample count,
+ *     3: uptime ms of the first sample,
+ *     4: bytes               SeriesPacker bit stream
+ *   }
+ *
+ * Shared by the firmware, the host decoder (telemetryDecoder.h) and the
+ * benchmark (tools/telemetry).
+ */
+namespace TelemetryFormat
+{
+
+constexpr uint8_t VERSION = 1;
+
+enum MessageKey : uint8_t {
+    MESSAGE_VERSION = 0,
+    MESSAGE_UPTIME_MS = 1,
+    MESSAGE_UNIX_MS = 2,
+    MESSAGE_SERIES = 3,
+};
+
+enum SeriesKey : uint8_t {
+    SERIES_QUANTITY = 0,
+    SERIES_CHANNEL = 1,
+    SERIES_COUNT = 2,
+    SERIES_FIRST_MS = 3,
+    SERIES_PACKED = 4,
+};
+
+struct SeriesView {
+    uint8_t quantity;
+    uint8_t channel;
+    const SeriesPacker* packer;
+};
+
+// Upper bound of the encoded message, for the TX ring reservation
+size_t MessageBound(const SeriesView* series, size_t count);
+
+// One message with the given series (empty packers included as they are);
+// unixMs 0 leaves the wall clock out. False if the writer ran out of room.
+bool WriteMessage(CborWriter& cbor, uint64_t uptimeMs, uint64_t unixMs, const SeriesView* series, size_t count);
+
+} // namespace TelemetryFormat
+
+#endif // TELEMETRY_FORMAT_H
@@ -0,0 +1,180 @@
+// JsonWriter: the exact output for every kind of value, escaping and
+// number formatting, overflow at every buffer size without a byte past
+// the end, unbalanced nesting; and the telemetry path (WiFiComm::Begin(),
+// a JsonWriter in the ring, Commit(), Publish()) without a single heap
+// allocation, counted by the replaced global operator new below.
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "hostTest.h"
+#include "jsonWriter.h"
+#include "wifiComm.h"
+
+namespace
+{
+
+std::atomic<size_t> g_allocations{ 0 };
+
+void* allocate(size_t size)
+{
+    g_allocations.fetch_add(1);
+    void* p = std::malloc(size != 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    g_allocations.fetch_add(1);
+    return std::malloc(size != 0 ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace
+{
+
+const char EXPECTED[] = "{\"t\":21.5,\"n\":-42,\"min\":-9223372036854775808,\"s\":\"a\\\"b\\\\c\\n\\u0001\","
+                        "\"ok\":true,\"off\":false,\"x\":null,\"v\":[1.3,0,null,3,0.001,-2.5,null],"
+                        "\"o\":{},\"e\":[],\"deep\":[[{\"k\":[]}]]}";
+
+void writeDocument(JsonWriter& json)
+{
+    json.BeginObject();
+    json.Key("t").Number(21.5);
+    json.Key("n").Integer(-42);
+    json.Key("min").Integer(INT64_MIN);
+    json.Key("s").String("a\"b\\c\n\x01");
+    json.Key("ok").Bool(true);
+    json.Key("off").Bool(false);
+    json.Key("x").Null();
+    json.Key("v").BeginArray();
+    json.Number(1.25, 1).Number(-0.0004).Number(NAN).Number(3.0).Number(0.001).Number(-2.5).Number(INFINITY);
+    json.EndArray();
+    json.Key("o").BeginObject().EndObject();
+    json.Key("e").BeginArray().EndArray();
+    json.Key("deep").BeginArray().BeginArray().BeginObject().Key("k").BeginArray().EndArray().EndObject();
+    json.EndArray().EndArray();
+    json.EndObject();
+}
+
+void exactOutput()
+{
+    char buffer[256];
+    JsonWriter json(buffer, sizeof(buffer));
+    writeDocument(json);
+    CHECK(json.Ok());
+    CHECK_EQ(std::string(json.Data(), json.Length()), std::string(EXPECTED));
+}
+
+// Every buffer too small by at least a byte: not Ok(), nothing written
+// past the capacity
+void overflowAtEverySize()
+{
+    const size_t length = sizeof(EXPECTED) - 1;
+    size_t reported = 0;
+    size_t intact = 0;
+    for (size_t capacity = 0; capacity < length; ++capacity) {
+        std::vector<char> buffer(capacity + 16, '#');
+        JsonWriter json(buffer.data(), capacity);
+        writeDocument(json);
+        reported += !json.Ok() && json.Length() <= capacity;
+        bool guard = true;
+        for (size_t i = capacity; i < buffer.size(); ++i) {
+            guard = guard && buffer[i] == '#';
+        }
+        intact += guard;
+    }
+    CHECK_EQ(reported, length);
+    CHECK_EQ(intact, length);
+
+    std::vector<char> exact(length);
+    JsonWriter json(exact.data(), exact.size());
+    writeDocument(json);
+    CHECK(json.Ok());
+
+    JsonWriter none(nullptr, 100);
+    none.BeginObject().EndObject();
+    CHECK(!none.Ok());
+}
+
+void unbalanced()
+{
+    char buffer[64];
+    JsonWriter unclosed(buffer, sizeof(buffer));
+    unclosed.BeginObject().Key("a").BeginArray().EndArray();
+    CHECK(!unclosed.Ok());
+
+    JsonWriter extra(buffer, sizeof(buffer));
+    extra.BeginArray().EndArray().EndArray();
+    CHECK(!extra.Ok());
+
+    JsonWriter deep(buffer, sizeof(buffer));
+    for (size_t i = 0; i <= JsonWriter::MAX_DEPTH; ++i) {
+        deep.BeginArray();
+    }
+    for (size_t i = 0; i <= JsonWriter::MAX_DEPTH; ++i) {
+        deep.EndArray();
+    }
+    CHECK(!deep.Ok());
+}
+
+WiFiComm& comm()
+{
+    // Offline and not started: messages only go into the ring
+    static WiFiComm instance;
+    return instance;
+}
+
+// The snapshot path of TelemetryPublisher, and Publish(), with the ring
+// overflowing so old messages are evicted on the way
+void noAllocation()
+{
+    WiFiComm& wifi = comm();
+    const std::string payload(200, 'p');
+    size_t before = g_allocations.load();
+    bool written = true;
+    for (int i = 0; i < 500; ++i) {
+        WiFiComm::Message message = wifi.Begin("hydrotower/telemetry", 512, 1);
+        JsonWriter json(message.Text(), message.Capacity());
+        writeDocument(json);
+        written = written && json.Ok() && message.Commit(json.Length());
+        written = written && wifi.Publish("hydrotower/raw", payload.data(), payload.size(), 0);
+    }
+    size_t allocations = g_allocations.load() - before;
+    CHECK(written);
+    CHECK_EQ(allocations, 0u);
+
+    WiFiComm::Stats stats = wifi.GetStats();
+    CHECK_EQ(stats.queued, 1000u);
+    CHECK(stats.dropped > 0);
+}
+
+} // namespace
+
+int main()
+{
+    // Whatever the first use of the shim allocates happens here
+    comm().Configure(WiFiComm::Config{});
+    comm().GetStats();
+
+    HostTest::Run("exact output: values, escapes, numbers, nesting", exactOutput);
+    HostTest::Run("overflow at every buffer size", overflowAtEverySize);
+    HostTest::Run("unbalanced nesting is not Ok()", unbalanced);
+    HostTest::Run("Begin/JsonWriter/Commit and Publish: no allocation", noAllocation);
+    return HostTest::Report();
+}
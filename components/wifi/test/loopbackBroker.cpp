@@ -0,0 +1,154 @@
+#include "loopbackBroker.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+LoopbackBroker::LoopbackBroker()
+    : _listener(-1), _port(0), _stop(false), _acking(true), _drop(false), _connects(0)
+{
+    _listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(_listener, 1) != 0 ||
+        getsockname(_listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return;
+    }
+    _port = ntohs(address.sin_port);
+    _thread = std::thread([this] { run(); });
+}
+
+LoopbackBroker::~LoopbackBroker()
+{
+    _stop = true;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    close(_listener);
+}
+
+void LoopbackBroker::Drop()
+{
+    _drop = true;
+}
+
+std::vector<LoopbackBroker::Publish> LoopbackBroker::Take()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Publish> received;
+    received.swap(_received);
+    return received;
+}
+
+size_t LoopbackBroker::Received()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _received.size();
+}
+
+void LoopbackBroker::run()
+{
+    while (!_stop) {
+        pollfd listening = { _listener, POLLIN, 0 };
+        if (poll(&listening, 1, 50) != 1) {
+            continue;
+        }
+        int client = accept(_listener, nullptr, nullptr);
+        if (client >= 0) {
+            serve(client);
+            close(client);
+        }
+    }
+}
+
+void LoopbackBroker::serve(int client)
+{
+    std::string input;
+    char buffer[4096];
+    _drop = false;
+    while (!_stop && !_drop) {
+        pollfd readable = { client, POLLIN, 0 };
+        if (poll(&readable, 1, 20) != 1) {
+            continue;
+        }
+        ssize_t length = recv(client, buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            return;
+        }
+        input.append(buffer, static_cast<size_t>(length));
+        if (!handle(client, input)) {
+            return;
+        }
+    }
+}
+
+bool LoopbackBroker::handle(int client, std::string& input)
+{
+    while (true) {
+        // Fixed header: type and flags, remaining length (1 to 4 bytes)
+        size_t used = 1;
+        size_t remaining = 0;
+        for (int shift = 0;; shift += 7) {
+            if (used >= input.size()) {
+                return true;
+            }
+            uint8_t digit = static_cast<uint8_t>(input[used++]);
+            remaining |= static_cast<size_t>(digit & 0x7F) << shift;
+            if ((digit & 0x80) == 0) {
+                break;
+            }
+        }
+        if (input.size() < used + remaining) {
+            return true;
+        }
+
+        uint8_t first = static_cast<uint8_t>(input[0]);
+        const uint8_t* body = reinterpret_cast<const uint8_t*>(input.data()) + used;
+        switch (first >> 4) {
+        case 1: {   // CONNECT
+            _connects++;
+            const uint8_t connack[] = { 0x20, 2, 0, 0 };
+            send(client, connack, sizeof(connack), MSG_NOSIGNAL);
+            break;
+        }
+        case 3: {   // PUBLISH
+            Publish publish;
+            publish.qos = (first >> 1) & 3;
+            publish.dup = (first & 0x08) != 0;
+            size_t topicLength = (body[0] << 8) | body[1];
+            publish.topic.assign(reinterpret_cast<const char*>(body + 2), topicLength);
+            size_t offset = 2 + topicLength;
+            publish.packetId = 0;
+            if (publish.qos > 0) {
+                publish.packetId = static_cast<uint16_t>((body[offset] << 8) | body[offset + 1]);
+                offset += 2;
+            }
+            publish.payload.assign(reinterpret_cast<const char*>(body + offset), remaining - offset);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _received.push_back(publish);
+            }
+            if (publish.qos > 0 && _acking) {
+                const uint8_t puback[] = { 0x40, 2, static_cast<uint8_t>(publish.packetId >> 8),
+                                           static_cast<uint8_t>(publish.packetId) };
+                send(client, puback, sizeof(puback), MSG_NOSIGNAL);
+            }
+            break;
+        }
+        case 12: {  // PINGREQ
+            const uint8_t pingresp[] = { 0xD0, 0 };
+            send(client, pingresp, sizeof(pingresp), MSG_NOSIGNAL);
+            break;
+        }
+        case 14:    // DISCONNECT
+            return false;
+        default:
+            break;
+        }
+        input.erase(0, used + remaining);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef LOOPBACK_BROKER_H
+#define LOOPBACK_BROKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief   Scripted MQTT 3.1.1 broker on 127.0.0.1 for host tests.
+ *
+ * One connection at a time: answers CONNECT and PINGREQ, records every
+ * PUBLISH and acknowledges QoS 1 ones unless acking is paused. The test
+ * can drop the connection to force a reconnect. Runs on its own thread.
+ */
+class LoopbackBroker {
+public:
+    struct Publish {
+        std::string topic;
+        std::string payload;
+        uint8_t qos;
+        bool dup;
+        uint16_t packetId;
+    };
+
+    LoopbackBroker();
+    ~LoopbackBroker();
+
+    uint16_t Port() const { return _port; }
+
+    void SetAcking(bool acking) { _acking = acking; }
+    // Closes the client connection without a word
+    void Drop();
+
+    std::vector<Publish> Take();
+    size_t Received();
+    uint32_t Connects() const { return _connects; }
+
+private:
+    void run();
+    void serve(int client);
+    // Handles the complete packets at the front of input; false to hang up
+    bool handle(int client, std::string& input);
+
+    int _listener;
+    uint16_t _port;
+    std::thread _thread;
+    std::atomic<bool> _stop;
+    std::atomic<bool> _acking;
+    std::atomic<bool> _drop;
+    std::atomic<uint32_t> _connects;
+
+    std::mutex _mutex;
+    std::vector<Publish> _received;
+};
+
+#endif // LOOPBACK_BROKER_H
@@ -0,0 +1,444 @@
+// Binary telemetry: SeriesPacker bit streams through every delta-of-delta
+// bucket and both value windows, checked bit by bit and unpacked again
+// bit-exact (NaN, signed zeros and infinities included); Add() refusing
+// when the buffer is full; CborWriter head sizes; and DecodeMessage() on
+// whole, truncated and malformed messages.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "cborWriter.h"
+#include "hostTest.h"
+#include "seriesPacker.h"
+#include "telemetryDecoder.h"
+#include "telemetryFormat.h"
+
+namespace
+{
+
+using Telemetry::Sample;
+
+float fromBits(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t toBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// count bits of the stream from bit position, MSB first
+uint32_t bitsAt(const uint8_t* data, size_t position, unsigned count)
+{
+    uint32_t value = 0;
+    for (unsigned i = 0; i < count; ++i, ++position) {
+        value = (value << 1) | ((data[position / 8] >> (7 - position % 8)) & 1);
+    }
+    return value;
+}
+
+// Unpacks what the packer holds; true if it gives back exactly times and
+// the bits of values
+bool roundTrips(const SeriesPacker& packer, const std::vector<uint64_t>& times, const std::vector<float>& values)
+{
+    std::vector<Sample> samples;
+    if (packer.Count() != times.size() ||
+        !Telemetry::UnpackSeries(packer.Data(), packer.Bytes(), packer.Count(), packer.FirstTime(), samples) ||
+        samples.size() != times.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].uptimeMs != times[i] || toBits(samples[i].value) != toBits(values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Two samples whose second one has the given delta-of-delta: the time
+// code behind the raw first value, then the same value ('0')
+void dodBuckets()
+{
+    struct Case {
+        int64_t dod;
+        uint32_t prefix;
+        unsigned prefixBits;
+        unsigned payloadBits;
+    };
+    const Case cases[] = {
+        { 0, 0x0, 1, 0 },
+        { 1, 0x2, 2, 7 },
+        { -63, 0x2, 2, 7 },
+        { 64, 0x2, 2, 7 },
+        { -64, 0x6, 3, 9 },
+        { 65, 0x6, 3, 9 },
+        { -255, 0x6, 3, 9 },
+        { 256, 0x6, 3, 9 },
+        { -256, 0xE, 4, 12 },
+        { 257, 0xE, 4, 12 },
+        { -2047, 0xE, 4, 12 },
+        { 2048, 0xE, 4, 12 },
+        // 32-bit escape
+        { -2048, 0xF, 4, 32 },
+        { 2049, 0xF, 4, 32 },
+        { -1000000, 0xF, 4, 32 },
+        { INT32_MAX, 0xF, 4, 32 },
+        { INT32_MIN, 0xF, 4, 32 },
+    };
+    const uint64_t start = 1ull << 40;
+
+    size_t passed = 0;
+    for (const Case& c : cases) {
+        uint8_t buffer[64];
+        SeriesPacker packer(buffer, sizeof(buffer));
+        std::vector<uint64_t> times = { start, start + c.dod };
+        std::vector<float> values = { 21.5f, 21.5f };
+        bool ok = packer.Add(times[0], values[0]) && packer.Add(times[1], values[1]);
+        size_t bits = 32 + c.prefixBits + c.payloadBits + 1;
+        ok = ok && bitsAt(buffer, 32, c.prefixBits) == c.prefix && packer.Bytes() == (bits + 7) / 8;
+        ok = ok && bitsAt(buffer, bits - 1, 1) == 0;
+        ok = ok && roundTrips(packer, times, values);
+        if (!ok) {
+            printf("  dod %lld\n", static_cast<long long>(c.dod));
+        }
+        passed += ok;
+    }
+    CHECK_EQ(passed, sizeof(cases) / sizeof(cases[0]));
+
+    // A time step beyond 32 bits is refused, the stream stays as it was
+    uint8_t buffer[64];
+    SeriesPacker packer(buffer, sizeof(buffer));
+    CHECK(packer.Add(start, 1.0f));
+    CHECK(!packer.Add(start + (1ull << 33), 1.0f));
+    CHECK_EQ(packer.Count(), 1u);
+    CHECK_EQ(packer.Bytes(), 4u);
+}
+
+// Jittered times, including a step back, and a random walk of values
+void longSeries()
+{
+    static uint8_t buffer[8192];
+    SeriesPacker packer(buffer, sizeof(buffer));
+    std::vector<uint64_t> times;
+    std::vector<float> values;
+    srand(24);
+    uint64_t time = 123456;
+    float value = 18.0f;
+    for (int i = 0; i < 1000; ++i) {
+        time += 1000 + rand() % 7 - 3;
+        if (i == 500) {
+            time -= 5000;
+        }
+        if (i % 50 == 0) {
+            time += rand() % 100000;
+        }
+        // Every tenth value repeats the previous one
+        if (i % 10 != 0) {
+            value += static_cast<float>(rand() % 21 - 10) / 100.0f;
+        }
+        times.push_back(time);
+        values.push_back(value);
+        CHECK(packer.Add(time, value));
+    }
+    CHECK(roundTrips(packer, times, values));
+}
+
+// NaNs keep their payload, the zeros their sign
+void specialValues()
+{
+    const uint32_t bits[] = {
+        0x7FC00000,     // quiet NaN
+        0x7FA00001,     // signalling NaN with payload
+        0xFFC00000,     // negative NaN
+        0x00000000,     // +0
+        0x80000000,     // -0
+        0x00000000,
+        0x7F800000,     // +inf
+        0xFF800000,     // -inf
+        0x00000001,     // smallest denormal
+        0x3F800000,
+    };
+    uint8_t buffer[128];
+    SeriesPacker packer(buffer, sizeof(buffer));
+    std::vector<uint64_t> times;
+    std::vector<float> values;
+    for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); ++i) {
+        times.push_back(1000 * i);
+        values.push_back(fromBits(bits[i]));
+        CHECK(packer.Add(times.back(), values.back()));
+    }
+    CHECK(std::isnan(values[0]) && std::signbit(values[4]));
+    CHECK(roundTrips(packer, times, values));
+}
+
+// Same times throughout ('0' each), values chosen so the XORs take a new
+// window, reuse it, and need new ones for more leading or fewer trailing
+// zeros
+void valueWindows()
+{
+    const uint32_t v0 = 0x3F800000;
+    const uint32_t v1 = v0 ^ 0x00000F00;    // leading 20, trailing 8
+    const uint32_t v2 = v1 ^ 0x00000600;    // inside 20/8: reused
+    const uint32_t v3 = v2 ^ 0x00010000;    // leading 15: new window
+    const uint32_t v4 = v3 ^ 0x00000001;    // trailing 0: new window
+    const uint32_t v5 = v4;                 // unchanged: '0'
+    uint8_t buffer[64];
+    SeriesPacker packer(buffer, sizeof(buffer));
+    std::vector<uint64_t> times(6, 5000);
+    std::vector<float> values;
+    for (uint32_t bits : { v0, v1, v2, v3, v4, v5 }) {
+        values.push_back(fromBits(bits));
+        CHECK(packer.Add(5000, values.back()));
+    }
+
+    CHECK_EQ(bitsAt(buffer, 0, 32), v0);
+    // v1: '0' time, '11', leading 20, length - 1 = 3, 4 bits
+    CHECK_EQ(bitsAt(buffer, 32, 1), 0u);
+    CHECK_EQ(bitsAt(buffer, 33, 2), 3u);
+    CHECK_EQ(bitsAt(buffer, 35, 5), 20u);
+    CHECK_EQ(bitsAt(buffer, 40, 5), 3u);
+    CHECK_EQ(bitsAt(buffer, 45, 4), 0xFu);
+    // v2: '0', '10', the 4 bits of the window
+    CHECK_EQ(bitsAt(buffer, 49, 1), 0u);
+    CHECK_EQ(bitsAt(buffer, 50, 2), 2u);
+    CHECK_EQ(bitsAt(buffer, 52, 4), 0x6u);
+    // v3: '0', '11', leading 15, length 1, '1'
+    CHECK_EQ(bitsAt(buffer, 56, 3), 3u);
+    CHECK_EQ(bitsAt(buffer, 59, 5), 15u);
+    CHECK_EQ(bitsAt(buffer, 64, 5), 0u);
+    CHECK_EQ(bitsAt(buffer, 69, 1), 1u);
+    // v4: '0', '11', leading 31, length 1, '1'
+    CHECK_EQ(bitsAt(buffer, 70, 3), 3u);
+    CHECK_EQ(bitsAt(buffer, 73, 5), 31u);
+    CHECK_EQ(bitsAt(buffer, 78, 5), 0u);
+    CHECK_EQ(bitsAt(buffer, 83, 1), 1u);
+    // v5: '0', '0'
+    CHECK_EQ(bitsAt(buffer, 84, 2), 0u);
+    CHECK_EQ(packer.Bytes(), 11u);
+    CHECK(roundTrips(packer, times, values));
+}
+
+// Add() refuses once the worst case no longer fits, without touching the
+// stream; Reset() starts over in the same buffer
+void refusesWhenFull()
+{
+    uint8_t buffer[40];
+    SeriesPacker packer(buffer, sizeof(buffer));
+    std::vector<uint64_t> times;
+    std::vector<float> values;
+    // Worst case every time: escaped dod and a new 32-bit window
+    uint64_t time = 0;
+    for (uint32_t i = 0;; ++i) {
+        time += i % 2 == 0 ? 100000 : 1;
+        float value = fromBits(i % 2 == 0 ? 0x80000001u : 0x7FFFFFFEu);
+        size_t bytes = packer.Bytes();
+        if (!packer.Add(time, value)) {
+            CHECK_EQ(packer.Bytes(), bytes);
+            break;
+        }
+        times.push_back(time);
+        values.push_back(value);
+    }
+    CHECK(packer.Count() >= 3);
+    CHECK(packer.Bytes() <= sizeof(buffer));
+    CHECK(sizeof(buffer) * 8 - (packer.Bytes() * 8) < SeriesPacker::MAX_SAMPLE_BITS + 8);
+    CHECK(roundTrips(packer, times, values));
+
+    packer.Reset();
+    CHECK_EQ(packer.Count(), 0u);
+    CHECK(packer.Add(7, 1.0f));
+    CHECK(roundTrips(packer, { 7 }, { 1.0f }));
+}
+
+std::vector<uint8_t> encoded(const CborWriter& cbor)
+{
+    return std::vector<uint8_t>(cbor.Data(), cbor.Data() + cbor.Length());
+}
+
+std::vector<uint8_t> unsignedHead(uint64_t value)
+{
+    uint8_t buffer[16];
+    CborWriter cbor(buffer, sizeof(buffer));
+    cbor.Unsigned(value);
+    return encoded(cbor);
+}
+
+void cborHeads()
+{
+    using Bytes = std::vector<uint8_t>;
+    CHECK(unsignedHead(0) == Bytes{ 0x00 });
+    CHECK(unsignedHead(23) == Bytes{ 0x17 });
+    CHECK(unsignedHead(24) == (Bytes{ 0x18, 24 }));
+    CHECK(unsignedHead(255) == (Bytes{ 0x18, 0xFF }));
+    CHECK(unsignedHead(256) == (Bytes{ 0x19, 0x01, 0x00 }));
+    CHECK(unsignedHead(65535) == (Bytes{ 0x19, 0xFF, 0xFF }));
+    CHECK(unsignedHead(65536) == (Bytes{ 0x1A, 0x00, 0x01, 0x00, 0x00 }));
+    CHECK(unsignedHead(UINT32_MAX) == (Bytes{ 0x1A, 0xFF, 0xFF, 0xFF, 0xFF }));
+    CHECK(unsignedHead(1ull << 32) == (Bytes{ 0x1B, 0, 0, 0, 1, 0, 0, 0, 0 }));
+
+    uint8_t buffer[64];
+    CborWriter cbor(buffer, sizeof(buffer));
+    cbor.Integer(-1).Integer(-24).Integer(-25).Integer(INT64_MIN);
+    CHECK(encoded(cbor) == (Bytes{ 0x20, 0x37, 0x38, 24, 0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }));
+
+    CborWriter mixed(buffer, sizeof(buffer));
+    uint8_t blob[24] = {};
+    mixed.BeginMap(1).Text("a").BeginArray(3).Float(1.0f).Null().Bytes(blob, 3);
+    CHECK(encoded(mixed) == (Bytes{ 0xA1, 0x61, 'a', 0x83, 0xFA, 0x3F, 0x80, 0x00, 0x00, 0xF6, 0x43, 0, 0, 0 }));
+    CborWriter longer(buffer, sizeof(buffer));
+    longer.Bytes(blob, 24);
+    CHECK_EQ(longer.Length(), 26u);
+    CHECK_EQ(buffer[0], 0x58);
+    CHECK_EQ(buffer[1], 24);
+
+    // Out of room: not Ok(), nothing past the capacity
+    uint8_t small[4] = { 0xEE, 0xEE, 0xEE, 0xEE };
+    CborWriter overflow(small, 3);
+    overflow.Unsigned(65536);
+    CHECK(!overflow.Ok());
+    CHECK_EQ(small[3], 0xEE);
+}
+
+struct Built {
+    std::vector<uint8_t> bytes;
+    std::vector<uint64_t> times[2];
+    std::vector<float> values[2];
+};
+
+// A message of two series as SeriesPublisher builds it
+Built buildMessage(uint64_t unixMs)
+{
+    static uint8_t bits[2][512];
+    SeriesPacker level(bits[0], sizeof(bits[0]));
+    SeriesPacker flow(bits[1], sizeof(bits[1]));
+    Built built;
+    for (int i = 0; i < 40; ++i) {
+        built.times[0].push_back(60000 + 1000 * i);
+        built.values[0].push_back(50.0f + 0.25f * (i % 5));
+        level.Add(built.times[0].back(), built.values[0].back());
+        if (i % 4 == 0) {
+            built.times[1].push_back(60010 + 1000 * i);
+            built.values[1].push_back(i % 8 == 0 ? 1.5f : 0.0f);
+            flow.Add(built.times[1].back(), built.values[1].back());
+        }
+    }
+    TelemetryFormat::SeriesView views[] = { { 1, 0, &level }, { 2, 3, &flow } };
+    built.bytes.resize(TelemetryFormat::MessageBound(views, 2));
+    CborWriter cbor(built.bytes.data(), built.bytes.size());
+    CHECK(TelemetryFormat::WriteMessage(cbor, 100000, unixMs, views, 2));
+    built.bytes.resize(cbor.Length());
+    return built;
+}
+
+bool sameSamples(const Telemetry::Series& series, const std::vector<uint64_t>& times, const std::vector<float>& values,
+                 int64_t offset)
+{
+    if (series.samples.size() != times.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < times.size(); ++i) {
+        const Sample& sample = series.samples[i];
+        int64_t unixMs = offset < 0 ? -1 : static_cast<int64_t>(times[i]) + offset;
+        if (sample.uptimeMs != times[i] || toBits(sample.value) != toBits(values[i]) || sample.unixMs != unixMs) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void decodeMessage()
+{
+    const uint64_t unixMs = 1700000000000ull;
+    Built built = buildMessage(unixMs);
+    Telemetry::Message message;
+    std::string error;
+    CHECK(Telemetry::DecodeMessage(built.bytes.data(), built.bytes.size(), message, &error));
+    CHECK_EQ(message.version, 1u);
+    CHECK_EQ(message.uptimeMs, 100000u);
+    CHECK(message.hasUnixTime && message.unixMs == unixMs);
+    CHECK_EQ(message.series.size(), 2u);
+    if (message.series.size() == 2) {
+        int64_t offset = static_cast<int64_t>(unixMs) - 100000;
+        CHECK(message.series[0].quantity == 1 && message.series[0].channel == 0);
+        CHECK(message.series[1].quantity == 2 && message.series[1].channel == 3);
+        CHECK(sameSamples(message.series[0], built.times[0], built.values[0], offset));
+        CHECK(sameSamples(message.series[1], built.times[1], built.values[1], offset));
+    }
+
+    // Without the wall clock the samples carry none
+    Built local = buildMessage(0);
+    CHECK(Telemetry::DecodeMessage(local.bytes.data(), local.bytes.size(), message));
+    CHECK(!message.hasUnixTime);
+    CHECK(message.series.size() == 2 && sameSamples(message.series[0], local.times[0], local.values[0], -1));
+}
+
+// Every proper prefix of a message is rejected
+void truncatedRejected()
+{
+    Built built = buildMessage(1700000000000ull);
+    size_t accepted = 0;
+    for (size_t length = 0; length < built.bytes.size(); ++length) {
+        std::vector<uint8_t> prefix(built.bytes.begin(), built.bytes.begin() + length);
+        Telemetry::Message message;
+        accepted += Telemetry::DecodeMessage(prefix.data(), prefix.size(), message);
+    }
+    CHECK_EQ(accepted, 0u);
+}
+
+void malformedRejected()
+{
+    uint8_t buffer[64];
+    Telemetry::Message message;
+    std::string error;
+
+    CborWriter noVersion(buffer, sizeof(buffer));
+    noVersion.BeginMap(2).Unsigned(1).Unsigned(5000).Unsigned(3).BeginArray(0);
+    CHECK(!Telemetry::DecodeMessage(buffer, noVersion.Length(), message, &error));
+    CHECK_EQ(error, std::string("no version"));
+
+    CborWriter newer(buffer, sizeof(buffer));
+    newer.BeginMap(1).Unsigned(0).Unsigned(2);
+    CHECK(!Telemetry::DecodeMessage(buffer, newer.Length(), message, &error));
+    CHECK_EQ(error, std::string("unsupported version"));
+
+    CborWriter array(buffer, sizeof(buffer));
+    array.BeginArray(1).Unsigned(0);
+    CHECK(!Telemetry::DecodeMessage(buffer, array.Length(), message, &error));
+
+    // More samples than the bits can hold
+    CborWriter overcount(buffer, sizeof(buffer));
+    uint8_t bits[4] = {};
+    overcount.BeginMap(2).Unsigned(0).Unsigned(1).Unsigned(3).BeginArray(1);
+    overcount.BeginMap(3).Unsigned(2).Unsigned(100).Unsigned(3).Unsigned(0).Unsigned(4).Bytes(bits, 4);
+    CHECK(!Telemetry::DecodeMessage(buffer, overcount.Length(), message, &error));
+
+    // Unknown keys of newer firmware are skipped
+    CborWriter extra(buffer, sizeof(buffer));
+    extra.BeginMap(3).Unsigned(0).Unsigned(1).Unsigned(9).Text("new").Unsigned(10).BeginArray(2).Float(1.0f).Null();
+    extra.Unsigned(3).BeginArray(0);
+    CHECK(Telemetry::DecodeMessage(buffer, extra.Length(), message, &error));
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("delta-of-delta buckets, 32-bit escape, steps back", dodBuckets);
+    HostTest::Run("1000 jittered samples round trip", longSeries);
+    HostTest::Run("NaN, signed zeros, infinities bit-exact", specialValues);
+    HostTest::Run("XOR windows: new, reused, new again", valueWindows);
+    HostTest::Run("Add() refuses when full, stream intact", refusesWhenFull);
+    HostTest::Run("CBOR heads at 23/24/255/256/65535/65536", cborHeads);
+    HostTest::Run("DecodeMessage: two series, with and without wall clock", decodeMessage);
+    HostTest::Run("DecodeMessage: every truncation rejected", truncatedRejected);
+    HostTest::Run("DecodeMessage: no or newer version, not a map, too many samples", malformedRejected);
+    return HostTest::Report();
+}
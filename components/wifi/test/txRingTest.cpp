@@ -0,0 +1,267 @@
+// TxRing: the PUBLISH packets it builds byte for byte, Reserve()/Commit()
+// with a shorter payload, abandoned reservations, the wrap marker, a full
+// ring that refuses instead of overwriting, retiring records, and the
+// MaxMessage() limit at every head position.
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hostTest.h"
+#include "txRing.h"
+
+namespace
+{
+
+using Record = TxRing::Record;
+
+std::vector<uint8_t> packet(Record* r)
+{
+    return std::vector<uint8_t>(r->Packet(), r->Packet() + r->PacketLength());
+}
+
+// Payload of `length` bytes, all of them the low byte of `index`
+bool push(TxRing& ring, uint32_t index, size_t length, uint8_t qos = 1)
+{
+    std::vector<uint8_t> payload(length, static_cast<uint8_t>(index));
+    return ring.Push("t", 1, payload.data(), payload.size(), qos);
+}
+
+bool isPayload(const Record* r, uint32_t index, size_t length)
+{
+    if (r->payloadLength != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (r->Payload()[i] != static_cast<uint8_t>(index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Indices of the committed records from Tail() to Head()
+std::vector<uint32_t> contents(TxRing& ring)
+{
+    std::vector<uint32_t> indices;
+    uint32_t position = ring.Tail();
+    for (Record* r = ring.At(position); r != nullptr; r = ring.At(position)) {
+        indices.push_back(r->payloadLength > 0 ? r->Payload()[0] : 0);
+        position = ring.Next(position);
+    }
+    return indices;
+}
+
+void packetBytes()
+{
+    TxRing ring(1024);
+    CHECK(ring.Push("a/b", 3, "xyz", 3, 1));
+    CHECK(ring.Push("a/b", 3, "xyz", 3, 0));
+
+    uint32_t position = ring.Tail();
+    Record* r = ring.At(position);
+    CHECK(r != nullptr);
+    CHECK(packet(r) == (std::vector<uint8_t>{ 0x32, 10, 0, 3, 'a', '/', 'b', 0, 0, 'x', 'y', 'z' }));
+    CHECK_EQ(std::string(r->Topic(), r->topicLength), "a/b");
+    r->SetPacketId(0x1234);
+    r->SetDup();
+    CHECK(packet(r) == (std::vector<uint8_t>{ 0x3A, 10, 0, 3, 'a', '/', 'b', 0x12, 0x34, 'x', 'y', 'z' }));
+
+    position = ring.Next(position);
+    r = ring.At(position);
+    CHECK(r != nullptr);
+    CHECK(packet(r) == (std::vector<uint8_t>{ 0x30, 8, 0, 3, 'a', '/', 'b', 'x', 'y', 'z' }));
+    position = ring.Next(position);
+    CHECK(ring.At(position) == nullptr);
+}
+
+// Remaining length 205 takes two bytes, the header still ends at the topic
+void twoByteLength()
+{
+    TxRing ring(1024);
+    CHECK(push(ring, 7, 200));
+    uint32_t position = ring.Tail();
+    Record* r = ring.At(position);
+    std::vector<uint8_t> bytes = packet(r);
+    CHECK_EQ(bytes.size(), 3u + 205u);
+    CHECK_EQ(bytes[0], 0x32);
+    CHECK_EQ(bytes[1], 0xCD);
+    CHECK_EQ(bytes[2], 0x01);
+    CHECK_EQ(bytes[3], 0);
+    CHECK_EQ(bytes[4], 1);
+    CHECK_EQ(bytes[5], 't');
+    CHECK(isPayload(r, 7, 200));
+}
+
+// Only the committed length takes room, the next record follows right
+// behind it
+void commitShorter()
+{
+    TxRing ring(1024);
+    Record* r = ring.Reserve("t", 1, 300, 1);
+    CHECK(r != nullptr);
+    memset(r->Payload(), 5, 10);
+    ring.Commit(r, 10);
+    // 12 byte record header, 5 + 2 + 1 + 2 + 10 packet bytes, 8-aligned
+    CHECK_EQ(ring.Used(), 32u);
+    CHECK(isPayload(r, 5, 10));
+    CHECK_EQ(r->PacketLength(), 2u + 15u);
+
+    CHECK(push(ring, 6, 10));
+    CHECK(contents(ring) == (std::vector<uint32_t>{ 5, 6 }));
+
+    // Committing more than was reserved is cut to the reservation
+    r = ring.Reserve("t", 1, 4, 1);
+    ring.Commit(r, 100);
+    CHECK_EQ(r->payloadLength, 4u);
+}
+
+void abandonedReservation()
+{
+    TxRing ring(1024);
+    CHECK(push(ring, 1, 20));
+    uint32_t head = ring.Head();
+    Record* abandoned = ring.Reserve("t", 1, 100, 1);
+    CHECK(abandoned != nullptr);
+    memset(abandoned->Payload(), 9, 100);
+    // Invisible until committed
+    CHECK_EQ(ring.Head(), head);
+    CHECK(contents(ring) == std::vector<uint32_t>{ 1 });
+
+    // The next reservation takes the same room
+    Record* r = ring.Reserve("t", 1, 20, 1);
+    CHECK(r == abandoned);
+    memset(r->Payload(), 2, 20);
+    ring.Commit(r, 20);
+    CHECK(contents(ring) == (std::vector<uint32_t>{ 1, 2 }));
+}
+
+// 176-byte records in a 1 KiB ring: the sixth does not fit the last 144
+// bytes, a wrap marker fills them and the record starts at offset 0
+void wrapMarker()
+{
+    TxRing ring(1024);
+    for (uint32_t i = 1; i <= 5; ++i) {
+        CHECK(push(ring, i, 150));
+    }
+    CHECK_EQ(ring.Used(), 880u);
+    CHECK(!push(ring, 6, 150));
+    CHECK(ring.DropFront());
+    CHECK(ring.DropFront());
+    CHECK(push(ring, 6, 150));
+    CHECK_EQ(ring.Used(), 3u * 176u + 144u + 176u);
+
+    CHECK(contents(ring) == (std::vector<uint32_t>{ 3, 4, 5, 6 }));
+    uint32_t position = ring.Tail();
+    for (uint32_t i = 3; i <= 6; ++i) {
+        Record* r = ring.At(position);
+        CHECK(isPayload(r, i, 150));
+        // Every packet is one span inside the buffer
+        CHECK((position & (ring.Capacity() - 1)) + r->size <= ring.Capacity());
+        position = ring.Next(position);
+    }
+
+    // DropFront() across the marker
+    CHECK(ring.DropFront());
+    CHECK(ring.DropFront());
+    CHECK(ring.DropFront());
+    CHECK(contents(ring) == std::vector<uint32_t>{ 6 });
+    CHECK(ring.DropFront());
+    CHECK(ring.Empty());
+    CHECK(!ring.DropFront());
+}
+
+// An abandoned reservation behind a wrap marker leaves the marker only
+void abandonedAtWrap()
+{
+    TxRing ring(1024);
+    for (uint32_t i = 1; i <= 5; ++i) {
+        CHECK(push(ring, i, 150));
+    }
+    ring.ReleaseTo(ring.Tail() + 2 * 176);
+    CHECK(ring.Reserve("t", 1, 150, 1) != nullptr);
+    CHECK(contents(ring) == (std::vector<uint32_t>{ 3, 4, 5 }));
+    CHECK(push(ring, 6, 150));
+    CHECK(contents(ring) == (std::vector<uint32_t>{ 3, 4, 5, 6 }));
+}
+
+// Full: Reserve() refuses, nothing is overwritten
+void fullRefuses()
+{
+    TxRing ring(1024);
+    uint32_t count = 0;
+    while (push(ring, count + 1, 40)) {
+        count++;
+    }
+    CHECK_EQ(count, 1024u / 64u);
+    CHECK(ring.Reserve("t", 1, 0, 0) == nullptr);
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 1; i <= count; ++i) {
+        expected.push_back(i);
+    }
+    CHECK(contents(ring) == expected);
+
+    // ReleaseTo() a read cursor retires everything before it
+    uint32_t position = ring.Tail();
+    for (int i = 0; i < 4; ++i) {
+        ring.At(position);
+        position = ring.Next(position);
+    }
+    ring.ReleaseTo(position);
+    CHECK_EQ(contents(ring).front(), 5u);
+    CHECK(push(ring, 17, 40));
+    CHECK_EQ(contents(ring).back(), 17u);
+}
+
+// Moves the head of an empty ring `bytes` ahead (0 or at least 24, the
+// smallest record, and less than the capacity), empty again afterwards
+void advance(TxRing& ring, size_t bytes)
+{
+    while (bytes > 0) {
+        size_t chunk = bytes > 280 ? 256 : bytes;
+        // 12 byte record header and 5 + 2 + 1 packet bytes before the payload
+        std::vector<uint8_t> payload(chunk - 20);
+        ring.Push("t", 1, payload.data(), payload.size(), 0);
+        ring.DropFront();
+        bytes -= chunk;
+    }
+}
+
+// A MaxMessage() record fits an otherwise empty ring wherever the head
+// is, one byte more never does
+void maxMessage()
+{
+    TxRing ring(1024);
+    CHECK_EQ(ring.Capacity(), 1024u);
+    CHECK_EQ(ring.MaxMessage(), 1024u / 2 - sizeof(Record) - TxRing::FIXED_HEADER_MAX - 4);
+    size_t payload = ring.MaxMessage() - 1;
+
+    size_t fits = 0;
+    size_t positions = 0;
+    for (size_t offset = 0; offset < ring.Capacity(); offset += offset == 0 ? 24 : 8) {
+        TxRing shifted(1024);
+        advance(shifted, offset);
+        bool placed = (shifted.Head() & 1023u) == offset && shifted.Empty();
+        fits += placed && push(shifted, 1, payload) && shifted.Reserve("t", 1, payload + 1, 1) == nullptr;
+        positions++;
+    }
+    CHECK_EQ(fits, positions);
+
+    // Capacity is rounded down to a power of two
+    TxRing odd(3000);
+    CHECK_EQ(odd.Capacity(), 2048u);
+}
+
+} // namespace
+
+int main()
+{
+    HostTest::Run("PUBLISH bytes for QoS 1 and 0, packet id and DUP", packetBytes);
+    HostTest::Run("remaining length 205: two length bytes", twoByteLength);
+    HostTest::Run("Commit() shorter than reserved", commitShorter);
+    HostTest::Run("second Reserve() discards an uncommitted one", abandonedReservation);
+    HostTest::Run("wrap marker: order and contiguous packets", wrapMarker);
+    HostTest::Run("abandoned reservation behind a wrap marker", abandonedAtWrap);
+    HostTest::Run("full ring refuses, ReleaseTo() retires", fullRefuses);
+    HostTest::Run("MaxMessage() fits at every head position", maxMessage);
+    return HostTest::Report();
+}
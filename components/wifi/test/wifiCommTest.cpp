@@ -0,0 +1,181 @@
+// WiFiComm against an in-process broker on loopback (loopbackBroker.h):
+// a burst leaves in few socket writes, an offline overflow keeps the
+// newest messages in order, unacknowledged messages are replayed with
+// DUP after the connection drops, and large messages go out whole.
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "hostTest.h"
+#include "loopbackBroker.h"
+#include "wifiComm.h"
+
+namespace
+{
+
+using Publish = LoopbackBroker::Publish;
+
+LoopbackBroker& broker()
+{
+    static LoopbackBroker instance;
+    return instance;
+}
+
+WiFiComm& comm()
+{
+    static WiFiComm instance;
+    return instance;
+}
+
+std::string numbered(uint32_t i, size_t length)
+{
+    std::string payload = std::to_string(i);
+    payload.resize(length, '.');
+    return payload;
+}
+
+bool publish(const char* topic, uint32_t i, size_t length, uint8_t qos = 1)
+{
+    std::string payload = numbered(i, length);
+    return comm().Publish(topic, payload.data(), payload.size(), qos);
+}
+
+// Messages first .. first + count - 1, in order, exactly the numbered ones
+bool inOrder(const std::vector<Publish>& received, size_t from, uint32_t first, size_t count, size_t length)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (from + i >= received.size() || received[from + i].payload != numbered(first + i, length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Publish> waitFor(size_t count, int timeoutMs = 5000)
+{
+    HostTest::WaitFor([&] { return broker().Received() >= count; }, timeoutMs);
+    return broker().Take();
+}
+
+// 200 small messages queued at once (11 KiB of the ring): batched
+void burstIsBatched()
+{
+    constexpr uint32_t MESSAGES = 200;
+    CHECK(HostTest::WaitFor([] { return comm().GetStats().connects > 0; }));
+    WiFiComm::Stats before = comm().GetStats();
+    for (uint32_t i = 0; i < MESSAGES; ++i) {
+        CHECK(publish("test/burst", i, 20));
+    }
+    std::vector<Publish> received = waitFor(MESSAGES);
+    WiFiComm::Stats after = comm().GetStats();
+
+    CHECK_EQ(received.size(), static_cast<size_t>(MESSAGES));
+    CHECK(inOrder(received, 0, 0, MESSAGES, 20));
+    bool fresh = true;
+    for (const Publish& publish : received) {
+        fresh = fresh && !publish.dup && publish.qos == 1 && publish.topic == "test/burst";
+    }
+    CHECK(fresh);
+    uint32_t writes = after.writes - before.writes;
+    // Up to MQTT_BATCH_PACKETS (16) per write, the window refilled by
+    // halves at worst
+    CHECK(writes <= MESSAGES / 8);
+    printf("  %u messages in %u writes\n", (unsigned)MESSAGES, (unsigned)writes);
+    CHECK(HostTest::WaitFor([] { return comm().GetStats().buffered == 0; }));
+}
+
+// Offline: the ring (16 KiB, 128 records of this size) keeps the newest,
+// the rest is dropped oldest first and counted
+void offlineOverflow()
+{
+    constexpr uint32_t MESSAGES = 400;
+    comm().SetOnline(false);
+    vTaskDelay(pdMS_TO_TICKS(200));
+    WiFiComm::Stats before = comm().GetStats();
+    for (uint32_t i = 0; i < MESSAGES; ++i) {
+        CHECK(publish("test/offline", i, 100));
+    }
+    WiFiComm::Stats offline = comm().GetStats();
+    uint32_t dropped = offline.dropped - before.dropped;
+    uint32_t kept = MESSAGES - dropped;
+    CHECK(dropped > 0 && kept >= 100);
+    CHECK(broker().Received() == 0);
+
+    comm().SetOnline(true);
+    std::vector<Publish> received = waitFor(kept);
+    CHECK_EQ(received.size(), static_cast<size_t>(kept));
+    CHECK(inOrder(received, 0, MESSAGES - kept, kept, 100));
+    CHECK(HostTest::WaitFor([] { return comm().GetStats().buffered == 0; }));
+}
+
+// No PUBACKs: the window fills and stops; after the connection drops
+// the same messages come again, in order and with DUP, then the rest
+void replayWithDup()
+{
+    constexpr uint32_t MESSAGES = 20;
+    constexpr uint32_t WINDOW = 16;
+    broker().SetAcking(false);
+    WiFiComm::Stats before = comm().GetStats();
+    for (uint32_t i = 0; i < MESSAGES; ++i) {
+        CHECK(publish("test/replay", i, 20));
+    }
+    CHECK_EQ(waitFor(WINDOW).size(), static_cast<size_t>(WINDOW));
+    vTaskDelay(pdMS_TO_TICKS(200));
+    CHECK(broker().Take().empty());
+
+    uint32_t connects = broker().Connects();
+    broker().SetAcking(true);
+    broker().Drop();
+    CHECK(HostTest::WaitFor([&] { return broker().Connects() > connects; }));
+    std::vector<Publish> received = waitFor(MESSAGES);
+    WiFiComm::Stats after = comm().GetStats();
+
+    CHECK_EQ(received.size(), static_cast<size_t>(MESSAGES));
+    CHECK(inOrder(received, 0, 0, MESSAGES, 20));
+    bool dupOnReplay = true;
+    for (size_t i = 0; i < received.size(); ++i) {
+        dupOnReplay = dupOnReplay && received[i].dup == (i < WINDOW);
+    }
+    CHECK(dupOnReplay);
+    CHECK_EQ(after.replayed - before.replayed, WINDOW);
+    CHECK(HostTest::WaitFor([] { return comm().GetStats().buffered == 0; }));
+}
+
+// Bigger than a batch (and a 2-byte remaining length): alone in its
+// write, intact; bigger than half the ring: refused
+void largeMessage()
+{
+    std::string payload(6000, 'x');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    CHECK(comm().Publish("test/large", payload.data(), payload.size(), 1));
+    CHECK(publish("test/large", 1, 10));
+    std::vector<Publish> received = waitFor(2);
+    CHECK_EQ(received.size(), 2u);
+    CHECK(received.size() == 2 && received[0].payload == payload && received[1].payload == numbered(1, 10));
+
+    WiFiComm::Stats before = comm().GetStats();
+    std::string huge(9000, 'y');
+    CHECK(!comm().Publish("test/large", huge.data(), huge.size(), 1));
+    CHECK_EQ(comm().GetStats().dropped - before.dropped, 1u);
+}
+
+} // namespace
+
+int main()
+{
+    WiFiComm::Config config;
+    config.host = "127.0.0.1";
+    config.port = broker().Port();
+    config.window = 16;
+    comm().Configure(config);
+    comm().Start();
+    comm().SetOnline(true);
+
+    HostTest::Run("burst of 200: batched writes, in order", burstIsBatched);
+    HostTest::Run("offline overflow: newest kept, in order", offlineOverflow);
+    HostTest::Run("dropped connection: replay with DUP, in order", replayWithDup);
+    HostTest::Run("large message whole, oversized refused", largeMessage);
+    return HostTest::Report();
+}
@@ -0,0 +1,157 @@
+#include "txRing.h"
+#include <cstring>
+#include <new>
+#include "mqttClient.h"
+
+void TxRing::Record::SetPacketId(uint16_t packetId)
+{
+    if (qos > 0) {
+        uint8_t* id = data() + FIXED_HEADER_MAX + 2 + topicLength;
+        id[0] = static_cast<uint8_t>(packetId >> 8);
+        id[1] = static_cast<uint8_t>(packetId);
+    }
+}
+
+void TxRing::Record::SetDup()
+{
+    Packet()[0] |= MqttClient::PUBLISH_DUP;
+}
+
+TxRing::TxRing(size_t capacity)
+    : _buffer(nullptr),
+      _capacity(0),
+      _head(0),
+      _tail(0)
+{
+    size_t size = ALIGN * 4;
+    while (size * 2 <= capacity) {
+        size *= 2;
+    }
+    // uint64_t keeps the records 8-byte aligned
+    _buffer = reinterpret_cast<uint8_t*>(new (std::nothrow) uint64_t[size / sizeof(uint64_t)]);
+    if (_buffer != nullptr) {
+        _capacity = size;
+    }
+}
+
+TxRing::~TxRing()
+{
+    delete[] reinterpret_cast<uint64_t*>(_buffer);
+}
+
+size_t TxRing::MaxMessage() const
+{
+    // Half the ring, so one record always fits next to a wrap marker
+    size_t limit = _capacity / 2 - sizeof(Record) - FIXED_HEADER_MAX - 4;
+    return limit < UINT16_MAX ? limit : UINT16_MAX;
+}
+
+TxRing::Record* TxRing::Reserve(const char* topic, size_t topicLength, size_t maxPayload, uint8_t qos)
+{
+    if (!IsValid() || topicLength + maxPayload > MaxMessage()) {
+        return nullptr;
+    }
+
+    size_t size = recordSize(topicLength, maxPayload, qos);
+    size_t toEnd = _capacity - (_head & (_capacity - 1));
+    size_t needed = size <= toEnd ? size : toEnd + size;
+    if (_capacity - Used() < needed) {
+        return nullptr;
+    }
+
+    if (size > toEnd) {
+        // An empty filler is harmless should the reservation be abandoned
+        Record* filler = record(_head);
+        filler->size = static_cast<uint32_t>(toEnd);
+        filler->flags = FLAG_WRAP;
+        _head += static_cast<uint32_t>(toEnd);
+    }
+
+    Record* r = record(_head);
+    r->size = static_cast<uint32_t>(size);
+    r->topicLength = static_cast<uint16_t>(topicLength);
+    r->payloadLength = static_cast<uint16_t>(maxPayload);
+    r->qos = qos;
+    r->flags = 0;
+    r->packetStart = 0;
+    r->reserved = 0;
+    uint8_t* variable = reinterpret_cast<uint8_t*>(r + 1) + FIXED_HEADER_MAX;
+    variable[0] = static_cast<uint8_t>(topicLength >> 8);
+    variable[1] = static_cast<uint8_t>(topicLength);
+    memcpy(variable + 2, topic, topicLength);
+    return r;
+}
+
+void TxRing::Commit(Record* r, size_t payloadLength)
+{
+    if (payloadLength > r->payloadLength) {
+        payloadLength = r->payloadLength;
+    }
+    r->payloadLength = static_cast<uint16_t>(payloadLength);
+    r->size = static_cast<uint32_t>(recordSize(r->topicLength, payloadLength, r->qos));
+    r->SetPacketId(0);
+
+    // Fixed header right-aligned against the topic, so the packet is one
+    // contiguous span
+    uint8_t header[FIXED_HEADER_MAX];
+    size_t remaining = 2 + r->topicLength + (r->qos > 0 ? 2 : 0) + payloadLength;
+    header[0] = static_cast<uint8_t>((MqttClient::PUBLISH << 4) | ((r->qos & 3) << 1));
+    size_t length = 1 + MqttClient::EncodeLength(header + 1, remaining);
+    r->packetStart = static_cast<uint8_t>(FIXED_HEADER_MAX - length);
+    memcpy(reinterpret_cast<uint8_t*>(r + 1) + r->packetStart, header, length);
+
+    _head += r->size;
+}
+
+bool TxRing::Push(const char* topic, size_t topicLength, const void* payload, size_t payloadLength, uint8_t qos)
+{
+    Record* r = Reserve(topic, topicLength, payloadLength, qos);
+    if (r == nullptr) {
+        return false;
+    }
+    if (payloadLength > 0) {
+        memcpy(r->Payload(), payload, payloadLength);
+    }
+    Commit(r, payloadLength);
+    return true;
+}
+
+TxRing::Record* TxRing::At(uint32_t& position)
+{
+    if (position == _head) {
+        return nullptr;
+    }
+    Record* r = record(position);
+    if (r->flags & FLAG_WRAP) {
+        position += r->size;
+        if (position == _head) {
+            return nullptr;
+        }
+        r = record(position);
+    }
+    return r;
+}
+
+uint32_t TxRing::Next(uint32_t position) const
+{
+    return position + record(position)->size;
+}
+
+bool TxRing::DropFront()
+{
+    if (Empty()) {
+        return false;
+    }
+    Record* r = At(_tail);
+    if (r == nullptr) {
+        // Only a wrap marker was left
+        return true;
+    }
+    _tail += r->size;
+    return true;
+}
+
+void TxRing::ReleaseTo(uint32_t position)
+{
+    _tail = position;
+}
@@ -0,0 +1,117 @@
+#ifndef TX_RING_H
+#define TX_RING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   Bounded FIFO of outgoing MQTT PUBLISH packets in one
+ *          preallocated byte ring.
+ *
+ * Every record holds a complete packet (fixed header, topic, packet
+ * identifier, payload) in one contiguous span, so the network task hands
+ * Packet() to the socket as it is: no copy between the producer and the
+ * wire. Producers either Push() a finished payload or Reserve() room,
+ * write the payload in place (e.g. with a JsonWriter) and Commit() the
+ * length they used.
+ *
+ * Records do not wrap (a wrap marker fills the end of the buffer when the
+ * next record does not fit) and are addressed by free-running byte
+ * positions, so "is a before b" is a plain subtraction. The owner keeps
+ * its own read cursor between Tail() and Head(); records stay in place
+ * until DropFront() or ReleaseTo() retires them, so a message can be sent
+ * again after a reconnect.
+ *
+ * Not thread-safe, the owner serialises access.
+ */
+class TxRing {
+public:
+    enum Flags : uint8_t {
+        FLAG_SENT = 0x01,   // written to a connection at least once
+        FLAG_WRAP = 0x80,   // filler up to the end of the buffer
+    };
+
+    // Room in front of the topic for the fixed header (1 + 4 length bytes)
+    static constexpr size_t FIXED_HEADER_MAX = 5;
+
+    struct Record {
+        uint32_t size;          // whole record including header and padding
+        uint8_t flags;          // within the first 8 bytes: a filler may be that short
+        uint8_t qos;
+        uint16_t topicLength;
+        uint16_t payloadLength;
+        uint8_t packetStart;    // offset of the fixed header in the header room
+        uint8_t reserved;
+
+        uint8_t* Packet() { return data() + packetStart; }
+        size_t PacketLength() const {
+            return FIXED_HEADER_MAX - packetStart + 2 + topicLength + (qos > 0 ? 2 : 0) + payloadLength;
+        }
+        const char* Topic() const { return reinterpret_cast<const char*>(data() + FIXED_HEADER_MAX + 2); }
+        uint8_t* Payload() { return data() + FIXED_HEADER_MAX + 2 + topicLength + (qos > 0 ? 2 : 0); }
+        const uint8_t* Payload() const { return const_cast<Record*>(this)->Payload(); }
+
+        // Patched in place before every send
+        void SetPacketId(uint16_t packetId);
+        void SetDup();
+
+    private:
+        uint8_t* data() const { return reinterpret_cast<uint8_t*>(const_cast<Record*>(this) + 1); }
+    };
+
+    // capacity is rounded down to a power of two
+    explicit TxRing(size_t capacity);
+    ~TxRing();
+
+    bool IsValid() const { return _buffer != nullptr; }
+    size_t Capacity() const { return _capacity; }
+    size_t Used() const { return _head - _tail; }
+    bool Empty() const { return _head == _tail; }
+
+    // Largest topic plus payload a single record can carry
+    size_t MaxMessage() const;
+
+    // Record with room for maxPayload payload bytes behind Head(), or null
+    // if it does not fit (nothing is overwritten). Invisible to At() until
+    // committed; a second Reserve() without Commit() discards it.
+    Record* Reserve(const char* topic, size_t topicLength, size_t maxPayload, uint8_t qos);
+    // Publishes the reserved record with the payload bytes actually written
+    void Commit(Record* record, size_t payloadLength);
+
+    // Reserve() and Commit() with a finished payload
+    bool Push(const char* topic, size_t topicLength, const void* payload, size_t payloadLength, uint8_t qos);
+
+    uint32_t Tail() const { return _tail; }
+    uint32_t Head() const { return _head; }
+
+    // Record at position (wrap markers skipped, position updated); null at
+    // the head
+    Record* At(uint32_t& position);
+    uint32_t Next(uint32_t position) const;
+
+    // Retires the oldest record / all records before position
+    bool DropFront();
+    void ReleaseTo(uint32_t position);
+
+private:
+    static constexpr size_t ALIGN = 8;
+
+    static size_t recordSize(size_t topicLength, size_t payloadLength, uint8_t qos) {
+        size_t packet = FIXED_HEADER_MAX + 2 + topicLength + (qos > 0 ? 2 : 0) + payloadLength;
+        return (sizeof(Record) + packet + ALIGN - 1) & ~(ALIGN - 1);
+    }
+    Record* record(uint32_t position) const {
+        return reinterpret_cast<Record*>(_buffer + (position & (_capacity - 1)));
+    }
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    uint32_t _head;
+    uint32_t _tail;
+
+    // Disallow copy and assignment
+    TxRing(const TxRing&) = delete;
+    TxRing& operator=(const TxRing&) = delete;
+};
+
+#endif // TX_RING_H
@@ -3,61 +3,38 @@
 #include "esp_log.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
 #include "nvs_flash.h"
 
 #include <cstring>
 
 static const char* TAG = "WiFiActor";
 
-WiFiComm::WiFiComm( ) : _txQueue( xQueueCreate( 10, sizeof( std::string* )))
-{
-
-}
-
-void WiFiComm::Start( )
-{
-    xTaskCreate( taskLoop, "WiFiCommTask", 4096, this, 5, &_task ); 
-}
+static const char* NVS_NAMESPACE = "wifi";
+static const char* NVS_KEY_AP = "ap";
+static constexpr uint8_t CACHE_VERSION = 1;
 
-void WiFiComm::Send( const std::string& payload )
-{
-    std::string* msg = new std::string( payload ); 
-
-    if( xQueueSend( _txQueue, &msg, 0 ) != pdPASS )
-    {
-        delete msg; 
-        ESP_LOGW("WiFiComm", "⚠️ Queue full, message dropped");
-    } else {
-        ESP_LOGI("WiFiComm", "📥 Queued: %s", msg->c_str());
+// FNV-1a, only to tell whether the cache belongs to the configured SSID
+static uint32_t ssidHash(const std::string& ssid) {
+    uint32_t hash = 2166136261u;
+    for (char c : ssid) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
     }
+    return hash;
 }
 
-void WiFiComm::taskLoop( void* args )
-{
-    WiFiComm* self = static_cast<WiFiComm*>( args );
-    std::string* msg = nullptr;
-
-    while( pdTRUE ) 
-    {
-        if ( xQueueReceive( self->_txQueue, &msg, portMAX_DELAY ) == pdPASS ) 
-        {
-            ESP_LOGI("WiFiComm", "📤 Sending: %s", msg->c_str( ));
-            delete msg;
-        }
-    } 
-}
-
-
-
-
-// Konstruktor
-WiFiActor::WiFiActor() : ActiveObject( "WiFi", 4096, 10 ), _connected( false ) 
+// Konstruktor - on core 0 next to the WiFi/lwIP tasks, core 1 stays free for the application
+WiFiActor::WiFiActor() : ActiveObject( "WiFi", TaskConfig{ 4096, 1, 0 }, 10 ), _connected( false ), _state( State::INIT ),
+    _cache{}, _cacheValid( false ), _associated{}, _reconnect( new WiFiReconnectEvent( "WiFi" )),
+    _attemptPending( false ), _nextScan( ReconnectPolicy::Scan::Full ), _outage( false ), _outageStartUs( 0 )
 {
     esp_netif_init( );
     esp_event_loop_create_default( );
     esp_netif_create_default_wifi_sta( );
 
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT( );         
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT( );
     esp_wifi_init( &cfg );
 
     esp_event_handler_instance_register( WIFI_EVENT,
@@ -72,7 +49,7 @@ WiFiActor::WiFiActor() : ActiveObject( "WiFi", 4096, 10 ), _connected( false )
                                          this,
                                          nullptr );
 
-    _comm.Start( ); 
+    _comm.Start( );
 }
 
 // Konfiguration
@@ -80,118 +57,261 @@ void WiFiActor::Configure(const std::string& ssid, const std::string& password)
     _ssid = ssid;
     _password = password;
 
-    wifi_config_t wifi_config = {};
-    strncpy((char*)wifi_config.sta.ssid, ssid.c_str(), sizeof(wifi_config.sta.ssid));
-    strncpy((char*)wifi_config.sta.password, password.c_str(), sizeof(wifi_config.sta.password));
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-
-    esp_wifi_set_mode(WIFI_MODE_STA);
-    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-    esp_wifi_start();
-    esp_wifi_connect();
-
     ESP_LOGI(TAG, "WiFi configured with SSID: %s", _ssid.c_str());
 }
 
 // Dispatcher
-void WiFiActor::Dispatcher(Event* e) {
+void WiFiActor::Dispatcher(const Event* e) {
     switch (_state) {
         case State::INIT:
             if (e->getType() == Event::Type::OnStart) {
                 printf("[WiFi] INIT → CONNECTING\n");
-                _state = State::CONNECTING;
-                Configure(_ssid, _password);
+                enter(State::CONNECTING);
+                startDriver();
+                beginReconnect();
             }
             break;
 
         case State::CONNECTING:
             if (e->getType() == Event::Type::WiFiConnected) {
                 printf("[WiFi] ✅ Connected\n");
-                _state = State::CONNECTED;
-
-                if (_retries > 0) {
-                    Post(new WiFiRestoredEvent("WiFi"));
-                }
-
-                _retries = 0;
+                onConnected();
             }
-            else if (e->getType() == Event::Type::WiFiDisconnected) {
-                printf("[WiFi] ❌ Disconnected while connecting\n");
-
-                if (_retries < MAX_RETRIES) {
-                    _retries++;
-                    printf("[WiFi] 🔁 Retry #%d...\n", _retries);
-                    esp_wifi_connect();
-                } else {
-                    printf("[WiFi] ❌ Max retries reached → FAILED\n");
-                    _state = State::FAILED;
-                    _retries = 0;
-                    Post(new WiFiFailedEvent("WiFi"));
+            else if (const WiFiDisconnectedEvent* lost = event_cast<WiFiDisconnectedEvent>(e)) {
+                printf("[WiFi] ❌ Disconnected while connecting (reason %u)\n", lost->getReason());
+                onAttemptFailed(lost->getReason());
+            }
+            else if (e->getType() == Event::Type::WiFiReconnect) {
+                // Backoff over; a stale timer event (attempt cancelled) finds nothing pending
+                if (_attemptPending) {
+                    _attemptPending = false;
+                    connect(_nextScan);
                 }
             }
             else if (e->getType() == Event::Type::WiFiShutdown) {
                 printf("[WiFi] 🔻 Shutdown while connecting\n");
+                cancelAttempt();
                 Shutdown();
-                _state = State::INIT;
-                _retries = 0;
+                enter(State::INIT);
             }
             break;
 
         case State::CONNECTED:
-            if (e->getType() == Event::Type::WiFiGotIP) {
-                WiFiGotIPEvent* ipEvent = static_cast<WiFiGotIPEvent*>(e);
+            if (const WiFiGotIPEvent* ipEvent = event_cast<WiFiGotIPEvent>(e)) {
                 printf("[WiFi] 📡 Got IP: %s\n", ipEvent->getIP().c_str());
             }
-            else if (e->getType() == Event::Type::WiFiDisconnected) {
-                printf("[WiFi] ⚠️ Connection lost\n");
-
-                if (_retries < MAX_RETRIES) {
-                    _retries++;
-                    printf("[WiFi] 🔁 Retry #%d...\n", _retries);
-                    _state = State::CONNECTING;
-                    esp_wifi_connect();
-                } else {
-                    printf("[WiFi] ❌ Max retries reached → FAILED\n");
-                    _state = State::FAILED;
-                    _retries = 0;
-                    Post(new WiFiFailedEvent("WiFi"));
-                }
+            else if (const WiFiDisconnectedEvent* lost = event_cast<WiFiDisconnectedEvent>(e)) {
+                printf("[WiFi] ⚠️ Connection lost (reason %u)\n", lost->getReason());
+                enter(State::CONNECTING);
+                _outage = true;
+                beginReconnect();
             }
             else if (e->getType() == Event::Type::WiFiDisconnectedByRequest) {
                 printf("[WiFi] 🔌 Disconnected manually\n");
                 Disconnect();
-                _state = State::INIT;
-                _retries = 0;
+                enter(State::INIT);
             }
             else if (e->getType() == Event::Type::WiFiShutdown) {
                 printf("[WiFi] 🔻 Shutdown requested\n");
                 Shutdown();
-                _state = State::INIT;
-                _retries = 0;
+                enter(State::INIT);
             }
             break;
 
         case State::FAILED:
-            printf("[WiFi] ⛔ Ignoring event in FAILED state: %s\n", Event::typeToString(e->getType()));
+            if (e->getType() == Event::Type::WiFiReconnect && _attemptPending) {
+                printf("[WiFi] 🔁 FAILED → CONNECTING, trying again\n");
+                _attemptPending = false;
+                enter(State::CONNECTING);
+                beginReconnect();
+            }
+            else if (e->getType() == Event::Type::WiFiShutdown) {
+                printf("[WiFi] 🔻 Shutdown while failed\n");
+                cancelAttempt();
+                Shutdown();
+                enter(State::INIT);
+            }
+            else {
+                printf("[WiFi] ⛔ Ignoring event in FAILED state: %s\n", Event::typeToString(e->getType()));
+            }
             break;
     }
 }
 
 
 
+void WiFiActor::enter(State next) {
+    _state = next;
+    _comm.SetOnline(next == State::CONNECTED);
+}
+
+void WiFiActor::startDriver() {
+    loadCache();
+    esp_wifi_set_mode(WIFI_MODE_STA);
+    esp_wifi_start();
+}
+
+void WiFiActor::beginReconnect() {
+    if (!_outage) {
+        _outageStartUs = esp_timer_get_time();
+    }
+    _policy.SetCached(_cacheValid);
+    schedule(_policy.Start());
+}
+
+void WiFiActor::schedule(const ReconnectPolicy::Attempt& attempt) {
+    if (attempt.delayMs == 0) {
+        connect(attempt.scan);
+        return;
+    }
+    ESP_LOGI(TAG, "Next attempt in %u ms", (unsigned)attempt.delayMs);
+    _nextScan = attempt.scan;
+    _attemptPending = true;
+    _timer.Start(attempt.delayMs, _reconnect->Retain());
+}
+
+void WiFiActor::connect(ReconnectPolicy::Scan scan) {
+    wifi_config_t wifi_config = {};
+    strncpy((char*)wifi_config.sta.ssid, _ssid.c_str(), sizeof(wifi_config.sta.ssid));
+    strncpy((char*)wifi_config.sta.password, _password.c_str(), sizeof(wifi_config.sta.password));
+    wifi_config.sta.pmf_cfg.capable = true;
+
+    if (scan == ReconnectPolicy::Scan::Fast && _cacheValid) {
+        // Straight to the known AP: one channel, no scan; the cached auth
+        // mode as threshold also keeps a fake AP from downgrading it
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, _cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = _cache.channel;
+        wifi_config.sta.threshold.authmode = static_cast<wifi_auth_mode_t>(_cache.authmode);
+        ESP_LOGI(TAG, "Connecting to cached AP %02x:%02x:%02x:%02x:%02x:%02x on channel %u",
+                 _cache.bssid[0], _cache.bssid[1], _cache.bssid[2],
+                 _cache.bssid[3], _cache.bssid[4], _cache.bssid[5], _cache.channel);
+    } else {
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+        wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+        ESP_LOGI(TAG, "Scanning all channels for %s", _ssid.c_str());
+    }
+
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    esp_wifi_connect();
+}
+
+void WiFiActor::onAttemptFailed(uint16_t reason) {
+    if (_attemptPending) {
+        // A late disconnect of the attempt already given up on
+        return;
+    }
+    ReconnectPolicy::Attempt next;
+    if (!_policy.Next(reason, esp_random(), next)) {
+        giveUp();
+        return;
+    }
+    printf("[WiFi] 🔁 Retry #%u (%s scan)...\n", (unsigned)_policy.Failures(),
+           next.scan == ReconnectPolicy::Scan::Fast ? "fast" : "full");
+    schedule(next);
+}
+
+void WiFiActor::onConnected() {
+    cancelAttempt();
+    enter(State::CONNECTED);
+    storeCache();
+
+    uint32_t elapsedMs = static_cast<uint32_t>((esp_timer_get_time() - _outageStartUs) / 1000);
+    ESP_LOGI(TAG, "Connected after %u ms, %u failed attempts", (unsigned)elapsedMs, (unsigned)_policy.Failures());
+
+    if (_outage) {
+        Post(new WiFiRestoredEvent("WiFi"));
+    }
+    _outage = false;
+    _policy.Reset();
+}
+
+void WiFiActor::giveUp() {
+    printf("[WiFi] ❌ Max retries reached → FAILED\n");
+    enter(State::FAILED);
+    _outage = true;
+    _nextScan = ReconnectPolicy::Scan::Full;
+    _attemptPending = true;
+    _timer.Start(ReconnectPolicy::RecoveryDelay(esp_random()), _reconnect->Retain());
+    Post(new WiFiFailedEvent("WiFi"));
+}
+
+void WiFiActor::cancelAttempt() {
+    // A timer event already in the mailbox is dropped by _attemptPending
+    _timer.Stop();
+    _attemptPending = false;
+}
+
+void WiFiActor::loadCache() {
+    _cacheValid = false;
+
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    ApCache cache;
+    size_t length = sizeof(cache);
+    if (nvs_get_blob(handle, NVS_KEY_AP, &cache, &length) == ESP_OK && length == sizeof(cache) &&
+        cache.version == CACHE_VERSION && cache.ssidHash == ssidHash(_ssid) && cache.channel != 0) {
+        _cache = cache;
+        _cacheValid = true;
+        ESP_LOGI(TAG, "Cached AP on channel %u", _cache.channel);
+    }
+    nvs_close(handle);
+}
+
+void WiFiActor::storeCache() {
+    ApCache cache = _associated;
+    cache.version = CACHE_VERSION;
+    cache.ssidHash = ssidHash(_ssid);
+    if (cache.channel == 0) {
+        return;
+    }
+    // Same AP as last time: no flash write
+    if (_cacheValid && memcmp(&cache, &_cache, sizeof(cache)) == 0) {
+        return;
+    }
+    _cache = cache;
+    _cacheValid = true;
+
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGW(TAG, "AP cache not stored, NVS not available");
+        return;
+    }
+    if (nvs_set_blob(handle, NVS_KEY_AP, &cache, sizeof(cache)) != ESP_OK || nvs_commit(handle) != ESP_OK) {
+        ESP_LOGW(TAG, "AP cache not stored");
+    }
+    nvs_close(handle);
+    ESP_LOGI(TAG, "AP cached: channel %u", cache.channel);
+}
+
 // Event-Handler (Callback aus ESP-IDF)
 void WiFiActor::wifiEventHandler(void* arg, esp_event_base_t base, int32_t id, void* data) {
     WiFiActor* self = static_cast<WiFiActor*>(arg);
 
     if (base == WIFI_EVENT && id == WIFI_EVENT_STA_START) {
         ESP_LOGI(TAG, "WiFi STA Start → waiting for connect...");
-        
-    } 
+
+    }
+    else if (base == WIFI_EVENT && id == WIFI_EVENT_STA_CONNECTED) {
+        // Remembered for the cache once the IP is there too; the GOT_IP
+        // event posted after this orders the write before the actor reads
+        const wifi_event_sta_connected_t* info = static_cast<const wifi_event_sta_connected_t*>(data);
+        ApCache associated = {};
+        memcpy(associated.bssid, info->bssid, sizeof(associated.bssid));
+        associated.channel = info->channel;
+        associated.authmode = static_cast<uint8_t>(info->authmode);
+        self->_associated = associated;
+    }
     else if (base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED) {
-        ESP_LOGW(TAG, "WiFi Disconnected → Posting Event");
+        const wifi_event_sta_disconnected_t* info = static_cast<const wifi_event_sta_disconnected_t*>(data);
+        ESP_LOGW(TAG, "WiFi Disconnected (reason %u) → Posting Event", info->reason);
         self->_connected = false;
-        self->Post(new WiFiDisconnectedEvent());  // Dispatcher übernimmt Retry-Logik
-    } 
+        self->Post(new WiFiDisconnectedEvent("WiFi", info->reason));  // Dispatcher übernimmt Retry-Logik
+    }
     else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP) {
         ESP_LOGI(TAG, "WiFi Connected → Got IP");
         self->_connected = true;
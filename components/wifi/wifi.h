@@ -7,48 +7,55 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
+#include "reconnectPolicy.h"
+#include "wifiComm.h"
+#include <cstdint>
 #include <string>
 
-/**
- * @brief   WiFi communication class 
- * 
- */
-class WiFiComm 
-{
-    public:
-        WiFiComm();
-        ~WiFiComm() = default;
-    
-        void Start();                                  // startet interne Task
-        void Send(const std::string& payload);         // fügt Nachricht zur Queue hinzu
-    
-    private:
-        static void taskLoop(void* arg);               // loop zum Senden
-        QueueHandle_t _txQueue;
-        TaskHandle_t _task;
-};
-
 /**
  * @brief   WiFi Actor - Active Object class 
+ *
+ * Remembers the AP of the last association (BSSID, channel, auth mode) in
+ * NVS and reconnects straight to it, without a scan; only when that fails
+ * it scans all channels, with backoff (see ReconnectPolicy). After
+ * WIFI_MAX_RETRIES failed attempts it rests in FAILED and starts over
+ * after WIFI_FAILED_RETRY_MS.
  */
 class WiFiActor : public ActiveObject {
 public:
     WiFiActor();
 
-    void Dispatcher(Event* e) override;
+    void Dispatcher(const Event* e) override;
+    // Credentials, before the actor starts; the driver starts on OnStart
     void Configure(const std::string& ssid, const std::string& password);
+    // Broker for the telemetry (before the WiFi connects); messages are
+    // buffered until WiFi and broker are up
+    void ConfigureMqtt(const WiFiComm::Config& config) { _comm.Configure(config); }
 
     void Disconnect( void ); 
     void Shutdown( void ); 
 
-    void SendPayload( const std::string& json ) 
+    // Text (JSON) or binary (CBOR, see telemetryFormat.h) alike
+    bool SendPayload( std::string_view payload ) 
+    {
+        return _comm.Send( payload );
+    }
+
+    bool Publish( const char* topic, const void* payload, size_t length, uint8_t qos = 1 )
     {
-        _comm.Send( json );
+        return _comm.Publish( topic, payload, length, qos );
     }
 
+    // Payload written in place, see WiFiComm::Begin()
+    WiFiComm::Message BeginMessage( const char* topic, size_t maxLength, uint8_t qos = 1 )
+    {
+        return _comm.Begin( topic, maxLength, qos );
+    }
+
+    WiFiComm::Stats CommStats( ) { return _comm.GetStats( ); }
+    WiFiComm& Comm( ) { return _comm; }
+
 private:
-    static constexpr int MAX_RETRIES = 5;
-    
     enum class State {
         INIT,
         CONNECTING,
@@ -56,8 +63,32 @@ private:
         FAILED  // ➕ Neuer Zustand
     };
 
+    // The AP of the last association, as stored in NVS
+    struct ApCache {
+        uint8_t version;
+        uint8_t channel;
+        uint8_t authmode;
+        uint8_t reserved;
+        uint32_t ssidHash;      // cache of another network is ignored
+        uint8_t bssid[6];
+        uint8_t padding[2];
+    };
+
+    // Changes state; the MQTT publisher is online exactly in CONNECTED
+    void enter(State next);
 
+    void startDriver();
+    // New attempt sequence (boot, link loss, end of FAILED)
+    void beginReconnect();
+    void schedule(const ReconnectPolicy::Attempt& attempt);
+    void connect(ReconnectPolicy::Scan scan);
+    void onAttemptFailed(uint16_t reason);
+    void onConnected();
+    void giveUp();
+    void cancelAttempt();
 
+    void loadCache();
+    void storeCache();
 
     static void wifiEventHandler(void* arg, esp_event_base_t event_base,
                              int32_t event_id, void* event_data);
@@ -66,7 +97,16 @@ private:
     std::string _password;
     bool _connected;
     State _state;
-    int _retries = 0;
+
+    ReconnectPolicy _policy;
+    ApCache _cache;
+    bool _cacheValid;
+    ApCache _associated;            // written by the event handler on STA_CONNECTED
+    const Event* _reconnect;        // timer event of a delayed attempt
+    bool _attemptPending;           // _reconnect is armed
+    ReconnectPolicy::Scan _nextScan;
+    bool _outage;                   // the link was lost, WiFiRestored when back
+    int64_t _outageStartUs;
 
     WiFiComm _comm; 
 };
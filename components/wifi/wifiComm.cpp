@@ -0,0 +1,352 @@
+// wifiComm.cpp
+#include "wifiComm.h"
+#include <cstring>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "WiFiComm";
+
+WiFiComm::WiFiComm( )
+    : _ring( MQTT_TX_BUFFER_SIZE ),
+      _lock( xSemaphoreCreateMutex( )),
+      _task( nullptr ),
+      _online( false ),
+      _cursor( 0 ),
+      _inflight{ },
+      _inflightCount( 0 ),
+      _packetId( 0 ),
+      _lastAckUs( 0 ),
+      _backoffMs( MQTT_RECONNECT_MIN_MS ),
+      _nextAttemptUs( 0 ),
+      _stats{ }
+{
+}
+
+void WiFiComm::Configure( const Config& config )
+{
+    _config = config;
+    if( _config.window == 0 ) {
+        _config.window = 1;
+    }
+    if( _config.window > MQTT_MAX_INFLIGHT ) {
+        _config.window = MQTT_MAX_INFLIGHT;
+    }
+}
+
+void WiFiComm::Start( )
+{
+    xTaskCreate( taskLoop, "WiFiCommTask", 4096, this, 5, &_task );
+}
+
+void WiFiComm::SetOnline( bool online )
+{
+    _online = online;
+    if( _task != nullptr ) {
+        xTaskNotifyGive( _task );
+    }
+}
+
+bool WiFiComm::Send( std::string_view payload )
+{
+    return Publish( _config.topic.c_str( ), payload.data( ), payload.size( ), _config.qos );
+}
+
+bool WiFiComm::Publish( const char* topic, const void* payload, size_t length, uint8_t qos )
+{
+    Message message = Begin( topic, length, qos );
+    if( !message ) {
+        return false;
+    }
+    if( length > 0 ) {
+        memcpy( message.Data( ), payload, length );
+    }
+    return message.Commit( length );
+}
+
+WiFiComm::Message WiFiComm::Begin( const char* topic, size_t maxLength, uint8_t qos )
+{
+    size_t topicLength = strlen( topic );
+    if( topicLength == 0 || topicLength > MQTT_MAX_TOPIC || qos > 1 ) {
+        ESP_LOGW( TAG, "Invalid topic or QoS, message dropped" );
+        return Message( nullptr, nullptr, 0 );
+    }
+
+    xSemaphoreTake( _lock, portMAX_DELAY );
+    TxRing::Record* record = nullptr;
+    if( topicLength + maxLength <= _ring.MaxMessage( )) {
+        record = _ring.Reserve( topic, topicLength, maxLength, qos );
+        // Full: the oldest message gives way, unless it is on its way already
+        while( record == nullptr && !_ring.Empty( ) && _ring.Tail( ) == _cursor ) {
+            _ring.DropFront( );
+            _cursor = _ring.Tail( );
+            _stats.dropped++;
+            record = _ring.Reserve( topic, topicLength, maxLength, qos );
+        }
+    }
+    if( record == nullptr ) {
+        _stats.dropped++;
+        xSemaphoreGive( _lock );
+        ESP_LOGW( TAG, "⚠️ Buffer full, message dropped" );
+        return Message( nullptr, nullptr, 0 );
+    }
+    // Still locked: Message::Commit() or its destructor gives the lock back
+    return Message( this, record, maxLength );
+}
+
+void WiFiComm::commit( TxRing::Record* record, size_t length )
+{
+    _ring.Commit( record, length );
+    _stats.queued++;
+    xSemaphoreGive( _lock );
+    if( _task != nullptr ) {
+        xTaskNotifyGive( _task );
+    }
+}
+
+void WiFiComm::abandon( )
+{
+    _stats.dropped++;
+    xSemaphoreGive( _lock );
+}
+
+WiFiComm::Message::Message( WiFiComm* owner, TxRing::Record* record, size_t capacity )
+    : _owner( owner ),
+      _record( record ),
+      _capacity( capacity )
+{
+}
+
+WiFiComm::Message::~Message( )
+{
+    if( _record != nullptr ) {
+        _owner->abandon( );
+    }
+}
+
+bool WiFiComm::Message::Commit( size_t length )
+{
+    if( _record == nullptr || length > _capacity ) {
+        return false;
+    }
+    TxRing::Record* record = _record;
+    _record = nullptr;
+    _owner->commit( record, length );
+    return true;
+}
+
+WiFiComm::Stats WiFiComm::GetStats( )
+{
+    xSemaphoreTake( _lock, portMAX_DELAY );
+    Stats stats = _stats;
+    stats.buffered = _ring.Used( );
+    xSemaphoreGive( _lock );
+    return stats;
+}
+
+void WiFiComm::taskLoop( void* args )
+{
+    static_cast<WiFiComm*>( args )->run( );
+}
+
+bool WiFiComm::hasWork( )
+{
+    xSemaphoreTake( _lock, portMAX_DELAY );
+    bool work = _cursor != _ring.Head( );
+    xSemaphoreGive( _lock );
+    return work || _inflightCount > 0;
+}
+
+void WiFiComm::run( )
+{
+    while( pdTRUE )
+    {
+        bool idle = !hasWork( );
+        if( idle || !_online || !_client.IsConnected( )) {
+            // Send() and SetOnline() wake us up; the timeout paces
+            // reconnects and keep-alive
+            TickType_t wait = pdMS_TO_TICKS( 1000 );
+            if( _online && !_client.IsConnected( )) {
+                int64_t left = _nextAttemptUs - esp_timer_get_time( );
+                wait = left > 0 ? pdMS_TO_TICKS( left / 1000 + 1 ) : 0;
+            }
+            if( wait > 0 ) {
+                ulTaskNotifyTake( pdTRUE, wait );
+            }
+        }
+
+        if( !_online ) {
+            if( _client.IsConnected( )) {
+                _client.Disconnect( );
+                rewind( );
+                ESP_LOGI( TAG, "Offline, buffering" );
+            }
+            _backoffMs = MQTT_RECONNECT_MIN_MS;
+            _nextAttemptUs = 0;
+            continue;
+        }
+
+        if( !_client.IsConnected( )) {
+            if( esp_timer_get_time( ) < _nextAttemptUs || !connect( )) {
+                continue;
+            }
+        }
+
+        // Acknowledgements in, and a moment for more messages to gather
+        bool alive = _client.Poll( idle ? MQTT_BATCH_LINGER_MS : MQTT_POLL_MS, onAck, this ) && pump( );
+        if( alive && _inflightCount > 0 &&
+            esp_timer_get_time( ) - _lastAckUs > static_cast<int64_t>( MQTT_ACK_TIMEOUT_MS ) * 1000 ) {
+            ESP_LOGW( TAG, "No PUBACK for %u ms, reconnecting", (unsigned)MQTT_ACK_TIMEOUT_MS );
+            alive = false;
+        }
+        if( !alive ) {
+            _client.Close( );
+            rewind( );
+            _nextAttemptUs = esp_timer_get_time( ) + static_cast<int64_t>( _backoffMs ) * 1000;
+        }
+    }
+}
+
+bool WiFiComm::connect( )
+{
+    MqttClient::Options options;
+    options.host = _config.host.c_str( );
+    options.port = _config.port;
+    options.clientId = _config.clientId.c_str( );
+    options.username = _config.username.empty( ) ? nullptr : _config.username.c_str( );
+    options.password = _config.password.empty( ) ? nullptr : _config.password.c_str( );
+    options.keepAliveS = _config.keepAliveS;
+
+    if( _config.host.empty( ) || !_client.Connect( options )) {
+        _nextAttemptUs = esp_timer_get_time( ) + static_cast<int64_t>( _backoffMs ) * 1000;
+        _backoffMs = _backoffMs * 2 < MQTT_RECONNECT_MAX_MS ? _backoffMs * 2 : MQTT_RECONNECT_MAX_MS;
+        return false;
+    }
+
+    _backoffMs = MQTT_RECONNECT_MIN_MS;
+    xSemaphoreTake( _lock, portMAX_DELAY );
+    _stats.connects++;
+    size_t buffered = _ring.Used( );
+    xSemaphoreGive( _lock );
+    if( buffered > 0 ) {
+        ESP_LOGI( TAG, "Replaying %u buffered bytes", (unsigned)buffered );
+    }
+    return true;
+}
+
+void WiFiComm::rewind( )
+{
+    // Everything not acknowledged goes out again, in order
+    xSemaphoreTake( _lock, portMAX_DELAY );
+    _cursor = _ring.Tail( );
+    _inflightCount = 0;
+    xSemaphoreGive( _lock );
+}
+
+void WiFiComm::onAck( uint16_t packetId, void* context )
+{
+    WiFiComm* self = static_cast<WiFiComm*>( context );
+    // The broker acknowledges in order, so this is nearly always the oldest
+    for( size_t i = 0; i < self->_inflightCount; ++i ) {
+        if( self->_inflight[i].packetId == packetId && !self->_inflight[i].acked ) {
+            self->_inflight[i].acked = true;
+            break;
+        }
+    }
+
+    size_t done = 0;
+    while( done < self->_inflightCount && self->_inflight[done].acked ) {
+        done++;
+    }
+    if( done > 0 ) {
+        memmove( self->_inflight, self->_inflight + done, ( self->_inflightCount - done ) * sizeof( InFlight ));
+        self->_inflightCount -= done;
+        self->_lastAckUs = esp_timer_get_time( );
+        xSemaphoreTake( self->_lock, portMAX_DELAY );
+        self->_stats.acked += static_cast<uint32_t>( done );
+        self->release( );
+        xSemaphoreGive( self->_lock );
+    }
+}
+
+void WiFiComm::release( )
+{
+    // Records before the oldest unacknowledged one are done with
+    _ring.ReleaseTo( _inflightCount > 0 ? _inflight[0].position : _cursor );
+}
+
+bool WiFiComm::pump( )
+{
+    while( _inflightCount < _config.window ) {
+        // A full window is refilled once half of it is free again, so a
+        // burst leaves in full writes instead of one per trickling PUBACK
+        if( _inflightCount > 0 && _config.window - _inflightCount < _config.window / 2u ) {
+            return true;
+        }
+
+        iovec parts[MQTT_BATCH_PACKETS];
+        size_t count = 0;
+        size_t bytes = 0;
+        uint32_t replayed = 0;
+
+        // Claim packets under the lock; once _cursor is past them nobody
+        // else touches them, the write itself runs unlocked and straight
+        // from the ring
+        xSemaphoreTake( _lock, portMAX_DELAY );
+        while( _inflightCount < _config.window && count < MQTT_BATCH_PACKETS ) {
+            uint32_t position = _cursor;
+            TxRing::Record* record = _ring.At( position );
+            if( record == nullptr ) {
+                _cursor = position;
+                break;
+            }
+            bool resend = ( record->flags & TxRing::FLAG_SENT ) != 0;
+            if( resend && record->qos == 0 ) {
+                // At most once: written before the connection broke
+                _cursor = _ring.Next( position );
+                continue;
+            }
+            size_t length = record->PacketLength( );
+            if( count > 0 && bytes + length > MQTT_BATCH_BYTES ) {
+                // Next write; a packet bigger than a batch goes alone
+                break;
+            }
+
+            if( record->qos > 0 ) {
+                _packetId = _packetId == UINT16_MAX ? 1 : _packetId + 1;
+                record->SetPacketId( _packetId );
+                if( _inflightCount == 0 ) {
+                    _lastAckUs = esp_timer_get_time( );
+                }
+                _inflight[_inflightCount++] = InFlight{ position, _packetId, false };
+            }
+            if( resend ) {
+                record->SetDup( );
+                replayed++;
+            }
+            record->flags |= TxRing::FLAG_SENT;
+            parts[count].iov_base = record->Packet( );
+            parts[count].iov_len = length;
+            count++;
+            bytes += length;
+            _cursor = _ring.Next( position );
+        }
+        xSemaphoreGive( _lock );
+
+        if( count == 0 ) {
+            return true;
+        }
+        if( !_client.Write( parts, count )) {
+            return false;
+        }
+
+        xSemaphoreTake( _lock, portMAX_DELAY );
+        _stats.published += static_cast<uint32_t>( count );
+        _stats.replayed += replayed;
+        _stats.writes++;
+        _stats.bytes += static_cast<uint32_t>( bytes );
+        // QoS 0 messages are done once written
+        release( );
+        xSemaphoreGive( _lock );
+    }
+    return true;
+}
@@ -0,0 +1,192 @@
+#ifndef WIFI_COMM_H
+#define WIFI_COMM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mqttClient.h"
+#include "txRing.h"
+
+// Outgoing messages kept while offline or awaiting PUBACK (power of two)
+#ifndef MQTT_TX_BUFFER_SIZE
+#define MQTT_TX_BUFFER_SIZE 16384
+#endif
+
+// Upper bound of Config::window
+#ifndef MQTT_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT 32
+#endif
+
+// One socket write carries as many PUBLISH packets as fit (one TCP segment)
+#ifndef MQTT_BATCH_BYTES
+#define MQTT_BATCH_BYTES 1436
+#endif
+
+// Gather list entries per write (one per packet)
+#ifndef MQTT_BATCH_PACKETS
+#define MQTT_BATCH_PACKETS 16
+#endif
+
+// Time a new message waits for company before the write goes out
+#ifndef MQTT_BATCH_LINGER_MS
+#define MQTT_BATCH_LINGER_MS 20
+#endif
+
+// Wait for acknowledgements while messages are in flight
+#ifndef MQTT_POLL_MS
+#define MQTT_POLL_MS 50
+#endif
+
+// No PUBACK for this long: the connection is dropped and replayed
+#ifndef MQTT_ACK_TIMEOUT_MS
+#define MQTT_ACK_TIMEOUT_MS 10000
+#endif
+
+#ifndef MQTT_RECONNECT_MIN_MS
+#define MQTT_RECONNECT_MIN_MS 1000
+#endif
+
+#ifndef MQTT_RECONNECT_MAX_MS
+#define MQTT_RECONNECT_MAX_MS 60000
+#endif
+
+#define MQTT_MAX_TOPIC 128
+
+/**
+ * @brief   MQTT telemetry publisher with its own task.
+ *
+ * Send()/Publish() copy the message into a TxRing and return at once, from
+ * any task; Begin() hands out the ring space itself, so a serializer can
+ * write the payload in place. Either way the ring holds the finished
+ * PUBLISH packet and the network task sends it from there: it connects
+ * to the broker while the WiFi is online (SetOnline), gathers as many
+ * queued packets into one socket write as fit into MQTT_BATCH_BYTES and
+ * keeps up to Config::window QoS 1 messages in flight instead of waiting
+ * for every PUBACK; a full window is refilled once half of it is free.
+ * No heap allocation per message anywhere.
+ *
+ * Messages stay in the ring until they are acknowledged (QoS 1) or
+ * written (QoS 0). Offline the ring is the offline buffer: when it is
+ * full the oldest message gives way. After a reconnect everything not yet
+ * acknowledged is sent again in order (QoS 1 with the DUP flag).
+ */
+class WiFiComm
+{
+    public:
+        struct Config {
+            std::string host;
+            uint16_t port = 1883;
+            std::string clientId = "hydrotower";
+            std::string username;
+            std::string password;
+            std::string topic = "hydrotower/telemetry";    // for Send()
+            uint16_t keepAliveS = 30;
+            uint8_t qos = 1;                                // for Send()
+            uint8_t window = 8;                             // 1 = stop-and-wait
+        };
+
+        struct Stats {
+            uint32_t queued;
+            uint32_t dropped;
+            uint32_t published;
+            uint32_t acked;
+            uint32_t replayed;
+            uint32_t writes;
+            uint32_t bytes;
+            uint32_t connects;
+            size_t buffered;
+        };
+
+        /**
+         * @brief   Ring space for one message, filled in place.
+         *
+         * The ring stays locked until Commit() or destruction, so write
+         * the payload right away (no blocking calls in between). A message
+         * that is not committed is discarded.
+         */
+        class Message
+        {
+            public:
+                ~Message();
+
+                explicit operator bool() const { return _record != nullptr; }
+                uint8_t* Data() { return _record != nullptr ? _record->Payload() : nullptr; }
+                char* Text() { return reinterpret_cast<char*>(Data()); }
+                size_t Capacity() const { return _capacity; }
+
+                // Queues the first length bytes; false if there was no room
+                bool Commit(size_t length);
+
+            private:
+                friend class WiFiComm;
+                Message(WiFiComm* owner, TxRing::Record* record, size_t capacity);
+
+                WiFiComm* _owner;
+                TxRing::Record* _record;
+                size_t _capacity;
+
+                // Disallow copy and assignment
+                Message(const Message&) = delete;
+                Message& operator=(const Message&) = delete;
+        };
+
+        WiFiComm();
+        ~WiFiComm() = default;
+
+        void Configure(const Config& config);          // vor Start()
+        void Start();                                  // startet interne Task
+        void SetOnline(bool online);                   // WLAN verbunden / getrennt
+
+        // Queue a message; false if it was dropped (too big, buffer full)
+        bool Send(std::string_view payload);           // Standard-Topic
+        bool Publish(const char* topic, const void* payload, size_t length, uint8_t qos);
+        // Room for up to maxLength payload bytes (evicting old messages
+        // like Publish); empty if the message cannot be queued
+        Message Begin(const char* topic, size_t maxLength, uint8_t qos);
+
+        Stats GetStats();
+
+    private:
+        struct InFlight {
+            uint32_t position;
+            uint16_t packetId;
+            bool acked;
+        };
+
+        static void taskLoop(void* arg);               // loop zum Senden
+        void run();
+        bool connect();
+        void rewind();
+        bool pump();
+        bool hasWork();
+        void release();
+        static void onAck(uint16_t packetId, void* context);
+
+        void commit(TxRing::Record* record, size_t length);
+        void abandon();
+
+        Config _config;
+        TxRing _ring;
+        MqttClient _client;
+        SemaphoreHandle_t _lock;
+        TaskHandle_t _task;
+        volatile bool _online;
+
+        // Network task only, except _cursor (under _lock)
+        uint32_t _cursor;
+        InFlight _inflight[MQTT_MAX_INFLIGHT];
+        size_t _inflightCount;
+        uint16_t _packetId;
+        int64_t _lastAckUs;
+        uint32_t _backoffMs;
+        int64_t _nextAttemptUs;
+
+        Stats _stats;
+};
+
+#endif // WIFI_COMM_H
@@ -0,0 +1,298 @@
+// Bytes per sample and encode time of the telemetry encodings on one hour
+// of synthetic sensor data shaped like the tower's: level, flow and
+// volume every second, two DS18B20 probes every two seconds (0.0625 °C
+// steps), all with a few milliseconds of timer jitter.
+//
+//   json/sample   one JsonWriter object per sample and MQTT message (the
+//                 naive publisher)
+//   json/batch    one JSON message per minute, times as deltas
+//   cbor/plain    the same batch in CBOR, float32 values, no packing
+//   cbor/gorilla  SeriesPublisher's format (delta-of-delta, XOR floats)
+//
+// "wire" adds the MQTT PUBLISH header and topic of every message. Host
+// timings only compare the encoders with each other; on the ESP32-S3
+// expect them an order of magnitude higher.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "cborWriter.h"
+#include "jsonWriter.h"
+#include "seriesPacker.h"
+#include "telemetryDecoder.h"
+#include "telemetryFormat.h"
+
+namespace
+{
+
+struct Point {
+    uint64_t timeMs;
+    float value;
+};
+
+struct SeriesData {
+    uint8_t quantity;
+    uint8_t channel;
+    const char* topic;      // per-sample topic of json/sample
+    std::vector<Point> points;
+};
+
+constexpr uint64_t DURATION_MS = 3600 * 1000;
+constexpr uint64_t BATCH_MS = 60 * 1000;
+constexpr size_t BATCH_TOPIC = sizeof("hydrotower/samples") - 1;
+
+uint32_t random32()
+{
+    static uint32_t state = 12345;
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+double uniform()
+{
+    return (random32() & 0xFFFF) / 65536.0;
+}
+
+std::vector<SeriesData> generate()
+{
+    std::vector<SeriesData> all = {
+        { 1, 0, "hydrotower/sensor/level/0", {} },
+        { 2, 0, "hydrotower/sensor/flow/0", {} },
+        { 3, 0, "hydrotower/sensor/volume/0", {} },
+        { 4, 0, "hydrotower/sensor/temperature/0", {} },
+        { 4, 1, "hydrotower/sensor/temperature/1", {} },
+    };
+    double volume = 0;
+    for (uint64_t t = 1000; t < DURATION_MS; t += 1000) {
+        uint64_t jitter = random32() % 5;
+        bool pumping = (t / 900000) % 2 == 0;   // 15 min on, 15 off
+        double level = 62.0 - t / 1.0e6 + (uniform() - 0.5) * 0.4;
+        double flow = pumping ? 3.2 + (uniform() - 0.5) * 0.05 : 0.0;
+        volume += flow / 60.0;
+        all[0].points.push_back({ t + jitter, static_cast<float>(std::round(level * 10) / 10) });
+        all[1].points.push_back({ t + jitter + 1, static_cast<float>(std::round(flow * 100) / 100) });
+        all[2].points.push_back({ t + jitter + 1, static_cast<float>(volume) });
+        if (t % 2000 == 0) {
+            for (int probe = 0; probe < 2; ++probe) {
+                double temperature = 21.0 + probe * 0.8 + std::sin(t / 600000.0) * 0.6 + (uniform() - 0.5) * 0.1;
+                all[3 + probe].points.push_back(
+                    { t + 750 + jitter, static_cast<float>(std::round(temperature * 16) / 16) });
+            }
+        }
+    }
+    return all;
+}
+
+size_t publishOverhead(size_t topicLength, size_t payloadLength)
+{
+    size_t remaining = 2 + topicLength + 2 + payloadLength;
+    size_t lengthBytes = remaining < 128 ? 1 : remaining < 16384 ? 2 : 3;
+    return 1 + lengthBytes + 2 + topicLength + 2;
+}
+
+// One minute of every series
+struct Batch {
+    uint64_t end;
+    std::vector<std::vector<Point>> series;
+};
+
+std::vector<Batch> split(const std::vector<SeriesData>& all)
+{
+    std::vector<Batch> batches;
+    for (uint64_t from = 0; from < DURATION_MS; from += BATCH_MS) {
+        Batch batch{ from + BATCH_MS, std::vector<std::vector<Point>>(all.size()) };
+        for (size_t i = 0; i < all.size(); ++i) {
+            for (const Point& p : all[i].points) {
+                if (p.timeMs >= from && p.timeMs < from + BATCH_MS) {
+                    batch.series[i].push_back(p);
+                }
+            }
+        }
+        batches.push_back(std::move(batch));
+    }
+    return batches;
+}
+
+struct Result {
+    size_t payload = 0;
+    size_t wire = 0;
+    size_t messages = 0;
+};
+
+template <typename EncodeBatch>
+Result runBatches(const std::vector<SeriesData>& all, const std::vector<Batch>& batches, EncodeBatch encode)
+{
+    Result result;
+    static uint8_t buffer[64 * 1024];
+    for (const Batch& batch : batches) {
+        size_t length = encode(all, batch, buffer, sizeof(buffer));
+        result.payload += length;
+        result.wire += length + publishOverhead(BATCH_TOPIC, length);
+        result.messages++;
+    }
+    return result;
+}
+
+size_t jsonBatch(const std::vector<SeriesData>& all, const Batch& batch, uint8_t* out, size_t capacity)
+{
+    JsonWriter json(reinterpret_cast<char*>(out), capacity);
+    json.BeginObject().Key("uptime").Integer(static_cast<int64_t>(batch.end)).Key("series").BeginArray();
+    for (size_t i = 0; i < all.size(); ++i) {
+        const std::vector<Point>& points = batch.series[i];
+        json.BeginObject().Key("q").String(Telemetry::QuantityName(all[i].quantity)).Key("c").Integer(all[i].channel);
+        json.Key("t").BeginArray();
+        for (size_t n = 0; n < points.size(); ++n) {
+            json.Integer(static_cast<int64_t>(n == 0 ? points[n].timeMs : points[n].timeMs - points[n - 1].timeMs));
+        }
+        json.EndArray().Key("v").BeginArray();
+        for (const Point& p : points) {
+            json.Number(p.value, 4);
+        }
+        json.EndArray().EndObject();
+    }
+    json.EndArray().EndObject();
+    return json.Ok() ? json.Length() : 0;
+}
+
+size_t cborPlain(const std::vector<SeriesData>& all, const Batch& batch, uint8_t* out, size_t capacity)
+{
+    CborWriter cbor(out, capacity);
+    cbor.BeginMap(2).Unsigned(1).Unsigned(batch.end).Unsigned(3).BeginArray(all.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        const std::vector<Point>& points = batch.series[i];
+        cbor.BeginMap(4).Unsigned(0).Unsigned(all[i].quantity).Unsigned(1).Unsigned(all[i].channel);
+        cbor.Unsigned(5).BeginArray(points.size());
+        for (size_t n = 0; n < points.size(); ++n) {
+            cbor.Unsigned(n == 0 ? points[n].timeMs : points[n].timeMs - points[n - 1].timeMs);
+        }
+        cbor.Unsigned(6).BeginArray(points.size());
+        for (const Point& p : points) {
+            cbor.Float(p.value);
+        }
+    }
+    return cbor.Ok() ? cbor.Length() : 0;
+}
+
+size_t cborGorilla(const std::vector<SeriesData>& all, const Batch& batch, uint8_t* out, size_t capacity)
+{
+    // As SeriesPublisher: packers with their buffers, reused batch after batch
+    static uint8_t buffers[8][4096];
+    static SeriesPacker packers[8] = {
+        { buffers[0], sizeof(buffers[0]) }, { buffers[1], sizeof(buffers[1]) }, { buffers[2], sizeof(buffers[2]) },
+        { buffers[3], sizeof(buffers[3]) }, { buffers[4], sizeof(buffers[4]) }, { buffers[5], sizeof(buffers[5]) },
+        { buffers[6], sizeof(buffers[6]) }, { buffers[7], sizeof(buffers[7]) },
+    };
+    TelemetryFormat::SeriesView views[8];
+    for (size_t i = 0; i < all.size(); ++i) {
+        packers[i].Reset();
+        for (const Point& p : batch.series[i]) {
+            packers[i].Add(p.timeMs, p.value);
+        }
+        views[i] = TelemetryFormat::SeriesView{ all[i].quantity, all[i].channel, &packers[i] };
+    }
+    CborWriter cbor(out, capacity);
+    return TelemetryFormat::WriteMessage(cbor, batch.end, 0, views, all.size()) ? cbor.Length() : 0;
+}
+
+Result jsonPerSample(const std::vector<SeriesData>& all)
+{
+    Result result;
+    char buffer[128];
+    for (const SeriesData& series : all) {
+        size_t topicLength = strlen(series.topic);
+        for (const Point& p : series.points) {
+            JsonWriter json(buffer, sizeof(buffer));
+            json.BeginObject().Key("v").Number(p.value, 4).Key("t").Integer(static_cast<int64_t>(p.timeMs)).EndObject();
+            result.payload += json.Length();
+            result.wire += json.Length() + publishOverhead(topicLength, json.Length());
+            result.messages++;
+        }
+    }
+    return result;
+}
+
+template <typename Run>
+double nanosecondsPerSample(Run run, size_t samples)
+{
+    // Best of a few rounds, the machine is not ours alone
+    double best = 1e30;
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / samples;
+        best = ns < best ? ns : best;
+    }
+    return best;
+}
+
+bool roundTrip(const std::vector<SeriesData>& all, const std::vector<Batch>& batches)
+{
+    static uint8_t buffer[64 * 1024];
+    for (const Batch& batch : batches) {
+        size_t length = cborGorilla(all, batch, buffer, sizeof(buffer));
+        Telemetry::Message message;
+        std::string error;
+        if (length == 0 || !Telemetry::DecodeMessage(buffer, length, message, &error)) {
+            printf("decode failed: %s\n", error.c_str());
+            return false;
+        }
+        for (size_t i = 0; i < all.size(); ++i) {
+            const std::vector<Point>& sent = batch.series[i];
+            const std::vector<Telemetry::Sample>& got = message.series[i].samples;
+            if (got.size() != sent.size()) {
+                printf("sample count differs in series %zu\n", i);
+                return false;
+            }
+            for (size_t n = 0; n < sent.size(); ++n) {
+                if (got[n].uptimeMs != sent[n].timeMs || memcmp(&got[n].value, &sent[n].value, sizeof(float)) != 0) {
+                    printf("mismatch in series %zu sample %zu\n", i, n);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<SeriesData> all = generate();
+    std::vector<Batch> batches = split(all);
+    size_t samples = 0;
+    for (const SeriesData& series : all) {
+        samples += series.points.size();
+    }
+
+    struct Row {
+        const char* name;
+        Result result;
+        double ns;
+    };
+    Row rows[] = {
+        { "json/sample", jsonPerSample(all), nanosecondsPerSample([&] { jsonPerSample(all); }, samples) },
+        { "json/batch", runBatches(all, batches, jsonBatch),
+          nanosecondsPerSample([&] { runBatches(all, batches, jsonBatch); }, samples) },
+        { "cbor/plain", runBatches(all, batches, cborPlain),
+          nanosecondsPerSample([&] { runBatches(all, batches, cborPlain); }, samples) },
+        { "cbor/gorilla", runBatches(all, batches, cborGorilla),
+          nanosecondsPerSample([&] { runBatches(all, batches, cborGorilla); }, samples) },
+    };
+
+    printf("%zu samples in %zu series, one hour, batches of %llu s\n\n", samples, all.size(),
+           (unsigned long long)(BATCH_MS / 1000));
+    printf("%-14s %9s %10s %12s %12s %12s\n", "encoding", "messages", "bytes", "bytes/sample", "wire/sample",
+           "ns/sample");
+    for (const Row& row : rows) {
+        printf("%-14s %9zu %10zu %12.2f %12.2f %12.1f\n", row.name, row.result.messages, row.result.payload,
+               static_cast<double>(row.result.payload) / samples, static_cast<double>(row.result.wire) / samples,
+               row.ns);
+    }
+
+    bool ok = roundTrip(all, batches);
+    printf("\ncbor/gorilla round trip: %s\n", ok ? "bit-exact" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+// Prints binary telemetry messages as one JSON line per sample, e.g.
+//   mosquitto_sub -t hydrotower/samples -C 1 > batch.bin
+//   telemetryDump batch.bin
+#include <cstdio>
+#include <iterator>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "telemetryDecoder.h"
+
+static bool dump(const std::vector<uint8_t>& data, const char* name)
+{
+    Telemetry::Message message;
+    std::string error;
+    if (!Telemetry::DecodeMessage(data.data(), data.size(), message, &error)) {
+        fprintf(stderr, "%s: %s\n", name, error.c_str());
+        return false;
+    }
+    for (const Telemetry::Series& series : message.series) {
+        for (const Telemetry::Sample& sample : series.samples) {
+            printf("{\"quantity\":\"%s\",\"channel\":%u,\"uptime_ms\":%llu", Telemetry::QuantityName(series.quantity),
+                   (unsigned)series.channel, (unsigned long long)sample.uptimeMs);
+            if (sample.unixMs >= 0) {
+                printf(",\"unix_ms\":%lld", (long long)sample.unixMs);
+            }
+            printf(",\"value\":%.9g}\n", sample.value);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool ok = true;
+    if (argc < 2) {
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        ok = dump(data, "stdin");
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "%s: cannot open\n", argv[i]);
+            ok = false;
+            continue;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        ok = dump(data, argv[i]) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+// Host mock (tools/wifiSim): seeded, so runs are reproducible
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
@@ -0,0 +1,529 @@
+#include "mockWifi.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t PROBE_MS = 120;
+constexpr uint32_t SCAN_MS = 13 * PROBE_MS;
+constexpr uint32_t ASSOC_MS = 180;
+constexpr uint32_t DHCP_MS = 120;
+
+Clock::duration deviceToReal(uint32_t deviceMs)
+{
+    return std::chrono::microseconds(static_cast<uint64_t>(deviceMs) * 1000 / SIM_TIME_SCALE);
+}
+
+struct Handler {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void* arg;
+};
+
+struct Ap {
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool up;
+};
+
+/**
+ * The driver: a thread working off timed actions, which also delivers the
+ * events to the registered handlers.
+ */
+class Driver {
+public:
+    Driver() : _ap{ { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 }, 6, true }, _config{}, _associated(false),
+               _attempt(0), _ipCount(0), _stats{}, _stop(false), _thread([this] { run(); })
+    {
+    }
+
+    ~Driver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        _thread.join();
+    }
+
+    std::mutex& Mutex() { return _mutex; }
+
+    void Register(const Handler& handler)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _handlers.push_back(handler);
+    }
+
+    void SetConfig(const wifi_config_t& config)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config = config;
+    }
+
+    void Start()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        emitLocked(0, WIFI_EVENT, WIFI_EVENT_STA_START, {});
+    }
+
+    void Connect()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint32_t attempt = ++_attempt;
+        bool fast = _config.sta.bssid_set && _config.sta.channel != 0 && _config.sta.scan_method == WIFI_FAST_SCAN;
+        uint8_t bssid[6];
+        memcpy(bssid, _config.sta.bssid, sizeof(bssid));
+        uint8_t channel = _config.sta.channel;
+        if (fast) {
+            _stats.fastAttempts++;
+        } else {
+            _stats.fullScans++;
+        }
+        at(fast ? PROBE_MS : SCAN_MS, [this, attempt, fast, bssid, channel] {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (attempt != _attempt) {
+                return;
+            }
+            bool found = _ap.up && (!fast || (memcmp(bssid, _ap.bssid, sizeof(bssid)) == 0 && channel == _ap.channel));
+            if (!found) {
+                disconnectedLocked(WIFI_REASON_NO_AP_FOUND);
+                return;
+            }
+            at(ASSOC_MS, [this, attempt] { associate(attempt); });
+        });
+    }
+
+    void Disconnect(uint8_t reason)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _attempt++;
+        if (_associated) {
+            _associated = false;
+            disconnectedLocked(reason);
+        }
+    }
+
+    void SetAp(const uint8_t bssid[6], uint8_t channel)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        memcpy(_ap.bssid, bssid, sizeof(_ap.bssid));
+        _ap.channel = channel;
+    }
+
+    void SetApUp(bool up)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _ap.up = up;
+        }
+        if (!up) {
+            Disconnect(WIFI_REASON_BEACON_TIMEOUT);
+        }
+    }
+
+    bool WaitForIp(uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        uint32_t seen = _ipCount;
+        return _ipChanged.wait_for(lock, deviceToReal(timeoutMs), [&] { return _ipCount != seen; });
+    }
+
+    MockWifi::Stats& Stats() { return _stats; }
+
+private:
+    using Action = std::function<void()>;
+
+    void associate(uint32_t attempt)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (attempt != _attempt) {
+            return;
+        }
+        if (!_ap.up) {
+            disconnectedLocked(WIFI_REASON_ASSOC_FAIL);
+            return;
+        }
+        _associated = true;
+        wifi_event_sta_connected_t info = {};
+        memcpy(info.ssid, _config.sta.ssid, sizeof(info.ssid));
+        info.ssid_len = static_cast<uint8_t>(strnlen(reinterpret_cast<const char*>(info.ssid), sizeof(info.ssid)));
+        memcpy(info.bssid, _ap.bssid, sizeof(info.bssid));
+        info.channel = _ap.channel;
+        info.authmode = WIFI_AUTH_WPA2_PSK;
+        emitLocked(0, WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, toBytes(info));
+
+        at(DHCP_MS, [this, attempt] {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (attempt != _attempt || !_associated) {
+                return;
+            }
+            ip_event_got_ip_t ip = {};
+            ip.ip_info.ip.addr = 0x0a01a8c0;     // 192.168.1.10
+            emitLocked(0, IP_EVENT, IP_EVENT_STA_GOT_IP, toBytes(ip));
+            at(0, [this] {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _ipCount++;
+                _ipChanged.notify_all();
+            });
+        });
+    }
+
+    void disconnectedLocked(uint8_t reason)
+    {
+        wifi_event_sta_disconnected_t info = {};
+        memcpy(info.ssid, _config.sta.ssid, sizeof(info.ssid));
+        memcpy(info.bssid, _ap.bssid, sizeof(info.bssid));
+        info.reason = reason;
+        info.rssi = -60;
+        emitLocked(0, WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, toBytes(info));
+    }
+
+    template <typename T>
+    static std::vector<uint8_t> toBytes(const T& value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        return std::vector<uint8_t>(bytes, bytes + sizeof(value));
+    }
+
+    void emitLocked(uint32_t deviceMs, esp_event_base_t base, int32_t id, std::vector<uint8_t> data)
+    {
+        at(deviceMs, [this, base, id, data]() mutable {
+            std::vector<Handler> handlers;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                handlers = _handlers;
+            }
+            for (const Handler& h : handlers) {
+                if (h.base == base && (h.id == ESP_EVENT_ANY_ID || h.id == id)) {
+                    h.handler(h.arg, base, id, data.empty() ? nullptr : data.data());
+                }
+            }
+        });
+    }
+
+    // Called with the mutex held
+    void at(uint32_t deviceMs, Action action)
+    {
+        _actions.emplace(Clock::now() + deviceToReal(deviceMs), std::move(action));
+        _wake.notify_all();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_stop) {
+            if (_actions.empty()) {
+                _wake.wait(lock);
+                continue;
+            }
+            auto next = _actions.begin();
+            if (next->first > Clock::now()) {
+                _wake.wait_until(lock, next->first);
+                continue;
+            }
+            Action action = std::move(next->second);
+            _actions.erase(next);
+            lock.unlock();
+            action();
+            lock.lock();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _ipChanged;
+    std::multimap<Clock::time_point, Action> _actions;
+    std::vector<Handler> _handlers;
+    Ap _ap;
+    wifi_config_t _config;
+    bool _associated;
+    uint32_t _attempt;          // bumped to cancel the attempt in flight
+    uint32_t _ipCount;
+    MockWifi::Stats _stats;
+    bool _stop;
+    std::thread _thread;
+};
+
+Driver& driver()
+{
+    static Driver instance;
+    return instance;
+}
+
+const Clock::time_point START = Clock::now();
+
+// NVS: "namespace/key" -> blob, written through to the file on commit
+std::mutex nvsMutex;
+std::string nvsPath;
+std::map<std::string, std::vector<uint8_t>> nvsBlobs;
+std::vector<std::string> nvsHandles;
+
+void nvsSave()
+{
+    std::ofstream out(nvsPath, std::ios::trunc);
+    for (const auto& entry : nvsBlobs) {
+        out << entry.first;
+        for (uint8_t b : entry.second) {
+            char hex[4];
+            snprintf(hex, sizeof(hex), " %02x", b);
+            out << hex;
+        }
+        out << '\n';
+    }
+}
+
+void nvsLoad()
+{
+    nvsBlobs.clear();
+    std::ifstream in(nvsPath);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        fields >> name;
+        std::vector<uint8_t> blob;
+        unsigned b;
+        while (fields >> std::hex >> b) {
+            blob.push_back(static_cast<uint8_t>(b));
+        }
+        nvsBlobs[name] = blob;
+    }
+}
+
+std::string nvsName(nvs_handle_t handle, const char* key)
+{
+    return nvsHandles[handle - 1] + "/" + key;
+}
+
+} // namespace
+
+namespace MockWifi
+{
+
+void SetNvsFile(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    nvsPath = path;
+    nvsLoad();
+}
+
+void SetAp(const uint8_t bssid[6], uint8_t channel)
+{
+    driver().SetAp(bssid, channel);
+}
+
+void SetApUp(bool up)
+{
+    driver().SetApUp(up);
+}
+
+void DropLink(uint8_t reason)
+{
+    driver().Disconnect(reason);
+}
+
+bool WaitForIp(uint32_t timeoutMs)
+{
+    return driver().WaitForIp(timeoutMs);
+}
+
+Stats GetStats()
+{
+    std::lock_guard<std::mutex> lock(driver().Mutex());
+    return driver().Stats();
+}
+
+void ResetStats()
+{
+    std::lock_guard<std::mutex> lock(driver().Mutex());
+    driver().Stats() = Stats{};
+}
+
+uint64_t NowMs()
+{
+    auto real = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - START).count();
+    return static_cast<uint64_t>(real) * SIM_TIME_SCALE / 1000;
+}
+
+void SleepMs(uint32_t deviceMs)
+{
+    std::this_thread::sleep_for(deviceToReal(deviceMs));
+}
+
+} // namespace MockWifi
+
+// --- ESP-IDF API --------------------------------------------------------
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler,
+                                              void* arg, esp_event_handler_instance_t* instance)
+{
+    driver().Register(Handler{ base, id, handler, arg });
+    if (instance != nullptr) {
+        *instance = nullptr;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t* esp_netif_create_default_wifi_sta(void)
+{
+    return nullptr;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t*)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t, wifi_config_t* config)
+{
+    driver().SetConfig(*config);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    driver().Start();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop(void)
+{
+    driver().Disconnect(WIFI_REASON_ASSOC_LEAVE);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    driver().Connect();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    driver().Disconnect(WIFI_REASON_ASSOC_LEAVE);
+    return ESP_OK;
+}
+
+uint32_t esp_random(void)
+{
+    static std::mt19937 generator(1);
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    return generator();
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    nvsBlobs.clear();
+    nvsSave();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* handle)
+{
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    if (mode == NVS_READONLY) {
+        std::string prefix = std::string(name) + "/";
+        auto it = nvsBlobs.lower_bound(prefix);
+        if (it == nvsBlobs.end() || it->first.compare(0, prefix.size(), prefix) != 0) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+    nvsHandles.push_back(name);
+    *handle = static_cast<nvs_handle_t>(nvsHandles.size());
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* value, size_t* length)
+{
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    auto it = nvsBlobs.find(nvsName(handle, key));
+    if (it == nvsBlobs.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (value == nullptr) {
+        *length = it->second.size();
+        return ESP_OK;
+    }
+    if (*length < it->second.size()) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(value, it->second.data(), it->second.size());
+    *length = it->second.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    nvsBlobs[nvsName(handle, key)] = std::vector<uint8_t>(bytes, bytes + length);
+    std::lock_guard<std::mutex> stats(driver().Mutex());
+    driver().Stats().nvsWrites++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t)
+{
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    if (!nvsPath.empty()) {
+        nvsSave();
+    }
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t)
+{
+}
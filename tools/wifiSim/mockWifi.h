@@ -0,0 +1,59 @@
+#ifndef MOCK_WIFI_H
+#define MOCK_WIFI_H
+
+#include <cstdint>
+#include <string>
+
+// Everything runs SIM_TIME_SCALE times faster than on the device; the
+// WiFi actor's backoff constants are scaled the same way (CMakeLists.txt)
+#ifndef SIM_TIME_SCALE
+#define SIM_TIME_SCALE 10
+#endif
+
+/**
+ * Simulated access point and station driver behind the mock esp_wifi.h.
+ *
+ * One AP with the configured SSID. Device-time costs of a connect, as
+ * seen on an ESP32 against a home router:
+ *
+ *   targeted probe (cached BSSID/channel)  120 ms
+ *   full scan, 13 channels                1560 ms
+ *   auth, assoc and 4-way handshake        180 ms
+ *   DHCP                                   120 ms
+ *
+ * A targeted attempt at a BSSID or channel the AP no longer has fails
+ * after the probe with WIFI_REASON_NO_AP_FOUND, a full scan without AP
+ * after the whole scan. Driver events run on one mock thread, in order,
+ * like the ESP-IDF event task.
+ */
+namespace MockWifi
+{
+
+struct Stats {
+    uint32_t fastAttempts;      // esp_wifi_connect() with a BSSID/channel
+    uint32_t fullScans;         // esp_wifi_connect() scanning all channels
+    uint32_t nvsWrites;
+};
+
+// Where the mock NVS keeps its blobs; the file survives a "reboot"
+void SetNvsFile(const std::string& path);
+
+void SetAp(const uint8_t bssid[6], uint8_t channel);
+// Down drops an associated station (beacon timeout)
+void SetApUp(bool up);
+// Link lost with the AP still up (interference, roaming glitch)
+void DropLink(uint8_t reason);
+
+// Waits for the next IP_EVENT_STA_GOT_IP; false on timeout (device ms)
+bool WaitForIp(uint32_t timeoutMs);
+
+Stats GetStats();
+void ResetStats();
+
+// Device time since the process started
+uint64_t NowMs();
+void SleepMs(uint32_t deviceMs);
+
+} // namespace MockWifi
+
+#endif // MOCK_WIFI_H
@@ -0,0 +1,214 @@
+// Reconnect times of the WiFi actor against a simulated AP (mockWifi.h).
+//
+// Every scenario runs the real WiFiActor in a fresh process, a "boot";
+// the mock NVS file carries the AP cache from one boot to the next like
+// the flash does. Times are device time from the trigger to the IP:
+//
+//   cold boot        nothing cached: full scan
+//   warm boot        cached BSSID/channel: straight to the AP
+//   link lost        beacon loss with the AP still there
+//   AP reboot        AP away for 20 s; time counted from its return, the
+//                    cost of the backoff
+//   AP gone          AP away until the actor gives up (FAILED); time from
+//                    its return until the timed recovery connects
+//   AP moved         AP switched to channel 11: the targeted attempt
+//                    fails, a full scan finds it and updates the cache
+//   boot after move  the new channel is cached
+//
+// Usage: wifiSim [-v]   (-v shows the actor's log)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "events.h"
+#include "mockWifi.h"
+#include "wifi.h"
+
+namespace
+{
+
+constexpr uint32_t TIMEOUT_MS = 180000;
+constexpr uint32_t AP_REBOOT_MS = 20000;
+// Past the last backoff step, so the actor sits in FAILED
+constexpr uint32_t AP_GONE_MS = 60000;
+constexpr uint32_t SETTLE_MS = 500;
+const char* NVS_FILE = "wifiSim.nvs";
+
+struct Result {
+    bool ok;
+    uint64_t elapsedMs;
+    MockWifi::Stats stats;
+    uint32_t attemptsDown;      // attempts while the AP was away
+};
+
+WiFiActor* boot()
+{
+    MockWifi::SetNvsFile(NVS_FILE);
+    WiFiActor* wifi = new WiFiActor();      // lives until the process ends, like on the device
+    wifi->Configure("HydroTower", "secret-passphrase");
+    wifi->Start();
+    wifi->Post(new OnStart("Sim"));
+    return wifi;
+}
+
+Result measure(uint64_t since, uint32_t attemptsDown = 0)
+{
+    Result result = {};
+    result.ok = MockWifi::WaitForIp(TIMEOUT_MS);
+    result.elapsedMs = MockWifi::NowMs() - since;
+    // The actor handles the connect (and stores the cache) after the event
+    MockWifi::SleepMs(SETTLE_MS);
+    result.stats = MockWifi::GetStats();
+    result.attemptsDown = attemptsDown;
+    return result;
+}
+
+// Booted and connected, counters cleared
+void bootConnected()
+{
+    boot();
+    MockWifi::WaitForIp(TIMEOUT_MS);
+    MockWifi::SleepMs(SETTLE_MS);
+    MockWifi::ResetStats();
+}
+
+uint32_t attempts()
+{
+    MockWifi::Stats stats = MockWifi::GetStats();
+    return stats.fastAttempts + stats.fullScans;
+}
+
+Result coldBoot()
+{
+    uint64_t start = MockWifi::NowMs();
+    boot();
+    return measure(start);
+}
+
+Result warmBoot()
+{
+    return coldBoot();
+}
+
+Result linkLost()
+{
+    bootConnected();
+    uint64_t start = MockWifi::NowMs();
+    MockWifi::DropLink(WIFI_REASON_BEACON_TIMEOUT);
+    return measure(start);
+}
+
+Result apAway(uint32_t awayMs)
+{
+    bootConnected();
+    MockWifi::SetApUp(false);
+    MockWifi::SleepMs(awayMs);
+    uint32_t down = attempts();
+    uint64_t back = MockWifi::NowMs();
+    MockWifi::SetApUp(true);
+    return measure(back, down);
+}
+
+Result apReboot()
+{
+    return apAway(AP_REBOOT_MS);
+}
+
+Result apGone()
+{
+    return apAway(AP_GONE_MS);
+}
+
+Result apMoved()
+{
+    bootConnected();
+    const uint8_t bssid[6] = { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 };
+    uint64_t start = MockWifi::NowMs();
+    MockWifi::SetAp(bssid, 11);
+    MockWifi::DropLink(WIFI_REASON_BEACON_TIMEOUT);
+    return measure(start);
+}
+
+Result bootAfterMove()
+{
+    const uint8_t bssid[6] = { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 };
+    MockWifi::SetAp(bssid, 11);
+    return coldBoot();
+}
+
+struct Scenario {
+    const char* name;
+    Result (*run)();
+};
+
+const Scenario SCENARIOS[] = {
+    { "cold boot", coldBoot },
+    { "warm boot", warmBoot },
+    { "link lost", linkLost },
+    { "AP reboot (20 s)", apReboot },
+    { "AP gone (FAILED)", apGone },
+    { "AP moved (ch 6 -> 11)", apMoved },
+    { "boot after move", bootAfterMove },
+};
+
+// One boot in a child process; the result comes back through a pipe
+bool runScenario(const Scenario& scenario, bool verbose, Result& result)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        if (!verbose) {
+            freopen("/dev/null", "w", stdout);
+            freopen("/dev/null", "w", stderr);
+        }
+        Result r = scenario.run();
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        fflush(stdout);
+        _exit(written == sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == sizeof(result);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    remove(NVS_FILE);
+
+    printf("WiFi reconnect, device time (simulated %dx faster)\n", SIM_TIME_SCALE);
+    printf("fast attempts: %d, backoff %d..%d ms, max retries %d, FAILED for %d ms\n\n",
+           WIFI_FAST_ATTEMPTS, WIFI_BACKOFF_MIN_MS * SIM_TIME_SCALE, WIFI_BACKOFF_MAX_MS * SIM_TIME_SCALE,
+           WIFI_MAX_RETRIES, WIFI_FAILED_RETRY_MS * SIM_TIME_SCALE);
+    printf("%-24s %10s %6s %6s %6s %6s\n", "scenario", "to IP ms", "fast", "full", "down", "nvs");
+
+    int failures = 0;
+    for (const Scenario& scenario : SCENARIOS) {
+        Result result;
+        if (!runScenario(scenario, verbose, result) || !result.ok) {
+            printf("%-24s %10s\n", scenario.name, "timeout");
+            failures++;
+            continue;
+        }
+        printf("%-24s %10llu %6u %6u %6u %6u\n", scenario.name, (unsigned long long)result.elapsedMs,
+               result.stats.fastAttempts, result.stats.fullScans, result.attemptsDown, result.stats.nvsWrites);
+    }
+    remove(NVS_FILE);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}